@@ -0,0 +1,832 @@
+#include "AssetCooker.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "FileMapping.h"
+#include "ThreadPool.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "GLBReader.h"
+
+namespace
+{
+	//first line of the state file, bump whenever what a key covers changes
+	const char StateMagic[] = "STDCOOK 1";
+
+	//what Textures::Decode loads for a map a textured material does not name
+	const char MissingTexturePath[] = "textures/missingTexture.png";
+
+	//the import flags a mesh cache is built and named for
+	uint32_t MeshBuildFlags(unsigned int importFlags)
+	{
+		return importFlags & (OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS | OBJ_IMPORT_COMPRESSED);
+	}
+
+	enum class NodeKind
+	{
+		Mesh,
+		Library,
+		Texture
+	};
+
+	struct Node
+	{
+		NodeKind kind = NodeKind::Mesh;
+		std::string path;
+		bool exists = false;
+		std::vector<size_t> dependencies;
+
+		//the cooked file, empty for libraries which the runtime parses as they are
+		std::string output;
+		bool compress = false;
+
+		//what a mesh is built with, a mesh loaded with several sets of build flags has a node for each
+		unsigned int importFlags = 0;
+	};
+
+	struct Graph
+	{
+		std::vector<Node> nodes;
+		std::map<std::string, size_t> indices;
+
+		size_t Add(NodeKind kind, const std::string& path, unsigned int importFlags = 0)
+		{
+			std::string name = AssetPack::Normalize(path);
+			std::string key = (kind == NodeKind::Mesh) ? MeshCache::CachePath(name, MeshBuildFlags(importFlags)) : name;
+			std::map<std::string, size_t>::iterator found = indices.find(key);
+			if (found != indices.end())
+			{
+				return found->second;
+			}
+
+			Node node;
+			node.kind = kind;
+			node.path = name;
+			node.importFlags = importFlags;
+
+			std::error_code error;
+			node.exists = std::filesystem::is_regular_file(name, error);
+
+			if (kind == NodeKind::Mesh)
+			{
+				node.output = key;
+			}
+			else if (kind == NodeKind::Texture)
+			{
+				node.output = TextureCache::CookedPath(name);
+			}
+
+			indices[key] = nodes.size();
+			nodes.push_back(node);
+			return nodes.size() - 1;
+		}
+	};
+
+	struct FileState
+	{
+		uint64_t size = 0;
+		int64_t time = 0;
+		uint64_t hash = 0;
+	};
+
+	struct State
+	{
+		//content hashes, only recomputed when size or timestamp changed
+		std::map<std::string, FileState> files;
+
+		//the key every output was last cooked with
+		std::map<std::string, uint64_t> outputs;
+	};
+
+	bool HasExtension(const std::string& path, std::initializer_list<const char*> extensions)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char character) { return static_cast<char>(tolower(static_cast<unsigned char>(character))); });
+		for (const char* candidate : extensions)
+		{
+			if (extension == candidate)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//the image types stb_image decodes
+	bool IsImage(const std::string& path)
+	{
+		return HasExtension(path, { ".png", ".jpg", ".jpeg", ".tga", ".bmp" });
+	}
+
+	std::vector<std::string> FilesIn(const std::string& directory, bool recursive)
+	{
+		std::vector<std::string> files;
+		std::error_code error;
+		if (recursive)
+		{
+			for (std::filesystem::recursive_directory_iterator entry(directory, error), end; !error && (entry != end); entry.increment(error))
+			{
+				if (entry->is_regular_file(error))
+				{
+					files.push_back(entry->path().generic_string());
+				}
+			}
+		}
+		else
+		{
+			for (std::filesystem::directory_iterator entry(directory, error), end; !error && (entry != end); entry.increment(error))
+			{
+				if (entry->is_regular_file(error))
+				{
+					files.push_back(entry->path().generic_string());
+				}
+			}
+		}
+
+		//the same graph and the same pack whatever order the file system lists them in
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	//calls line for every line of the file without its line break
+	template<typename LineFunction>
+	bool ForEachLine(const std::string& filepath, LineFunction line)
+	{
+		MappedFile file;
+		if (!file.Open(filepath))
+		{
+			return false;
+		}
+
+		const char* cursor = file.Data();
+		const char* end = cursor + file.Size();
+		while (cursor < end)
+		{
+			const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+			lineEnd = (lineEnd != nullptr) ? lineEnd : end;
+
+			std::string_view text(cursor, lineEnd - cursor);
+			if (!text.empty() && (text.back() == '\r'))
+			{
+				text.remove_suffix(1);
+			}
+			line(text);
+
+			cursor = lineEnd + 1;
+		}
+		return true;
+	}
+
+	//the word before the first space and everything after it, the split ParseMTL and OBJReader use
+	std::string_view SplitWord(std::string_view line, std::string_view& rest)
+	{
+		size_t space = line.find(' ');
+		rest = (space != std::string_view::npos) ? line.substr(space + 1) : std::string_view();
+		return line.substr(0, space);
+	}
+
+	//every OBJ and GLB in the mesh tree and every image in the texture tree, plus whatever their MTL files and materials refer to
+	void BuildGraph(const AssetCooker::Options& options, Graph& graph)
+	{
+		std::vector<size_t> meshes;
+		for (const std::string& file : FilesIn(options.meshDirectory, true))
+		{
+			if (!HasExtension(file, { ".obj", ".glb" }))
+			{
+				continue;
+			}
+
+			//one cache for each set of build flags the scene loads the mesh with, meshes it does not load get the default flags
+			std::vector<unsigned int> importFlags;
+			for (const AssetCooker::MeshLoad& load : options.meshLoads)
+			{
+				if (AssetPack::Normalize(load.path) == AssetPack::Normalize(file))
+				{
+					importFlags.push_back(load.importFlags);
+				}
+			}
+			if (importFlags.empty())
+			{
+				importFlags.push_back(options.meshFlags);
+			}
+
+			for (unsigned int flags : importFlags)
+			{
+				size_t mesh = graph.Add(NodeKind::Mesh, file, flags);
+				if (std::find(meshes.begin(), meshes.end(), mesh) == meshes.end())
+				{
+					meshes.push_back(mesh);
+				}
+			}
+		}
+
+		for (size_t mesh : meshes)
+		{
+			//a .glb is its own material library
+			if (GLBReader::IsGLB(graph.nodes[mesh].path))
+			{
+				std::vector<GLBReader::Material> materials;
+				GLBReader::ReadMaterials(graph.nodes[mesh].path, materials);
+				for (const GLBReader::Material& material : materials)
+				{
+					for (const std::string* map : { &material.map_Ka, &material.map_Kd, &material.map_Ks })
+					{
+						if (material.textured && !map->empty())
+						{
+							size_t node = graph.Add(NodeKind::Texture, *map);
+							graph.nodes[node].compress = MATERIAL_TEXTURE_COMPRESSION;
+							graph.nodes[mesh].dependencies.push_back(node);
+						}
+					}
+				}
+				continue;
+			}
+
+			std::vector<std::string> libraries;
+			ForEachLine(graph.nodes[mesh].path, [&](std::string_view line)
+			{
+				std::string_view rest;
+				if ((line.size() > 7) && (line[0] == 'm') && (SplitWord(line, rest) == "mtllib"))
+				{
+					libraries.push_back(std::string(rest));
+				}
+			});
+
+			for (const std::string& library : libraries)
+			{
+				//ParseMTL looks for libraries in the mesh directory whatever directory the OBJ is in
+				size_t node = graph.Add(NodeKind::Library, options.meshDirectory + "/" + library);
+				graph.nodes[mesh].dependencies.push_back(node);
+			}
+		}
+
+		for (size_t library = 0; library < graph.nodes.size(); library++)
+		{
+			if ((graph.nodes[library].kind != NodeKind::Library) || !graph.nodes[library].exists)
+			{
+				continue;
+			}
+
+			std::vector<std::string> maps;
+			bool textured = false;
+			bool named[3] = { false, false, false };
+			auto finishMaterial = [&]()
+			{
+				for (int map = 0; textured && (map < 3); map++)
+				{
+					if (!named[map])
+					{
+						maps.push_back(MissingTexturePath);
+					}
+				}
+				textured = false;
+				named[0] = named[1] = named[2] = false;
+			};
+
+			ForEachLine(graph.nodes[library].path, [&](std::string_view line)
+			{
+				std::string_view rest;
+				std::string_view word = SplitWord(line, rest);
+				if (word == "newmtl")
+				{
+					finishMaterial();
+					return;
+				}
+
+				const char* mapWords[3][2] = { { "map_Ka", "map_ka" }, { "map_Kd", "map_kd" }, { "map_Ks", "map_ks" } };
+				for (int map = 0; map < 3; map++)
+				{
+					if ((word == mapWords[map][0]) || (word == mapWords[map][1]))
+					{
+						textured = true;
+						named[map] = !rest.empty();
+						if (!rest.empty())
+						{
+							maps.push_back(std::string(rest));
+						}
+					}
+				}
+			});
+			finishMaterial();
+
+			for (const std::string& map : maps)
+			{
+				size_t node = graph.Add(NodeKind::Texture, map);
+				graph.nodes[node].compress = MATERIAL_TEXTURE_COMPRESSION;
+				graph.nodes[library].dependencies.push_back(node);
+			}
+		}
+
+		//textures no material uses are loaded uncompressed, like the particle textures
+		for (const std::string& file : FilesIn(options.textureDirectory, true))
+		{
+			if (IsImage(file))
+			{
+				graph.Add(NodeKind::Texture, file);
+			}
+		}
+	}
+
+	bool LoadState(const std::string& stateFilepath, State& state)
+	{
+		std::ifstream file(stateFilepath);
+		std::string line;
+		if (!file.is_open() || !std::getline(file, line) || (line != StateMagic))
+		{
+			return false;
+		}
+
+		while (std::getline(file, line))
+		{
+			std::istringstream fields(line);
+			std::string kind;
+			fields >> kind;
+
+			if (kind == "file")
+			{
+				FileState fileState;
+				fields >> fileState.size >> fileState.time >> std::hex >> fileState.hash;
+				fields.get();
+
+				std::string path;
+				if (fields && std::getline(fields, path))
+				{
+					state.files[path] = fileState;
+				}
+			}
+			else if (kind == "output")
+			{
+				uint64_t key;
+				fields >> std::hex >> key;
+				fields.get();
+
+				std::string path;
+				if (fields && std::getline(fields, path))
+				{
+					state.outputs[path] = key;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool SaveState(const std::string& stateFilepath, const State& state)
+	{
+		std::string temporaryFilepath = stateFilepath + ".tmp";
+		{
+			std::ofstream file(temporaryFilepath, std::ios::trunc);
+			file << StateMagic << "\n";
+			for (const std::pair<const std::string, FileState>& entry : state.files)
+			{
+				file << "file " << entry.second.size << " " << entry.second.time << " " << std::hex << entry.second.hash << std::dec << " " << entry.first << "\n";
+			}
+			for (const std::pair<const std::string, uint64_t>& entry : state.outputs)
+			{
+				file << "output " << std::hex << entry.second << std::dec << " " << entry.first << "\n";
+			}
+
+			if (!file.good())
+			{
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryFilepath, stateFilepath, error);
+		return !error;
+	}
+
+	//fills in the content hashes of paths in current, reusing the ones already in current and the ones of files whose size and timestamp
+	//did not change since the last run. Returns how many had to be hashed
+	size_t HashFiles(const std::vector<std::string>& paths, const State& previous, State& current)
+	{
+		std::vector<FileState> states(paths.size());
+		std::vector<char> found(paths.size(), 0);
+		std::vector<char> hashed(paths.size(), 0);
+
+		ThreadPool::Shared().ParallelFor(paths.size(), [&](size_t i)
+		{
+			FileState& fileState = states[i];
+			std::map<std::string, FileState>::const_iterator hashedBefore = current.files.find(paths[i]);
+			if (hashedBefore != current.files.end())
+			{
+				fileState = hashedBefore->second;
+				found[i] = 1;
+				return;
+			}
+
+			if (!AssetPack::SourceInfo(paths[i], fileState.size, fileState.time))
+			{
+				return;
+			}
+
+			std::map<std::string, FileState>::const_iterator known = previous.files.find(paths[i]);
+			if ((known != previous.files.end()) && (known->second.size == fileState.size) && (known->second.time == fileState.time))
+			{
+				fileState.hash = known->second.hash;
+				found[i] = 1;
+				return;
+			}
+
+			MappedFile file;
+			if (file.Open(paths[i]))
+			{
+				fileState.hash = MeshCache::HashFile(file.Data(), file.Size());
+				found[i] = 1;
+				hashed[i] = 1;
+			}
+		});
+
+		size_t hashedCount = 0;
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			if (found[i] != 0)
+			{
+				current.files[paths[i]] = states[i];
+			}
+			hashedCount += hashed[i];
+		}
+		return hashedCount;
+	}
+
+	uint64_t Key(std::initializer_list<uint64_t> values)
+	{
+		return MeshCache::HashFile(reinterpret_cast<const char*>(values.begin()), values.size() * sizeof(uint64_t));
+	}
+
+	uint64_t HashText(const std::string& text)
+	{
+		return MeshCache::HashFile(text.data(), text.size());
+	}
+
+	//what the output of node would be cooked from and with, a cooked output is current as long as this stays the same
+	uint64_t OutputKey(const Node& node, const State& state)
+	{
+		uint64_t sourceHash = state.files.at(node.path).hash;
+		if (node.kind == NodeKind::Mesh)
+		{
+			return Key({ 1, MeshBuildFlags(node.importFlags), sourceHash });
+		}
+		return Key({ 2, node.compress ? 1u : 0u, sourceHash });
+	}
+
+	//points a current output at its touched source, fails if the output is no longer what the runtime would accept
+	bool Restamp(const Node& node, const State& state)
+	{
+		if (node.kind == NodeKind::Mesh)
+		{
+			return MeshCache::Restamp(node.output, node.path, MeshBuildFlags(node.importFlags), state.files.at(node.path).hash);
+		}
+		return TextureCache::Restamp(node.output, node.path, node.compress);
+	}
+
+	bool Cook(const Node& node)
+	{
+		if (node.kind == NodeKind::Mesh)
+		{
+			MeshData mesh;
+			return AssetCooker::BuildMesh(node.path, node.importFlags, mesh, false) &&
+				MeshCache::Write(node.output, node.path, mesh, MeshBuildFlags(node.importFlags), (node.importFlags & OBJ_IMPORT_COMPRESSED) != 0);
+		}
+
+		TextureCache::CookedTexture texture;
+		return TextureCache::Cook(node.path, node.compress, texture) && TextureCache::Write(node.output, node.path, node.compress, texture);
+	}
+}
+
+bool AssetCooker::BuildMesh(const std::string& OBJFilepath, unsigned int importFlags, MeshData& mesh, bool verbose)
+{
+	if (GLBReader::IsGLB(OBJFilepath))
+	{
+		GLBReader::ReadStats stats;
+		if (!GLBReader::Read(OBJFilepath, mesh, &stats))
+		{
+			return false;
+		}
+
+		if (verbose)
+		{
+			std::cout << OBJFilepath << ": read " << stats.bytes / 1024 << " KB in " << stats.seconds * 1000.0 << " ms (" << stats.MegabytesPerSecond() << " MB/s)" << std::endl;
+		}
+	}
+	else
+	{
+		OBJReader::ReadStats stats;
+		if (!OBJReader::Read(OBJFilepath, mesh, importFlags, &stats))
+		{
+			return false;
+		}
+
+		if (verbose)
+		{
+			std::cout << OBJFilepath << ": parsed " << stats.bytes / 1024 << " KB in " << stats.seconds * 1000.0 << " ms (" << stats.MegabytesPerSecond() << " MB/s, " << stats.chunks << " chunks)" << std::endl;
+		}
+	}
+
+	if ((importFlags & OBJ_IMPORT_OPTIMIZE) != 0)
+	{
+		MeshOptimizer::OptimizeStats optimized = MeshOptimizer::Optimize(mesh);
+
+		if (verbose)
+		{
+			std::cout << OBJFilepath << ": optimized, ACMR " << optimized.before.ACMR << " -> " << optimized.after.ACMR << ", ATVR " << optimized.before.ATVR << " -> " << optimized.after.ATVR
+				<< ", " << optimized.verticesBefore << " -> " << optimized.verticesAfter << " vertices, " << optimized.submeshesBefore << " -> " << optimized.submeshesAfter << " submeshes" << std::endl;
+		}
+	}
+
+	if ((importFlags & OBJ_IMPORT_LOD) != 0)
+	{
+		MeshSimplifier::BuildLODs(mesh, STDOBJ_LOD_LEVELS);
+		MeshOptimizer::OptimizeLODs(mesh);
+
+		if (verbose)
+		{
+			std::cout << OBJFilepath << ": " << mesh.lods.size() << " levels of detail";
+			for (const MeshLOD& lod : mesh.lods)
+			{
+				int indexCount = 0;
+				for (const Submesh& submesh : lod.submeshes)
+				{
+					indexCount += submesh.size;
+				}
+				std::cout << ", " << indexCount / 3 << " triangles (error " << lod.error << ")";
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	if ((importFlags & OBJ_IMPORT_MESHLETS) != 0)
+	{
+		Meshlets::Build(mesh);
+
+		if (verbose)
+		{
+			std::cout << OBJFilepath << ": " << mesh.meshlets.size() << " meshlets" << std::endl;
+		}
+	}
+
+	return true;
+}
+
+bool AssetCooker::Run(const Options& options, Report& report)
+{
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+	report = Report();
+
+	Graph graph;
+	BuildGraph(options, graph);
+
+	State previous;
+	if (!options.force)
+	{
+		LoadState(options.stateFilepath, previous);
+	}
+
+	std::vector<std::string> sources;
+	for (const Node& node : graph.nodes)
+	{
+		if (!node.exists && !options.verbose)
+		{
+			report.missing++;
+			continue;
+		}
+		if (!node.exists)
+		{
+			std::cerr << "Missing asset: " << node.path;
+			for (const Node& user : graph.nodes)
+			{
+				if (std::find_if(user.dependencies.begin(), user.dependencies.end(), [&](size_t dependency) { return graph.nodes[dependency].path == node.path; }) != user.dependencies.end())
+				{
+					std::cerr << ", used by " << user.path;
+				}
+			}
+			std::cerr << std::endl;
+			report.missing++;
+			continue;
+		}
+
+		if (std::find(sources.begin(), sources.end(), node.path) == sources.end())
+		{
+			sources.push_back(node.path);
+		}
+		report.meshes += (node.kind == NodeKind::Mesh) ? 1 : 0;
+		report.libraries += (node.kind == NodeKind::Library) ? 1 : 0;
+		report.textures += (node.kind == NodeKind::Texture) ? 1 : 0;
+	}
+
+	State current;
+	report.hashed += HashFiles(sources, previous, current);
+
+	//largest first, so a big mesh does not start last and keep every other thread waiting
+	std::vector<size_t> outdated;
+	for (size_t i = 0; i < graph.nodes.size(); i++)
+	{
+		const Node& node = graph.nodes[i];
+		if (node.output.empty() || !node.exists || (current.files.count(node.path) == 0))
+		{
+			continue;
+		}
+
+		uint64_t key = OutputKey(node, current);
+		std::map<std::string, uint64_t>::const_iterator cooked = previous.outputs.find(node.output);
+		if ((cooked != previous.outputs.end()) && (cooked->second == key) && Restamp(node, current))
+		{
+			std::map<std::string, FileState>::const_iterator known = previous.files.find(node.path);
+			bool touched = (known == previous.files.end()) || (known->second.time != current.files[node.path].time);
+			report.restamped += touched ? 1 : 0;
+			report.upToDate++;
+			current.outputs[node.output] = key;
+			continue;
+		}
+		outdated.push_back(i);
+	}
+	std::sort(outdated.begin(), outdated.end(), [&](size_t a, size_t b) { return current.files[graph.nodes[a].path].size > current.files[graph.nodes[b].path].size; });
+
+	std::vector<char> succeeded(outdated.size(), 0);
+	std::mutex logMutex;
+	ThreadPool::Shared().ParallelFor(outdated.size(), [&](size_t i)
+	{
+		const Node& node = graph.nodes[outdated[i]];
+
+		std::chrono::time_point<std::chrono::steady_clock> cookStart = std::chrono::steady_clock::now();
+		succeeded[i] = Cook(node) ? 1 : 0;
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - cookStart;
+
+		std::lock_guard<std::mutex> lock(logMutex);
+		if (succeeded[i] == 0)
+		{
+			std::cerr << "Failed to cook: " << node.path << std::endl;
+		}
+		else if (options.verbose)
+		{
+			std::cout << "  cooked " << node.output << " in " << elapsed.count() << " ms" << std::endl;
+		}
+	});
+
+	for (size_t i = 0; i < outdated.size(); i++)
+	{
+		const Node& node = graph.nodes[outdated[i]];
+		if (succeeded[i] != 0)
+		{
+			current.outputs[node.output] = OutputKey(node, current);
+			report.cooked++;
+		}
+		else
+		{
+			report.failed++;
+		}
+	}
+
+	if (!options.packFilepath.empty())
+	{
+		//sources and outputs are compressed where it pays, except what is better used straight out of the mapping:
+		//OBJ files can be streamed, GLB buffer views and cooked texture levels go to the device as they are
+		std::vector<AssetPack::Source> members;
+		for (const Node& node : graph.nodes)
+		{
+			if (!node.exists)
+			{
+				continue;
+			}
+			if (std::find_if(members.begin(), members.end(), [&](const AssetPack::Source& member) { return member.path == node.path; }) == members.end())
+			{
+				members.push_back({ node.path, node.kind == NodeKind::Library });
+			}
+			if (current.outputs.count(node.output) != 0)
+			{
+				members.push_back({ node.output, node.kind == NodeKind::Mesh });
+			}
+		}
+		for (const std::string& file : FilesIn(options.shaderDirectory, false))
+		{
+			if (HasExtension(file, { ".cso" }))
+			{
+				members.push_back({ AssetPack::Normalize(file), true });
+			}
+		}
+
+		std::vector<std::string> memberPaths;
+		for (const AssetPack::Source& member : members)
+		{
+			memberPaths.push_back(member.path);
+		}
+		report.hashed += HashFiles(memberPaths, previous, current);
+
+		uint64_t key = Key({ 3, members.size() });
+		for (const AssetPack::Source& member : members)
+		{
+			std::map<std::string, FileState>::const_iterator file = current.files.find(member.path);
+			key = Key({ key, HashText(member.path), (file != current.files.end()) ? file->second.hash : 0, member.compress ? 1u : 0u });
+		}
+
+		std::error_code error;
+		std::map<std::string, uint64_t>::const_iterator built = previous.outputs.find(options.packFilepath);
+		if ((built == previous.outputs.end()) || (built->second != key) || !std::filesystem::is_regular_file(options.packFilepath, error))
+		{
+			if (AssetPack::Build(options.packFilepath, members))
+			{
+				current.outputs[options.packFilepath] = key;
+				report.packBuilt = true;
+			}
+			else
+			{
+				report.failed++;
+			}
+		}
+		else
+		{
+			current.outputs[options.packFilepath] = key;
+		}
+	}
+
+	if (!SaveState(options.stateFilepath, current))
+	{
+		std::cerr << "Failed to save cook state: " << options.stateFilepath << std::endl;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	report.seconds = elapsed.count();
+
+	if (options.verbose)
+	{
+		std::cout << report.meshes << " meshes, " << report.libraries << " material libraries, " << report.textures << " textures: " << report.cooked << " cooked, "
+			<< report.upToDate << " up to date (" << report.restamped << " restamped), " << report.failed << " failed, " << report.missing << " missing, "
+			<< report.hashed << " files hashed" << (report.packBuilt ? ", pack rebuilt" : "") << " in " << report.seconds * 1000.0 << " ms" << std::endl;
+	}
+
+	return report.failed == 0;
+}
+
+int AssetCooker::Main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if (argument == "-force")
+		{
+			options.force = true;
+		}
+		else if (argument == "-quiet")
+		{
+			options.verbose = false;
+		}
+		else if ((argument == "-pack") && (i + 1 < argc))
+		{
+			options.packFilepath = argv[++i];
+		}
+		else if ((argument == "-flags") && (i + 1 < argc))
+		{
+			//comma separated, "none" for caches of the plain parsed mesh, cooks every mesh with these instead of the scene's flags
+			options.meshLoads.clear();
+			options.meshFlags = OBJ_IMPORT_PARALLEL;
+			std::istringstream flags(argv[++i]);
+			std::string flag;
+			while (std::getline(flags, flag, ','))
+			{
+				if (flag == "optimize")
+				{
+					options.meshFlags |= OBJ_IMPORT_OPTIMIZE;
+				}
+				else if (flag == "lod")
+				{
+					options.meshFlags |= OBJ_IMPORT_LOD;
+				}
+				else if (flag == "meshlets")
+				{
+					options.meshFlags |= OBJ_IMPORT_MESHLETS;
+				}
+				else if (flag == "compressed")
+				{
+					options.meshFlags |= OBJ_IMPORT_COMPRESSED;
+				}
+				else if (flag != "none")
+				{
+					std::cerr << "Unknown mesh flag: " << flag << std::endl;
+					return 2;
+				}
+			}
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-force] [-quiet] [-pack <file>] [-flags optimize,lod,meshlets,compressed|none]" << std::endl;
+			return 2;
+		}
+	}
+
+	Report report;
+	return Run(options, report) ? 0 : 1;
+}
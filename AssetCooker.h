@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "MeshData.h"
+#include "OBJReader.h"
+
+//the flags main.cpp loads its meshes with, the cooker writes a cache for each so the scene never builds one itself
+#define SCENE_HUGIN_FLAGS (OBJ_IMPORT_PARALLEL | OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_COMPACT | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS | OBJ_IMPORT_COMPRESSED)
+#define SCENE_CORNER_CUBE_FLAGS (OBJ_IMPORT_PARALLEL | OBJ_IMPORT_COMPACT | OBJ_IMPORT_LOD)
+#define SCENE_FLOOR_CUBE_FLAGS (OBJ_IMPORT_PARALLEL | OBJ_IMPORT_TRIM_VERTICES)
+
+//Offline cooking of the asset library into what the runtime loads without converting anything: mesh caches and cooked textures,
+//optionally packed into one AssetPack. Scans the mesh and texture trees into a dependency graph (OBJ to MTL to textures, GLB to textures) and only
+//cooks outputs whose inputs changed, decided by content hash. Runs from the command line, see CookerMain.cpp
+namespace AssetCooker
+{
+	struct MeshLoad
+	{
+		std::string path;
+		unsigned int importFlags = 0;
+	};
+
+	//the meshes main.cpp loads with flags of their own, the tessellated and mirror meshes use the STDOBJ default
+	inline std::vector<MeshLoad> SceneMeshLoads()
+	{
+		return { { "OBJ/Hugin.obj", SCENE_HUGIN_FLAGS }, { "OBJ/simpleCube.obj", SCENE_CORNER_CUBE_FLAGS }, { "OBJ/simpleCube.obj", SCENE_FLOOR_CUBE_FLAGS } };
+	}
+
+	struct Options
+	{
+		//relative to the working directory like every path the runtime loads
+		std::string meshDirectory = "OBJ";
+		std::string textureDirectory = "textures";
+		std::string shaderDirectory = ".";
+
+		//content hashes of the inputs and the key every output was cooked with
+		std::string stateFilepath = "assets.cookstate";
+
+		//built from all sources, outputs and compiled shaders when not empty
+		std::string packFilepath = "";
+
+		//a mesh gets a cache for every set of build flags it is loaded with, meshes no load names are cooked with meshFlags
+		std::vector<MeshLoad> meshLoads = SceneMeshLoads();
+		unsigned int meshFlags = OBJ_IMPORT_PARALLEL;
+
+		//cook everything, as if nothing was cooked before
+		bool force = false;
+		bool verbose = true;
+	};
+
+	struct Report
+	{
+		//mesh caches, one per mesh and set of build flags
+		size_t meshes = 0;
+		size_t libraries = 0;
+		size_t textures = 0;
+
+		size_t cooked = 0;
+		size_t upToDate = 0;
+
+		//up to date, but their source was touched so the header had to take over its new timestamp
+		size_t restamped = 0;
+		size_t failed = 0;
+
+		//referenced by an OBJ or MTL but not on disk
+		size_t missing = 0;
+
+		//inputs hashed because their size or timestamp changed since the last run
+		size_t hashed = 0;
+
+		bool packBuilt = false;
+		double seconds = 0.0;
+	};
+
+	//parses the OBJ or GLB file and builds whatever importFlags ask for on the whole mesh: optimization, levels of detail and meshlets.
+	//What STDOBJ runs when there is no current cache, so the cooker writes exactly the caches a load would
+	bool BuildMesh(const std::string& OBJFilepath, unsigned int importFlags, MeshData& mesh, bool verbose = true);
+
+	//cooks in parallel on the shared thread pool, fails if any output could not be cooked
+	bool Run(const Options& options, Report& report);
+
+	//command line of the cooker executable, returns the process exit code
+	int Main(int argc, char** argv);
+}
@@ -0,0 +1,639 @@
+#include "AssetPack.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+
+#include "FileMapping.h"
+
+namespace
+{
+	const char Magic[4] = { 'S', 'T', 'P', 'K' };
+
+	//bump whenever the layout of the pack or the compression changes
+	const uint32_t Version = 1;
+
+	//entry data starts on a cache line so anything mapped from it can be read with aligned loads
+	const uint64_t DataAlignment = 64;
+
+	const uint32_t EmptyBucket = 0xFFFFFFFF;
+
+	enum Compression : uint32_t
+	{
+		Stored = 0,
+		LZ = 1
+	};
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t bucketCount;
+
+		uint64_t entryOffset;
+		uint64_t bucketOffset;
+		uint64_t nameOffset;
+		uint64_t nameBytes;
+		uint64_t dataOffset;
+	};
+
+	struct EntryRecord
+	{
+		uint64_t hash;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t storedSize;
+		int64_t sourceTime;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t compression;
+		uint32_t padding;
+	};
+
+	struct Mounted
+	{
+		MappedFile file;
+		std::vector<EntryRecord> entries;
+		std::vector<uint32_t> buckets;
+		std::string names;
+	};
+
+	std::mutex mountMutex;
+	std::shared_ptr<const Mounted> mounted;
+
+	std::shared_ptr<const Mounted> CurrentPack()
+	{
+		std::lock_guard<std::mutex> lock(mountMutex);
+		return mounted;
+	}
+
+	uint64_t Align(uint64_t value)
+	{
+		return (value + DataAlignment - 1) / DataAlignment * DataAlignment;
+	}
+
+	//FNV-1a
+	uint64_t HashName(const std::string& name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (char character : name)
+		{
+			hash ^= static_cast<uint8_t>(character);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//index into entries, or -1
+	int64_t Find(const Mounted& pack, const std::string& name)
+	{
+		if (pack.buckets.empty())
+		{
+			return -1;
+		}
+
+		uint64_t hash = HashName(name);
+		size_t mask = pack.buckets.size() - 1;
+		for (size_t bucket = hash & mask, probes = 0; probes < pack.buckets.size(); bucket = (bucket + 1) & mask, probes++)
+		{
+			uint32_t index = pack.buckets[bucket];
+			if (index == EmptyBucket)
+			{
+				return -1;
+			}
+
+			const EntryRecord& entry = pack.entries[index];
+			if ((entry.hash == hash) && (entry.nameLength == name.size()) && (pack.names.compare(entry.nameOffset, entry.nameLength, name) == 0))
+			{
+				return index;
+			}
+		}
+		return -1;
+	}
+
+	bool LooseInfo(const std::string& filepath, uint64_t& size, int64_t& time)
+	{
+		std::error_code error;
+		size = static_cast<uint64_t>(std::filesystem::file_size(filepath, error));
+		if (error)
+		{
+			return false;
+		}
+
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filepath, error);
+		if (error)
+		{
+			return false;
+		}
+
+		time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+		return true;
+	}
+
+	//Byte oriented LZ77 in the layout of an LZ4 block: a token with 4 bits of literal length and 4 bits of match length, longer lengths
+	//continued in bytes of 255, the literals, then a 2 byte offset back into the output. The last sequence has literals only.
+	//Greedy matching through a hash of the next 4 bytes, fast enough to run on every build and cheap to decode
+	const size_t MinimumMatch = 4;
+	const size_t MaximumOffset = 0xFFFF;
+	const int HashBits = 16;
+
+	//every byte of a match length continuation adds at most 255 bytes, so nothing decompresses to more than this many times its size
+	const uint64_t MaximumExpansion = 256;
+
+	void AppendLength(std::vector<uint8_t>& output, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			output.push_back(255);
+		}
+		output.push_back(static_cast<uint8_t>(length));
+	}
+
+	void AppendSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		size_t matchCode = (matchLength != 0) ? matchLength - MinimumMatch : 0;
+		output.push_back(static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+		if (literalCount >= 15)
+		{
+			AppendLength(output, literalCount - 15);
+		}
+		output.insert(output.end(), literals, literals + literalCount);
+
+		if (matchLength == 0)
+		{
+			return;
+		}
+
+		output.push_back(static_cast<uint8_t>(offset & 0xFF));
+		output.push_back(static_cast<uint8_t>(offset >> 8));
+		if (matchCode >= 15)
+		{
+			AppendLength(output, matchCode - 15);
+		}
+	}
+
+	void Compress(const uint8_t* input, size_t size, std::vector<uint8_t>& output)
+	{
+		output.clear();
+		output.reserve(size + size / 255 + 16);
+
+		//position + 1 of the last time a 4 byte sequence hashed here, 0 for never
+		std::vector<uint32_t> table(size_t(1) << HashBits, 0);
+
+		size_t anchor = 0;
+		size_t position = 0;
+		while (position + MinimumMatch <= size)
+		{
+			uint32_t sequence;
+			memcpy(&sequence, input + position, sizeof(uint32_t));
+			uint32_t hash = (sequence * 2654435761u) >> (32 - HashBits);
+
+			size_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(position + 1);
+
+			if ((candidate == 0) || (position - (candidate - 1) > MaximumOffset) || (memcmp(input + candidate - 1, input + position, MinimumMatch) != 0))
+			{
+				position++;
+				continue;
+			}
+
+			size_t match = candidate - 1;
+			size_t length = MinimumMatch;
+			while ((position + length < size) && (input[match + length] == input[position + length]))
+			{
+				length++;
+			}
+
+			AppendSequence(output, input + anchor, position - anchor, position - match, length);
+			position += length;
+			anchor = position;
+		}
+
+		AppendSequence(output, input + anchor, size - anchor, 0, 0);
+	}
+
+	bool ReadLength(const uint8_t*& cursor, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (cursor == end)
+			{
+				return false;
+			}
+			byte = *cursor++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	//fails on anything that does not decode to exactly size bytes, without reading or writing out of bounds
+	bool Decompress(const uint8_t* input, size_t inputSize, uint8_t* output, size_t size)
+	{
+		const uint8_t* cursor = input;
+		const uint8_t* end = input + inputSize;
+		size_t written = 0;
+
+		while (cursor != end)
+		{
+			uint8_t token = *cursor++;
+
+			size_t literalCount = token >> 4;
+			if ((literalCount == 15) && !ReadLength(cursor, end, literalCount))
+			{
+				return false;
+			}
+			if ((static_cast<size_t>(end - cursor) < literalCount) || (size - written < literalCount))
+			{
+				return false;
+			}
+			memcpy(output + written, cursor, literalCount);
+			cursor += literalCount;
+			written += literalCount;
+
+			if (cursor == end)
+			{
+				break;
+			}
+
+			if (end - cursor < 2)
+			{
+				return false;
+			}
+			size_t offset = cursor[0] | (static_cast<size_t>(cursor[1]) << 8);
+			cursor += 2;
+
+			size_t matchLength = token & 0x0F;
+			if ((matchLength == 15) && !ReadLength(cursor, end, matchLength))
+			{
+				return false;
+			}
+			matchLength += MinimumMatch;
+
+			if ((offset == 0) || (offset > written) || (size - written < matchLength))
+			{
+				return false;
+			}
+
+			//the match may overlap what it writes, runs of a short pattern rely on that. What is copied repeats every offset bytes,
+			//so it is copied from its own start in chunks that double and never overlap
+			uint8_t* to = output + written;
+			size_t copied = std::min(offset, matchLength);
+			memcpy(to, to - offset, copied);
+			while (copied < matchLength)
+			{
+				size_t chunk = std::min(copied, matchLength - copied);
+				memcpy(to + copied, to, chunk);
+				copied += chunk;
+			}
+			written += matchLength;
+		}
+
+		return written == size;
+	}
+
+	bool Validate(const Mounted& pack, const Header& header)
+	{
+		uint64_t fileSize = pack.file.Size();
+		for (const EntryRecord& entry : pack.entries)
+		{
+			if ((static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > pack.names.size()) || (entry.offset > fileSize) ||
+				(fileSize - entry.offset < entry.storedSize) || (entry.offset < header.dataOffset) || (entry.compression > LZ) ||
+				((entry.compression == Stored) && (entry.storedSize != entry.size)) || ((entry.compression == LZ) && (entry.size / MaximumExpansion > entry.storedSize)))
+			{
+				return false;
+			}
+			if (entry.hash != HashName(pack.names.substr(entry.nameOffset, entry.nameLength)))
+			{
+				return false;
+			}
+		}
+
+		for (uint32_t index : pack.buckets)
+		{
+			if ((index != EmptyBucket) && (index >= pack.entries.size()))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+Asset::Asset() : owner(nullptr), data(nullptr), size(0)
+{
+}
+
+Asset::Asset(std::shared_ptr<const void> owner, const char* data, size_t size) : owner(std::move(owner)), data(data), size(size)
+{
+}
+
+bool Asset::IsOpen() const
+{
+	return owner != nullptr;
+}
+
+const char* Asset::Data() const
+{
+	return data;
+}
+
+size_t Asset::Size() const
+{
+	return size;
+}
+
+void Asset::Close()
+{
+	owner = nullptr;
+	data = nullptr;
+	size = 0;
+}
+
+std::string AssetPack::Normalize(const std::string& path)
+{
+	std::string name = path;
+	for (char& character : name)
+	{
+		if (character == '\\')
+		{
+			character = '/';
+		}
+	}
+	while (name.compare(0, 2, "./") == 0)
+	{
+		name.erase(0, 2);
+	}
+	return name;
+}
+
+bool AssetPack::Build(const std::string& packFilepath, const std::vector<Source>& sources)
+{
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.entryCount = static_cast<uint32_t>(sources.size());
+
+	//at most half full, so a lookup of a missing name stops at an empty bucket soon
+	header.bucketCount = 1;
+	while (header.bucketCount < sources.size() * 2)
+	{
+		header.bucketCount *= 2;
+	}
+
+	std::vector<EntryRecord> entries(sources.size());
+	std::vector<uint32_t> buckets(header.bucketCount, EmptyBucket);
+	std::string names;
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		std::string name = Normalize(sources[i].path);
+
+		EntryRecord& entry = entries[i];
+		entry.hash = HashName(name);
+		entry.nameOffset = static_cast<uint32_t>(names.size());
+		entry.nameLength = static_cast<uint32_t>(name.size());
+		names += name;
+
+		size_t mask = buckets.size() - 1;
+		size_t bucket = entry.hash & mask;
+		for (; buckets[bucket] != EmptyBucket; bucket = (bucket + 1) & mask)
+		{
+			const EntryRecord& other = entries[buckets[bucket]];
+			if ((other.hash == entry.hash) && (names.compare(other.nameOffset, other.nameLength, name) == 0))
+			{
+				std::cerr << "Asset added to pack twice: " << name << std::endl;
+				return false;
+			}
+		}
+		buckets[bucket] = static_cast<uint32_t>(i);
+	}
+
+	header.entryOffset = sizeof(Header);
+	header.bucketOffset = header.entryOffset + sizeof(EntryRecord) * entries.size();
+	header.nameOffset = header.bucketOffset + sizeof(uint32_t) * buckets.size();
+	header.nameBytes = names.size();
+	header.dataOffset = Align(header.nameOffset + header.nameBytes);
+
+	std::ostringstream temporaryName;
+	temporaryName << packFilepath << "." << std::this_thread::get_id() << ".tmp";
+	std::string temporaryFilepath = temporaryName.str();
+	{
+		std::ofstream pack(temporaryFilepath, std::ios::binary | std::ios::trunc);
+		if (!pack.is_open())
+		{
+			std::cerr << "Failed to create asset pack: " << packFilepath << std::endl;
+			return false;
+		}
+
+		//the table of contents is written last, once the offsets of the data are known
+		const char zeros[DataAlignment] = {};
+		uint64_t offset = 0;
+		for (; offset + DataAlignment <= header.dataOffset; offset += DataAlignment)
+		{
+			pack.write(zeros, DataAlignment);
+		}
+		pack.write(zeros, header.dataOffset - offset);
+		offset = header.dataOffset;
+
+		std::vector<uint8_t> compressed;
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			EntryRecord& entry = entries[i];
+
+			MappedFile source;
+			if (!LooseInfo(sources[i].path, entry.size, entry.sourceTime) || !source.Open(sources[i].path) || (source.Size() != entry.size))
+			{
+				pack.close();
+				std::error_code error;
+				std::filesystem::remove(temporaryFilepath, error);
+				std::cerr << "Failed to add asset to pack: " << sources[i].path << std::endl;
+				return false;
+			}
+
+			const char* stored = source.Data();
+			entry.storedSize = entry.size;
+			entry.compression = Stored;
+			if (sources[i].compress && (source.Size() != 0))
+			{
+				Compress(reinterpret_cast<const uint8_t*>(source.Data()), source.Size(), compressed);
+				if (compressed.size() <= source.Size() - source.Size() / 8)
+				{
+					stored = reinterpret_cast<const char*>(compressed.data());
+					entry.storedSize = compressed.size();
+					entry.compression = LZ;
+				}
+			}
+
+			entry.offset = offset;
+			pack.write(stored, entry.storedSize);
+			pack.write(zeros, Align(entry.storedSize) - entry.storedSize);
+			offset += Align(entry.storedSize);
+		}
+
+		pack.seekp(0);
+		pack.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		pack.write(reinterpret_cast<const char*>(entries.data()), sizeof(EntryRecord) * entries.size());
+		pack.write(reinterpret_cast<const char*>(buckets.data()), sizeof(uint32_t) * buckets.size());
+		pack.write(names.data(), names.size());
+
+		if (!pack.good())
+		{
+			pack.close();
+			std::error_code error;
+			std::filesystem::remove(temporaryFilepath, error);
+			std::cerr << "Failed to write asset pack: " << packFilepath << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilepath, packFilepath, error);
+	if (error)
+	{
+		std::filesystem::remove(temporaryFilepath, error);
+		std::cerr << "Failed to write asset pack: " << packFilepath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool AssetPack::Mount(const std::string& packFilepath)
+{
+	Unmount();
+
+	std::shared_ptr<Mounted> pack = std::make_shared<Mounted>();
+	if (!pack->file.Open(packFilepath) || (pack->file.Size() < sizeof(Header)))
+	{
+		std::cerr << "Failed to open asset pack: " << packFilepath << std::endl;
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, pack->file.Data(), sizeof(Header));
+
+	uint64_t fileSize = pack->file.Size();
+	if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || (header.bucketCount == 0) ||
+		((header.bucketCount & (header.bucketCount - 1)) != 0) || (header.bucketCount < header.entryCount) ||
+		(header.entryOffset + sizeof(EntryRecord) * static_cast<uint64_t>(header.entryCount) > fileSize) ||
+		(header.bucketOffset + sizeof(uint32_t) * static_cast<uint64_t>(header.bucketCount) > fileSize) ||
+		(header.nameOffset > fileSize) || (fileSize - header.nameOffset < header.nameBytes) || (header.dataOffset > fileSize))
+	{
+		std::cerr << "Not a valid asset pack: " << packFilepath << std::endl;
+		return false;
+	}
+
+	//the table of contents is small, copied out of the mapping so nothing in it has to be aligned
+	pack->entries.resize(header.entryCount);
+	pack->buckets.resize(header.bucketCount);
+	memcpy(pack->entries.data(), pack->file.Data() + header.entryOffset, sizeof(EntryRecord) * pack->entries.size());
+	memcpy(pack->buckets.data(), pack->file.Data() + header.bucketOffset, sizeof(uint32_t) * pack->buckets.size());
+	pack->names.assign(pack->file.Data() + header.nameOffset, header.nameBytes);
+
+	if (!Validate(*pack, header))
+	{
+		std::cerr << "Not a valid asset pack: " << packFilepath << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mountMutex);
+	mounted = pack;
+	return true;
+}
+
+void AssetPack::Unmount()
+{
+	std::lock_guard<std::mutex> lock(mountMutex);
+	mounted = nullptr;
+}
+
+bool AssetPack::IsMounted()
+{
+	return CurrentPack() != nullptr;
+}
+
+bool AssetPack::Contains(const std::string& path)
+{
+	std::shared_ptr<const Mounted> pack = CurrentPack();
+	return (pack != nullptr) && (Find(*pack, Normalize(path)) >= 0);
+}
+
+std::vector<AssetPack::EntryInfo> AssetPack::Entries()
+{
+	std::vector<EntryInfo> infos;
+
+	std::shared_ptr<const Mounted> pack = CurrentPack();
+	if (pack == nullptr)
+	{
+		return infos;
+	}
+
+	for (const EntryRecord& entry : pack->entries)
+	{
+		EntryInfo info;
+		info.path = pack->names.substr(entry.nameOffset, entry.nameLength);
+		info.offset = entry.offset;
+		info.size = entry.size;
+		info.storedSize = entry.storedSize;
+		info.compressed = entry.compression != Stored;
+		infos.push_back(info);
+	}
+	return infos;
+}
+
+bool AssetPack::Open(const std::string& path, Asset& asset)
+{
+	asset.Close();
+
+	std::shared_ptr<const Mounted> pack = CurrentPack();
+	int64_t index = (pack != nullptr) ? Find(*pack, Normalize(path)) : -1;
+
+	if (index >= 0)
+	{
+		const EntryRecord& entry = pack->entries[index];
+		const char* stored = pack->file.Data() + entry.offset;
+
+		if (entry.compression == Stored)
+		{
+			asset = Asset(pack, stored, entry.size);
+			return true;
+		}
+
+		std::shared_ptr<std::vector<char>> decompressed = std::make_shared<std::vector<char>>(entry.size);
+		if (!Decompress(reinterpret_cast<const uint8_t*>(stored), entry.storedSize, reinterpret_cast<uint8_t*>(decompressed->data()), entry.size))
+		{
+			return false;
+		}
+		asset = Asset(decompressed, decompressed->data(), decompressed->size());
+		return true;
+	}
+
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	if (!file->Open(path))
+	{
+		return false;
+	}
+	asset = Asset(file, file->Data(), file->Size());
+	return true;
+}
+
+bool AssetPack::SourceInfo(const std::string& path, uint64_t& size, int64_t& time)
+{
+	std::shared_ptr<const Mounted> pack = CurrentPack();
+	int64_t index = (pack != nullptr) ? Find(*pack, Normalize(path)) : -1;
+
+	if (index >= 0)
+	{
+		size = pack->entries[index].size;
+		time = pack->entries[index].sourceTime;
+		return true;
+	}
+
+	return LooseInfo(path, size, time);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+//Read only bytes of one asset: a span of the mounted pack, a mapped loose file or the decompressed copy of a compressed pack entry.
+//Copies share the bytes, they stay valid until the last copy is closed, even if the pack is unmounted in between
+class Asset
+{
+	public :
+		Asset();
+		Asset(std::shared_ptr<const void> owner, const char* data, size_t size);
+
+		bool IsOpen() const;
+		const char* Data() const;
+		size_t Size() const;
+		void Close();
+
+	private :
+		std::shared_ptr<const void> owner;
+		const char* data;
+		size_t size;
+};
+
+//Single file archive of the assets that are otherwise opened one by one by relative path: the OBJ and MTL files, the textures,
+//their caches and the compiled shaders. A hashed table of contents at the front finds an entry without touching the others,
+//entries start on 64 byte boundaries and are read straight out of one mapping of the whole pack.
+//While a pack is mounted every asset is looked up in it first and loaded from the loose file only if the pack does not have it
+namespace AssetPack
+{
+	//mounted by the scene at startup when it exists next to the executable
+	const char DefaultPath[] = "assets.stpack";
+
+	struct Source
+	{
+		//relative path as the loaders ask for it, which is also the name in the pack
+		std::string path;
+
+		//stored compressed if that saves at least an eighth, a compressed entry is decompressed into memory when opened
+		bool compress = false;
+	};
+
+	struct EntryInfo
+	{
+		std::string path;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t storedSize = 0;
+		bool compressed = false;
+	};
+
+	//the name an asset is stored and looked up under: forward slashes and no leading "./"
+	std::string Normalize(const std::string& path);
+
+	//reads every source from its loose file. Written to a temporary first, an existing pack is only replaced by a complete one
+	bool Build(const std::string& packFilepath, const std::vector<Source>& sources);
+
+	//replaces the mounted pack, assets opened from the old one stay valid. A pack that fails validation leaves nothing mounted
+	bool Mount(const std::string& packFilepath);
+	void Unmount();
+	bool IsMounted();
+
+	bool Contains(const std::string& path);
+	std::vector<EntryInfo> Entries();
+
+	//from the mounted pack, else from the loose file. Fails quietly if neither has it or a compressed entry is damaged
+	bool Open(const std::string& path, Asset& asset);
+
+	//size and write time of the loose file the asset came from, the time is what the caches compare against
+	bool SourceInfo(const std::string& path, uint64_t& size, int64_t& time);
+}
@@ -0,0 +1,59 @@
+#include "AsyncLoading.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include "ThreadPool.h"
+
+namespace
+{
+	std::mutex mainThreadMutex;
+	std::vector<std::coroutine_handle<>> mainThreadQueue;
+
+	std::atomic<size_t> pendingTasks(0);
+}
+
+void AsyncLoading::WorkerAwaitable::await_suspend(std::coroutine_handle<> handle) const
+{
+	ThreadPool::Shared().Submit([handle]() { handle.resume(); });
+}
+
+void AsyncLoading::MainThreadAwaitable::await_suspend(std::coroutine_handle<> handle) const
+{
+	std::lock_guard<std::mutex> lock(mainThreadMutex);
+	mainThreadQueue.push_back(handle);
+}
+
+size_t AsyncLoading::Pump()
+{
+	//coroutines resumed here may queue themselves again, they wait for the next call
+	std::vector<std::coroutine_handle<>> ready;
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		ready.swap(mainThreadQueue);
+	}
+
+	for (std::coroutine_handle<> handle : ready)
+	{
+		handle.resume();
+	}
+	return ready.size();
+}
+
+size_t AsyncLoading::Pending()
+{
+	return pendingTasks.load();
+}
+
+void AsyncLoading::Detail::Finished()
+{
+	pendingTasks.fetch_sub(1);
+}
+
+void AsyncLoading::Start(Task<void> task)
+{
+	std::coroutine_handle<Task<void>::promise_type> handle = task.Release();
+	handle.promise().started = true;
+	pendingTasks.fetch_add(1);
+	handle.resume();
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <cstddef>
+
+//C++20 coroutines for loading assets without blocking the main thread. A load co_awaits ToWorker() before file access, parsing and decoding
+//and ToMainThread() before it creates device resources, which resumes it from Pump() on the thread that owns the device.
+namespace AsyncLoading
+{
+	//resumes the awaiting coroutine on a worker of ThreadPool::Shared()
+	struct WorkerAwaitable
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const;
+		void await_resume() const noexcept {}
+	};
+
+	//resumes the awaiting coroutine from the next call to Pump()
+	struct MainThreadAwaitable
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const;
+		void await_resume() const noexcept {}
+	};
+
+	inline WorkerAwaitable ToWorker() { return {}; }
+	inline MainThreadAwaitable ToMainThread() { return {}; }
+
+	//resumes every coroutine that waits for the main thread, call once per frame from the thread that owns the device.
+	//returns how many were resumed
+	size_t Pump();
+
+	//started tasks that have not finished yet
+	size_t Pending();
+
+	namespace Detail
+	{
+		void Finished();
+
+		//hands control to whoever awaits the task, a started task has nobody and frees itself
+		struct FinalAwaitable
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+			{
+				std::coroutine_handle<> continuation = handle.promise().continuation;
+				if (handle.promise().started)
+				{
+					handle.destroy();
+					Finished();
+				}
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		struct PromiseBase
+		{
+			std::coroutine_handle<> continuation;
+			bool started = false;
+
+			//tasks are lazy, nothing runs until they are awaited or started
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			FinalAwaitable final_suspend() const noexcept { return {}; }
+
+			//loaders report errors through std::cerr and their results, an exception has nowhere to go
+			void unhandled_exception() const noexcept { std::terminate(); }
+		};
+
+		template<typename T>
+		struct Promise : PromiseBase
+		{
+			std::optional<T> value;
+
+			void return_value(T result) { value = std::move(result); }
+			T Result() { return std::move(*value); }
+		};
+
+		template<>
+		struct Promise<void> : PromiseBase
+		{
+			void return_void() const noexcept {}
+			void Result() const noexcept {}
+		};
+	}
+
+	//a coroutine that produces a T, awaiting it runs it and resumes the awaiting coroutine with its result
+	template<typename T = void>
+	class Task
+	{
+		public:
+			struct promise_type : Detail::Promise<T>
+			{
+				Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			};
+
+			Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+			~Task()
+			{
+				if (handle)
+				{
+					handle.destroy();
+				}
+			}
+
+			Task(const Task&) = delete;
+			Task& operator=(const Task&) = delete;
+			Task& operator=(Task&&) = delete;
+
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			T await_resume() { return handle.promise().Result(); }
+
+			//gives up ownership, the coroutine frees itself once it is done
+			std::coroutine_handle<promise_type> Release() { return std::exchange(handle, nullptr); }
+
+		private:
+			explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+			std::coroutine_handle<promise_type> handle;
+	};
+
+	//runs a task nobody awaits on the calling thread until its first suspension
+	void Start(Task<void> task);
+}
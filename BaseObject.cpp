@@ -218,4 +218,9 @@ void Object::AddToQuadTree(QuadTree* tree)
 {
 }
 
+bool Object::InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes)
+{
+	return false;
+}
+
 void Object::OnModyfied() {}
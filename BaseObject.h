@@ -3,9 +3,13 @@
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
 #include <array>
+#include <vector>
 
 #include "QuadTree.h"
 
+struct MeshResource;
+struct Submesh;
+
 #define OBJECT_TRANSFORM_SPACE_LOCAL true
 #define OBJECT_TRANSFORM_SPACE_GLOBAL false
 
@@ -39,6 +43,10 @@ class Object
 
 		virtual void AddToQuadTree(QuadTree* tree);
 
+		//objects that give the same mesh and submesh list are drawn together by InstanceBatcher instead of through Render and DepthRender.
+		//false draws the object on its own
+		virtual bool InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes);
+
 	protected :
 		bool CreateTransformBuffer();
 		
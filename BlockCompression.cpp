@@ -0,0 +1,762 @@
+#include "BlockCompression.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+namespace
+{
+	//block rows handed to a worker at a time
+	const int BlockRowsPerTask = 4;
+
+	//BC7 interpolation weights for 4 bit indices, out of 64
+	const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	//principal axis of the first channels of the 16 texels through power iteration, false when the block is a single colour
+	bool PrincipalAxis(const float texels[16][4], int channels, float mean[4], float axis[4])
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			mean[c] = 0.0f;
+			axis[c] = 0.0f;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				mean[c] += texels[i][c] / 16.0f;
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++)
+				{
+					covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+				}
+			}
+		}
+
+		//start from the channel that varies most, a fixed start can be orthogonal to the answer
+		int widest = 0;
+		for (int c = 1; c < channels; c++)
+		{
+			widest = (covariance[c][c] > covariance[widest][widest]) ? c : widest;
+		}
+		if (covariance[widest][widest] < 1e-6f)
+		{
+			return false;
+		}
+		for (int c = 0; c < channels; c++)
+		{
+			axis[c] = covariance[widest][c];
+		}
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+			}
+
+			float length = 0.0f;
+			for (int c = 0; c < channels; c++)
+			{
+				length += next[c] * next[c];
+			}
+			length = sqrtf(length);
+			if (length < 1e-12f)
+			{
+				return false;
+			}
+			for (int c = 0; c < channels; c++)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+		return true;
+	}
+
+	//endpoints at the extremes of the texels projected on the principal axis
+	void AxisEndpoints(const float texels[16][4], int channels, float start[4], float end[4])
+	{
+		float mean[4];
+		float axis[4];
+		if (!PrincipalAxis(texels, channels, mean, axis))
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				start[c] = mean[c];
+				end[c] = mean[c];
+			}
+			return;
+		}
+
+		float lowest = 1e30f;
+		float highest = -1e30f;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++)
+			{
+				t += (texels[i][c] - mean[c]) * axis[c];
+			}
+			lowest = std::min(lowest, t);
+			highest = std::max(highest, t);
+		}
+
+		for (int c = 0; c < channels; c++)
+		{
+			start[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * lowest));
+			end[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * highest));
+		}
+	}
+
+	//least squares endpoints for fixed indices, weights[i] is how far texel i lies from start towards end. False when all weights are equal
+	bool RefineEndpoints(const float texels[16][4], int channels, const float weights[16], float start[4], float end[4])
+	{
+		float aa = 0.0f;
+		float ab = 0.0f;
+		float bb = 0.0f;
+		float ax[4] = {};
+		float bx[4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float b = weights[i];
+			float a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < channels; c++)
+			{
+				ax[c] += a * texels[i][c];
+				bx[c] += b * texels[i][c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (fabsf(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (int c = 0; c < channels; c++)
+		{
+			start[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+			end[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+		}
+		return true;
+	}
+
+	//---------------------------------BC1---------------------------------//
+
+	uint16_t Pack565(const float color[4])
+	{
+		int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+		int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+		int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void Unpack565(uint16_t packed, int color[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	//four colour mode only, which needs color0 > color1
+	void BC1Palette(uint16_t color0, uint16_t color1, int palette[4][3])
+	{
+		Unpack565(color0, palette[0]);
+		Unpack565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	}
+
+	//picks the nearest palette entry for every texel, returns the summed squared error
+	int BC1Indices(const float texels[16][4], uint16_t color0, uint16_t color1, uint32_t& indices)
+	{
+		int palette[4][3];
+		BC1Palette(color0, color1, palette);
+
+		indices = 0;
+		int total = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			int bestError = 1 << 30;
+			for (int entry = 0; entry < ((color0 == color1) ? 1 : 4); entry++)
+			{
+				int error = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					int difference = static_cast<int>(texels[i][c] + 0.5f) - palette[entry][c];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					best = entry;
+				}
+			}
+			indices |= static_cast<uint32_t>(best) << (2 * i);
+			total += bestError;
+		}
+		return total;
+	}
+
+	//orders the endpoints for four colour mode and picks indices, returns the error
+	int BC1Candidate(const float texels[16][4], const float start[4], const float end[4], uint16_t& color0, uint16_t& color1, uint32_t& indices)
+	{
+		color0 = Pack565(end);
+		color1 = Pack565(start);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+		return BC1Indices(texels, color0, color1, indices);
+	}
+
+	void EncodeBC1(const float texels[16][4], uint8_t* output)
+	{
+		float start[4];
+		float end[4];
+		AxisEndpoints(texels, 3, start, end);
+
+		uint16_t color0;
+		uint16_t color1;
+		uint32_t indices;
+		int error = BC1Candidate(texels, start, end, color0, color1, indices);
+
+		//one least squares pass on the chosen indices usually pulls the endpoints in from the extremes
+		const float stepWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+		{
+			weights[i] = stepWeights[(indices >> (2 * i)) & 3];
+		}
+
+		//weights run from color0 to color1, which is end to start here
+		float refinedStart[4];
+		float refinedEnd[4];
+		if ((error > 0) && RefineEndpoints(texels, 3, weights, refinedEnd, refinedStart))
+		{
+			uint16_t refined0;
+			uint16_t refined1;
+			uint32_t refinedIndices;
+			int refinedError = BC1Candidate(texels, refinedStart, refinedEnd, refined0, refined1, refinedIndices);
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				indices = refinedIndices;
+			}
+		}
+
+		memcpy(output, &color0, 2);
+		memcpy(output + 2, &color1, 2);
+		memcpy(output + 4, &indices, 4);
+	}
+
+	void DecodeBC1(const uint8_t* input, uint8_t rgba[64])
+	{
+		uint16_t color0;
+		uint16_t color1;
+		uint32_t indices;
+		memcpy(&color0, input, 2);
+		memcpy(&color1, input + 2, 2);
+		memcpy(&indices, input + 4, 4);
+
+		int palette[4][3];
+		Unpack565(color0, palette[0]);
+		Unpack565(color1, palette[1]);
+		bool transparent = color0 <= color1;
+		for (int c = 0; c < 3; c++)
+		{
+			if (transparent)
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			else
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int entry = (indices >> (2 * i)) & 3;
+			for (int c = 0; c < 3; c++)
+			{
+				rgba[i * 4 + c] = static_cast<uint8_t>(palette[entry][c]);
+			}
+			rgba[i * 4 + 3] = (transparent && (entry == 3)) ? 0 : 255;
+		}
+	}
+
+	//---------------------------------BC4---------------------------------//
+
+	void BC4Palette(int red0, int red1, int palette[8])
+	{
+		palette[0] = red0;
+		palette[1] = red1;
+		if (red0 > red1)
+		{
+			for (int i = 2; i < 8; i++)
+			{
+				palette[i] = ((8 - i) * red0 + (i - 1) * red1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 2; i < 6; i++)
+			{
+				palette[i] = ((6 - i) * red0 + (i - 1) * red1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void EncodeBC4(const uint8_t values[16], uint8_t* output)
+	{
+		int lowest = 255;
+		int highest = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			lowest = std::min(lowest, static_cast<int>(values[i]));
+			highest = std::max(highest, static_cast<int>(values[i]));
+		}
+
+		//eight step mode, red0 > red1. A flat block keeps every index on red0
+		int palette[8];
+		BC4Palette(highest, lowest, palette);
+
+		uint64_t bits = static_cast<uint64_t>(highest) | (static_cast<uint64_t>(lowest) << 8);
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			if (highest != lowest)
+			{
+				int bestError = 256;
+				for (int entry = 0; entry < 8; entry++)
+				{
+					int error = abs(palette[entry] - values[i]);
+					if (error < bestError)
+					{
+						bestError = error;
+						best = entry;
+					}
+				}
+			}
+			bits |= static_cast<uint64_t>(best) << (16 + 3 * i);
+		}
+		memcpy(output, &bits, 8);
+	}
+
+	void DecodeBC4(const uint8_t* input, uint8_t values[16], int stride)
+	{
+		uint64_t bits;
+		memcpy(&bits, input, 8);
+
+		int palette[8];
+		BC4Palette(static_cast<int>(bits & 255), static_cast<int>((bits >> 8) & 255), palette);
+		for (int i = 0; i < 16; i++)
+		{
+			values[i * stride] = static_cast<uint8_t>(palette[(bits >> (16 + 3 * i)) & 7]);
+		}
+	}
+
+	//---------------------------------BC7---------------------------------//
+
+	//seven bit endpoint plus a shared lowest bit, the bit is picked per endpoint to fit its four channels best
+	void QuantizeBC7(const float endpoint[4], int quantized[4], int& pBit)
+	{
+		float bestError = 1e30f;
+		for (int bit = 0; bit < 2; bit++)
+		{
+			int candidate[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				candidate[c] = std::min(127, std::max(0, static_cast<int>((endpoint[c] - bit) / 2.0f + 0.5f)));
+				float difference = static_cast<float>((candidate[c] << 1) | bit) - endpoint[c];
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pBit = bit;
+				memcpy(quantized, candidate, sizeof(candidate));
+			}
+		}
+	}
+
+	struct BC7Block
+	{
+		int endpoints[2][4];
+		int pBits[2];
+		int indices[16];
+	};
+
+	//nearest of the 16 steps for every texel, returns the summed squared error
+	int BC7Indices(const float texels[16][4], BC7Block& block)
+	{
+		int palette[16][4];
+		for (int step = 0; step < 16; step++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				int start = (block.endpoints[0][c] << 1) | block.pBits[0];
+				int end = (block.endpoints[1][c] << 1) | block.pBits[1];
+				palette[step][c] = ((64 - BC7Weights[step]) * start + BC7Weights[step] * end + 32) >> 6;
+			}
+		}
+
+		int total = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int bestError = 1 << 30;
+			for (int step = 0; step < 16; step++)
+			{
+				int error = 0;
+				for (int c = 0; c < 4; c++)
+				{
+					int difference = static_cast<int>(texels[i][c] + 0.5f) - palette[step][c];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					block.indices[i] = step;
+				}
+			}
+			total += bestError;
+		}
+		return total;
+	}
+
+	int BC7Candidate(const float texels[16][4], const float start[4], const float end[4], BC7Block& block)
+	{
+		QuantizeBC7(start, block.endpoints[0], block.pBits[0]);
+		QuantizeBC7(end, block.endpoints[1], block.pBits[1]);
+		return BC7Indices(texels, block);
+	}
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(uint8_t* output) : output(output), position(0)
+		{
+			memset(output, 0, 16);
+		}
+
+		void Write(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; i++, position++)
+			{
+				output[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (position & 7));
+			}
+		}
+
+	private:
+		uint8_t* output;
+		int position;
+	};
+
+	class BitReader
+	{
+	public:
+		explicit BitReader(const uint8_t* input) : input(input), position(0)
+		{
+		}
+
+		uint32_t Read(int bits)
+		{
+			uint32_t value = 0;
+			for (int i = 0; i < bits; i++, position++)
+			{
+				value |= static_cast<uint32_t>((input[position >> 3] >> (position & 7)) & 1) << i;
+			}
+			return value;
+		}
+
+	private:
+		const uint8_t* input;
+		int position;
+	};
+
+	void EncodeBC7(const float texels[16][4], uint8_t* output)
+	{
+		float start[4];
+		float end[4];
+		AxisEndpoints(texels, 4, start, end);
+
+		BC7Block block;
+		int error = BC7Candidate(texels, start, end, block);
+
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+		{
+			weights[i] = BC7Weights[block.indices[i]] / 64.0f;
+		}
+
+		BC7Block refined;
+		if ((error > 0) && RefineEndpoints(texels, 4, weights, start, end) && (BC7Candidate(texels, start, end, refined) < error))
+		{
+			block = refined;
+		}
+
+		//the first index is stored without its top bit, so it has to be in the lower half
+		if (block.indices[0] >= 8)
+		{
+			std::swap(block.endpoints[0], block.endpoints[1]);
+			std::swap(block.pBits[0], block.pBits[1]);
+			for (int& index : block.indices)
+			{
+				index = 15 - index;
+			}
+		}
+
+		BitWriter writer(output);
+		writer.Write(1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write(block.endpoints[0][c], 7);
+			writer.Write(block.endpoints[1][c], 7);
+		}
+		writer.Write(block.pBits[0], 1);
+		writer.Write(block.pBits[1], 1);
+		for (int i = 0; i < 16; i++)
+		{
+			writer.Write(block.indices[i], (i == 0) ? 3 : 4);
+		}
+	}
+
+	void DecodeBC7(const uint8_t* input, uint8_t rgba[64])
+	{
+		BitReader reader(input);
+		if (reader.Read(7) != (1 << 6))
+		{
+			//another mode, never written by EncodeBC7
+			memset(rgba, 0, 64);
+			return;
+		}
+
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = reader.Read(7) << 1;
+			endpoints[1][c] = reader.Read(7) << 1;
+		}
+		int pBit0 = reader.Read(1);
+		int pBit1 = reader.Read(1);
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] |= pBit0;
+			endpoints[1][c] |= pBit1;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int weight = BC7Weights[reader.Read((i == 0) ? 3 : 4)];
+			for (int c = 0; c < 4; c++)
+			{
+				rgba[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+}
+
+size_t BlockCompression::BlockBytes(Format format)
+{
+	return ((format == Format::BC1) || (format == Format::BC4)) ? 8 : 16;
+}
+
+size_t BlockCompression::EncodedSize(int width, int height, Format format)
+{
+	return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * BlockBytes(format);
+}
+
+bool BlockCompression::Choose(const uint8_t* pixels, int width, int height, int channels, Format& format)
+{
+	if ((width % 4 != 0) || (height % 4 != 0))
+	{
+		return false;
+	}
+
+	if (channels == 2)
+	{
+		format = Format::BC5;
+		return true;
+	}
+
+	if (channels != 4)
+	{
+		return false;
+	}
+
+	bool opaque = true;
+	bool grey = true;
+	size_t texelCount = static_cast<size_t>(width) * height;
+	for (size_t i = 0; (i < texelCount) && (opaque || grey); i++)
+	{
+		const uint8_t* texel = pixels + i * 4;
+		opaque &= texel[3] == 255;
+		grey &= (texel[0] == texel[1]) && (texel[1] == texel[2]);
+	}
+
+	format = !opaque ? Format::BC7 : (grey ? Format::BC4 : Format::BC1);
+	return true;
+}
+
+void BlockCompression::EncodeBlock(const uint8_t rgba[64], Format format, uint8_t* output)
+{
+	float texels[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			texels[i][c] = rgba[i * 4 + c];
+		}
+	}
+
+	uint8_t values[16];
+	switch (format)
+	{
+	case Format::BC1:
+		EncodeBC1(texels, output);
+		break;
+
+	case Format::BC4:
+		for (int i = 0; i < 16; i++)
+		{
+			values[i] = rgba[i * 4];
+		}
+		EncodeBC4(values, output);
+		break;
+
+	case Format::BC5:
+		for (int channel = 0; channel < 2; channel++)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				values[i] = rgba[i * 4 + channel];
+			}
+			EncodeBC4(values, output + 8 * channel);
+		}
+		break;
+
+	case Format::BC7:
+		EncodeBC7(texels, output);
+		break;
+	}
+}
+
+void BlockCompression::DecodeBlock(const uint8_t* input, Format format, uint8_t rgba[64])
+{
+	switch (format)
+	{
+	case Format::BC1:
+		DecodeBC1(input, rgba);
+		break;
+
+	case Format::BC4:
+	case Format::BC5:
+		for (int i = 0; i < 16; i++)
+		{
+			rgba[i * 4 + 1] = 0;
+			rgba[i * 4 + 2] = 0;
+			rgba[i * 4 + 3] = 255;
+		}
+		DecodeBC4(input, rgba, 4);
+		if (format == Format::BC5)
+		{
+			DecodeBC4(input + 8, rgba + 1, 4);
+		}
+		break;
+
+	case Format::BC7:
+		DecodeBC7(input, rgba);
+		break;
+	}
+}
+
+void BlockCompression::Encode(const uint8_t* pixels, int width, int height, int channels, Format format, std::vector<uint8_t>& blocks)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	size_t blockBytes = BlockBytes(format);
+	blocks.resize(EncodedSize(width, height, format));
+
+	size_t tasks = (blocksHigh + BlockRowsPerTask - 1) / BlockRowsPerTask;
+	ThreadPool::Shared().ParallelFor(tasks, [&](size_t task)
+	{
+		int firstRow = static_cast<int>(task) * BlockRowsPerTask;
+		int lastRow = std::min(blocksHigh, firstRow + BlockRowsPerTask);
+		for (int blockY = firstRow; blockY < lastRow; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				uint8_t rgba[64];
+				for (int i = 0; i < 16; i++)
+				{
+					int x = std::min(width - 1, blockX * 4 + (i & 3));
+					int y = std::min(height - 1, blockY * 4 + (i >> 2));
+					const uint8_t* texel = pixels + (static_cast<size_t>(y) * width + x) * channels;
+
+					rgba[i * 4] = texel[0];
+					rgba[i * 4 + 1] = (channels > 1) ? texel[1] : 0;
+					rgba[i * 4 + 2] = (channels > 2) ? texel[2] : 0;
+					rgba[i * 4 + 3] = (channels > 3) ? texel[3] : 255;
+				}
+
+				EncodeBlock(rgba, format, blocks.data() + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes);
+			}
+		}
+	});
+}
+
+void BlockCompression::Decode(const uint8_t* blocks, int width, int height, Format format, std::vector<uint8_t>& rgba)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	size_t blockBytes = BlockBytes(format);
+	rgba.resize(static_cast<size_t>(width) * height * 4);
+
+	for (int blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksWide; blockX++)
+		{
+			uint8_t block[64];
+			DecodeBlock(blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes, format, block);
+
+			for (int i = 0; i < 16; i++)
+			{
+				int x = blockX * 4 + (i & 3);
+				int y = blockY * 4 + (i >> 2);
+				if ((x < width) && (y < height))
+				{
+					memcpy(rgba.data() + (static_cast<size_t>(y) * width + x) * 4, block + i * 4, 4);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//CPU encoder for the block compressed texture formats material maps are stored in.
+//every format works on 4x4 texel blocks, input blocks are always 16 RGBA texels
+namespace BlockCompression
+{
+	enum class Format : uint32_t
+	{
+		BC1 = 1,	//RGB, 8 bytes a block
+		BC4 = 4,	//red only, 8 bytes a block
+		BC5 = 5,	//red and green, 16 bytes a block
+		BC7 = 7		//RGBA, 16 bytes a block. Only mode 6 is written, one pair of RGBA endpoints with 16 steps between them
+	};
+
+	size_t BlockBytes(Format format);
+	size_t EncodedSize(int width, int height, Format format);
+
+	//opaque grey images become BC4, other opaque images BC1, images with alpha BC7 and two channel images BC5.
+	//false when the image stays uncompressed: one or three channels, or a size that is not a multiple of 4
+	bool Choose(const uint8_t* pixels, int width, int height, int channels, Format& format);
+
+	void EncodeBlock(const uint8_t rgba[64], Format format, uint8_t* output);
+
+	//missing channels decode to 0 and missing alpha to 255, like the hardware does
+	void DecodeBlock(const uint8_t* input, Format format, uint8_t rgba[64]);
+
+	//whole image of 2 or 4 channels, edge blocks repeat the last row and column. Block rows are spread over the shared thread pool
+	void Encode(const uint8_t* pixels, int width, int height, int channels, Format format, std::vector<uint8_t>& blocks);
+
+	//back to width * height RGBA texels
+	void Decode(const uint8_t* blocks, int width, int height, Format format, std::vector<uint8_t>& rgba);
+}
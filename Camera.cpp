@@ -4,7 +4,10 @@
 
 #include "Pipeline.h"
 
-Camera::Camera(UINT widthPixels, UINT heightPixels, UINT topLeftX, UINT topLeftY, float NearZ, float FarZ) : width(widthPixels), height(heightPixels), topLeftX(topLeftX), topLeftY(topLeftY), NearZ(NearZ), FarZ(FarZ), projectionBuffer(nullptr), projModified(false)
+ActiveViewState Camera::activeView;
+UINT Camera::nextViewID = 1;
+
+Camera::Camera(UINT widthPixels, UINT heightPixels, UINT topLeftX, UINT topLeftY, float NearZ, float FarZ) : width(widthPixels), height(heightPixels), topLeftX(topLeftX), topLeftY(topLeftY), NearZ(NearZ), FarZ(FarZ), projectionBuffer(nullptr), projModified(false), viewID(nextViewID++)
 {
 	if (!CreateTransformBuffer())
 	{
@@ -61,6 +64,17 @@ void Camera::SetActiveCamera()
 	Pipeline::Deferred::LightPass::ComputeShader::Bind::CameraProjectionBuffer(projectionBuffer);
 
 	Pipeline::Deferred::LightPass::ComputeShader::Bind::CameraViewportBuffer(viewBuffer);
+
+	activeView.viewID = viewID;
+	activeView.position = position;
+	DirectX::XMStoreFloat3(&activeView.forward, DirectX::XMVector3Rotate(DirectX::XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), DirectX::XMLoadFloat4(&rotationQuaternion)));
+	ViewFrustum(activeView.frustum);
+	FillActiveView(activeView);
+}
+
+const ActiveViewState& Camera::ActiveView()
+{
+	return activeView;
 }
 
 void Camera::SetNearPlane(float nearZ)
@@ -201,6 +215,12 @@ void CameraPerspective::UpdateProjection()
 	Pipeline::ResourceManipulation::UnmapBuffer(projectionBuffer);
 }
 
+void CameraPerspective::FillActiveView(ActiveViewState& view)
+{
+	view.pixelsPerUnit = static_cast<float>(ViewportHeight()) * 0.5f / tanf(static_cast<float>(FovAngleY * OBJECT_ROTATION_UNIT_DEGREES) * 0.5f);
+	view.perspective = true;
+}
+
 bool CameraPerspective::CreateBuffers()
 {
 	D3D11_BUFFER_DESC bufferDesc;
@@ -267,6 +287,12 @@ void CameraOrthographic::UpdateProjection()
 	Pipeline::ResourceManipulation::UnmapBuffer(projectionBuffer);
 }
 
+void CameraOrthographic::FillActiveView(ActiveViewState& view)
+{
+	view.pixelsPerUnit = static_cast<float>(ViewportHeight()) / HeightScale;
+	view.perspective = false;
+}
+
 bool CameraOrthographic::CreateBuffers()
 {
 	D3D11_BUFFER_DESC bufferDesc;
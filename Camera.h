@@ -70,6 +70,21 @@ struct ViewBuffer
 	{}
 };
 
+//the parts of the camera made active last that objects need to judge their size on screen
+struct ActiveViewState
+{
+	//tells the views apart, so an object keeps what it chose for each one. Never reused, a new camera does not pick up what an old one left
+	UINT viewID = 0;
+
+	DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 forward = { 0.0f, 0.0f, 1.0f };
+	DirectX::BoundingFrustum frustum;
+
+	//pixels covered by one unit, at a distance of one for perspective cameras and at any distance for orthographic ones
+	float pixelsPerUnit = 0.0f;
+	bool perspective = true;
+};
+
 class Camera : public Object
 {
 	public :
@@ -79,6 +94,8 @@ class Camera : public Object
 
 		void SetActiveCamera();
 
+		static const ActiveViewState& ActiveView();
+
 		void SetNearPlane(float nearZ);
 		void SetFarPlane(float farZ);
 
@@ -94,6 +111,7 @@ class Camera : public Object
 		virtual DirectX::XMFLOAT4X4 InverseTransformMatrix() override;
 
 		virtual void UpdateProjection() = 0;
+		virtual void FillActiveView(ActiveViewState& view) = 0;
 
 		void FlagProjChange();
 
@@ -121,6 +139,11 @@ class Camera : public Object
 		bool projModified;
 
 		ID3D11Buffer* viewBuffer;
+
+		UINT viewID;
+
+		static ActiveViewState activeView;
+		static UINT nextViewID;
 };
 
 class CameraPerspective : public Camera
@@ -135,6 +158,7 @@ public:
 
 protected:
 	virtual void UpdateProjection() override;
+	virtual void FillActiveView(ActiveViewState& view) override;
 	virtual bool CreateBuffers() override;
 
 private:
@@ -170,6 +194,7 @@ public:
 
 protected:
 	virtual void UpdateProjection() override;
+	virtual void FillActiveView(ActiveViewState& view) override;
 	virtual bool CreateBuffers() override;
 
 private:
@@ -0,0 +1,10 @@
+#include "AssetCooker.h"
+
+//Entry point of the headless asset cooker, kept out of the Windows project which runs the cooker through "-cook" instead.
+//Built from the headless modules only, see Diagnostics.h, for example on Linux:
+//g++ -O2 -std=c++20 -pthread CookerMain.cpp AssetCooker.cpp AssetPack.cpp FileMapping.cpp ThreadPool.cpp OBJReader.cpp GLBReader.cpp CornerHashTable.cpp MeshBounds.cpp
+//	MeshCache.cpp MeshCodec.cpp MeshOptimizer.cpp MeshSimplifier.cpp Meshlets.cpp TextureCache.cpp MipChain.cpp BlockCompression.cpp -o AssetCooker
+int main(int argc, char** argv)
+{
+	return AssetCooker::Main(argc, argv);
+}
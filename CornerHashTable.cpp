@@ -0,0 +1,109 @@
+#include "CornerHashTable.h"
+
+namespace
+{
+	const uint32_t EmptySlot = 0xFFFFFFFF;
+
+	inline uint32_t HashTriple(uint32_t pos, uint32_t uv, uint32_t norm)
+	{
+		uint32_t hash = pos * 0x9E3779B1u;
+		hash ^= uv * 0x85EBCA77u;
+		hash ^= norm * 0xC2B2AE3Du;
+
+		//murmur3 finalizer, spreads neighbouring indices over the whole table
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	size_t CapacityFor(size_t entries)
+	{
+		//kept at most half full so probe chains stay short
+		size_t capacity = 16;
+		while (capacity < entries * 2)
+		{
+			capacity *= 2;
+		}
+		return capacity;
+	}
+}
+
+CornerHashTable::CornerHashTable(size_t expectedEntries) : mask(0), count(0)
+{
+	size_t capacity = CapacityFor(expectedEntries);
+	slots.assign(capacity, { 0, 0, 0, EmptySlot });
+	mask = capacity - 1;
+}
+
+uint32_t CornerHashTable::FindOrInsert(const int index[3], uint32_t newVertex, bool& inserted)
+{
+	uint32_t pos = static_cast<uint32_t>(index[0]);
+	uint32_t uv = static_cast<uint32_t>(index[1]);
+	uint32_t norm = static_cast<uint32_t>(index[2]);
+
+	size_t slot = HashTriple(pos, uv, norm) & mask;
+	while (true)
+	{
+		Slot& current = slots[slot];
+		if (current.vertex == EmptySlot)
+		{
+			current = { pos, uv, norm, newVertex };
+			count++;
+			inserted = true;
+
+			if (count * 2 > slots.size())
+			{
+				Grow();
+			}
+			return newVertex;
+		}
+		if ((current.pos == pos) && (current.uv == uv) && (current.norm == norm))
+		{
+			inserted = false;
+			return current.vertex;
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+size_t CornerHashTable::Size() const
+{
+	return count;
+}
+
+size_t CornerHashTable::Bytes() const
+{
+	return slots.capacity() * sizeof(Slot);
+}
+
+bool CornerHashTable::GrowsOnInsert() const
+{
+	return (count + 1) * 2 > slots.size();
+}
+
+void CornerHashTable::Grow()
+{
+	std::vector<Slot> previous;
+	previous.swap(slots);
+
+	slots.assign(previous.size() * 2, { 0, 0, 0, EmptySlot });
+	mask = slots.size() - 1;
+
+	for (const Slot& entry : previous)
+	{
+		if (entry.vertex == EmptySlot)
+		{
+			continue;
+		}
+
+		size_t slot = HashTriple(entry.pos, entry.uv, entry.norm) & mask;
+		while (slots[slot].vertex != EmptySlot)
+		{
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = entry;
+	}
+}
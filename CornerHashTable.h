@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Open addressing table from a face corner's (pos, uv, norm) index triple to the vertex it was welded into.
+//Vertex indices are handed out by the caller in insertion order, so the result does not depend on the table layout.
+class CornerHashTable
+{
+	public:
+		//pre-sizes the table so expectedEntries unique triples fit without growing
+		CornerHashTable(size_t expectedEntries);
+
+		//returns the vertex already stored for the triple, or stores newVertex and sets inserted
+		uint32_t FindOrInsert(const int index[3], uint32_t newVertex, bool& inserted);
+
+		size_t Size() const;
+
+		//memory held by the slots, and what it becomes once the next insert makes the table grow
+		size_t Bytes() const;
+		bool GrowsOnInsert() const;
+
+	private:
+		struct Slot
+		{
+			uint32_t pos;
+			uint32_t uv;
+			uint32_t norm;
+			uint32_t vertex;
+		};
+
+		std::vector<Slot> slots;
+		size_t mask;
+		size_t count;
+
+		void Grow();
+};
@@ -0,0 +1,3231 @@
+#include "Diagnostics.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <memory>
+#include <random>
+#include <cstring>
+#include <filesystem>
+#include <atomic>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "OBJReader.h"
+#include "ThreadPool.h"
+#include "CornerHashTable.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantization.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+#include "MeshBounds.h"
+#include "AsyncLoading.h"
+#include "Instancing.h"
+#include "MipChain.h"
+#include "BlockCompression.h"
+#include "TextureCache.h"
+#include "MaterialPacking.h"
+#include "MeshCodec.h"
+#include "AssetPack.h"
+#include "AssetCooker.h"
+#include "GLBReader.h"
+#include "MeshArena.h"
+#include "FileMapping.h"
+
+namespace
+{
+	//FNV-1a over the whole mesh, used to check that two import paths agree
+	uint64_t HashMesh(const MeshData& mesh)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+		};
+
+		if (!mesh.vertices.empty())
+		{
+			add(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+		}
+		if (!mesh.indices.empty())
+		{
+			add(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		}
+		for (size_t i = 0; i < mesh.submeshes.size(); i++)
+		{
+			add(&mesh.submeshes[i].Start, sizeof(int));
+			add(&mesh.submeshes[i].size, sizeof(int));
+			add(mesh.submeshMaterials[i].data(), mesh.submeshMaterials[i].size());
+		}
+		for (const MeshLOD& lod : mesh.lods)
+		{
+			add(&lod.error, sizeof(float));
+			for (const Submesh& submesh : lod.submeshes)
+			{
+				add(&submesh.Start, sizeof(int));
+				add(&submesh.size, sizeof(int));
+			}
+		}
+		add(&mesh.bounds, sizeof(Bounds));
+
+		return hash;
+	}
+
+	//closest point on a triangle (Ericson, Real-Time Collision Detection 5.1.5), returns the squared distance to it
+	double PointTriangleDistanceSquared(const float* point, const float* a, const float* b, const float* c)
+	{
+		double ab[3], ac[3], ap[3];
+		for (int k = 0; k < 3; k++)
+		{
+			ab[k] = static_cast<double>(b[k]) - a[k];
+			ac[k] = static_cast<double>(c[k]) - a[k];
+			ap[k] = static_cast<double>(point[k]) - a[k];
+		}
+		auto dot = [](const double* x, const double* y) { return x[0] * y[0] + x[1] * y[1] + x[2] * y[2]; };
+
+		double closest[3];
+		auto at = [&](double v, double w)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				closest[k] = a[k] + ab[k] * v + ac[k] * w;
+			}
+		};
+
+		double d1 = dot(ab, ap);
+		double d2 = dot(ac, ap);
+		double bp[3] = { ap[0] - ab[0], ap[1] - ab[1], ap[2] - ab[2] };
+		double d3 = dot(ab, bp);
+		double d4 = dot(ac, bp);
+		double cp[3] = { ap[0] - ac[0], ap[1] - ac[1], ap[2] - ac[2] };
+		double d5 = dot(ab, cp);
+		double d6 = dot(ac, cp);
+
+		double vc = d1 * d4 - d3 * d2;
+		double vb = d5 * d2 - d1 * d6;
+		double va = d3 * d6 - d5 * d4;
+
+		if ((d1 <= 0.0) && (d2 <= 0.0))
+		{
+			at(0.0, 0.0);
+		}
+		else if ((d3 >= 0.0) && (d4 <= d3))
+		{
+			at(1.0, 0.0);
+		}
+		else if ((d6 >= 0.0) && (d5 <= d6))
+		{
+			at(0.0, 1.0);
+		}
+		else if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+		{
+			at(d1 / (d1 - d3), 0.0);
+		}
+		else if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+		{
+			at(0.0, d2 / (d2 - d6));
+		}
+		else if ((va <= 0.0) && ((d4 - d3) >= 0.0) && ((d5 - d6) >= 0.0))
+		{
+			double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			at(1.0 - w, w);
+		}
+		else
+		{
+			double denominator = 1.0 / (va + vb + vc);
+			at(vb * denominator, vc * denominator);
+		}
+
+		double distance = 0.0;
+		for (int k = 0; k < 3; k++)
+		{
+			distance += (point[k] - closest[k]) * (point[k] - closest[k]);
+		}
+		return distance;
+	}
+
+	//largest distance from a vertex of the full mesh to the triangles of a level, brute force over at most maxSamples evenly spread vertices
+	double SurfaceDeviation(const MeshData& mesh, const std::vector<Submesh>& level, size_t maxSamples)
+	{
+		std::vector<bool> used(mesh.vertices.size(), false);
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			for (int i = submesh.Start; i < submesh.Start + submesh.size; i++)
+			{
+				used[mesh.indices[i]] = true;
+			}
+		}
+
+		std::vector<uint32_t> samples;
+		for (size_t i = 0; i < used.size(); i++)
+		{
+			if (used[i])
+			{
+				samples.push_back(static_cast<uint32_t>(i));
+			}
+		}
+		size_t step = (samples.size() + maxSamples - 1) / maxSamples;
+
+		double largest = 0.0;
+		for (size_t s = 0; s < samples.size(); s += step)
+		{
+			const float* point = mesh.vertices[samples[s]].pos;
+			double nearest = -1.0;
+			for (const Submesh& submesh : level)
+			{
+				for (int i = submesh.Start; i + 2 < submesh.Start + submesh.size; i += 3)
+				{
+					double distance = PointTriangleDistanceSquared(point, mesh.vertices[mesh.indices[i]].pos, mesh.vertices[mesh.indices[i + 1]].pos, mesh.vertices[mesh.indices[i + 2]].pos);
+					if ((nearest < 0.0) || (distance < nearest))
+					{
+						nearest = distance;
+					}
+				}
+			}
+			largest = std::max(largest, sqrt(std::max(nearest, 0.0)));
+		}
+		return largest;
+	}
+
+	void Normalize(float vector[3])
+	{
+		float length = sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+		for (int k = 0; k < 3; k++)
+		{
+			vector[k] /= length;
+		}
+	}
+
+	void Cross(const float a[3], const float b[3], float result[3])
+	{
+		result[0] = a[1] * b[2] - a[2] * b[1];
+		result[1] = a[2] * b[0] - a[0] * b[2];
+		result[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	void SetPlane(float plane[4], const float normal[3], const float point[3], float offset)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			plane[k] = normal[k];
+		}
+		plane[3] = -(normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2]) + offset;
+	}
+
+	//left handed camera at position looking at the origin with y up, the way Camera sets up its frustum.
+	//halfExtent is tan(fovY / 2) for perspective views and half the view height for orthographic ones
+	Meshlets::CullView LookAtOrigin(const float position[3], bool perspective, float halfExtent, float aspectRatio, float nearZ, float farZ)
+	{
+		Meshlets::CullView view;
+		view.perspective = perspective;
+
+		float forward[3] = { -position[0], -position[1], -position[2] };
+		Normalize(forward);
+		float up[3] = { 0.0f, 1.0f, 0.0f };
+		float right[3];
+		Cross(up, forward, right);
+		Normalize(right);
+		Cross(forward, right, up);
+
+		for (int k = 0; k < 3; k++)
+		{
+			view.position[k] = position[k];
+			view.direction[k] = forward[k];
+		}
+
+		float back[3] = { -forward[0], -forward[1], -forward[2] };
+		SetPlane(view.planes[0], forward, position, -nearZ);
+		SetPlane(view.planes[1], back, position, farZ);
+
+		float halfWidth = halfExtent * aspectRatio;
+		for (int side = 0; side < 4; side++)
+		{
+			const float* axis = (side < 2) ? right : up;
+			float sign = (side % 2 == 0) ? -1.0f : 1.0f;
+			float extent = (side < 2) ? halfWidth : halfExtent;
+
+			float normal[3];
+			if (perspective)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					normal[k] = forward[k] * extent + axis[k] * sign;
+				}
+				SetPlane(view.planes[2 + side], normal, position, 0.0f);
+			}
+			else
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					normal[k] = axis[k] * sign;
+				}
+				SetPlane(view.planes[2 + side], normal, position, extent);
+			}
+		}
+
+		return view;
+	}
+
+	//triangles a view draws in drawCalls ranges, counts the culled ones that would have covered pixels in missed
+	size_t SubmittedTriangles(const MeshData& mesh, const Meshlets::CullView& view, size_t& drawCalls, size_t& missed)
+	{
+		std::vector<Meshlets::DrawRange> ranges;
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			size_t first = Meshlets::FindFirst(mesh.meshlets, static_cast<uint32_t>(submesh.Start));
+			size_t last = Meshlets::FindFirst(mesh.meshlets, static_cast<uint32_t>(submesh.Start + submesh.size));
+			Meshlets::Cull(mesh.meshlets.data() + first, last - first, view, ranges);
+		}
+
+		drawCalls = ranges.size();
+
+		std::vector<bool> drawn(mesh.indices.size() / 3, false);
+		size_t submitted = 0;
+		for (const Meshlets::DrawRange& range : ranges)
+		{
+			for (uint32_t i = range.start; i < range.start + range.count; i += 3)
+			{
+				drawn[i / 3] = true;
+			}
+			submitted += range.count / 3;
+		}
+
+		//a culled triangle must face away or lie completely outside one plane
+		missed = 0;
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			for (int i = submesh.Start; i + 2 < submesh.Start + submesh.size; i += 3)
+			{
+				if (drawn[i / 3])
+				{
+					continue;
+				}
+
+				const float* p[3] = { mesh.vertices[mesh.indices[i]].pos, mesh.vertices[mesh.indices[i + 1]].pos, mesh.vertices[mesh.indices[i + 2]].pos };
+				float edge0[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+				float edge1[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+				float normal[3];
+				Cross(edge0, edge1, normal);
+
+				float toTriangle[3];
+				for (int k = 0; k < 3; k++)
+				{
+					toTriangle[k] = view.perspective ? p[0][k] - view.position[k] : view.direction[k];
+				}
+
+				//cosine between normal and view ray, triangles seen edge on within float precision cover no pixels either
+				float facing = normal[0] * toTriangle[0] + normal[1] * toTriangle[1] + normal[2] * toTriangle[2];
+				float lengths = sqrtf((normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]) * (toTriangle[0] * toTriangle[0] + toTriangle[1] * toTriangle[1] + toTriangle[2] * toTriangle[2]));
+				if (facing >= -1e-5f * lengths)
+				{
+					continue;
+				}
+
+				bool outside = false;
+				for (int plane = 0; (plane < 6) && !outside; plane++)
+				{
+					const float* planeValues = view.planes[plane];
+					outside = true;
+					for (int k = 0; k < 3; k++)
+					{
+						outside &= (planeValues[0] * p[k][0] + planeValues[1] * p[k][1] + planeValues[2] * p[k][2] + planeValues[3] < 0.0f);
+					}
+				}
+				if (!outside)
+				{
+					missed++;
+				}
+			}
+		}
+
+		return submitted;
+	}
+
+	size_t TriangleCount(const std::vector<Submesh>& submeshes)
+	{
+		size_t indices = 0;
+		for (const Submesh& submesh : submeshes)
+		{
+			indices += submesh.size;
+		}
+		return indices / 3;
+	}
+
+	//an asynchronous load the way STDOBJ does it, with a hash of the mesh standing in for the device step
+	AsyncLoading::Task<void> LoadAsync(std::string OBJFilepath, std::thread::id mainThread, uint64_t* hash, bool* onMainThread)
+	{
+		co_await AsyncLoading::ToWorker();
+
+		MeshData mesh;
+		bool read = OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_SERIAL);
+		uint64_t result = read ? HashMesh(mesh) : 0;
+
+		co_await AsyncLoading::ToMainThread();
+
+		*hash = result;
+		*onMainThread = (std::this_thread::get_id() == mainThread);
+	}
+
+	//best of a few runs, the first one also pays for cold page faults
+	bool TimeImport(const std::string& OBJFilepath, unsigned int importFlags, int repeats, double& bestSeconds, uint64_t& hash)
+	{
+		bestSeconds = 0.0;
+		for (int i = 0; i < repeats; i++)
+		{
+			MeshData mesh;
+			OBJReader::ReadStats stats;
+			if (!OBJReader::Read(OBJFilepath, mesh, importFlags, &stats))
+			{
+				return false;
+			}
+
+			if ((i == 0) || (stats.seconds < bestSeconds))
+			{
+				bestSeconds = stats.seconds;
+			}
+			hash = HashMesh(mesh);
+		}
+		return true;
+	}
+
+	double ExactSRGBToLinear(double value)
+	{
+		return (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+	}
+
+	double ExactLinearToSRGB(double value)
+	{
+		return (value <= 0.0031308) ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+	}
+
+	//straightforward version of MipChain::Build for one level, the largest difference to level in steps
+	int CompareMipLevel(const uint8_t* source, int sourceWidth, int sourceHeight, int channels, const MipChain::Level& level)
+	{
+		auto weights = [](int destination, int sourceSize, std::vector<std::pair<int, double>>& taps)
+		{
+			taps.clear();
+			if (sourceSize == 1)
+			{
+				taps.push_back({ 0, 1.0 });
+			}
+			else if (sourceSize % 2 == 0)
+			{
+				taps.push_back({ destination * 2, 0.5 });
+				taps.push_back({ destination * 2 + 1, 0.5 });
+			}
+			else
+			{
+				taps.push_back({ destination * 2, 0.25 });
+				taps.push_back({ destination * 2 + 1, 0.5 });
+				taps.push_back({ destination * 2 + 2, 0.25 });
+			}
+		};
+
+		int largest = 0;
+		std::vector<std::pair<int, double>> rows;
+		std::vector<std::pair<int, double>> columns;
+		for (int y = 0; y < level.height; y++)
+		{
+			weights(y, sourceHeight, rows);
+			for (int x = 0; x < level.width; x++)
+			{
+				weights(x, sourceWidth, columns);
+				for (int channel = 0; channel < channels; channel++)
+				{
+					bool sRGB = (channels >= 3) && (channel < 3);
+
+					double sum = 0.0;
+					for (const std::pair<int, double>& row : rows)
+					{
+						for (const std::pair<int, double>& column : columns)
+						{
+							double value = source[(static_cast<size_t>(row.first) * sourceWidth + column.first) * channels + channel] / 255.0;
+							sum += row.second * column.second * (sRGB ? ExactSRGBToLinear(value) : value);
+						}
+					}
+
+					int expected = static_cast<int>(floor((sRGB ? ExactLinearToSRGB(sum) : sum) * 255.0 + 0.5));
+					int actual = level.pixels[(static_cast<size_t>(y) * level.width + x) * channels + channel];
+					largest = std::max(largest, abs(expected - actual));
+				}
+			}
+		}
+		return largest;
+	}
+
+	//smooth gradients with a little noise and a hard edge every 64 texels, roughly what painted textures look like to an encoder
+	std::vector<uint8_t> SyntheticImage(int size, int channels, bool grey, bool alpha, std::mt19937& random)
+	{
+		std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * channels);
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				float edge = (((x / 64) + (y / 64)) % 2 == 0) ? 0.0f : 60.0f;
+				float base[4] =
+				{
+					100.0f + 80.0f * sinf(x * 0.013f) + edge,
+					110.0f + 70.0f * cosf(y * 0.021f) - edge * 0.5f,
+					120.0f + 60.0f * sinf((x + y) * 0.008f),
+					alpha ? 128.0f + 120.0f * sinf(x * 0.03f) * cosf(y * 0.03f) : 255.0f
+				};
+
+				float noise = static_cast<float>(static_cast<int>(random() % 9) - 4);
+				for (int c = 0; c < channels; c++)
+				{
+					float value = (grey && (c < 3)) ? base[0] + noise : base[c];
+					if (!grey && (c < 3))
+					{
+						value += static_cast<float>(static_cast<int>(random() % 9) - 4);
+					}
+					pixels[(static_cast<size_t>(y) * size + x) * channels + c] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)));
+				}
+			}
+		}
+		return pixels;
+	}
+
+	//over the first channels of the original, decoded is always RGBA
+	double PSNR(const std::vector<uint8_t>& original, int channels, const std::vector<uint8_t>& decoded, int comparedChannels)
+	{
+		double squared = 0.0;
+		size_t texels = original.size() / channels;
+		for (size_t i = 0; i < texels; i++)
+		{
+			for (int c = 0; c < comparedChannels; c++)
+			{
+				double difference = static_cast<double>(original[i * channels + c]) - decoded[i * 4 + c];
+				squared += difference * difference;
+			}
+		}
+
+		double mean = squared / (static_cast<double>(texels) * comparedChannels);
+		return (mean == 0.0) ? 99.0 : 10.0 * log10(255.0 * 255.0 / mean);
+	}
+
+	//resident memory of the whole process, 0 where it cannot be read
+	size_t ResidentBytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return 0;
+		}
+		return counters.WorkingSetSize;
+#else
+		std::ifstream statm("/proc/self/statm");
+		size_t pages = 0;
+		size_t resident = 0;
+		if (!(statm >> pages >> resident))
+		{
+			return 0;
+		}
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	//highest resident memory between construction and Stop, sampled every millisecond on a thread of its own
+	class ResidentPeak
+	{
+		public:
+			ResidentPeak() : running(true), peak(ResidentBytes())
+			{
+				sampler = std::thread([this]()
+				{
+					while (running)
+					{
+						size_t current = ResidentBytes();
+						if (current > peak)
+						{
+							peak = current;
+						}
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				});
+			}
+
+			size_t Stop()
+			{
+				running = false;
+				sampler.join();
+				return std::max(peak.load(), ResidentBytes());
+			}
+
+		private:
+			std::atomic<bool> running;
+			std::atomic<size_t> peak;
+			std::thread sampler;
+	};
+
+	//checks that every index refers to a vertex handed on before it, keeps the mesh only when given one
+	class CheckingSink : public MeshSink
+	{
+		public:
+			CheckingSink(MeshData* mesh) : mesh(mesh), vertexCount(0), indexCount(0), ordered(true)
+			{
+			}
+
+			bool Vertices(const Vertex* vertices, size_t count) override
+			{
+				if (mesh != nullptr)
+				{
+					mesh->vertices.insert(mesh->vertices.end(), vertices, vertices + count);
+				}
+				vertexCount += count;
+				return true;
+			}
+
+			bool Indices(const uint32_t* indices, size_t count) override
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					ordered &= (indices[i] < vertexCount);
+				}
+				if (mesh != nullptr)
+				{
+					mesh->indices.insert(mesh->indices.end(), indices, indices + count);
+				}
+				indexCount += count;
+				return true;
+			}
+
+			MeshData* mesh;
+			size_t vertexCount;
+			size_t indexCount;
+			bool ordered;
+	};
+
+	//same triangles with the same corners, the vertices they are welded into may differ
+	bool SameCorners(const MeshData& a, const MeshData& b)
+	{
+		if ((a.indices.size() != b.indices.size()) || (a.submeshMaterials != b.submeshMaterials) || (a.materialLibraries != b.materialLibraries) || (a.submeshes.size() != b.submeshes.size()))
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < a.submeshes.size(); i++)
+		{
+			if ((a.submeshes[i].Start != b.submeshes[i].Start) || (a.submeshes[i].size != b.submeshes[i].size))
+			{
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < a.indices.size(); i++)
+		{
+			if (memcmp(&a.vertices[a.indices[i]], &b.vertices[b.indices[i]], sizeof(Vertex)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	enum class GLBLayout
+	{
+		//one buffer view of Vertex the reader can use as it is
+		Interleaved,
+		//a buffer view per attribute, the way most exporters write
+		Separate,
+		//every submesh with its own vertices indexed from 0, under a node that moves it
+		PerSubmesh
+	};
+
+	void AppendBytes(std::vector<char>& binary, const void* data, size_t size)
+	{
+		binary.insert(binary.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+		binary.resize((binary.size() + 3) & ~static_cast<size_t>(3), 0);
+	}
+
+	//writes mesh as a .glb with one material per material name, the first one textured with texture if it is not empty.
+	//UVs are written as MeshData holds them, so a read compares byte for byte
+	bool WriteGLB(const std::string& GLBFilepath, const MeshData& mesh, GLBLayout layout, bool shortIndices, bool normals, const float offset[3], const std::string& texture)
+	{
+		std::vector<std::string> materials;
+		for (const std::string& name : mesh.submeshMaterials)
+		{
+			if (std::find(materials.begin(), materials.end(), name) == materials.end())
+			{
+				materials.push_back(name);
+			}
+		}
+
+		std::vector<char> binary;
+		std::string bufferViews;
+		std::string accessors;
+		size_t viewCount = 0;
+		size_t accessorCount = 0;
+
+		auto addView = [&](const void* data, size_t size, size_t stride)
+		{
+			bufferViews += std::string(viewCount > 0 ? "," : "") + "{\"buffer\":0,\"byteOffset\":" + std::to_string(binary.size()) + ",\"byteLength\":" + std::to_string(size) +
+				((stride != 0) ? ",\"byteStride\":" + std::to_string(stride) : "") + "}";
+			AppendBytes(binary, data, size);
+			return viewCount++;
+		};
+		auto addAccessor = [&](size_t view, size_t byteOffset, size_t componentType, size_t count, const char* type)
+		{
+			accessors += std::string(accessorCount > 0 ? "," : "") + "{\"bufferView\":" + std::to_string(view) + ",\"byteOffset\":" + std::to_string(byteOffset) +
+				",\"componentType\":" + std::to_string(componentType) + ",\"count\":" + std::to_string(count) + ",\"type\":\"" + type + "\"}";
+			return accessorCount++;
+		};
+
+		//the vertices and local indices of every range, one for the whole mesh unless every submesh gets its own
+		std::vector<std::vector<Vertex>> rangeVertices;
+		std::vector<std::vector<uint32_t>> rangeIndices;
+		if (layout == GLBLayout::PerSubmesh)
+		{
+			for (const Submesh& submesh : mesh.submeshes)
+			{
+				std::map<uint32_t, uint32_t> local;
+				rangeVertices.emplace_back();
+				rangeIndices.emplace_back();
+				for (int i = submesh.Start; i < submesh.Start + submesh.size; i++)
+				{
+					std::pair<std::map<uint32_t, uint32_t>::iterator, bool> inserted = local.insert({ mesh.indices[i], static_cast<uint32_t>(rangeVertices.back().size()) });
+					if (inserted.second)
+					{
+						rangeVertices.back().push_back(mesh.vertices[mesh.indices[i]]);
+					}
+					rangeIndices.back().push_back(inserted.first->second);
+				}
+			}
+		}
+		else
+		{
+			rangeVertices.push_back(mesh.vertices);
+			rangeIndices.push_back(mesh.indices);
+		}
+
+		std::string primitives;
+		std::string meshes;
+		std::string nodes;
+		for (size_t range = 0; range < rangeVertices.size(); range++)
+		{
+			const std::vector<Vertex>& vertices = rangeVertices[range];
+			std::string attributes;
+			if (layout == GLBLayout::Interleaved)
+			{
+				size_t view = addView(vertices.data(), vertices.size() * sizeof(Vertex), sizeof(Vertex));
+				attributes = "\"POSITION\":" + std::to_string(addAccessor(view, 0, 5126, vertices.size(), "VEC3")) +
+					",\"NORMAL\":" + std::to_string(addAccessor(view, 12, 5126, vertices.size(), "VEC3")) +
+					",\"TEXCOORD_0\":" + std::to_string(addAccessor(view, 24, 5126, vertices.size(), "VEC2"));
+			}
+			else
+			{
+				std::vector<float> positions;
+				std::vector<float> normalValues;
+				std::vector<float> uvs;
+				for (const Vertex& vertex : vertices)
+				{
+					positions.insert(positions.end(), vertex.pos, vertex.pos + 3);
+					normalValues.insert(normalValues.end(), vertex.norm, vertex.norm + 3);
+					uvs.insert(uvs.end(), vertex.uv, vertex.uv + 2);
+				}
+
+				attributes = "\"POSITION\":" + std::to_string(addAccessor(addView(positions.data(), positions.size() * sizeof(float), 0), 0, 5126, vertices.size(), "VEC3"));
+				if (normals)
+				{
+					attributes += ",\"NORMAL\":" + std::to_string(addAccessor(addView(normalValues.data(), normalValues.size() * sizeof(float), 0), 0, 5126, vertices.size(), "VEC3"));
+				}
+				attributes += ",\"TEXCOORD_0\":" + std::to_string(addAccessor(addView(uvs.data(), uvs.size() * sizeof(float), 0), 0, 5126, vertices.size(), "VEC2"));
+			}
+
+			//the indices of a range in one view, an accessor per submesh
+			const std::vector<uint32_t>& indices = rangeIndices[range];
+			size_t indexView = 0;
+			if (shortIndices)
+			{
+				std::vector<uint16_t> narrowed(indices.begin(), indices.end());
+				indexView = addView(narrowed.data(), narrowed.size() * sizeof(uint16_t), 0);
+			}
+			else
+			{
+				indexView = addView(indices.data(), indices.size() * sizeof(uint32_t), 0);
+			}
+
+			std::string rangePrimitives;
+			for (size_t submesh = 0; submesh < mesh.submeshes.size(); submesh++)
+			{
+				if ((layout == GLBLayout::PerSubmesh) && (submesh != range))
+				{
+					continue;
+				}
+
+				size_t start = (layout == GLBLayout::PerSubmesh) ? 0 : mesh.submeshes[submesh].Start;
+				size_t accessor = addAccessor(indexView, start * (shortIndices ? 2 : 4), shortIndices ? 5123 : 5125, mesh.submeshes[submesh].size, "SCALAR");
+				size_t material = std::find(materials.begin(), materials.end(), mesh.submeshMaterials[submesh]) - materials.begin();
+
+				rangePrimitives += std::string(rangePrimitives.empty() ? "" : ",") + "{\"attributes\":{" + attributes + "},\"indices\":" + std::to_string(accessor) + ",\"material\":" + std::to_string(material) + "}";
+			}
+
+			meshes += std::string(range > 0 ? "," : "") + "{\"primitives\":[" + rangePrimitives + "]}";
+			nodes += std::string(range > 0 ? "," : "") + "{\"mesh\":" + std::to_string(range) + "}";
+		}
+
+		//every node below one root that carries the offset
+		std::string children;
+		for (size_t range = 0; range < rangeVertices.size(); range++)
+		{
+			children += std::string(range > 0 ? "," : "") + std::to_string(range + 1);
+		}
+		nodes = "{\"translation\":[" + std::to_string(offset[0]) + "," + std::to_string(offset[1]) + "," + std::to_string(offset[2]) + "],\"children\":[" + children + "]}," + nodes;
+
+		std::string materialList;
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			std::string textureInfo = ((i == 0) && !texture.empty()) ? ",\"baseColorTexture\":{\"index\":0}" : "";
+			materialList += std::string(i > 0 ? "," : "") + "{\"name\":\"" + materials[i] + "\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.5,0.25,1,1],\"metallicFactor\":0,\"roughnessFactor\":0.5" + textureInfo + "}}";
+		}
+
+		std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[" + nodes + "],\"meshes\":[" + meshes + "],\"materials\":[" + materialList + "]" +
+			(texture.empty() ? "" : ",\"textures\":[{\"source\":0}],\"images\":[{\"uri\":\"" + texture + "\"}]") +
+			",\"accessors\":[" + accessors + "],\"bufferViews\":[" + bufferViews + "],\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}]}";
+		json.resize((json.size() + 3) & ~static_cast<size_t>(3), ' ');
+
+		uint32_t header[5] = { 0x46546C67, 2, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binary.size()), static_cast<uint32_t>(json.size()), 0x4E4F534A };
+		uint32_t binaryHeader[2] = { static_cast<uint32_t>(binary.size()), 0x004E4942 };
+
+		std::ofstream file(GLBFilepath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(json.data(), json.size());
+		file.write(reinterpret_cast<const char*>(binaryHeader), sizeof(binaryHeader));
+		file.write(binary.data(), binary.size());
+		return file.good();
+	}
+
+	bool BoundsContain(const Bounds& bounds, const std::vector<Vertex>& vertices)
+	{
+		for (const Vertex& vertex : vertices)
+		{
+			double distance = 0.0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if ((vertex.pos[axis] < bounds.min[axis]) || (vertex.pos[axis] > bounds.max[axis]))
+				{
+					return false;
+				}
+				double offset = static_cast<double>(vertex.pos[axis]) - bounds.center[axis];
+				distance += offset * offset;
+			}
+			if (sqrt(distance) > bounds.radius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//a check that writes where the runtime looks for cooked files first moves what the user cooked there out of the way
+	std::vector<std::string> SetAside(const std::vector<std::string>& outputs)
+	{
+		std::vector<std::string> moved;
+		for (const std::string& output : outputs)
+		{
+			std::error_code error;
+			if (std::filesystem::is_regular_file(output, error))
+			{
+				std::filesystem::rename(output, output + ".aside", error);
+				if (!error)
+				{
+					moved.push_back(output);
+				}
+			}
+		}
+		return moved;
+	}
+
+	//removes what the check wrote and puts back what SetAside moved
+	void Restore(const std::vector<std::string>& outputs, const std::vector<std::string>& moved)
+	{
+		std::error_code error;
+		for (const std::string& output : outputs)
+		{
+			std::filesystem::remove(output, error);
+		}
+		for (const std::string& output : moved)
+		{
+			std::filesystem::rename(output + ".aside", output, error);
+		}
+	}
+}
+
+bool Diagnostics::WriteGridOBJ(const std::string& OBJFilepath, int quadsPerSide)
+{
+	std::ofstream OBJ(OBJFilepath, std::ios::binary);
+	if (!OBJ.is_open())
+	{
+		std::cerr << "Failed to create: " << OBJFilepath << std::endl;
+		return false;
+	}
+
+	int side = quadsPerSide + 1;
+	for (int i = 0; i < side; i++)
+	{
+		for (int j = 0; j < side; j++)
+		{
+			//a little height variation so the positions are not all trivially short
+			float height = static_cast<float>((i * 7 + j * 13) % 17) * 0.01f;
+			OBJ << "v " << i * 0.1f << " " << height << " " << j * 0.1f << "\n";
+		}
+	}
+	for (int i = 0; i < side; i++)
+	{
+		for (int j = 0; j < side; j++)
+		{
+			OBJ << "vt " << static_cast<float>(i) / quadsPerSide << " " << static_cast<float>(j) / quadsPerSide << "\n";
+		}
+	}
+	OBJ << "vn 0 1 0\n";
+
+	OBJ << "s 1\n";
+	for (int i = 0; i < quadsPerSide; i++)
+	{
+		for (int j = 0; j < quadsPerSide; j++)
+		{
+			int a = i * side + j + 1;
+			int b = a + 1;
+			int c = a + side;
+			int d = c + 1;
+			OBJ << "f " << a << "/" << a << "/1 " << c << "/" << c << "/1 " << b << "/" << b << "/1\n";
+			OBJ << "f " << b << "/" << b << "/1 " << c << "/" << c << "/1 " << d << "/" << d << "/1\n";
+		}
+	}
+
+	return OBJ.good();
+}
+
+bool Diagnostics::CheckStreamingImport(const std::vector<std::string>& OBJFilepaths, size_t memoryBudget)
+{
+	std::cout << "Streaming OBJ import, " << memoryBudget / (1024 * 1024) << " MB budget" << std::endl;
+
+	OBJReader::StreamOptions options;
+	options.memoryBudget = memoryBudget;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		//counted and dropped, so whatever the process grows by while streaming is the import's own memory
+		CheckingSink counter(nullptr);
+		MeshData counted;
+		OBJReader::ReadStats stats;
+
+		size_t baseline = ResidentBytes();
+		ResidentPeak streamPeak;
+		bool streamed = OBJReader::Stream(OBJFilepath, counter, counted, OBJ_IMPORT_PARALLEL, options, &stats);
+		size_t streamGrowth = std::max(streamPeak.Stop(), baseline) - baseline;
+
+		MeshData parsed;
+		baseline = ResidentBytes();
+		ResidentPeak readPeak;
+		bool read = OBJReader::Read(OBJFilepath, parsed, OBJ_IMPORT_PARALLEL);
+		size_t readGrowth = std::max(readPeak.Stop(), baseline) - baseline;
+
+		MeshData collected;
+		CheckingSink collector(&collected);
+		streamed &= OBJReader::Stream(OBJFilepath, collector, collected, OBJ_IMPORT_PARALLEL, options);
+
+		//through the cache writer and back, to a file of its own so the real cache is left alone
+		std::string cacheFilepath = OBJFilepath + ".streamed.stdmesh";
+		MeshData written;
+		MeshCache::CachedMesh cached;
+		{
+			MeshCache::StreamWriter writer(cacheFilepath, OBJFilepath, 0);
+			streamed &= OBJReader::Stream(OBJFilepath, writer, written, OBJ_IMPORT_SERIAL, options) && writer.Finish(written);
+		}
+		streamed &= MeshCache::Read(cacheFilepath, OBJFilepath, 0, cached);
+
+		if (!streamed || !read)
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			std::remove(cacheFilepath.c_str());
+			success = false;
+			continue;
+		}
+
+		MeshData roundTrip;
+		roundTrip.vertices.assign(cached.vertices, cached.vertices + cached.vertexCount);
+		roundTrip.indices.assign(cached.indices, cached.indices + cached.indexCount);
+		roundTrip.submeshes = cached.submeshes;
+		roundTrip.submeshMaterials = cached.submeshMaterials;
+		roundTrip.materialLibraries = cached.materialLibraries;
+		roundTrip.bounds = cached.bounds;
+		cached.file.Close();
+		std::remove(cacheFilepath.c_str());
+
+		std::cout << "  " << OBJFilepath << ": " << stats.windows << " windows, " << stats.peakWorkingBytes / 1024 << " KB working memory, resident +" << streamGrowth / 1024
+			<< " KB streamed, +" << readGrowth / 1024 << " KB read, " << parsed.vertices.size() << " -> " << collected.vertices.size() << " vertices";
+
+		if ((stats.peakWorkingBytes > memoryBudget) || (streamGrowth > memoryBudget))
+		{
+			std::cout << " OVER BUDGET";
+			success = false;
+		}
+		if (!counter.ordered || (counter.indexCount != parsed.indices.size()) || !SameCorners(parsed, collected) || !SameCorners(collected, roundTrip) ||
+			!BoundsContain(collected.bounds, collected.vertices) || (memcmp(&collected.bounds, &roundTrip.bounds, sizeof(Bounds)) != 0))
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkOBJImport(const std::vector<std::string>& OBJFilepaths, int repeats)
+{
+	std::cout << "OBJ import, best of " << repeats << ", " << ThreadPool::Shared().ThreadCount() + 1 << " threads" << std::endl;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		double serialSeconds = 0.0;
+		double parallelSeconds = 0.0;
+		uint64_t serialHash = 0;
+		uint64_t parallelHash = 0;
+
+		if (!TimeImport(OBJFilepath, OBJ_IMPORT_SERIAL, repeats, serialSeconds, serialHash) ||
+			!TimeImport(OBJFilepath, OBJ_IMPORT_PARALLEL, repeats, parallelSeconds, parallelHash))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		std::cout << "  " << OBJFilepath << ": serial " << serialSeconds * 1000.0 << " ms, parallel " << parallelSeconds * 1000.0 << " ms, speedup " << ((parallelSeconds > 0.0) ? serialSeconds / parallelSeconds : 0.0) << "x";
+		if (serialHash != parallelHash)
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkAsyncLoading(const std::vector<std::string>& OBJFilepaths, int copies)
+{
+	std::cout << "Asynchronous loading, " << copies << " copies of every file, " << ThreadPool::Shared().ThreadCount() << " workers" << std::endl;
+
+	std::vector<uint64_t> expected;
+	auto serialStart = std::chrono::steady_clock::now();
+	for (int copy = 0; copy < copies; copy++)
+	{
+		for (const std::string& OBJFilepath : OBJFilepaths)
+		{
+			MeshData mesh;
+			if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_SERIAL))
+			{
+				std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+				return false;
+			}
+			expected.push_back(HashMesh(mesh));
+		}
+	}
+	std::chrono::duration<double> serialTime = std::chrono::steady_clock::now() - serialStart;
+
+	std::vector<uint64_t> hashes(expected.size(), 0);
+	std::unique_ptr<bool[]> onMainThread(new bool[expected.size()]());
+	std::thread::id mainThread = std::this_thread::get_id();
+
+	auto asyncStart = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		AsyncLoading::Start(LoadAsync(OBJFilepaths[i % OBJFilepaths.size()], mainThread, &hashes[i], &onMainThread[i]));
+	}
+	std::chrono::duration<double> startTime = std::chrono::steady_clock::now() - asyncStart;
+
+	//stands in for the frame loop, the longest Pump is how long a frame would stall
+	double longestPump = 0.0;
+	while (AsyncLoading::Pending() > 0)
+	{
+		auto pumpStart = std::chrono::steady_clock::now();
+		size_t resumed = AsyncLoading::Pump();
+		std::chrono::duration<double> pumpTime = std::chrono::steady_clock::now() - pumpStart;
+		longestPump = std::max(longestPump, pumpTime.count());
+
+		if (resumed == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+	std::chrono::duration<double> asyncTime = std::chrono::steady_clock::now() - asyncStart;
+
+	bool success = (hashes == expected);
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		success &= onMainThread[i];
+	}
+
+	std::cout << "  " << expected.size() << " loads: serial " << serialTime.count() * 1000.0 << " ms, asynchronous " << asyncTime.count() * 1000.0 << " ms, starting them "
+		<< startTime.count() * 1000.0 << " ms, longest pump " << longestPump * 1000.0 << " ms";
+	if (!success)
+	{
+		std::cout << " MISMATCH";
+	}
+	std::cout << std::endl;
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkVertexDedup(int quadsPerSide, int repeats)
+{
+	//the corners in face order, the same stream the OBJ reader welds
+	std::vector<std::array<int, 3>> corners;
+	corners.reserve(static_cast<size_t>(quadsPerSide) * quadsPerSide * 6);
+
+	int side = quadsPerSide + 1;
+	for (int i = 0; i < quadsPerSide; i++)
+	{
+		for (int j = 0; j < quadsPerSide; j++)
+		{
+			int a = i * side + j;
+			int b = a + 1;
+			int c = a + side;
+			int d = c + 1;
+			for (int corner : { a, c, b, b, c, d })
+			{
+				corners.push_back({ corner, corner, 0 });
+			}
+		}
+	}
+
+	double mapSeconds = 0.0;
+	double tableSeconds = 0.0;
+	std::vector<uint32_t> mapIndices;
+	std::vector<uint32_t> tableIndices;
+
+	for (int run = 0; run < repeats; run++)
+	{
+		//what LoadOBJ used to do: build the "v/vt/vn" text and look it up in a tree
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		{
+			std::map<std::string, int> vertMap;
+			mapIndices.clear();
+			for (const std::array<int, 3>& corner : corners)
+			{
+				std::string key = std::to_string(corner[0] + 1) + "/" + std::to_string(corner[1] + 1) + "/" + std::to_string(corner[2] + 1);
+				if (vertMap.find(key) == vertMap.end())
+				{
+					int next = static_cast<int>(vertMap.size());
+					vertMap[key] = next;
+				}
+				mapIndices.push_back(vertMap[key]);
+			}
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if ((run == 0) || (elapsed.count() < mapSeconds))
+		{
+			mapSeconds = elapsed.count();
+		}
+
+		start = std::chrono::steady_clock::now();
+		{
+			CornerHashTable vertMap(corners.size() / 2);
+			tableIndices.clear();
+			uint32_t next = 0;
+			for (const std::array<int, 3>& corner : corners)
+			{
+				bool inserted = false;
+				tableIndices.push_back(vertMap.FindOrInsert(corner.data(), next, inserted));
+				if (inserted)
+				{
+					next++;
+				}
+			}
+		}
+		elapsed = std::chrono::steady_clock::now() - start;
+		if ((run == 0) || (elapsed.count() < tableSeconds))
+		{
+			tableSeconds = elapsed.count();
+		}
+	}
+
+	//the string building is part of what the old path paid per corner, so it is counted on its side
+	std::cout << "Vertex dedup, " << corners.size() << " corners: std::map " << mapSeconds * 1000.0 << " ms, hash table " << tableSeconds * 1000.0 << " ms, speedup " << ((tableSeconds > 0.0) ? mapSeconds / tableSeconds : 0.0) << "x";
+
+	bool success = (mapIndices == tableIndices);
+	if (!success)
+	{
+		std::cout << " MISMATCH";
+	}
+	std::cout << std::endl;
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkMeshCache(const std::vector<std::string>& OBJFilepaths, int repeats)
+{
+	std::cout << "Mesh cache, best of " << repeats << std::endl;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		double parseSeconds = 0.0;
+		uint64_t parseHash = 0;
+
+		MeshData parsed;
+		if (!TimeImport(OBJFilepath, OBJ_IMPORT_PARALLEL, repeats, parseSeconds, parseHash) ||
+			!OBJReader::Read(OBJFilepath, parsed, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		//one level of detail so the LOD records are part of the round trip
+		MeshSimplifier::BuildLODs(parsed, 1);
+		uint64_t parsedHash = HashMesh(parsed);
+
+		//a name of its own, so the cache the scene loads with the same flags is left alone
+		std::string cacheFilepath = OBJFilepath + ".benchmark.stdmesh";
+		if (!MeshCache::Write(cacheFilepath, OBJFilepath, parsed, OBJ_IMPORT_LOD))
+		{
+			success = false;
+			continue;
+		}
+
+		double cacheSeconds = 0.0;
+		MeshData roundTrip;
+		for (int i = 0; i < repeats; i++)
+		{
+			std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+			MeshCache::CachedMesh cached;
+			if (!MeshCache::Read(cacheFilepath, OBJFilepath, OBJ_IMPORT_LOD, cached))
+			{
+				std::cerr << "Failed to read mesh cache: " << cacheFilepath << std::endl;
+				success = false;
+				break;
+			}
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if ((i == 0) || (elapsed.count() < cacheSeconds))
+			{
+				cacheSeconds = elapsed.count();
+			}
+
+			roundTrip.vertices.assign(cached.vertices, cached.vertices + cached.vertexCount);
+			roundTrip.indices.assign(cached.indices, cached.indices + cached.indexCount);
+			roundTrip.submeshes = cached.submeshes;
+			roundTrip.submeshMaterials = cached.submeshMaterials;
+			roundTrip.materialLibraries = cached.materialLibraries;
+			roundTrip.lods = cached.lods;
+			roundTrip.bounds = cached.bounds;
+		}
+
+		std::remove(cacheFilepath.c_str());
+
+		std::cout << "  " << OBJFilepath << ": parse " << parseSeconds * 1000.0 << " ms, cache " << cacheSeconds * 1000.0 << " ms";
+		if ((HashMesh(roundTrip) != parsedHash) || (roundTrip.materialLibraries != parsed.materialLibraries))
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkMeshOptimizer(const std::vector<std::string>& OBJFilepaths)
+{
+	std::cout << "Mesh optimizer, FIFO cache of 16" << std::endl;
+
+	//every triangle as the bytes of its three vertices, rotated so the smallest comes first
+	auto triangleSet = [](const MeshData& mesh)
+	{
+		std::vector<std::string> triangles;
+		triangles.reserve(mesh.indices.size() / 3);
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			std::string corners[3];
+			for (int k = 0; k < 3; k++)
+			{
+				corners[k].assign(reinterpret_cast<const char*>(&mesh.vertices[mesh.indices[i + k]]), sizeof(Vertex));
+			}
+
+			int first = 0;
+			for (int k = 1; k < 3; k++)
+			{
+				if (corners[k] < corners[first])
+				{
+					first = k;
+				}
+			}
+			triangles.push_back(corners[first] + corners[(first + 1) % 3] + corners[(first + 2) % 3]);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		std::vector<std::string> trianglesBefore = triangleSet(mesh);
+
+		//only bit identical welding, so the triangles can be compared exactly afterwards
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		MeshOptimizer::OptimizeStats stats = MeshOptimizer::Optimize(mesh, 0.0f);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "  " << OBJFilepath << ": ACMR " << stats.before.ACMR << " -> " << stats.after.ACMR << ", ATVR " << stats.before.ATVR << " -> " << stats.after.ATVR
+			<< ", " << stats.verticesBefore << " -> " << stats.verticesAfter << " vertices, " << stats.submeshesBefore << " -> " << stats.submeshesAfter << " submeshes, " << elapsed.count() * 1000.0 << " ms";
+
+		if (triangleSet(mesh) != trianglesBefore)
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckVertexQuantization(const std::vector<std::string>& OBJFilepaths)
+{
+	//half a step of each encoding, plus float rounding in the decode
+	const double MaxNormalDegrees = 0.01;
+	const double HalfPrecision = 1.0 / 2048.0;
+
+	std::cout << "Vertex quantization round trip" << std::endl;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		std::vector<CompactVertex> compact;
+		MeshDecodeBufferStruct decode;
+		VertexQuantization::Quantize(mesh.vertices.data(), mesh.vertices.size(), compact, decode);
+
+		double maxPositionError = 0.0;
+		double maxPositionBound = 0.0;
+		double maxNormalDegrees = 0.0;
+		double maxUVError = 0.0;
+		bool withinBounds = true;
+
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			const Vertex& original = mesh.vertices[i];
+			Vertex decoded = VertexQuantization::Dequantize(compact[i], decode);
+
+			for (int k = 0; k < 3; k++)
+			{
+				double error = fabs(static_cast<double>(decoded.pos[k]) - original.pos[k]);
+				double bound = decode.boundsExtent[k] * (0.5 / 65535.0) + (fabs(decode.boundsMin[k]) + decode.boundsExtent[k]) * 1e-6;
+				maxPositionError = std::max(maxPositionError, error);
+				maxPositionBound = std::max(maxPositionBound, bound);
+				withinBounds &= (error <= bound);
+			}
+
+			//atan2 of the cross and dot products, acos is too imprecise for angles this small
+			const float* a = original.norm;
+			const float* b = decoded.norm;
+			double cross[3] = { static_cast<double>(a[1]) * b[2] - static_cast<double>(a[2]) * b[1], static_cast<double>(a[2]) * b[0] - static_cast<double>(a[0]) * b[2], static_cast<double>(a[0]) * b[1] - static_cast<double>(a[1]) * b[0] };
+			double dot = static_cast<double>(a[0]) * b[0] + static_cast<double>(a[1]) * b[1] + static_cast<double>(a[2]) * b[2];
+			double degrees = atan2(sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot) * 180.0 / 3.141592653589793;
+			maxNormalDegrees = std::max(maxNormalDegrees, degrees);
+			withinBounds &= (degrees <= MaxNormalDegrees);
+
+			for (int k = 0; k < 2; k++)
+			{
+				double error = fabs(static_cast<double>(decoded.uv[k]) - original.uv[k]);
+				maxUVError = std::max(maxUVError, error);
+				withinBounds &= (error <= fabs(original.uv[k]) * HalfPrecision + 1e-7);
+			}
+		}
+
+		size_t fullBytes = sizeof(Vertex) * mesh.vertices.size() + sizeof(uint32_t) * mesh.indices.size();
+		size_t compactBytes = sizeof(CompactVertex) * mesh.vertices.size() + (VertexQuantization::FitsShortIndices(mesh.vertices.size()) ? sizeof(uint16_t) : sizeof(uint32_t)) * mesh.indices.size();
+
+		std::cout << "  " << OBJFilepath << ": position " << maxPositionError << " (bound " << maxPositionBound << "), normal " << maxNormalDegrees << " degrees, uv " << maxUVError
+			<< ", " << fullBytes / 1024 << " KB -> " << compactBytes / 1024 << " KB";
+		if (!withinBounds)
+		{
+			std::cout << " OUT OF BOUNDS";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckVertexFormats(const std::vector<std::string>& OBJFilepaths)
+{
+	std::cout << "Vertex formats" << std::endl;
+
+	bool success = true;
+
+	//the generated offsets have to be where the compiler placed the base classes, else the input layouts read the wrong bytes
+	{
+		Vertex vertex;
+		UntexturedVertex untextured;
+		const char* base = reinterpret_cast<const char*>(&vertex);
+		const char* untexturedBase = reinterpret_cast<const char*>(&untextured);
+
+		bool placed = (reinterpret_cast<const char*>(vertex.pos) - base == Vertex::Offset<VertexAttribute::Position>()) &&
+			(reinterpret_cast<const char*>(vertex.norm) - base == Vertex::Offset<VertexAttribute::Normal>()) &&
+			(reinterpret_cast<const char*>(vertex.uv) - base == Vertex::Offset<VertexAttribute::UV>()) &&
+			(reinterpret_cast<const char*>(untextured.pos) - untexturedBase == UntexturedVertex::Offset<VertexAttribute::Position>()) &&
+			(reinterpret_cast<const char*>(untextured.norm) - untexturedBase == UntexturedVertex::Offset<VertexAttribute::Normal>());
+
+		//the layout the shaders were written against before it was generated
+		const VertexAttributeInfo expected[3] = { { "POSITION", 3, 0 }, { "NORMAL", 3, 12 }, { "UV", 2, 24 } };
+		for (size_t i = 0; i < Vertex::AttributeCount; i++)
+		{
+			placed &= (std::string(Vertex::Layout[i].semantic) == expected[i].semantic) && (Vertex::Layout[i].components == expected[i].components) && (Vertex::Layout[i].offset == expected[i].offset);
+		}
+		placed &= (Vertex::Stride == 32) && (UntexturedVertex::Stride == 24) && (UntexturedVertex::AttributeCount == 2) && !UntexturedVertex::Has<VertexAttribute::UV>;
+
+		std::cout << "  layouts: Vertex " << Vertex::Stride << " bytes, UntexturedVertex " << UntexturedVertex::Stride << " bytes";
+		if (!placed)
+		{
+			std::cout << " MISPLACED";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		std::vector<UntexturedVertex> untextured;
+		UntexturedVertex::Convert(mesh.vertices.data(), mesh.vertices.size(), untextured);
+
+		bool same = (untextured.size() == mesh.vertices.size());
+		for (size_t i = 0; same && (i < untextured.size()); i++)
+		{
+			same = (memcmp(untextured[i].pos, mesh.vertices[i].pos, sizeof(untextured[i].pos)) == 0) && (memcmp(untextured[i].norm, mesh.vertices[i].norm, sizeof(untextured[i].norm)) == 0);
+		}
+
+		std::cout << "  " << OBJFilepath << ": " << sizeof(Vertex) * mesh.vertices.size() / 1024 << " KB -> " << sizeof(UntexturedVertex) * untextured.size() / 1024 << " KB without uvs";
+		if (!same)
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckDepthStream(const std::vector<std::string>& OBJFilepaths)
+{
+	std::cout << "Depth stream" << std::endl;
+
+	bool success = true;
+
+	//a gap or submeshes out of order have to be drawn one by one
+	{
+		Submesh range;
+		bool rejected = !Instancing::CoveringRange({ { 0, 6, 0 }, { 9, 3, 1 } }, range) && !Instancing::CoveringRange({ { 6, 3, 0 }, { 0, 6, 1 } }, range);
+		bool accepted = Instancing::CoveringRange({ { 3, 6, 0 }, { 9, 0, 1 }, { 9, 3, 2 } }, range) && (range.Start == 3) && (range.size == 9);
+		if (!rejected || !accepted)
+		{
+			std::cout << "  covering range MISMATCH" << std::endl;
+			success = false;
+		}
+	}
+
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!AssetCooker::BuildMesh(OBJFilepath, OBJ_IMPORT_PARALLEL | OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS, mesh, false))
+		{
+			std::cerr << "Failed to build: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		std::vector<const std::vector<Submesh>*> levels = { &mesh.submeshes };
+		for (const MeshLOD& lod : mesh.lods)
+		{
+			levels.push_back(&lod.submeshes);
+		}
+
+		bool covered = true;
+		size_t submeshDraws = 0;
+		for (const std::vector<Submesh>* level : levels)
+		{
+			size_t indexCount = 0;
+			for (const Submesh& submesh : *level)
+			{
+				indexCount += submesh.size;
+				submeshDraws += (submesh.size > 0) ? 1 : 0;
+			}
+
+			Submesh range;
+			covered &= Instancing::CoveringRange(*level, range) && (static_cast<size_t>(range.size) == indexCount) && (range.Start + range.size <= static_cast<int>(mesh.indices.size()));
+		}
+
+		std::vector<PositionVertex> positions;
+		PositionVertex::Convert(mesh.vertices.data(), mesh.vertices.size(), positions);
+
+		bool same = (positions.size() == mesh.vertices.size());
+		for (size_t i = 0; same && (i < positions.size()); i++)
+		{
+			same = memcmp(positions[i].pos, mesh.vertices[i].pos, sizeof(positions[i].pos)) == 0;
+		}
+
+		std::cout << "  " << OBJFilepath << ": " << levels.size() << " levels, " << sizeof(Vertex) * mesh.vertices.size() / 1024 << " KB -> " << sizeof(PositionVertex) * positions.size() / 1024
+			<< " KB fetched, " << static_cast<double>(submeshDraws) / levels.size() << " -> 1 draws per object";
+		if (!covered || !same)
+		{
+			std::cout << " MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckMeshSimplifier(const std::vector<std::string>& OBJFilepaths, int levelCount)
+{
+	std::cout << "Mesh simplifier" << std::endl;
+
+	bool success = true;
+
+	//a flat square can go down to two triangles without moving its surface or outline at all
+	{
+		const int QuadsPerSide = 64;
+		MeshData grid;
+		for (int i = 0; i <= QuadsPerSide; i++)
+		{
+			for (int j = 0; j <= QuadsPerSide; j++)
+			{
+				float u = static_cast<float>(i) / QuadsPerSide;
+				float v = static_cast<float>(j) / QuadsPerSide;
+				grid.vertices.push_back(Vertex({ u, 0.0f, v }, { 0.0f, 1.0f, 0.0f }, { u, v }));
+			}
+		}
+		for (int i = 0; i < QuadsPerSide; i++)
+		{
+			for (int j = 0; j < QuadsPerSide; j++)
+			{
+				uint32_t a = i * (QuadsPerSide + 1) + j;
+				uint32_t b = a + 1;
+				uint32_t c = a + QuadsPerSide + 1;
+				uint32_t d = c + 1;
+				grid.indices.insert(grid.indices.end(), { a, c, b, b, c, d });
+			}
+		}
+
+		std::vector<uint32_t> result;
+		std::vector<uint32_t> resultRegions;
+		size_t targetIndexCount = grid.indices.size() / 50;
+		float error = MeshSimplifier::Simplify(grid.vertices, grid.indices, {}, targetIndexCount, 1e-6f, result, resultRegions);
+
+		double area = 0.0;
+		for (size_t i = 0; i + 2 < result.size(); i += 3)
+		{
+			const float* a = grid.vertices[result[i]].pos;
+			const float* b = grid.vertices[result[i + 1]].pos;
+			const float* c = grid.vertices[result[i + 2]].pos;
+			//signed, a folded over triangle would take area away
+			area += 0.5 * ((static_cast<double>(c[0]) - a[0]) * (static_cast<double>(b[2]) - a[2]) - (static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[2]) - a[2]));
+		}
+
+		std::cout << "  flat grid: " << grid.indices.size() / 3 << " -> " << result.size() / 3 << " triangles (target " << targetIndexCount / 3 << "), error " << error << ", area " << area;
+		if ((result.size() > targetIndexCount) || (error > 1e-6f) || (fabs(fabs(area) - 1.0) > 1e-5))
+		{
+			std::cout << " FAILED";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+		MeshOptimizer::Optimize(mesh);
+		size_t baseIndexCount = mesh.indices.size();
+
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		MeshSimplifier::BuildLODs(mesh, levelCount);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "  " << OBJFilepath << ": " << mesh.lods.size() << " levels in " << elapsed.count() * 1000.0 << " ms, " << TriangleCount(mesh.submeshes) << " triangles" << std::endl;
+
+		//every level must be clearly smaller than the one before, stay inside the index buffer and keep the surface within its reported error
+		std::vector<Submesh> previous = mesh.submeshes;
+		for (size_t level = 0; level < mesh.lods.size(); level++)
+		{
+			const MeshLOD& lod = mesh.lods[level];
+			bool valid = (lod.submeshes.size() == mesh.submeshes.size()) && (TriangleCount(lod.submeshes) <= TriangleCount(previous) * 9 / 10);
+			for (const Submesh& submesh : lod.submeshes)
+			{
+				valid &= (submesh.Start >= static_cast<int>(baseIndexCount)) && (submesh.Start + submesh.size <= static_cast<int>(mesh.indices.size())) && (submesh.size % 3 == 0);
+			}
+
+			double deviation = SurfaceDeviation(mesh, lod.submeshes, 2000) / mesh.bounds.radius;
+			valid &= (deviation <= lod.error * 2.0 + 1e-6);
+
+			std::cout << "    level " << level + 1 << ": " << TriangleCount(lod.submeshes) << " triangles, error " << lod.error << ", measured " << deviation;
+			if (!valid)
+			{
+				std::cout << " FAILED";
+				success = false;
+			}
+			std::cout << std::endl;
+
+			previous = lod.submeshes;
+		}
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckMeshBounds(const std::vector<std::string>& OBJFilepaths)
+{
+	std::cout << "Mesh bounds" << std::endl;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		//moved away from the origin, where a sphere around the origin gets much looser than one around the mesh
+		for (Vertex& vertex : mesh.vertices)
+		{
+			vertex.pos[0] += 10.0f;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		Bounds bounds = MeshBounds::Compute(mesh.vertices);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		double originRadius = 0.0;
+		bool contained = true;
+		for (const Vertex& vertex : mesh.vertices)
+		{
+			double distance = 0.0;
+			double originDistance = 0.0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				double offset = static_cast<double>(vertex.pos[axis]) - bounds.center[axis];
+				distance += offset * offset;
+				originDistance += static_cast<double>(vertex.pos[axis]) * vertex.pos[axis];
+
+				contained &= (vertex.pos[axis] >= bounds.min[axis]) && (vertex.pos[axis] <= bounds.max[axis]);
+			}
+			originRadius = std::max(originRadius, sqrt(originDistance));
+			contained &= (sqrt(distance) <= bounds.radius);
+		}
+
+		double halfDiagonal = 0.0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			halfDiagonal += pow(0.5 * (static_cast<double>(bounds.max[axis]) - bounds.min[axis]), 2.0);
+		}
+		halfDiagonal = sqrt(halfDiagonal);
+
+		std::cout << "  " << OBJFilepath << ": radius " << bounds.radius << " (around the origin " << originRadius << ", around the box " << halfDiagonal << ") in " << elapsed.count() << " ms";
+		if (!contained || (bounds.radius > halfDiagonal * (1.0 + 1e-4)))
+		{
+			std::cout << " NOT CONTAINED";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkClusterCulling(const std::vector<std::string>& OBJFilepaths, int viewCount)
+{
+	std::cout << "Cluster culling, " << viewCount << " views around each mesh" << std::endl;
+
+	bool success = true;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+		MeshOptimizer::Optimize(mesh);
+
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		Meshlets::Build(mesh);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		size_t totalTriangles = mesh.indices.size() / 3;
+		std::cout << "  " << OBJFilepath << ": " << mesh.meshlets.size() << " meshlets in " << elapsed.count() * 1000.0 << " ms, " << totalTriangles << " triangles" << std::endl;
+
+		//the whole mesh in view from all around, then from close by so part of it leaves the frustum, then the orthographic shadow case
+		struct Setup
+		{
+			const char* name;
+			float distance;
+			bool perspective;
+		};
+		const Setup setups[] = { { "perspective", 3.0f, true }, { "perspective close", 1.2f, true }, { "orthographic", 3.0f, false } };
+
+		for (const Setup& setup : setups)
+		{
+			size_t submitted = 0;
+			size_t drawCalls = 0;
+			size_t missed = 0;
+			for (int i = 0; i < viewCount; i++)
+			{
+				float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(viewCount);
+				float position[3] = { cosf(angle) * setup.distance * mesh.bounds.radius, 0.3f * setup.distance * mesh.bounds.radius, sinf(angle) * setup.distance * mesh.bounds.radius };
+
+				float halfExtent = setup.perspective ? tanf(0.5f * 45.0f * 3.14159265f / 180.0f) : mesh.bounds.radius;
+				Meshlets::CullView view = LookAtOrigin(position, setup.perspective, halfExtent, 16.0f / 9.0f, 0.1f, 10.0f * setup.distance * mesh.bounds.radius);
+
+				size_t viewDrawCalls = 0;
+				size_t viewMissed = 0;
+				submitted += SubmittedTriangles(mesh, view, viewDrawCalls, viewMissed);
+				drawCalls += viewDrawCalls;
+				missed += viewMissed;
+			}
+
+			double share = static_cast<double>(submitted) / static_cast<double>(totalTriangles * viewCount);
+			std::cout << "    " << setup.name << ": " << submitted / viewCount << " of " << totalTriangles << " triangles submitted per view (" << share * 100.0 << "%) in " << drawCalls / viewCount << " draw calls";
+			if (missed > 0)
+			{
+				std::cout << " CULLED " << missed << " VISIBLE TRIANGLES";
+				success = false;
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkInstancing(const std::vector<std::string>& OBJFilepaths, int objectCount)
+{
+	std::cout << "Instancing, " << objectCount << " objects" << std::endl;
+
+	std::vector<MeshData> meshes(OBJFilepaths.size());
+	for (size_t i = 0; i < OBJFilepaths.size(); i++)
+	{
+		if (!OBJReader::Read(OBJFilepaths[i], meshes[i], OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepaths[i] << std::endl;
+			return false;
+		}
+		MeshOptimizer::Optimize(meshes[i]);
+		MeshSimplifier::BuildLODs(meshes[i], 4);
+	}
+
+	auto drawnSubmeshes = [](const std::vector<Submesh>& submeshes)
+	{
+		size_t count = 0;
+		for (const Submesh& submesh : submeshes)
+		{
+			count += (submesh.size > 0) ? 1 : 0;
+		}
+		return count;
+	};
+
+	//objects on a square field around the camera, meshes alternate and the level grows by one every few rings
+	struct Placed
+	{
+		const MeshData* mesh;
+		const std::vector<Submesh>* submeshes;
+	};
+	std::vector<Placed> objects;
+	int side = static_cast<int>(ceil(sqrt(static_cast<double>(objectCount))));
+	for (int i = 0; i < objectCount; i++)
+	{
+		const MeshData& mesh = meshes[i % meshes.size()];
+		int ring = std::max(abs(i % side - side / 2), abs(i / side - side / 2));
+		size_t level = std::min(static_cast<size_t>(ring / 4), mesh.lods.size());
+		objects.push_back({ &mesh, (level == 0) ? &mesh.submeshes : &mesh.lods[level - 1].submeshes });
+	}
+
+	size_t separateDrawCalls = 0;
+	for (const Placed& object : objects)
+	{
+		separateDrawCalls += drawnSubmeshes(*object.submeshes);
+	}
+
+	//grouped like a frame would be, the last frame's groups are reused
+	const int frames = 100;
+	Instancing::Groups<MeshData, size_t> groups;
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		groups.Clear();
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			groups.Add(objects[i].mesh, objects[i].submeshes, i);
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	bool success = true;
+	size_t instancedDrawCalls = 0;
+	std::vector<int> seen(objects.size(), 0);
+	for (size_t i = 0; i < groups.Size(); i++)
+	{
+		for (size_t object : groups[i].items)
+		{
+			seen[object]++;
+			if ((objects[object].mesh != groups[i].mesh) || (objects[object].submeshes != groups[i].submeshes))
+			{
+				std::cerr << "  object " << object << " is in a group of another mesh or level" << std::endl;
+				success = false;
+			}
+		}
+
+		size_t perInstance = drawnSubmeshes(*groups[i].submeshes);
+		instancedDrawCalls += (groups[i].items.size() < Instancing::MinimumInstances) ? perInstance * groups[i].items.size() : perInstance;
+	}
+
+	if (std::count(seen.begin(), seen.end(), 1) != static_cast<long>(seen.size()))
+	{
+		std::cerr << "  not every object is in exactly one group" << std::endl;
+		success = false;
+	}
+
+	std::cout << "  " << groups.Size() << " groups, " << separateDrawCalls << " draw calls one by one, " << instancedDrawCalls << " instanced, grouping took "
+		<< elapsed.count() * 1000.0 / frames << " ms per frame" << std::endl;
+
+	return success;
+}
+
+bool Diagnostics::CheckMipChain()
+{
+	std::cout << "Mip chains" << std::endl;
+
+	bool success = true;
+
+	//white and black texels with alternating alpha average to half the light, which is well above half of 255 in sRGB
+	{
+		const uint8_t checker[16] = { 255, 255, 255, 255, 0, 0, 0, 0, 0, 0, 0, 0, 255, 255, 255, 255 };
+		std::vector<MipChain::Level> levels;
+		MipChain::Build(checker, 2, 2, 4, levels);
+
+		uint8_t grey = MipChain::LinearToSRGB(0.5f);
+		bool correct = (levels.size() == 1) && (levels[0].pixels[0] == grey) && (levels[0].pixels[1] == grey) && (levels[0].pixels[2] == grey) && (levels[0].pixels[3] == 128);
+		std::cout << "  checkerboard: " << static_cast<int>(levels.empty() ? 0 : levels[0].pixels[0]) << ", expected " << static_cast<int>(grey);
+		if (!correct)
+		{
+			std::cout << " WRONG";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	std::mt19937 random(7);
+	const int sizes[][2] = { { 1, 1 }, { 7, 5 }, { 33, 1 }, { 64, 64 }, { 255, 129 } };
+	for (const int* size : sizes)
+	{
+		for (int channels : { 1, 2, 4 })
+		{
+			std::vector<uint8_t> pixels(static_cast<size_t>(size[0]) * size[1] * channels);
+			for (uint8_t& value : pixels)
+			{
+				value = static_cast<uint8_t>(random() & 255);
+			}
+
+			std::vector<MipChain::Level> levels;
+			MipChain::Build(pixels.data(), size[0], size[1], channels, levels);
+
+			bool correct = (static_cast<int>(levels.size()) == MipChain::LevelCount(size[0], size[1]) - 1);
+			int largest = 0;
+
+			const uint8_t* source = pixels.data();
+			int sourceWidth = size[0];
+			int sourceHeight = size[1];
+			for (const MipChain::Level& level : levels)
+			{
+				correct &= (level.width == std::max(1, sourceWidth / 2)) && (level.height == std::max(1, sourceHeight / 2));
+				if (!correct)
+				{
+					break;
+				}
+
+				largest = std::max(largest, CompareMipLevel(source, sourceWidth, sourceHeight, channels, level));
+				source = level.pixels.data();
+				sourceWidth = level.width;
+				sourceHeight = level.height;
+			}
+
+			if (!correct || (largest > 1))
+			{
+				std::cout << "  " << size[0] << "x" << size[1] << " with " << channels << " channels: " << levels.size() << " levels, off by up to " << largest << " WRONG" << std::endl;
+				success = false;
+			}
+		}
+	}
+
+	std::vector<uint8_t> large(4096 * 4096 * 4);
+	for (uint8_t& value : large)
+	{
+		value = static_cast<uint8_t>(random() & 255);
+	}
+
+	std::vector<MipChain::Level> levels;
+	auto start = std::chrono::steady_clock::now();
+	MipChain::Build(large.data(), 4096, 4096, 4, levels);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "  4096x4096 RGBA: " << levels.size() << " levels in " << elapsed.count() << " ms, " << ThreadPool::Shared().ThreadCount() + 1 << " threads" << std::endl;
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkBlockCompression()
+{
+	const int size = 1024;
+	std::cout << "Block compression, " << size << "x" << size << ", " << ThreadPool::Shared().ThreadCount() + 1 << " threads" << std::endl;
+
+	std::mt19937 random(11);
+	std::vector<uint8_t> color = SyntheticImage(size, 4, false, false, random);
+	std::vector<uint8_t> colorAlpha = SyntheticImage(size, 4, false, true, random);
+	std::vector<uint8_t> grey = SyntheticImage(size, 4, true, false, random);
+	std::vector<uint8_t> twoChannel = SyntheticImage(size, 2, false, false, random);
+
+	struct Case
+	{
+		const char* name;
+		const std::vector<uint8_t>* pixels;
+		int channels;
+		BlockCompression::Format format;
+		int comparedChannels;
+		double minimumPSNR;
+	};
+	const Case cases[] =
+	{
+		{ "BC1 colour", &color, 4, BlockCompression::Format::BC1, 3, 32.0 },
+		{ "BC7 colour", &color, 4, BlockCompression::Format::BC7, 3, 36.0 },
+		{ "BC7 colour and alpha", &colorAlpha, 4, BlockCompression::Format::BC7, 4, 36.0 },
+		{ "BC4 grey", &grey, 4, BlockCompression::Format::BC4, 1, 38.0 },
+		{ "BC5 two channel", &twoChannel, 2, BlockCompression::Format::BC5, 2, 38.0 }
+	};
+
+	bool success = true;
+	for (const Case& test : cases)
+	{
+		std::vector<uint8_t> blocks;
+		auto start = std::chrono::steady_clock::now();
+		BlockCompression::Encode(test.pixels->data(), size, size, test.channels, test.format, blocks);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::vector<uint8_t> decoded;
+		BlockCompression::Decode(blocks.data(), size, size, test.format, decoded);
+		double quality = PSNR(*test.pixels, test.channels, decoded, test.comparedChannels);
+
+		std::cout << "  " << test.name << ": " << quality << " dB, " << (static_cast<double>(size) * size / 1e6) / elapsed.count() << " MTexels/s, "
+			<< static_cast<double>(test.pixels->size()) / blocks.size() << ":1";
+		if (quality < test.minimumPSNR)
+		{
+			std::cout << " BELOW " << test.minimumPSNR << " dB";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	BlockCompression::Format chosen[4];
+	bool choices = BlockCompression::Choose(color.data(), size, size, 4, chosen[0]) && BlockCompression::Choose(colorAlpha.data(), size, size, 4, chosen[1]) &&
+		BlockCompression::Choose(grey.data(), size, size, 4, chosen[2]) && BlockCompression::Choose(twoChannel.data(), size, size, 2, chosen[3]) &&
+		!BlockCompression::Choose(color.data(), size - 2, size, 4, chosen[0]);
+	choices &= (chosen[0] == BlockCompression::Format::BC1) && (chosen[1] == BlockCompression::Format::BC7) && (chosen[2] == BlockCompression::Format::BC4) && (chosen[3] == BlockCompression::Format::BC5);
+	if (!choices)
+	{
+		std::cout << "  WRONG FORMAT CHOSEN" << std::endl;
+		success = false;
+	}
+
+	return success;
+}
+
+bool Diagnostics::BenchmarkTextureCooking(const std::vector<std::string>& texturePaths)
+{
+	std::cout << "Cooked textures, " << ThreadPool::Shared().ThreadCount() + 1 << " threads" << std::endl;
+
+	std::vector<std::string> outputs;
+	for (const std::string& texturePath : texturePaths)
+	{
+		outputs.push_back(TextureCache::CookedPath(texturePath));
+	}
+	std::vector<std::string> moved = SetAside(outputs);
+
+	bool success = true;
+	for (const std::string& texturePath : texturePaths)
+	{
+		for (bool compress : { false, true })
+		{
+			std::string cookedFilepath = TextureCache::CookedPath(texturePath);
+			std::remove(cookedFilepath.c_str());
+
+			TextureCache::CookedTexture cooked;
+			auto start = std::chrono::steady_clock::now();
+			bool loaded = TextureCache::Load(texturePath, compress, cooked);
+			std::chrono::duration<double, std::milli> cookTime = std::chrono::steady_clock::now() - start;
+
+			TextureCache::CookedTexture read;
+			start = std::chrono::steady_clock::now();
+			loaded &= TextureCache::Read(cookedFilepath, texturePath, compress, read);
+			std::chrono::duration<double, std::milli> readTime = std::chrono::steady_clock::now() - start;
+
+			//the device reads every byte of the mapped levels, touch them the same way so the comparison includes the I/O
+			bool matches = loaded && (read.format == cooked.format) && (read.levels.size() == cooked.levels.size());
+			for (size_t i = 0; matches && (i < read.levels.size()); i++)
+			{
+				matches &= (read.levels[i].width == cooked.levels[i].width) && (read.levels[i].height == cooked.levels[i].height) &&
+					(read.levels[i].rowPitch == cooked.levels[i].rowPitch) && (memcmp(read.LevelData(i), cooked.LevelData(i), read.levels[i].bytes) == 0);
+			}
+			std::chrono::duration<double, std::milli> compareTime = std::chrono::steady_clock::now() - start;
+
+			std::cout << "  " << texturePath << (compress ? " compressed" : "") << ": ";
+			if (!matches)
+			{
+				std::cout << "COOKED FILE DOES NOT MATCH" << std::endl;
+				success = false;
+			}
+			else
+			{
+				std::cout << "format " << static_cast<uint32_t>(cooked.format) << ", " << cooked.levels.size() << " levels, cooked in " << cookTime.count() << " ms, mapped in "
+					<< readTime.count() << " ms, " << compareTime.count() << " ms with every level read" << std::endl;
+			}
+
+			std::remove(cookedFilepath.c_str());
+		}
+	}
+
+	//a cooked file of an older source must not be used
+	const std::string texturePath = texturePaths.front();
+	std::string cookedFilepath = TextureCache::CookedPath(texturePath);
+	TextureCache::CookedTexture stale;
+	bool rejected = TextureCache::Load(texturePath, false, stale);
+
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(texturePath, error);
+	std::filesystem::last_write_time(texturePath, writeTime + std::chrono::seconds(1), error);
+	rejected &= !error && !TextureCache::Read(cookedFilepath, texturePath, false, stale) && !TextureCache::Read(cookedFilepath + ".missing", texturePath, false, stale);
+	std::filesystem::last_write_time(texturePath, writeTime, error);
+	rejected &= !TextureCache::Read(cookedFilepath, texturePath, true, stale);
+	std::remove(cookedFilepath.c_str());
+
+	if (!rejected)
+	{
+		std::cout << "  STALE COOKED FILE USED" << std::endl;
+		success = false;
+	}
+
+	Restore(outputs, moved);
+	return success;
+}
+
+bool Diagnostics::CheckMaterialPacking(const std::vector<std::string>& OBJFilepaths, int objectCount)
+{
+	std::cout << "Material table" << std::endl;
+
+	bool success = true;
+
+	//materials with a colour, a grey and an alpha map each, the grey maps are half size
+	const int materialCount = 40;
+	const MaterialPacking::TextureKey colour = { 71, 1024, 1024, 11 };
+	const MaterialPacking::TextureKey grey = { 80, 512, 512, 10 };
+	const MaterialPacking::TextureKey alpha = { 98, 1024, 1024, 11 };
+
+	std::vector<MaterialPacking::TextureKey> keys;
+	for (int i = 0; i < materialCount; i++)
+	{
+		keys.push_back(colour);
+		keys.push_back(grey);
+		keys.push_back(alpha);
+	}
+
+	MaterialPacking::Layout layout = MaterialPacking::Pack(keys);
+	bool packed = (layout.arrays.size() == 3);
+	for (size_t i = 0; packed && (i < keys.size()); i++)
+	{
+		packed &= (layout.slots[i].array == static_cast<int>(i % 3)) && (layout.slots[i].slice == static_cast<int>(i / 3));
+	}
+
+	//one key more than there are slots, and one array more than the slice limit
+	std::vector<MaterialPacking::TextureKey> distinct;
+	for (int i = 0; i <= MaterialPacking::ArraySlots; i++)
+	{
+		distinct.push_back({ 71, 64 << (i % 4), 64, i + 1 });
+	}
+	MaterialPacking::Layout overflow = MaterialPacking::Pack(distinct);
+	packed &= (overflow.arrays.size() == MaterialPacking::ArraySlots) && (overflow.slots[MaterialPacking::ArraySlots - 1].array == MaterialPacking::ArraySlots - 1) &&
+		(overflow.slots[MaterialPacking::ArraySlots].array == -1);
+
+	MaterialPacking::Layout split = MaterialPacking::Pack(std::vector<MaterialPacking::TextureKey>(MaterialPacking::MaxSlices + 1, colour));
+	packed &= (split.arrays.size() == 2) && (split.arraySizes[0] == MaterialPacking::MaxSlices) && (split.slots.back().array == 1) && (split.slots.back().slice == 0);
+
+	//the same materials arriving one per frame, the way MaterialTable::Update appends them, have to end in the same slots and only
+	//recreate the arrays when one runs out of reserved slices
+	MaterialPacking::Layout appended;
+	std::vector<int> reserved;
+	int recreated = 0;
+	for (int i = 0; i < materialCount; i++)
+	{
+		bool outgrown = false;
+		for (int map = 0; map < 3; map++)
+		{
+			MaterialPacking::Slot slot = MaterialPacking::Append(appended, keys[i * 3 + map]);
+			packed &= (slot.array == layout.slots[i * 3 + map].array) && (slot.slice == layout.slots[i * 3 + map].slice);
+			outgrown |= (slot.array >= 0) && ((slot.array >= static_cast<int>(reserved.size())) || (slot.slice >= reserved[slot.array]));
+		}
+
+		if (outgrown)
+		{
+			reserved.clear();
+			for (int size : appended.arraySizes)
+			{
+				reserved.push_back(MaterialPacking::Reserve(size));
+			}
+			recreated++;
+		}
+	}
+	packed &= (recreated < materialCount / 4);
+
+	std::cout << "  " << keys.size() << " maps of " << materialCount << " materials in " << layout.arrays.size() << " arrays, recreated " << recreated << " times while adding them one by one";
+	if (!packed)
+	{
+		std::cout << " WRONG PACKING";
+		success = false;
+	}
+	std::cout << std::endl;
+
+	//material changes of a frame the way STDOBJ::Render walks its submeshes, each object starts without a material
+	std::vector<MeshData> meshes(OBJFilepaths.size());
+	for (size_t i = 0; i < OBJFilepaths.size(); i++)
+	{
+		if (!OBJReader::Read(OBJFilepaths[i], meshes[i], OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepaths[i] << std::endl;
+			return false;
+		}
+	}
+
+	size_t changes = 0;
+	for (int i = 0; i < objectCount; i++)
+	{
+		const MeshData& mesh = meshes[i % meshes.size()];
+		const std::string* previous = nullptr;
+		for (const std::string& material : mesh.submeshMaterials)
+		{
+			changes += ((previous == nullptr) || (*previous != material)) ? 1 : 0;
+			previous = &material;
+		}
+	}
+
+	//the table is bound once and stays bound while only the row index changes
+	std::cout << "  " << objectCount << " objects: " << changes << " material changes, " << changes << " binds one by one, 1 with the table" << std::endl;
+
+	return success;
+}
+
+bool Diagnostics::CheckMeshCodec(const std::vector<std::string>& OBJFilepaths, int fuzzIterations)
+{
+	std::cout << "Mesh codec, " << (MeshCodec::SIMDAvailable() ? "SSSE3" : "scalar only") << std::endl;
+
+	bool success = true;
+	std::mt19937 random(19);
+
+	//random buffers of every kind the encoder picks a different group width for, and broken copies of their encodings
+	size_t broken = 0;
+	for (int iteration = 0; iteration < fuzzIterations; iteration++)
+	{
+		size_t vertexSize = (iteration % 16 == 15) ? MeshCodec::MaxVertexSize : 4 * (1 + random() % 16);
+		size_t vertexCount = random() % 1200;
+		int pattern = iteration % 4;
+
+		std::vector<uint8_t> vertices(vertexCount * vertexSize);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			size_t vertex = i / vertexSize;
+			switch (pattern)
+			{
+			case 0: vertices[i] = 0; break;
+			case 1: vertices[i] = static_cast<uint8_t>(vertex * (i % vertexSize) / 8 + random() % 3); break;
+			case 2: vertices[i] = static_cast<uint8_t>(vertex + random() % 24); break;
+			default: vertices[i] = static_cast<uint8_t>(random()); break;
+			}
+		}
+
+		size_t indexCount = random() % 5000;
+		std::vector<uint32_t> indices(indexCount);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			switch (pattern)
+			{
+			case 0: indices[i] = static_cast<uint32_t>(i / 3 + i % 3); break;
+			case 1: indices[i] = static_cast<uint32_t>(random() % 300); break;
+			case 2: indices[i] = static_cast<uint32_t>(random() % 70000); break;
+			default: indices[i] = static_cast<uint32_t>(random()); break;
+			}
+		}
+
+		std::vector<uint8_t> encodedVertices;
+		std::vector<uint8_t> encodedIndices;
+		MeshCodec::EncodeVertices(vertices.data(), vertexCount, vertexSize, encodedVertices);
+		MeshCodec::EncodeIndices(indices.data(), indexCount, encodedIndices);
+
+		for (bool SIMD : { false, true })
+		{
+			std::vector<uint8_t> decodedVertices(vertices.size());
+			std::vector<uint32_t> decodedIndices(indexCount);
+			if (!MeshCodec::DecodeVertices(decodedVertices.data(), vertexCount, vertexSize, encodedVertices.data(), encodedVertices.size(), SIMD) || (decodedVertices != vertices) ||
+				!MeshCodec::DecodeIndices(decodedIndices.data(), indexCount, encodedIndices.data(), encodedIndices.size(), SIMD) || (decodedIndices != indices))
+			{
+				std::cout << "  round trip " << iteration << " (" << vertexCount << " vertices of " << vertexSize << " bytes, " << indexCount << " indices, " << (SIMD ? "SSSE3" : "scalar") << ") MISMATCH" << std::endl;
+				success = false;
+			}
+
+			//a cut stream always misses bytes the decoder needs, a changed byte only must not make it read or write out of bounds
+			std::vector<uint8_t> cut(encodedVertices.begin(), encodedVertices.begin() + random() % encodedVertices.size());
+			std::vector<uint8_t> cutIndices(encodedIndices.begin(), encodedIndices.begin() + random() % encodedIndices.size());
+			if (MeshCodec::DecodeVertices(decodedVertices.data(), vertexCount, vertexSize, cut.data(), cut.size(), SIMD) ||
+				MeshCodec::DecodeIndices(decodedIndices.data(), indexCount, cutIndices.data(), cutIndices.size(), SIMD))
+			{
+				std::cout << "  truncated stream " << iteration << " decoded" << std::endl;
+				success = false;
+			}
+
+			std::vector<uint8_t> flipped = encodedVertices;
+			std::vector<uint8_t> flippedIndices = encodedIndices;
+			for (int flip = 0; flip < 4; flip++)
+			{
+				flipped[random() % flipped.size()] ^= static_cast<uint8_t>(1 + random() % 255);
+				flippedIndices[random() % flippedIndices.size()] ^= static_cast<uint8_t>(1 + random() % 255);
+			}
+			broken += !MeshCodec::DecodeVertices(decodedVertices.data(), vertexCount, vertexSize, flipped.data(), flipped.size(), SIMD);
+			broken += !MeshCodec::DecodeIndices(decodedIndices.data(), indexCount, flippedIndices.data(), flippedIndices.size(), SIMD);
+		}
+	}
+	std::cout << "  " << fuzzIterations << " random buffers round tripped, " << broken << " of " << fuzzIterations * 4 << " damaged streams rejected" << std::endl;
+
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		//optimized, the order a cache holds its vertices and indices in
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+		MeshOptimizer::Optimize(mesh);
+
+		size_t vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+		size_t indexBytes = mesh.indices.size() * sizeof(uint32_t);
+
+		std::vector<uint8_t> encodedVertices;
+		std::vector<uint8_t> encodedIndices;
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		MeshCodec::EncodeVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), encodedVertices);
+		MeshCodec::EncodeIndices(mesh.indices.data(), mesh.indices.size(), encodedIndices);
+		std::chrono::duration<double> encodeTime = std::chrono::steady_clock::now() - start;
+
+		//best of a few runs, in GB of decoded data per second
+		double throughput[2] = { 0.0, 0.0 };
+		for (bool SIMD : { false, true })
+		{
+			std::vector<Vertex> vertices(mesh.vertices.size());
+			std::vector<uint32_t> indices(mesh.indices.size());
+			for (int repeat = 0; repeat < 5; repeat++)
+			{
+				start = std::chrono::steady_clock::now();
+				bool decoded = MeshCodec::DecodeVertices(vertices.data(), vertices.size(), sizeof(Vertex), encodedVertices.data(), encodedVertices.size(), SIMD) &&
+					MeshCodec::DecodeIndices(indices.data(), indices.size(), encodedIndices.data(), encodedIndices.size(), SIMD);
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+				throughput[SIMD] = std::max(throughput[SIMD], (vertexBytes + indexBytes) / std::max(elapsed.count(), 1e-9) / 1e9);
+				if (!decoded || (memcmp(vertices.data(), mesh.vertices.data(), vertexBytes) != 0) || (indices != mesh.indices))
+				{
+					std::cout << "  " << OBJFilepath << (SIMD ? " SSSE3" : " scalar") << " MISMATCH" << std::endl;
+					success = false;
+					break;
+				}
+			}
+		}
+
+		//and through a compressed cache, to a file of its own so the real cache is left alone
+		std::string cacheFilepath = OBJFilepath + ".compressed.stdmesh";
+		MeshCache::CachedMesh cached;
+		bool cacheMatches = MeshCache::Write(cacheFilepath, OBJFilepath, mesh, 0, true) && MeshCache::Read(cacheFilepath, OBJFilepath, 0, cached) &&
+			(cached.vertexCount == mesh.vertices.size()) && (cached.indexCount == mesh.indices.size()) &&
+			(memcmp(cached.vertices, mesh.vertices.data(), vertexBytes) == 0) && std::equal(mesh.indices.begin(), mesh.indices.end(), cached.indices);
+		size_t cacheBytes = cached.file.Size();
+		cached.file.Close();
+		std::remove(cacheFilepath.c_str());
+
+		std::error_code error;
+		size_t sourceBytes = static_cast<size_t>(std::filesystem::file_size(OBJFilepath, error));
+
+		std::cout << "  " << OBJFilepath << ": " << (vertexBytes + indexBytes) / 1024 << " KB -> " << (encodedVertices.size() + encodedIndices.size()) / 1024 << " KB (vertices "
+			<< (encodedVertices.empty() ? 0.0 : static_cast<double>(vertexBytes) / encodedVertices.size()) << ":1, indices " << (encodedIndices.empty() ? 0.0 : static_cast<double>(indexBytes) / encodedIndices.size())
+			<< ":1), source " << sourceBytes / 1024 << " KB, cache " << cacheBytes / 1024 << " KB, encoded in " << encodeTime.count() * 1000.0 << " ms, decoded at "
+			<< throughput[0] << " GB/s scalar, " << throughput[1] << " GB/s SSSE3";
+		if (!cacheMatches)
+		{
+			std::cout << " CACHE MISMATCH";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckAssetPack(const std::vector<std::string>& assetPaths, int repeats)
+{
+	const std::string packFilepath = "diagnostics.stpack";
+	std::cout << "Asset pack, " << assetPaths.size() << " assets" << std::endl;
+
+	std::vector<std::string> outputs;
+	for (const std::string& assetPath : assetPaths)
+	{
+		std::string extension = std::filesystem::path(assetPath).extension().string();
+		if (extension == ".obj")
+		{
+			outputs.push_back(MeshCache::CachePath(assetPath, 0));
+		}
+		else if (extension == ".png")
+		{
+			outputs.push_back(TextureCache::CookedPath(assetPath));
+		}
+	}
+	std::vector<std::string> moved = SetAside(outputs);
+
+	//the caches are packed next to their sources, like a cooked build would ship them
+	std::vector<AssetPack::Source> sources;
+	std::vector<std::string> caches;
+	for (const std::string& assetPath : assetPaths)
+	{
+		std::string extension = std::filesystem::path(assetPath).extension().string();
+		sources.push_back({ assetPath, extension != ".obj" });
+
+		if (extension == ".obj")
+		{
+			MeshData mesh;
+			if (OBJReader::Read(assetPath, mesh) && MeshCache::Write(MeshCache::CachePath(assetPath, 0), assetPath, mesh, 0))
+			{
+				caches.push_back(MeshCache::CachePath(assetPath, 0));
+			}
+		}
+		else if (extension == ".png")
+		{
+			TextureCache::CookedTexture cooked;
+			if (TextureCache::Cook(assetPath, false, cooked) && TextureCache::Write(TextureCache::CookedPath(assetPath), assetPath, false, cooked))
+			{
+				caches.push_back(TextureCache::CookedPath(assetPath));
+			}
+		}
+	}
+	//cooked textures stay stored so their levels are still handed to the device straight out of the mapping
+	for (const std::string& cache : caches)
+	{
+		sources.push_back({ cache, std::filesystem::path(cache).extension() != ".stdtex" });
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	bool success = AssetPack::Build(packFilepath, sources);
+	std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+
+	std::error_code error;
+	size_t packBytes = static_cast<size_t>(std::filesystem::file_size(packFilepath, error));
+
+	start = std::chrono::steady_clock::now();
+	success &= AssetPack::Mount(packFilepath);
+	std::chrono::duration<double, std::milli> mountTime = std::chrono::steady_clock::now() - start;
+
+	std::vector<AssetPack::EntryInfo> entries = AssetPack::Entries();
+	success &= entries.size() == sources.size();
+
+	//every entry reads back as its loose file, stored ones as an aligned span of the pack
+	size_t looseBytes = 0;
+	size_t compressedEntries = 0;
+	for (const AssetPack::EntryInfo& entry : entries)
+	{
+		Asset packed;
+		MappedFile loose;
+		bool matches = AssetPack::Open(entry.path, packed) && loose.Open(entry.path) && (packed.Size() == loose.Size()) && (memcmp(packed.Data(), loose.Data(), loose.Size()) == 0);
+		matches &= entry.compressed || (reinterpret_cast<uintptr_t>(packed.Data()) % 64 == 0);
+		if (!matches)
+		{
+			std::cout << "  " << entry.path << " DOES NOT MATCH ITS LOOSE FILE" << std::endl;
+			success = false;
+		}
+		looseBytes += loose.Size();
+		compressedEntries += entry.compressed ? 1 : 0;
+	}
+
+	//whatever the pack does not have still comes from the loose file
+	Asset fallback;
+	bool fallbacks = !AssetPack::Open(sources.front().path + ".missing", fallback);
+	std::string unpacked = packFilepath + ".unpacked";
+	{
+		std::ofstream file(unpacked, std::ios::binary);
+		file << "loose";
+	}
+	fallbacks &= AssetPack::Open(unpacked, fallback) && (fallback.Size() == 5) && !AssetPack::Contains(unpacked) && AssetPack::Contains("./" + sources.front().path);
+	fallback.Close();
+	std::remove(unpacked.c_str());
+	if (!fallbacks)
+	{
+		std::cout << "  LOOSE FALLBACK FAILED" << std::endl;
+		success = false;
+	}
+
+	//every asset opened and read once, one by one from loose files and out of the one mapping of the pack
+	double looseTime = 1e30;
+	double packTime = 1e30;
+	uint64_t checksum[2] = { 0, 0 };
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		for (int packed = 0; packed < 2; packed++)
+		{
+			if (packed == 0)
+			{
+				AssetPack::Unmount();
+			}
+			else
+			{
+				AssetPack::Mount(packFilepath);
+			}
+
+			start = std::chrono::steady_clock::now();
+			uint64_t sum = 0;
+			for (const AssetPack::Source& source : sources)
+			{
+				Asset asset;
+				if (AssetPack::Open(source.path, asset))
+				{
+					sum += MeshCache::HashFile(asset.Data(), asset.Size());
+				}
+			}
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+			(packed ? packTime : looseTime) = std::min((packed ? packTime : looseTime), elapsed.count());
+			checksum[packed] = sum;
+		}
+	}
+	if (checksum[0] != checksum[1])
+	{
+		std::cout << "  LOOSE AND PACKED READS DIFFER" << std::endl;
+		success = false;
+	}
+
+	//the loaders find everything in the pack, the loose caches are gone and the caches still have to be used
+	for (const std::string& cache : caches)
+	{
+		std::remove(cache.c_str());
+	}
+	for (const std::string& assetPath : assetPaths)
+	{
+		std::string extension = std::filesystem::path(assetPath).extension().string();
+		bool loaded = true;
+		if (extension == ".obj")
+		{
+			MeshData packed;
+			MeshData packedStream;
+			MeshCache::CachedMesh cached;
+			loaded = OBJReader::Read(assetPath, packed) && OBJReader::Read(assetPath, packedStream, OBJ_IMPORT_STREAMING) &&
+				MeshCache::Read(MeshCache::CachePath(assetPath, 0), assetPath, 0, cached);
+
+			AssetPack::Unmount();
+			MeshData loose;
+			loaded = loaded && OBJReader::Read(assetPath, loose) && (packed.vertices.size() == loose.vertices.size()) && (packed.indices == loose.indices) &&
+				(memcmp(packed.vertices.data(), loose.vertices.data(), sizeof(Vertex) * loose.vertices.size()) == 0) && SameCorners(packedStream, loose) &&
+				(cached.vertexCount == loose.vertices.size()) && std::equal(loose.indices.begin(), loose.indices.end(), cached.indices);
+			AssetPack::Mount(packFilepath);
+		}
+		else if (extension == ".png")
+		{
+			TextureCache::CookedTexture cached;
+			TextureCache::CookedTexture cooked;
+			loaded = TextureCache::Read(TextureCache::CookedPath(assetPath), assetPath, false, cached) && TextureCache::Cook(assetPath, false, cooked) &&
+				(cached.levels.size() == cooked.levels.size());
+			for (size_t i = 0; loaded && (i < cooked.levels.size()); i++)
+			{
+				loaded &= (cached.levels[i].bytes == cooked.levels[i].bytes) && (memcmp(cached.LevelData(i), cooked.LevelData(i), cooked.levels[i].bytes) == 0);
+			}
+		}
+
+		if (!loaded)
+		{
+			std::cout << "  " << assetPath << " LOADED DIFFERENTLY FROM THE PACK" << std::endl;
+			success = false;
+		}
+	}
+
+	//damaged packs are rejected on mount or their entries fail to open, nothing may read out of bounds
+	size_t rejected = 0;
+	size_t damagedCount = 0;
+	{
+		MappedFile pack;
+		pack.Open(packFilepath);
+		std::vector<char> original(pack.Data(), pack.Data() + pack.Size());
+		pack.Close();
+
+		std::mt19937 random(20);
+		std::string damagedFilepath = packFilepath + ".damaged";
+		for (int iteration = 0; iteration < 200; iteration++, damagedCount++)
+		{
+			std::vector<char> damaged = original;
+			if (iteration % 4 == 0)
+			{
+				damaged.resize(random() % damaged.size());
+			}
+			else
+			{
+				//the table of contents half the time, else anywhere
+				size_t range = (iteration % 2 == 0) ? std::min<size_t>(damaged.size(), 4096) : damaged.size();
+				for (int flip = 0; flip < 4; flip++)
+				{
+					damaged[random() % range] ^= static_cast<char>(1 + random() % 255);
+				}
+			}
+
+			{
+				std::ofstream file(damagedFilepath, std::ios::binary | std::ios::trunc);
+				file.write(damaged.data(), damaged.size());
+			}
+
+			std::streambuf* errorBuffer = std::cerr.rdbuf(nullptr);
+			bool mounted = AssetPack::Mount(damagedFilepath);
+			std::cerr.rdbuf(errorBuffer);
+
+			size_t opened = 0;
+			for (size_t i = 0; mounted && (i < entries.size()); i++)
+			{
+				Asset asset;
+				if (AssetPack::Contains(entries[i].path) && AssetPack::Open(entries[i].path, asset))
+				{
+					MeshCache::HashFile(asset.Data(), asset.Size());
+					opened++;
+				}
+			}
+			rejected += (!mounted || (opened < entries.size())) ? 1 : 0;
+		}
+		AssetPack::Unmount();
+		std::remove(damagedFilepath.c_str());
+	}
+
+	std::cout << "  " << entries.size() << " entries, " << looseBytes / 1024 << " KB loose -> " << packBytes / 1024 << " KB packed (" << compressedEntries << " compressed), built in "
+		<< buildTime.count() << " ms, mounted in " << mountTime.count() << " ms" << std::endl;
+	std::cout << "  every asset opened and read: " << looseTime << " ms from " << sources.size() << " loose files, " << packTime << " ms from the pack" << std::endl;
+	std::cout << "  " << rejected << " of " << damagedCount << " damaged packs rejected or missing entries" << std::endl;
+
+	AssetPack::Unmount();
+	std::remove(packFilepath.c_str());
+	Restore(outputs, moved);
+	return success;
+}
+
+bool Diagnostics::CheckAssetCooker(const std::string& OBJFilepath)
+{
+	std::cout << "Asset cooker, " << ThreadPool::Shared().ThreadCount() + 1 << " threads" << std::endl;
+
+	//cooks copies of the assets, so whatever the user cooked next to the real ones is left alone
+	const std::string scratchDirectory = "diagnostics.cook";
+	std::error_code error;
+	std::filesystem::remove_all(scratchDirectory, error);
+
+	AssetCooker::Options options;
+	options.meshDirectory = scratchDirectory + "/OBJ";
+	options.textureDirectory = scratchDirectory + "/textures";
+	options.stateFilepath = scratchDirectory + "/assets.cookstate";
+	options.packFilepath = scratchDirectory + "/assets.stpack";
+	options.verbose = false;
+
+	bool success = true;
+	for (const std::string& directory : { std::string("OBJ"), std::string("textures") })
+	{
+		std::filesystem::create_directories(scratchDirectory + "/" + directory, error);
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+		{
+			std::string extension = entry.path().extension().string();
+			std::string copy = scratchDirectory + "/" + directory + "/" + entry.path().filename().string();
+			if (extension == ".mtl")
+			{
+				//the maps name textures relative to the working directory
+				std::ifstream library(entry.path());
+				std::ofstream copied(copy);
+				std::string line;
+				while (std::getline(library, line))
+				{
+					size_t map = line.find(" textures/");
+					copied << ((map != std::string::npos) ? line.substr(0, map + 1) + scratchDirectory + "/" + line.substr(map + 1) : line) << "\n";
+				}
+			}
+			else if ((extension == ".obj") || (extension == ".glb") || (extension == ".png"))
+			{
+				std::filesystem::copy_file(entry.path(), copy, std::filesystem::copy_options::overwrite_existing, error);
+				success &= !error;
+			}
+		}
+	}
+
+	//a copy to edit, loaded like the corner cubes so a cache of other flags can stand in for it
+	const std::string scratchFilepath = options.meshDirectory + "/cookerScratch.obj";
+	std::filesystem::copy_file(OBJFilepath, scratchFilepath, std::filesystem::copy_options::overwrite_existing, error);
+	success &= !error;
+
+	options.meshLoads.clear();
+	for (const AssetCooker::MeshLoad& load : AssetCooker::SceneMeshLoads())
+	{
+		options.meshLoads.push_back({ scratchDirectory + "/" + load.path, load.importFlags });
+	}
+	options.meshLoads.push_back({ scratchFilepath, SCENE_CORNER_CUBE_FLAGS });
+
+	auto buildFlagsOf = [](unsigned int importFlags)
+	{
+		return static_cast<uint32_t>(importFlags & (OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS | OBJ_IMPORT_COMPRESSED));
+	};
+	uint32_t buildFlags = buildFlagsOf(SCENE_CORNER_CUBE_FLAGS);
+
+	auto run = [&](const char* name, size_t expectedCooked, bool expectPack, size_t expectedRestamped)
+	{
+		AssetCooker::Report report;
+		bool ran = AssetCooker::Run(options, report);
+
+		std::cout << "  " << name << ": " << report.cooked << " cooked, " << report.upToDate << " up to date (" << report.restamped << " restamped), " << report.hashed << " files hashed"
+			<< (report.packBuilt ? ", pack rebuilt" : "") << " in " << report.seconds * 1000.0 << " ms";
+
+		bool expected = ran && (report.cooked == expectedCooked) && (report.packBuilt == expectPack) && (report.restamped == expectedRestamped) &&
+			(report.cooked + report.upToDate == report.meshes + report.textures);
+		if (!expected)
+		{
+			std::cout << " UNEXPECTED";
+			success = false;
+		}
+		std::cout << std::endl;
+		return report;
+	};
+
+	//the first run cooks everything, and the runtime has to accept every output as it is loaded
+	AssetCooker::Report cold;
+	AssetCooker::Run(options, cold);
+	std::cout << "  cold: " << cold.meshes << " mesh caches, " << cold.libraries << " material libraries, " << cold.textures << " textures, " << cold.missing << " missing, "
+		<< cold.cooked << " cooked in " << cold.seconds * 1000.0 << " ms" << std::endl;
+	success &= (cold.failed == 0) && (cold.cooked == cold.meshes + cold.textures) && cold.packBuilt;
+
+	size_t accepted = 0;
+	size_t outputs = 0;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(options.meshDirectory, error))
+	{
+		std::string path = entry.path().generic_string();
+		if (entry.path().extension() != ".obj")
+		{
+			continue;
+		}
+
+		//every set of flags the scene loads the mesh with, or the default ones
+		std::vector<unsigned int> importFlags;
+		for (const AssetCooker::MeshLoad& load : options.meshLoads)
+		{
+			if (load.path == path)
+			{
+				importFlags.push_back(load.importFlags);
+			}
+		}
+		if (importFlags.empty())
+		{
+			importFlags.push_back(options.meshFlags);
+		}
+
+		for (unsigned int flags : importFlags)
+		{
+			MeshCache::CachedMesh cached;
+			accepted += MeshCache::Read(MeshCache::CachePath(path, buildFlagsOf(flags)), path, buildFlagsOf(flags), cached) ? 1 : 0;
+			outputs++;
+		}
+	}
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(options.textureDirectory, error))
+	{
+		std::string path = entry.path().generic_string();
+		if (entry.path().extension() == ".png")
+		{
+			TextureCache::CookedTexture cooked;
+			accepted += (TextureCache::Read(TextureCache::CookedPath(path), path, true, cooked) || TextureCache::Read(TextureCache::CookedPath(path), path, false, cooked)) ? 1 : 0;
+			outputs++;
+		}
+	}
+	if (accepted != outputs)
+	{
+		std::cout << "  " << outputs - accepted << " COOKED OUTPUTS REJECTED BY THE RUNTIME" << std::endl;
+		success = false;
+	}
+
+	//nothing changed, nothing is hashed or cooked
+	AssetCooker::Report unchanged = run("unchanged", 0, false, 0);
+	success &= unchanged.hashed == 0;
+
+	//a new timestamp on the same content only rewrites the cache header
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(scratchFilepath, error);
+	std::filesystem::last_write_time(scratchFilepath, writeTime + std::chrono::seconds(5), error);
+	run("touched", 0, true, 1);
+
+	MeshCache::CachedMesh restamped;
+	if (!MeshCache::Read(MeshCache::CachePath(scratchFilepath, buildFlags), scratchFilepath, buildFlags, restamped))
+	{
+		std::cout << "  RESTAMPED CACHE REJECTED" << std::endl;
+		success = false;
+	}
+	restamped.file.Close();
+
+	//an edit cooks that mesh alone
+	{
+		std::ofstream scratch(scratchFilepath, std::ios::app);
+		scratch << "\n# edited\n";
+	}
+	run("edited", 1, true, 0);
+
+	//as does an output that went missing or was overwritten
+	std::remove(MeshCache::CachePath(scratchFilepath, buildFlags).c_str());
+	run("cache deleted", 1, false, 0);
+
+	MeshData plain;
+	OBJReader::Read(scratchFilepath, plain);
+	MeshCache::Write(MeshCache::CachePath(scratchFilepath, buildFlags), scratchFilepath, plain, 0);
+	run("cache of other flags", 1, false, 0);
+
+	std::filesystem::remove_all(scratchDirectory, error);
+	return success;
+}
+
+bool Diagnostics::CheckGLBImport(const std::vector<std::string>& OBJFilepaths, int repeats)
+{
+	std::cout << "GLB import, best of " << repeats << std::endl;
+
+	//written next to the models, the uri is relative to the file
+	const std::string texturePath = "textures/star.png";
+	const float noOffset[3] = { 0.0f, 0.0f, 0.0f };
+	const float offset[3] = { 10.0f, -2.0f, 0.5f };
+
+	struct Variant
+	{
+		const char* name;
+		GLBLayout layout;
+		bool shortIndices;
+		bool normals;
+		const float* offset;
+		bool viewedVertices;
+		bool viewedIndices;
+	};
+
+	bool success = true;
+	std::string damageFilepath;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		double parseSeconds = 0.0;
+		uint64_t parseHash = 0;
+
+		MeshData parsed;
+		if (!TimeImport(OBJFilepath, OBJ_IMPORT_PARALLEL, repeats, parseSeconds, parseHash) || !OBJReader::Read(OBJFilepath, parsed, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+
+		bool fitsShort = parsed.vertices.size() <= 65536;
+		Variant variants[] =
+		{
+			{ "interleaved", GLBLayout::Interleaved, false, true, noOffset, true, true },
+			{ "separate", GLBLayout::Separate, fitsShort, true, noOffset, false, true },
+			{ "per submesh", GLBLayout::PerSubmesh, fitsShort, true, offset, false, parsed.submeshes.size() == 1 },
+			{ "without normals", GLBLayout::Separate, false, false, noOffset, false, false }
+		};
+
+		std::cout << "  " << OBJFilepath << ": parse " << parseSeconds * 1000.0 << " ms";
+		for (const Variant& variant : variants)
+		{
+			std::string GLBFilepath = OBJFilepath + ".diagnostics.glb";
+			if (!WriteGLB(GLBFilepath, parsed, variant.layout, variant.shortIndices, variant.normals, variant.offset, "../" + texturePath))
+			{
+				std::cout << std::endl << "    failed to write " << GLBFilepath;
+				success = false;
+				continue;
+			}
+
+			double mapSeconds = 0.0;
+			GLBReader::MappedMesh mapped;
+			GLBReader::ReadStats stats;
+			for (int i = 0; i < repeats; i++)
+			{
+				std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+				if (!GLBReader::Map(GLBFilepath, mapped, &stats))
+				{
+					success = false;
+					break;
+				}
+
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				if ((i == 0) || (elapsed.count() < mapSeconds))
+				{
+					mapSeconds = elapsed.count();
+				}
+			}
+
+			std::cout << std::endl << "    " << variant.name << ": " << mapSeconds * 1000.0 << " ms, " << parseSeconds / std::max(mapSeconds, 1e-9) << "x, "
+				<< (stats.viewedVertices ? "viewed" : "gathered") << " vertices and " << (stats.viewedIndices ? "viewed" : "gathered") << " indices";
+
+			//the same triangles in the same submeshes, with the material names of the file. Unnamed materials are named by their index
+			bool same = (mapped.submeshes.size() == parsed.submeshes.size()) && (mapped.indexCount == parsed.indices.size()) &&
+				(stats.viewedVertices == variant.viewedVertices) && (stats.viewedIndices == variant.viewedIndices);
+			std::vector<std::string> materialNames;
+			for (size_t i = 0; same && (i < parsed.submeshes.size()); i++)
+			{
+				const std::string& name = parsed.submeshMaterials[i];
+				size_t material = std::find(materialNames.begin(), materialNames.end(), name) - materialNames.begin();
+				if (material == materialNames.size())
+				{
+					materialNames.push_back(name);
+				}
+
+				same = (mapped.submeshes[i].Start == parsed.submeshes[i].Start) && (mapped.submeshes[i].size == parsed.submeshes[i].size) &&
+					(mapped.submeshMaterials[i] == GLBFilepath + ":" + (name.empty() ? "material" + std::to_string(material) : name));
+			}
+
+			for (size_t i = 0; same && (i < mapped.indexCount); i++)
+			{
+				uint32_t index = 0;
+				if (mapped.indexSize == sizeof(uint16_t))
+				{
+					uint16_t shortIndex;
+					memcpy(&shortIndex, static_cast<const char*>(mapped.indices) + i * sizeof(uint16_t), sizeof(shortIndex));
+					index = shortIndex;
+				}
+				else
+				{
+					index = static_cast<const uint32_t*>(mapped.indices)[i];
+				}
+
+				const Vertex& expected = parsed.vertices[parsed.indices[i]];
+				const Vertex& vertex = mapped.vertices[index];
+				same = (index < mapped.vertexCount) && (memcmp(expected.uv, vertex.uv, sizeof(vertex.uv)) == 0);
+
+				//normals under a transform come out normalized, computed ones only have to be
+				float normalLength = sqrtf(vertex.norm[0] * vertex.norm[0] + vertex.norm[1] * vertex.norm[1] + vertex.norm[2] * vertex.norm[2]);
+				if (!variant.normals)
+				{
+					same &= (normalLength == 0.0f) || (fabsf(normalLength - 1.0f) < 1e-4f);
+				}
+				else if (variant.offset != noOffset)
+				{
+					float expectedLength = sqrtf(expected.norm[0] * expected.norm[0] + expected.norm[1] * expected.norm[1] + expected.norm[2] * expected.norm[2]);
+					float cosine = (expected.norm[0] * vertex.norm[0] + expected.norm[1] * vertex.norm[1] + expected.norm[2] * vertex.norm[2]) / std::max(expectedLength, 1e-20f);
+					same &= (expectedLength == 0.0f) ? (normalLength == 0.0f) : (cosine > 0.9999f);
+				}
+				else
+				{
+					same &= memcmp(expected.norm, vertex.norm, sizeof(vertex.norm)) == 0;
+				}
+				for (int axis = 0; axis < 3; axis++)
+				{
+					same &= fabsf(expected.pos[axis] + variant.offset[axis] - vertex.pos[axis]) <= 1e-5f * (1.0f + fabsf(vertex.pos[axis]));
+				}
+			}
+
+			//the first material samples the texture, which is found next to the models
+			same &= !mapped.materials.empty() && mapped.materials[0].textured && (mapped.materials[0].map_Kd == texturePath);
+
+			MeshData read;
+			same &= GLBReader::Read(GLBFilepath, read) && (read.indices.size() == mapped.indexCount) && (read.materialLibraries == std::vector<std::string>{ GLBFilepath });
+
+			if (!same)
+			{
+				std::cout << " MISMATCH";
+				success = false;
+			}
+
+			if (variant.layout == GLBLayout::Interleaved)
+			{
+				//the cooker builds the same caches from a .glb as from an OBJ
+				MeshData built;
+				MeshData builtOBJ;
+				if (!AssetCooker::BuildMesh(GLBFilepath, SCENE_HUGIN_FLAGS, built, false) || !AssetCooker::BuildMesh(OBJFilepath, SCENE_HUGIN_FLAGS, builtOBJ, false) ||
+					(built.indices != builtOBJ.indices) || (built.lods.size() != builtOBJ.lods.size()) || (built.meshlets.size() != builtOBJ.meshlets.size()) || (built.materialLibraries != read.materialLibraries))
+				{
+					std::cout << " BUILD FAILED";
+					success = false;
+				}
+			}
+
+			if (damageFilepath.empty() && (variant.layout == GLBLayout::PerSubmesh))
+			{
+				damageFilepath = OBJFilepath + ".damaged.glb";
+				std::filesystem::copy_file(GLBFilepath, damageFilepath, std::filesystem::copy_options::overwrite_existing);
+			}
+			std::remove(GLBFilepath.c_str());
+		}
+		std::cout << std::endl;
+	}
+
+	//damaged files are rejected, or read into a mesh whose indices and submeshes stay within it
+	if (!damageFilepath.empty())
+	{
+		std::vector<char> original;
+		{
+			MappedFile file;
+			if (file.Open(damageFilepath))
+			{
+				original.assign(file.Data(), file.Data() + file.Size());
+			}
+		}
+		std::remove(damageFilepath.c_str());
+
+		std::mt19937 random(22);
+		size_t rejected = 0;
+		const int iterations = 300;
+		std::string damagedFilepath = damageFilepath + ".damaged";
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			std::vector<char> damaged = original;
+			if (iteration % 5 == 0)
+			{
+				damaged.resize(random() % damaged.size());
+			}
+			else
+			{
+				//mostly the JSON chunk, which decides where everything else is read from
+				uint32_t JSONLength = 0;
+				memcpy(&JSONLength, original.data() + 12, sizeof(JSONLength));
+				size_t range = (iteration % 2 == 0) ? std::min<size_t>(damaged.size(), 20 + JSONLength) : damaged.size();
+				for (int flips = 1 + random() % 4; flips > 0; flips--)
+				{
+					size_t position = random() % range;
+					damaged[position] = (iteration % 3 == 0) ? "0123456789[]{},:\"-"[random() % 17] : static_cast<char>(damaged[position] ^ (1 + random() % 255));
+				}
+			}
+
+			{
+				std::ofstream file(damagedFilepath, std::ios::binary | std::ios::trunc);
+				file.write(damaged.data(), damaged.size());
+			}
+
+			std::streambuf* errorBuffer = std::cerr.rdbuf(nullptr);
+			GLBReader::MappedMesh mapped;
+			bool read = GLBReader::Map(damagedFilepath, mapped);
+			std::cerr.rdbuf(errorBuffer);
+
+			if (!read)
+			{
+				rejected++;
+				continue;
+			}
+
+			bool valid = (mapped.vertices != nullptr) && (mapped.indices != nullptr);
+			for (size_t i = 0; valid && (i < mapped.indexCount); i++)
+			{
+				uint32_t index = 0;
+				if (mapped.indexSize == sizeof(uint16_t))
+				{
+					uint16_t shortIndex;
+					memcpy(&shortIndex, static_cast<const char*>(mapped.indices) + i * sizeof(uint16_t), sizeof(shortIndex));
+					index = shortIndex;
+				}
+				else
+				{
+					index = static_cast<const uint32_t*>(mapped.indices)[i];
+				}
+				valid = index < mapped.vertexCount;
+			}
+			for (const Submesh& submesh : mapped.submeshes)
+			{
+				valid &= (submesh.Start >= 0) && (submesh.size >= 0) && (static_cast<size_t>(submesh.Start) + submesh.size <= mapped.indexCount);
+			}
+
+			if (!valid)
+			{
+				std::cout << "  damaged file " << iteration << " read out of range" << std::endl;
+				success = false;
+			}
+		}
+		std::remove(damagedFilepath.c_str());
+
+		std::cout << "  " << rejected << " of " << iterations << " damaged files rejected" << std::endl;
+	}
+
+	return success;
+}
+
+bool Diagnostics::CheckMeshArena(const std::vector<std::string>& OBJFilepaths, int meshCount)
+{
+	std::cout << "Mesh arena" << std::endl;
+
+	bool success = true;
+
+	//every element remembers the allocation it belongs to, -1 while free
+	{
+		const size_t Capacity = 4096;
+		MeshArena::Allocator allocator(Capacity);
+		std::vector<int> owner(Capacity, -1);
+		std::vector<std::pair<size_t, size_t>> live;
+		std::mt19937 random(25);
+
+		bool valid = true;
+		size_t failed = 0;
+		for (int i = 0; (i < 20000) && valid; i++)
+		{
+			if (!live.empty() && ((random() % 2) == 0))
+			{
+				size_t pick = random() % live.size();
+				allocator.Free(live[pick].first);
+				std::fill(owner.begin() + live[pick].first, owner.begin() + live[pick].first + live[pick].second, -1);
+				live[pick] = live.back();
+				live.pop_back();
+				continue;
+			}
+
+			size_t count = 1 + random() % 300;
+			size_t offset = 0;
+			if (!allocator.Allocate(count, offset))
+			{
+				//only allowed when no free range is large enough
+				valid &= (allocator.LargestFree() < count);
+				failed++;
+				continue;
+			}
+
+			valid &= (offset + count <= Capacity) && std::all_of(owner.begin() + offset, owner.begin() + offset + count, [](int element) { return element == -1; });
+			if (valid)
+			{
+				std::fill(owner.begin() + offset, owner.begin() + offset + count, i);
+				live.push_back({ offset, count });
+			}
+
+			size_t used = 0;
+			for (const std::pair<size_t, size_t>& allocation : live)
+			{
+				used += allocation.second;
+			}
+			valid &= (allocator.Used() == used) && (allocator.Allocations() == live.size());
+		}
+
+		for (const std::pair<size_t, size_t>& allocation : live)
+		{
+			allocator.Free(allocation.first);
+		}
+		valid &= (allocator.Used() == 0) && (allocator.FreeRanges() == 1) && (allocator.LargestFree() == Capacity);
+
+		std::cout << "  20000 random operations, " << failed << " allocations did not fit, peak " << allocator.Peak() << " of " << Capacity << " elements";
+		if (!valid)
+		{
+			std::cout << " OVERLAP";
+			success = false;
+		}
+		std::cout << std::endl;
+	}
+
+	struct MeshSize
+	{
+		size_t vertices;
+		size_t indices;
+	};
+
+	std::vector<MeshSize> sizes;
+	for (const std::string& OBJFilepath : OBJFilepaths)
+	{
+		MeshData mesh;
+		if (!OBJReader::Read(OBJFilepath, mesh, OBJ_IMPORT_PARALLEL))
+		{
+			std::cerr << "Failed to import: " << OBJFilepath << std::endl;
+			success = false;
+			continue;
+		}
+		sizes.push_back({ mesh.vertices.size(), mesh.indices.size() });
+	}
+
+	if (sizes.empty())
+	{
+		return false;
+	}
+
+	//the buffers a mesh of the standard layout takes, as MeshArenaBuffers::Add places them
+	struct Placed
+	{
+		MeshArena::Range vertices;
+		MeshArena::Range positions;
+		MeshArena::Range indices;
+	};
+
+	MeshArena::Stream vertexStream(MESH_ARENA_BUFFER_BYTES / sizeof(Vertex));
+	MeshArena::Stream positionStream(MESH_ARENA_BUFFER_BYTES / sizeof(PositionVertex));
+	MeshArena::Stream indexStream(MESH_ARENA_BUFFER_BYTES / sizeof(uint32_t));
+
+	auto place = [](MeshArena::Stream& stream, size_t count, MeshArena::Range& range)
+	{
+		if (!stream.Allocate(count, range))
+		{
+			stream.AddBlock(stream.NextBlockCapacity(count));
+			stream.Allocate(count, range);
+		}
+	};
+
+	std::mt19937 random(26);
+	std::vector<Placed> meshes;
+	auto load = [&]()
+	{
+		const MeshSize& size = sizes[random() % sizes.size()];
+		Placed placed;
+		place(vertexStream, size.vertices, placed.vertices);
+		place(positionStream, size.vertices, placed.positions);
+		place(indexStream, size.indices, placed.indices);
+		meshes.push_back(placed);
+	};
+
+	//a level streamed in, half of it unloaded again and refilled, which is what fragments the buffers
+	for (int i = 0; i < meshCount; i++)
+	{
+		load();
+	}
+	for (int i = 0; i < meshCount / 2; i++)
+	{
+		size_t pick = random() % meshes.size();
+		vertexStream.Free(meshes[pick].vertices);
+		positionStream.Free(meshes[pick].positions);
+		indexStream.Free(meshes[pick].indices);
+		meshes[pick] = meshes.back();
+		meshes.pop_back();
+	}
+	for (int i = 0; i < meshCount / 2; i++)
+	{
+		load();
+	}
+
+	MeshArena::Report report;
+	vertexStream.Describe(sizeof(Vertex), report);
+	positionStream.Describe(sizeof(PositionVertex), report);
+	indexStream.Describe(sizeof(uint32_t), report);
+
+	//one vertex and one index buffer bind per mesh on their own, in the arena only when the next mesh lies in other buffers
+	size_t separateBinds = 2 * meshes.size();
+	size_t arenaBinds = 0;
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		arenaBinds += ((i == 0) || (meshes[i].vertices.block != meshes[i - 1].vertices.block)) ? 1 : 0;
+		arenaBinds += ((i == 0) || (meshes[i].indices.block != meshes[i - 1].indices.block)) ? 1 : 0;
+	}
+
+	std::cout << "  " << meshes.size() << " meshes after churn: " << report.usedBytes / 1024 << " of " << report.capacityBytes / 1024 << " KB in " << report.buffers << " buffers, peak "
+		<< report.peakBytes / 1024 << " KB, " << report.freeRanges << " free ranges, largest " << report.largestFreeBytes / 1024 << " KB, " << report.Fragmentation() * 100.0 << "% fragmented" << std::endl;
+	std::cout << "  buffer binds: " << separateBinds << " with a buffer pair per mesh, " << arenaBinds << " from the arena" << std::endl;
+
+	if ((report.allocations != 3 * meshes.size()) || (report.usedBytes > report.capacityBytes) || (arenaBinds > separateBinds))
+	{
+		std::cout << "  REPORT MISMATCH" << std::endl;
+		success = false;
+	}
+
+	return success;
+}
+
+int Diagnostics::Run()
+{
+	const std::string gridFilepath = "OBJ/benchmarkGrid.obj";
+
+	//708 * 708 * 2 is just over a million faces
+	if (!WriteGridOBJ(gridFilepath, 708))
+	{
+		return -1;
+	}
+
+	//first, while the process has not yet grown and freed memory a streaming import could reuse unnoticed
+	bool success = CheckStreamingImport({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 8 * 1024 * 1024);
+	success &= BenchmarkOBJImport({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 5);
+	success &= BenchmarkVertexDedup(708, 3);
+	success &= BenchmarkAsyncLoading({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" }, 100);
+	success &= BenchmarkMeshOptimizer({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath });
+	success &= CheckVertexQuantization({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath });
+	success &= CheckVertexFormats({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath });
+	success &= CheckDepthStream({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" });
+	success &= CheckMeshSimplifier({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" }, 4);
+	success &= CheckMeshBounds({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath });
+	success &= BenchmarkClusterCulling({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 8);
+	success &= BenchmarkInstancing({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" }, 2500);
+	success &= CheckMipChain();
+	success &= BenchmarkBlockCompression();
+	success &= CheckMaterialPacking({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" }, 2500);
+	success &= BenchmarkTextureCooking({ "textures/missingTexture.png", "textures/hugin_head_color.png", "textures/hugin_head_AO.png" });
+	success &= CheckMeshCodec({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 2000);
+	success &= BenchmarkMeshCache({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 5);
+
+	//the scene's compiled shaders are packed along with the models and textures
+	std::vector<std::string> assetPaths = { "OBJ/simpleCube.obj", "OBJ/simpleCube.mtl", "OBJ/Hugin.obj", "OBJ/Hugin.mtl", "textures/missingTexture.png", "textures/star.png", "textures/hugin_head_AO.png" };
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(".", error))
+	{
+		if (entry.path().extension() == ".cso")
+		{
+			assetPaths.push_back(entry.path().filename().string());
+		}
+	}
+	success &= CheckAssetPack(assetPaths, 5);
+	success &= CheckGLBImport({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj", gridFilepath }, 5);
+	success &= CheckMeshArena({ "OBJ/simpleCube.obj", "OBJ/Hugin.obj" }, 400);
+
+	std::remove(gridFilepath.c_str());
+
+	//after the grid is gone, the cooker cooks a copy of every OBJ in the mesh directory
+	success &= CheckAssetCooker("OBJ/simpleCube.obj");
+
+	return success ? 0 : -1;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+//Headless checks and benchmarks for the loading code. Started from the command line before any window or device is created.
+//Everything it checks has no graphics dependencies and runs without a device: ThreadPool, AsyncLoading, OBJReader, GLBReader, MeshCache,
+//MeshCodec, MeshOptimizer, MeshSimplifier, Meshlets, MeshBounds, VertexFormat, VertexQuantization, Instancing, MeshArena, MipChain,
+//BlockCompression, TextureCache, MaterialPacking, AssetPack and AssetCooker. The classes that draw with them own the device resources.
+namespace Diagnostics
+{
+	//writes a flat grid with quadsPerSide * quadsPerSide * 2 triangles, used as a large synthetic model
+	bool WriteGridOBJ(const std::string& OBJFilepath, int quadsPerSide);
+
+	//streams every file within memoryBudget and fails if the import reports more working memory or the process grows by more than that while
+	//it runs. Also fails if an index comes before its vertex or the streamed mesh, or its cache written on the fly, draws other triangles than a normal read
+	bool CheckStreamingImport(const std::vector<std::string>& OBJFilepaths, size_t memoryBudget);
+
+	//loads every file serially and in parallel, checks that both give the same mesh and prints the timings
+	bool BenchmarkOBJImport(const std::vector<std::string>& OBJFilepaths, int repeats);
+
+	//loads copies of every file through AsyncLoading coroutines while the calling thread pumps like the frame loop does.
+	//fails if a load gives another mesh than a serial one or its last step does not run on the calling thread
+	bool BenchmarkAsyncLoading(const std::vector<std::string>& OBJFilepaths, int copies);
+
+	//welds the corners of a grid with quadsPerSide * quadsPerSide quads through a string keyed std::map and through CornerHashTable
+	bool BenchmarkVertexDedup(int quadsPerSide, int repeats);
+
+	//writes the binary cache for every file, checks that reading it back gives the parsed mesh and compares the load times
+	bool BenchmarkMeshCache(const std::vector<std::string>& OBJFilepaths, int repeats);
+
+	//optimizes every file, prints ACMR/ATVR before and after and checks that the same triangles are drawn
+	bool BenchmarkMeshOptimizer(const std::vector<std::string>& OBJFilepaths);
+
+	//encodes every file to CompactVertex and back, fails if position, normal or uv error exceed what the encoding allows
+	bool CheckVertexQuantization(const std::vector<std::string>& OBJFilepaths);
+
+	//checks the generated offsets and input layouts of the VertexOf formats against where the compiler put the members,
+	//then converts every file to UntexturedVertex and fails if a position or normal changes
+	bool CheckVertexFormats(const std::vector<std::string>& OBJFilepaths);
+
+	//builds every file with levels of detail and meshlets and checks that each level is drawn by the single range of the depth passes,
+	//and that the position stream holds the positions of the full vertices. Prints the depth pass fetch and draw counts before and after
+	bool CheckDepthStream(const std::vector<std::string>& OBJFilepaths);
+
+	//simplifies a flat grid to a triangle target without error, then builds levelCount LODs for every file and checks their triangle counts,
+	//index ranges and that the measured distance to the full mesh stays within twice the error each level reports
+	bool CheckMeshSimplifier(const std::vector<std::string>& OBJFilepaths, int levelCount);
+
+	//moves every file off the origin and computes its bounds, fails if a vertex lies outside the sphere or box
+	//or the sphere is larger than the one around the box
+	bool CheckMeshBounds(const std::vector<std::string>& OBJFilepaths);
+
+	//splits every file into meshlets and counts the triangles that survive frustum and backface cone culling from viewCount cameras around it.
+	//fails if a culled triangle faces the camera and is not completely outside the frustum
+	bool BenchmarkClusterCulling(const std::vector<std::string>& OBJFilepaths, int viewCount);
+
+	//scatters objectCount copies of the files over a field with a level of detail picked by distance, groups them like InstanceBatcher
+	//and counts the draw calls drawn one by one and instanced. Fails if an object is lost, drawn twice or put in a group of another mesh or level
+	bool BenchmarkInstancing(const std::vector<std::string>& OBJFilepaths, int objectCount);
+
+	//builds mip chains of noise images of awkward sizes and channel counts and compares every level against a double precision
+	//reference built from the level above. Fails on a wrong level size, more than one step of difference or a black and white
+	//checkerboard not filtering to 50% linear grey. Times a 4096x4096 chain, the size of the Hugin textures
+	bool CheckMipChain();
+
+	//encodes synthetic 1024x1024 colour, grey and two channel images to every block format and prints quality and speed.
+	//fails if a format falls below its quality floor or Choose picks the wrong format
+	bool BenchmarkBlockCompression();
+
+	//packs material maps of a few sizes and formats into texture arrays and counts the material binds of a frame of objectCount objects
+	//with and without the material table. Fails if textures of one key do not share an array or the slot and slice limits are not kept
+	bool CheckMaterialPacking(const std::vector<std::string>& OBJFilepaths, int objectCount);
+
+	//cooks every texture with and without compression and times it against mapping the cooked file.
+	//fails if the mapped levels differ from the cooked ones or a cooked file is used after its source changed
+	bool BenchmarkTextureCooking(const std::vector<std::string>& texturePaths);
+
+	//round trips fuzzIterations random vertex and index buffers through MeshCodec with both decoders and feeds them truncated and damaged
+	//streams, then compresses every optimized file and times the decode. Fails on any difference or a truncated stream that decodes
+	bool CheckMeshCodec(const std::vector<std::string>& OBJFilepaths, int fuzzIterations);
+
+	//packs the assets with their mesh caches and cooked textures, checks that every entry and every loader reads the same from the pack as from
+	//the loose files and times opening all of them both ways. Also mounts damaged packs, which have to be rejected without reading out of bounds
+	bool CheckAssetPack(const std::vector<std::string>& assetPaths, int repeats);
+
+	//cooks the asset library from nothing and checks the runtime accepts every output, then runs the cooker again unchanged, after touching,
+	//editing and deleting the cache of a copy of OBJFilepath and checks that exactly what is outdated is cooked again
+	bool CheckAssetCooker(const std::string& OBJFilepath);
+
+	//writes every file as .glb in the layouts exporters use and maps it, fails if a layout that can be used as it is gets copied
+	//or another mesh comes out than the parsed one. Times the map against parsing the OBJ and reads damaged files, which have to be
+	//rejected or give a mesh that stays within its arrays
+	bool CheckGLBImport(const std::vector<std::string>& OBJFilepaths, int repeats);
+
+	//runs random allocations against one arena buffer and fails on a range that overlaps another or leaves the buffer, or free ranges
+	//that do not merge back into one. Then loads and unloads meshCount meshes of the sizes of the files like MeshArenaBuffers does,
+	//prints the allocation and fragmentation report and counts the buffer binds of drawing them with and without the arena
+	bool CheckMeshArena(const std::vector<std::string>& OBJFilepaths, int meshCount);
+
+	//runs every benchmark, returns the process exit code
+	int Run();
+}
@@ -0,0 +1,164 @@
+#include "FileMapping.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data(nullptr), size(0), open(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath)
+{
+	Close();
+
+	fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+	open = true;
+
+	//an empty file cannot be mapped, it is still a valid open file though
+	if (size == 0)
+	{
+		return true;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle != nullptr)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	data = nullptr;
+	size = 0;
+	open = false;
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : data(nullptr), size(0), open(false), fileDescriptor(-1)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath)
+{
+	Close();
+
+	fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStats;
+	if (fstat(fileDescriptor, &fileStats) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(fileStats.st_size);
+	open = true;
+
+	if (size == 0)
+	{
+		return true;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	madvise(mapping, size, MADV_SEQUENTIAL);
+	data = static_cast<const char*>(mapping);
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+	{
+		munmap(const_cast<char*>(data), size);
+	}
+	if (fileDescriptor >= 0)
+	{
+		::close(fileDescriptor);
+	}
+
+	data = nullptr;
+	size = 0;
+	open = false;
+	fileDescriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::IsOpen() const
+{
+	return open;
+}
+
+const char* MappedFile::Data() const
+{
+	return data;
+}
+
+size_t MappedFile::Size() const
+{
+	return size;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+//Read only view of a whole file mapped into memory. The data stays valid until Close() or destruction.
+class MappedFile
+{
+	public :
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		bool IsOpen() const;
+		const char* Data() const;
+		size_t Size() const;
+
+	private :
+		const char* data;
+		size_t size;
+		bool open;
+
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#else
+		int fileDescriptor;
+#endif
+};
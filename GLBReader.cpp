@@ -0,0 +1,1550 @@
+#include "GLBReader.h"
+#include <iostream>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string_view>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <array>
+
+#include "MeshBounds.h"
+
+namespace
+{
+	const uint32_t GLBMagic = 0x46546C67;
+	const uint32_t JSONChunkType = 0x4E4F534A;
+	const uint32_t BinaryChunkType = 0x004E4942;
+	const size_t HeaderSize = 12;
+	const size_t ChunkHeaderSize = 8;
+
+	const size_t ComponentUnsignedByte = 5121;
+	const size_t ComponentUnsignedShort = 5123;
+	const size_t ComponentUnsignedInt = 5125;
+	const size_t ComponentFloat = 5126;
+
+	const size_t TrianglesMode = 4;
+
+	//no glTF nests this deep, keeps a damaged file from running the parser out of stack
+	const int MaximumDepth = 64;
+
+	//missing optional indices
+	const size_t None = SIZE_MAX;
+
+	struct JSONValue
+	{
+		enum class Type { Null, Boolean, Number, String, Array, Object };
+
+		Type type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+
+		//array elements, or object members in file order next to their names. glTF objects are small enough to search one by one
+		std::vector<JSONValue> elements;
+		std::vector<std::string> names;
+
+		//nullptr when this is no object or has no such member
+		const JSONValue* Find(std::string_view name) const
+		{
+			if (type != Type::Object)
+			{
+				return nullptr;
+			}
+
+			for (size_t i = 0; i < names.size(); i++)
+			{
+				if (names[i] == name)
+				{
+					return &elements[i];
+				}
+			}
+			return nullptr;
+		}
+
+		//nullptr when this is no array or index is past its end
+		const JSONValue* At(size_t index) const
+		{
+			return ((type == Type::Array) && (index < elements.size())) ? &elements[index] : nullptr;
+		}
+
+		size_t Size() const
+		{
+			return (type == Type::Array) ? elements.size() : 0;
+		}
+	};
+
+	class JSONParser
+	{
+		public:
+			JSONParser(const char* data, size_t size) : cursor(data), end(data + size)
+			{
+			}
+
+			//the whole text has to be one value, the padding of a GLB chunk is allowed after it
+			bool Parse(JSONValue& value)
+			{
+				if (!ParseValue(value, 0))
+				{
+					return false;
+				}
+
+				while ((cursor < end) && (IsWhitespace(*cursor) || (*cursor == '\0')))
+				{
+					cursor++;
+				}
+				return cursor == end;
+			}
+
+		private:
+			const char* cursor;
+			const char* end;
+
+			static bool IsWhitespace(char character)
+			{
+				return (character == ' ') || (character == '\t') || (character == '\n') || (character == '\r');
+			}
+
+			void SkipWhitespace()
+			{
+				while ((cursor < end) && IsWhitespace(*cursor))
+				{
+					cursor++;
+				}
+			}
+
+			bool Expect(char character)
+			{
+				SkipWhitespace();
+				if ((cursor >= end) || (*cursor != character))
+				{
+					return false;
+				}
+				cursor++;
+				return true;
+			}
+
+			bool Literal(std::string_view text)
+			{
+				if ((static_cast<size_t>(end - cursor) < text.size()) || (std::string_view(cursor, text.size()) != text))
+				{
+					return false;
+				}
+				cursor += text.size();
+				return true;
+			}
+
+			bool ParseValue(JSONValue& value, int depth)
+			{
+				SkipWhitespace();
+				if ((cursor >= end) || (depth > MaximumDepth))
+				{
+					return false;
+				}
+
+				switch (*cursor)
+				{
+				case '{':
+					return ParseObject(value, depth);
+				case '[':
+					return ParseArray(value, depth);
+				case '"':
+					value.type = JSONValue::Type::String;
+					return ParseString(value.string);
+				case 't':
+					value.type = JSONValue::Type::Boolean;
+					value.boolean = true;
+					return Literal("true");
+				case 'f':
+					value.type = JSONValue::Type::Boolean;
+					value.boolean = false;
+					return Literal("false");
+				case 'n':
+					value.type = JSONValue::Type::Null;
+					return Literal("null");
+				default:
+					value.type = JSONValue::Type::Number;
+					return ParseNumber(value.number);
+				}
+			}
+
+			bool ParseNumber(double& number)
+			{
+				if ((*cursor != '-') && ((*cursor < '0') || (*cursor > '9')))
+				{
+					return false;
+				}
+
+				std::from_chars_result result = std::from_chars(cursor, end, number);
+				if ((result.ec != std::errc()) || !std::isfinite(number))
+				{
+					return false;
+				}
+
+				cursor = result.ptr;
+				return true;
+			}
+
+			bool ParseHex(uint32_t& value)
+			{
+				if (end - cursor < 4)
+				{
+					return false;
+				}
+
+				std::from_chars_result result = std::from_chars(cursor, cursor + 4, value, 16);
+				if ((result.ec != std::errc()) || (result.ptr != cursor + 4))
+				{
+					return false;
+				}
+
+				cursor += 4;
+				return true;
+			}
+
+			static void AppendUTF8(std::string& text, uint32_t codePoint)
+			{
+				if (codePoint < 0x80)
+				{
+					text.push_back(static_cast<char>(codePoint));
+				}
+				else if (codePoint < 0x800)
+				{
+					text.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+					text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+				else if (codePoint < 0x10000)
+				{
+					text.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+					text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+					text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+				else
+				{
+					text.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+					text.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+					text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+					text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+			}
+
+			bool ParseString(std::string& text)
+			{
+				//opening quote
+				cursor++;
+
+				while (cursor < end)
+				{
+					char character = *cursor++;
+					if (character == '"')
+					{
+						return true;
+					}
+					if (static_cast<unsigned char>(character) < 0x20)
+					{
+						return false;
+					}
+					if (character != '\\')
+					{
+						text.push_back(character);
+						continue;
+					}
+
+					if (cursor >= end)
+					{
+						return false;
+					}
+
+					char escape = *cursor++;
+					switch (escape)
+					{
+					case '"':
+					case '\\':
+					case '/':
+						text.push_back(escape);
+						break;
+					case 'b':
+						text.push_back('\b');
+						break;
+					case 'f':
+						text.push_back('\f');
+						break;
+					case 'n':
+						text.push_back('\n');
+						break;
+					case 'r':
+						text.push_back('\r');
+						break;
+					case 't':
+						text.push_back('\t');
+						break;
+					case 'u':
+					{
+						uint32_t codePoint = 0;
+						if (!ParseHex(codePoint))
+						{
+							return false;
+						}
+
+						//characters outside the basic plane are written as two escaped halves
+						if ((codePoint >= 0xD800) && (codePoint < 0xDC00))
+						{
+							uint32_t low = 0;
+							if ((end - cursor < 2) || (cursor[0] != '\\') || (cursor[1] != 'u'))
+							{
+								return false;
+							}
+							cursor += 2;
+
+							if (!ParseHex(low) || (low < 0xDC00) || (low >= 0xE000))
+							{
+								return false;
+							}
+							codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+						}
+						AppendUTF8(text, codePoint);
+						break;
+					}
+					default:
+						return false;
+					}
+				}
+				return false;
+			}
+
+			bool ParseArray(JSONValue& value, int depth)
+			{
+				value.type = JSONValue::Type::Array;
+				cursor++;
+
+				SkipWhitespace();
+				if ((cursor < end) && (*cursor == ']'))
+				{
+					cursor++;
+					return true;
+				}
+
+				while (true)
+				{
+					value.elements.emplace_back();
+					if (!ParseValue(value.elements.back(), depth + 1))
+					{
+						return false;
+					}
+
+					SkipWhitespace();
+					if (cursor >= end)
+					{
+						return false;
+					}
+
+					char separator = *cursor++;
+					if (separator == ']')
+					{
+						return true;
+					}
+					if (separator != ',')
+					{
+						return false;
+					}
+				}
+			}
+
+			bool ParseObject(JSONValue& value, int depth)
+			{
+				value.type = JSONValue::Type::Object;
+				cursor++;
+
+				SkipWhitespace();
+				if ((cursor < end) && (*cursor == '}'))
+				{
+					cursor++;
+					return true;
+				}
+
+				while (true)
+				{
+					SkipWhitespace();
+					if ((cursor >= end) || (*cursor != '"'))
+					{
+						return false;
+					}
+
+					value.names.emplace_back();
+					value.elements.emplace_back();
+					if (!ParseString(value.names.back()) || !Expect(':') || !ParseValue(value.elements.back(), depth + 1))
+					{
+						return false;
+					}
+
+					SkipWhitespace();
+					if (cursor >= end)
+					{
+						return false;
+					}
+
+					char separator = *cursor++;
+					if (separator == '}')
+					{
+						return true;
+					}
+					if (separator != ',')
+					{
+						return false;
+					}
+				}
+			}
+	};
+
+	//glTF indices and sizes, exact in a double up to 2^53
+	bool AsIndex(const JSONValue& value, size_t& index)
+	{
+		if ((value.type != JSONValue::Type::Number) || (value.number < 0.0) || (value.number > 9007199254740992.0) || (value.number != std::floor(value.number)))
+		{
+			return false;
+		}
+
+		index = static_cast<size_t>(value.number);
+		return true;
+	}
+
+	//leaves index as it is when the member is missing, fails if it is there but not an index
+	bool OptionalIndex(const JSONValue& object, std::string_view name, size_t& index)
+	{
+		const JSONValue* member = object.Find(name);
+		return (member == nullptr) || AsIndex(*member, index);
+	}
+
+	bool RequiredIndex(const JSONValue& object, std::string_view name, size_t& index)
+	{
+		const JSONValue* member = object.Find(name);
+		return (member != nullptr) && AsIndex(*member, index);
+	}
+
+	//fills values from a number array of exactly count elements, leaves them as they are when the member is missing
+	bool OptionalFloats(const JSONValue& object, std::string_view name, float* values, size_t count)
+	{
+		const JSONValue* member = object.Find(name);
+		if (member == nullptr)
+		{
+			return true;
+		}
+		if (member->Size() != count)
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (member->elements[i].type != JSONValue::Type::Number)
+			{
+				return false;
+			}
+			values[i] = static_cast<float>(member->elements[i].number);
+		}
+		return true;
+	}
+
+	float OptionalFloat(const JSONValue& object, std::string_view name, float fallback)
+	{
+		const JSONValue* member = object.Find(name);
+		return ((member != nullptr) && (member->type == JSONValue::Type::Number)) ? static_cast<float>(member->number) : fallback;
+	}
+
+	uint32_t ReadUInt32(const char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	struct Document
+	{
+		std::string filepath;
+		JSONValue json;
+
+		//the BIN chunk, nullptr in a file without one
+		const uint8_t* binary = nullptr;
+		size_t binarySize = 0;
+	};
+
+	bool ParseContainer(const char* data, size_t size, Document& document, std::string& error)
+	{
+		if ((size < HeaderSize + ChunkHeaderSize) || (ReadUInt32(data) != GLBMagic))
+		{
+			error = "Not a binary glTF file";
+			return false;
+		}
+		if (ReadUInt32(data + 4) != 2)
+		{
+			error = "Unsupported glTF version";
+			return false;
+		}
+
+		size_t length = ReadUInt32(data + 8);
+		if (length > size)
+		{
+			error = "Truncated binary glTF file";
+			return false;
+		}
+
+		size_t JSONLength = ReadUInt32(data + HeaderSize);
+		if ((ReadUInt32(data + HeaderSize + 4) != JSONChunkType) || (JSONLength > length - HeaderSize - ChunkHeaderSize))
+		{
+			error = "Missing JSON chunk";
+			return false;
+		}
+
+		JSONParser parser(data + HeaderSize + ChunkHeaderSize, JSONLength);
+		if (!parser.Parse(document.json) || (document.json.type != JSONValue::Type::Object))
+		{
+			error = "Malformed JSON chunk";
+			return false;
+		}
+
+		size_t next = HeaderSize + ChunkHeaderSize + JSONLength;
+		if (length - next >= ChunkHeaderSize)
+		{
+			size_t binaryLength = ReadUInt32(data + next);
+			if ((ReadUInt32(data + next + 4) == BinaryChunkType) && (binaryLength <= length - next - ChunkHeaderSize))
+			{
+				document.binary = reinterpret_cast<const uint8_t*>(data + next + ChunkHeaderSize);
+				document.binarySize = binaryLength;
+			}
+		}
+
+		return true;
+	}
+
+	size_t ComponentSize(size_t componentType)
+	{
+		switch (componentType)
+		{
+		case 5120:
+		case 5121:
+			return 1;
+		case 5122:
+		case 5123:
+			return 2;
+		case 5125:
+		case 5126:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	size_t ComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR")
+		{
+			return 1;
+		}
+		if (type == "VEC2")
+		{
+			return 2;
+		}
+		if (type == "VEC3")
+		{
+			return 3;
+		}
+		if (type == "VEC4")
+		{
+			return 4;
+		}
+		return 0;
+	}
+
+	//an accessor resolved to where its elements lie in the binary chunk
+	struct AccessorView
+	{
+		const uint8_t* data = nullptr;
+		size_t count = 0;
+		size_t stride = 0;
+		size_t componentType = 0;
+		size_t components = 0;
+		bool normalized = false;
+
+		size_t ElementSize() const
+		{
+			return ComponentSize(componentType) * components;
+		}
+	};
+
+	bool ResolveAccessor(const Document& document, size_t accessorIndex, AccessorView& view, std::string& error)
+	{
+		const JSONValue* accessors = document.json.Find("accessors");
+		const JSONValue* accessor = (accessors != nullptr) ? accessors->At(accessorIndex) : nullptr;
+
+		const JSONValue* typeName = (accessor != nullptr) ? accessor->Find("type") : nullptr;
+		size_t accessorOffset = 0;
+		if ((typeName == nullptr) || (typeName->type != JSONValue::Type::String) || !RequiredIndex(*accessor, "componentType", view.componentType) ||
+			!RequiredIndex(*accessor, "count", view.count) || !OptionalIndex(*accessor, "byteOffset", accessorOffset))
+		{
+			error = "Malformed accessor";
+			return false;
+		}
+
+		size_t bufferViewIndex = None;
+		if ((accessor->Find("sparse") != nullptr) || !RequiredIndex(*accessor, "bufferView", bufferViewIndex))
+		{
+			error = "Sparse accessors and accessors without a buffer view are not supported";
+			return false;
+		}
+
+		view.components = ComponentCount(typeName->string);
+		if ((view.components == 0) || (ComponentSize(view.componentType) == 0))
+		{
+			error = "Unsupported accessor type";
+			return false;
+		}
+
+		const JSONValue* normalized = accessor->Find("normalized");
+		view.normalized = (normalized != nullptr) && (normalized->type == JSONValue::Type::Boolean) && normalized->boolean;
+
+		const JSONValue* bufferViews = document.json.Find("bufferViews");
+		const JSONValue* bufferView = (bufferViews != nullptr) ? bufferViews->At(bufferViewIndex) : nullptr;
+
+		size_t bufferIndex = None;
+		size_t viewOffset = 0;
+		size_t viewLength = 0;
+		size_t viewStride = 0;
+		if ((bufferView == nullptr) || !RequiredIndex(*bufferView, "buffer", bufferIndex) || !RequiredIndex(*bufferView, "byteLength", viewLength) ||
+			!OptionalIndex(*bufferView, "byteOffset", viewOffset) || !OptionalIndex(*bufferView, "byteStride", viewStride))
+		{
+			error = "Malformed buffer view";
+			return false;
+		}
+
+		//the BIN chunk is the first buffer, the one without a uri
+		const JSONValue* buffers = document.json.Find("buffers");
+		const JSONValue* buffer = (buffers != nullptr) ? buffers->At(bufferIndex) : nullptr;
+		if ((bufferIndex != 0) || (buffer == nullptr) || (buffer->Find("uri") != nullptr) || (document.binary == nullptr))
+		{
+			error = "Buffers outside the binary chunk are not supported";
+			return false;
+		}
+
+		if ((viewOffset > document.binarySize) || (viewLength > document.binarySize - viewOffset))
+		{
+			error = "Buffer view outside the binary chunk";
+			return false;
+		}
+
+		size_t elementSize = view.ElementSize();
+		view.stride = (viewStride != 0) ? viewStride : elementSize;
+		if (view.stride < elementSize)
+		{
+			error = "Buffer view stride smaller than its elements";
+			return false;
+		}
+
+		if ((view.count > 0) && ((accessorOffset > viewLength) || (elementSize > viewLength - accessorOffset) || ((view.count - 1) > (viewLength - accessorOffset - elementSize) / view.stride)))
+		{
+			error = "Accessor outside its buffer view";
+			return false;
+		}
+
+		view.data = document.binary + viewOffset + accessorOffset;
+		return true;
+	}
+
+	//component of an element as a float, normalized integers are mapped to [0, 1] or [-1, 1]
+	float ReadComponent(const uint8_t* element, size_t componentType, bool normalized, size_t component)
+	{
+		switch (componentType)
+		{
+		case 5120:
+		{
+			int8_t value;
+			memcpy(&value, element + component, sizeof(value));
+			return normalized ? std::max(value / 127.0f, -1.0f) : value;
+		}
+		case 5121:
+			return normalized ? element[component] / 255.0f : element[component];
+		case 5122:
+		{
+			int16_t value;
+			memcpy(&value, element + component * 2, sizeof(value));
+			return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+		}
+		case 5123:
+		{
+			uint16_t value;
+			memcpy(&value, element + component * 2, sizeof(value));
+			return normalized ? value / 65535.0f : value;
+		}
+		case 5125:
+		{
+			uint32_t value;
+			memcpy(&value, element + component * 4, sizeof(value));
+			return static_cast<float>(value);
+		}
+		default:
+		{
+			float value;
+			memcpy(&value, element + component * 4, sizeof(value));
+			return value;
+		}
+		}
+	}
+
+	uint32_t ReadIndex(const uint8_t* element, size_t componentType)
+	{
+		if (componentType == ComponentUnsignedByte)
+		{
+			return element[0];
+		}
+		if (componentType == ComponentUnsignedShort)
+		{
+			uint16_t value;
+			memcpy(&value, element, sizeof(value));
+			return value;
+		}
+
+		uint32_t value;
+		memcpy(&value, element, sizeof(value));
+		return value;
+	}
+
+	//column major like glTF
+	typedef std::array<float, 16> Matrix;
+
+	const Matrix Identity = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+	Matrix Multiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result;
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				float sum = 0.0f;
+				for (int i = 0; i < 4; i++)
+				{
+					sum += a[i * 4 + row] * b[column * 4 + i];
+				}
+				result[column * 4 + row] = sum;
+			}
+		}
+		return result;
+	}
+
+	//the node's matrix, or translation * rotation * scale
+	bool LocalMatrix(const JSONValue& node, Matrix& matrix)
+	{
+		matrix = Identity;
+		if (node.Find("matrix") != nullptr)
+		{
+			return OptionalFloats(node, "matrix", matrix.data(), 16);
+		}
+
+		float translation[3] = { 0.0f, 0.0f, 0.0f };
+		float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float scale[3] = { 1.0f, 1.0f, 1.0f };
+		if (!OptionalFloats(node, "translation", translation, 3) || !OptionalFloats(node, "rotation", rotation, 4) || !OptionalFloats(node, "scale", scale, 3))
+		{
+			return false;
+		}
+
+		float x = rotation[0];
+		float y = rotation[1];
+		float z = rotation[2];
+		float w = rotation[3];
+
+		float columns[3][3] =
+		{
+			{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w) },
+			{ 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) },
+			{ 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) }
+		};
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				matrix[column * 4 + row] = columns[column][row] * scale[column];
+			}
+			matrix[12 + column] = translation[column];
+		}
+		return true;
+	}
+
+	//a mesh placed by the scene
+	struct Draw
+	{
+		size_t mesh = 0;
+		Matrix matrix = Identity;
+	};
+
+	//the meshes of the default scene, or of every root node when there is none, or every mesh when there are no nodes
+	bool CollectDraws(const Document& document, std::vector<Draw>& draws, std::string& error)
+	{
+		const JSONValue* meshes = document.json.Find("meshes");
+		const JSONValue* nodes = document.json.Find("nodes");
+		const JSONValue* scenes = document.json.Find("scenes");
+
+		if ((nodes == nullptr) || (nodes->Size() == 0))
+		{
+			for (size_t mesh = 0; (meshes != nullptr) && (mesh < meshes->Size()); mesh++)
+			{
+				draws.push_back({ mesh, Identity });
+			}
+			return true;
+		}
+
+		std::vector<size_t> roots;
+		if ((scenes != nullptr) && (scenes->Size() > 0))
+		{
+			size_t sceneIndex = 0;
+			const JSONValue* scene = OptionalIndex(document.json, "scene", sceneIndex) ? scenes->At(sceneIndex) : nullptr;
+			const JSONValue* sceneNodes = (scene != nullptr) ? scene->Find("nodes") : nullptr;
+			if (scene == nullptr)
+			{
+				error = "Malformed scene";
+				return false;
+			}
+
+			for (size_t i = 0; i < ((sceneNodes != nullptr) ? sceneNodes->Size() : 0); i++)
+			{
+				size_t node = None;
+				if (!AsIndex(sceneNodes->elements[i], node))
+				{
+					error = "Malformed scene";
+					return false;
+				}
+				roots.push_back(node);
+			}
+		}
+		else
+		{
+			std::vector<bool> child(nodes->Size(), false);
+			for (const JSONValue& node : nodes->elements)
+			{
+				const JSONValue* children = node.Find("children");
+				for (size_t i = 0; i < ((children != nullptr) ? children->Size() : 0); i++)
+				{
+					size_t index = None;
+					if (AsIndex(children->elements[i], index) && (index < child.size()))
+					{
+						child[index] = true;
+					}
+				}
+			}
+
+			for (size_t node = 0; node < child.size(); node++)
+			{
+				if (!child[node])
+				{
+					roots.push_back(node);
+				}
+			}
+		}
+
+		//the hierarchy has to be a tree, a node reached twice would otherwise be drawn twice or loop forever
+		std::vector<bool> visited(nodes->Size(), false);
+		std::vector<std::pair<size_t, Matrix>> pending;
+		for (std::vector<size_t>::reverse_iterator root = roots.rbegin(); root != roots.rend(); root++)
+		{
+			pending.push_back({ *root, Identity });
+		}
+
+		while (!pending.empty())
+		{
+			size_t index = pending.back().first;
+			Matrix parent = pending.back().second;
+			pending.pop_back();
+
+			const JSONValue* node = nodes->At(index);
+			Matrix local;
+			if ((node == nullptr) || visited[index] || !LocalMatrix(*node, local))
+			{
+				error = "Malformed node hierarchy";
+				return false;
+			}
+			visited[index] = true;
+
+			Matrix world = Multiply(parent, local);
+
+			size_t mesh = None;
+			if (!OptionalIndex(*node, "mesh", mesh) || ((mesh != None) && ((meshes == nullptr) || (mesh >= meshes->Size()))))
+			{
+				error = "Node refers to a mesh that does not exist";
+				return false;
+			}
+			if (mesh != None)
+			{
+				draws.push_back({ mesh, world });
+			}
+
+			const JSONValue* children = node->Find("children");
+			for (size_t i = (children != nullptr) ? children->Size() : 0; i > 0; i--)
+			{
+				size_t child = None;
+				if (!AsIndex(children->elements[i - 1], child))
+				{
+					error = "Malformed node hierarchy";
+					return false;
+				}
+				pending.push_back({ child, world });
+			}
+		}
+
+		return true;
+	}
+
+	std::string DecodeURI(const std::string& uri)
+	{
+		std::string decoded;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			unsigned int value = 0;
+			if ((uri[i] == '%') && (i + 2 < uri.size()) && (std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr == uri.data() + i + 3))
+			{
+				decoded.push_back(static_cast<char>(value));
+				i += 2;
+			}
+			else
+			{
+				decoded.push_back(uri[i]);
+			}
+		}
+		return decoded;
+	}
+
+	//the file an image of textures[textureIndex] is loaded from, empty for images embedded in the file
+	std::string TexturePath(const Document& document, const JSONValue* textureInfo, bool& embedded)
+	{
+		size_t textureIndex = None;
+		size_t imageIndex = None;
+		if ((textureInfo == nullptr) || !RequiredIndex(*textureInfo, "index", textureIndex))
+		{
+			return "";
+		}
+
+		const JSONValue* textures = document.json.Find("textures");
+		const JSONValue* texture = (textures != nullptr) ? textures->At(textureIndex) : nullptr;
+		const JSONValue* images = document.json.Find("images");
+		const JSONValue* image = ((texture != nullptr) && RequiredIndex(*texture, "source", imageIndex) && (images != nullptr)) ? images->At(imageIndex) : nullptr;
+		const JSONValue* uri = (image != nullptr) ? image->Find("uri") : nullptr;
+		if (image == nullptr)
+		{
+			return "";
+		}
+
+		if ((uri == nullptr) || (uri->type != JSONValue::Type::String) || (uri->string.compare(0, 5, "data:") == 0))
+		{
+			embedded = true;
+			return "";
+		}
+
+		//relative to the file like every glTF uri
+		std::filesystem::path directory = std::filesystem::path(document.filepath).parent_path();
+		return (directory / std::filesystem::path(DecodeURI(uri->string))).lexically_normal().generic_string();
+	}
+
+	GLBReader::Material ConvertMaterial(const Document& document, const JSONValue& material, bool& embedded)
+	{
+		GLBReader::Material converted;
+
+		float baseColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float metallic = 1.0f;
+		float roughness = 1.0f;
+
+		const JSONValue* pbr = material.Find("pbrMetallicRoughness");
+		std::string baseColorPath;
+		if (pbr != nullptr)
+		{
+			OptionalFloats(*pbr, "baseColorFactor", baseColor, 4);
+			metallic = std::clamp(OptionalFloat(*pbr, "metallicFactor", 1.0f), 0.0f, 1.0f);
+			roughness = std::clamp(OptionalFloat(*pbr, "roughnessFactor", 1.0f), 0.0f, 1.0f);
+			baseColorPath = TexturePath(document, pbr->Find("baseColorTexture"), embedded);
+		}
+		std::string occlusionPath = TexturePath(document, material.Find("occlusionTexture"), embedded);
+
+		//ambient multiplies the diffuse albedo in the light pass, so it is what occlusion leaves of it
+		for (int i = 0; i < 3; i++)
+		{
+			converted.Kd[i] = baseColor[i];
+			converted.Ka[i] = 1.0f;
+			converted.Ks[i] = 0.5f + (baseColor[i] - 0.5f) * metallic;
+		}
+
+		//the exponent Blender's OBJ exporter writes for the same roughness
+		converted.Ns = ((1.0f - roughness) * 30.0f) * ((1.0f - roughness) * 30.0f);
+
+		if (!baseColorPath.empty())
+		{
+			converted.textured = true;
+			converted.map_Kd = baseColorPath;
+			converted.map_Ka = occlusionPath.empty() ? baseColorPath : occlusionPath;
+			converted.map_Ks = baseColorPath;
+		}
+		return converted;
+	}
+
+	void ReadMaterials(const Document& document, std::vector<GLBReader::Material>& materials)
+	{
+		const JSONValue* list = document.json.Find("materials");
+
+		std::set<std::string> names;
+		bool embedded = false;
+		for (size_t i = 0; i < ((list != nullptr) ? list->Size() : 0); i++)
+		{
+			GLBReader::Material material = ConvertMaterial(document, list->elements[i], embedded);
+
+			const JSONValue* name = list->elements[i].Find("name");
+			std::string materialName = ((name != nullptr) && (name->type == JSONValue::Type::String) && !name->string.empty()) ? name->string : "material" + std::to_string(i);
+			if (!names.insert(materialName).second)
+			{
+				materialName += "#" + std::to_string(i);
+			}
+
+			material.name = document.filepath + ":" + materialName;
+			materials.push_back(material);
+		}
+
+		//glTF's default material, for primitives without one
+		GLBReader::Material fallback;
+		fallback.name = document.filepath + ":default";
+		materials.push_back(fallback);
+
+		if (embedded)
+		{
+			std::cerr << document.filepath << ": embedded images are not supported, their materials are drawn with their factors" << std::endl;
+		}
+	}
+
+	//the vertices of one set of attribute accessors under one transform, shared by every primitive that uses both
+	struct VertexRange
+	{
+		AccessorView position;
+		AccessorView normal;
+		AccessorView uv;
+		bool hasNormal = false;
+		bool hasUV = false;
+
+		const Matrix* matrix = nullptr;
+		bool flipped = false;
+		size_t base = 0;
+	};
+
+	struct Primitive
+	{
+		size_t range = 0;
+		bool indexed = false;
+		AccessorView indices;
+		size_t indexCount = 0;
+		std::string material;
+	};
+
+	bool IsIdentity(const Matrix& matrix)
+	{
+		return matrix == Identity;
+	}
+
+	//a range that already is an array of Vertex
+	bool Interleaved(const VertexRange& range)
+	{
+		return range.hasNormal && range.hasUV && (range.matrix == nullptr) &&
+			(range.position.componentType == ComponentFloat) && (range.position.components == 3) && (range.position.stride == sizeof(Vertex)) &&
+			(range.normal.componentType == ComponentFloat) && (range.normal.components == 3) && (range.normal.stride == sizeof(Vertex)) &&
+			(range.uv.componentType == ComponentFloat) && (range.uv.components == 2) && (range.uv.stride == sizeof(Vertex)) && !range.uv.normalized &&
+			(range.normal.data == range.position.data + Vertex::Offset<VertexAttribute::Normal>()) && (range.uv.data == range.position.data + Vertex::Offset<VertexAttribute::UV>()) &&
+			(range.normal.count == range.position.count) && (range.uv.count == range.position.count) &&
+			(reinterpret_cast<uintptr_t>(range.position.data) % alignof(Vertex) == 0);
+	}
+
+	//the components of element i, float ones are copied as they are
+	void ReadElement(const AccessorView& view, size_t i, float* values, size_t count)
+	{
+		const uint8_t* element = view.data + i * view.stride;
+		if (view.componentType == ComponentFloat)
+		{
+			memcpy(values, element, count * sizeof(float));
+			return;
+		}
+
+		for (size_t component = 0; component < count; component++)
+		{
+			values[component] = ReadComponent(element, view.componentType, view.normalized, component);
+		}
+	}
+
+	void GatherVertices(const VertexRange& range, Vertex* vertices)
+	{
+		for (size_t i = 0; i < range.position.count; i++)
+		{
+			Vertex& vertex = vertices[i];
+			ReadElement(range.position, i, vertex.pos, 3);
+
+			if (range.hasNormal && (i < range.normal.count))
+			{
+				ReadElement(range.normal, i, vertex.norm, 3);
+			}
+			else
+			{
+				vertex.norm[0] = vertex.norm[1] = vertex.norm[2] = 0.0f;
+			}
+
+			if (range.hasUV && (i < range.uv.count))
+			{
+				ReadElement(range.uv, i, vertex.uv, 2);
+			}
+			else
+			{
+				vertex.uv[0] = vertex.uv[1] = 0.0f;
+			}
+		}
+
+		if (range.matrix == nullptr)
+		{
+			return;
+		}
+
+		//normals go through the inverse transpose, the cofactors are that up to a scale the normalization removes
+		const Matrix& m = *range.matrix;
+		float cofactors[3][3];
+		for (int row = 0; row < 3; row++)
+		{
+			for (int column = 0; column < 3; column++)
+			{
+				int r1 = (row + 1) % 3;
+				int r2 = (row + 2) % 3;
+				int c1 = (column + 1) % 3;
+				int c2 = (column + 2) % 3;
+				cofactors[row][column] = m[c1 * 4 + r1] * m[c2 * 4 + r2] - m[c2 * 4 + r1] * m[c1 * 4 + r2];
+			}
+		}
+
+		for (size_t i = 0; i < range.position.count; i++)
+		{
+			Vertex& vertex = vertices[i];
+			float position[3];
+			float normal[3];
+			for (int row = 0; row < 3; row++)
+			{
+				position[row] = m[row] * vertex.pos[0] + m[4 + row] * vertex.pos[1] + m[8 + row] * vertex.pos[2] + m[12 + row];
+				normal[row] = cofactors[row][0] * vertex.norm[0] + cofactors[row][1] * vertex.norm[1] + cofactors[row][2] * vertex.norm[2];
+			}
+
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float scale = (length > 0.0f) ? (range.flipped ? -1.0f : 1.0f) / length : 0.0f;
+			for (int row = 0; row < 3; row++)
+			{
+				vertex.pos[row] = position[row];
+				vertex.norm[row] = normal[row] * scale;
+			}
+		}
+	}
+
+	//area weighted face normals for the vertices of ranges without any
+	void ComputeNormals(const std::vector<VertexRange>& ranges, Vertex* vertices, const uint32_t* indices, size_t indexCount)
+	{
+		std::vector<bool> missing;
+		for (const VertexRange& range : ranges)
+		{
+			missing.resize(range.base + range.position.count, !range.hasNormal);
+		}
+
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const float* a = vertices[indices[i]].pos;
+			const float* b = vertices[indices[i + 1]].pos;
+			const float* c = vertices[indices[i + 2]].pos;
+
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				if (missing[indices[i + corner]])
+				{
+					for (int component = 0; component < 3; component++)
+					{
+						vertices[indices[i + corner]].norm[component] += normal[component];
+					}
+				}
+			}
+		}
+
+		for (size_t vertex = 0; vertex < missing.size(); vertex++)
+		{
+			float* normal = vertices[vertex].norm;
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (missing[vertex] && (length > 0.0f))
+			{
+				normal[0] /= length;
+				normal[1] /= length;
+				normal[2] /= length;
+			}
+		}
+	}
+
+	bool MapMesh(const Document& document, GLBReader::MappedMesh& mesh, bool& viewedVertices, bool& viewedIndices, std::string& error)
+	{
+		std::vector<Draw> draws;
+		if (!CollectDraws(document, draws, error))
+		{
+			return false;
+		}
+
+		ReadMaterials(document, mesh.materials);
+
+		std::vector<VertexRange> ranges;
+		std::map<std::array<size_t, 4>, size_t> rangeIndices;
+		std::vector<Primitive> primitives;
+
+		const JSONValue* meshes = document.json.Find("meshes");
+		for (size_t draw = 0; draw < draws.size(); draw++)
+		{
+			const JSONValue* primitiveList = meshes->At(draws[draw].mesh)->Find("primitives");
+			bool identity = IsIdentity(draws[draw].matrix);
+
+			for (size_t i = 0; i < ((primitiveList != nullptr) ? primitiveList->Size() : 0); i++)
+			{
+				const JSONValue& primitiveValue = primitiveList->elements[i];
+				const JSONValue* attributes = primitiveValue.Find("attributes");
+
+				size_t mode = TrianglesMode;
+				size_t position = None;
+				size_t normal = None;
+				size_t uv = None;
+				size_t indices = None;
+				size_t material = None;
+				if ((attributes == nullptr) || !RequiredIndex(*attributes, "POSITION", position) || !OptionalIndex(*attributes, "NORMAL", normal) ||
+					!OptionalIndex(*attributes, "TEXCOORD_0", uv) || !OptionalIndex(primitiveValue, "indices", indices) ||
+					!OptionalIndex(primitiveValue, "material", material) || !OptionalIndex(primitiveValue, "mode", mode))
+				{
+					error = "Malformed primitive";
+					return false;
+				}
+				if (mode != TrianglesMode)
+				{
+					error = "Only triangle primitives are supported";
+					return false;
+				}
+
+				//primitives of one mesh often share their attributes, they then share one range of vertices
+				std::array<size_t, 4> key = { position, normal, uv, identity ? None : draw };
+				std::map<std::array<size_t, 4>, size_t>::iterator found = rangeIndices.find(key);
+
+				Primitive primitive;
+				if (found != rangeIndices.end())
+				{
+					primitive.range = found->second;
+				}
+				else
+				{
+					VertexRange range;
+					range.hasNormal = normal != None;
+					range.hasUV = uv != None;
+					if (!ResolveAccessor(document, position, range.position, error) ||
+						(range.hasNormal && !ResolveAccessor(document, normal, range.normal, error)) ||
+						(range.hasUV && !ResolveAccessor(document, uv, range.uv, error)))
+					{
+						return false;
+					}
+
+					if ((range.position.components != 3) || (range.hasNormal && (range.normal.components != 3)) || (range.hasUV && (range.uv.components != 2)))
+					{
+						error = "Unexpected attribute type";
+						return false;
+					}
+
+					if (!identity)
+					{
+						const Matrix& m = draws[draw].matrix;
+						float determinant = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+						range.matrix = &draws[draw].matrix;
+						range.flipped = determinant < 0.0f;
+					}
+
+					range.base = ranges.empty() ? 0 : ranges.back().base + ranges.back().position.count;
+					primitive.range = ranges.size();
+					rangeIndices[key] = ranges.size();
+					ranges.push_back(range);
+				}
+
+				const VertexRange& range = ranges[primitive.range];
+				primitive.indexed = indices != None;
+				if (primitive.indexed)
+				{
+					if (!ResolveAccessor(document, indices, primitive.indices, error))
+					{
+						return false;
+					}
+					if ((primitive.indices.components != 1) || ((primitive.indices.componentType != ComponentUnsignedByte) &&
+						(primitive.indices.componentType != ComponentUnsignedShort) && (primitive.indices.componentType != ComponentUnsignedInt)))
+					{
+						error = "Unexpected index type";
+						return false;
+					}
+					primitive.indexCount = primitive.indices.count;
+				}
+				else
+				{
+					primitive.indexCount = range.position.count;
+				}
+
+				if (primitive.indexCount % 3 != 0)
+				{
+					error = "Triangle list with an incomplete triangle";
+					return false;
+				}
+
+				//the default material is the last one
+				if (material == None)
+				{
+					material = mesh.materials.size() - 1;
+				}
+				else if (material >= mesh.materials.size() - 1)
+				{
+					error = "Primitive refers to a material that does not exist";
+					return false;
+				}
+				primitive.material = mesh.materials[material].name;
+
+				primitives.push_back(primitive);
+			}
+		}
+
+		if (primitives.empty())
+		{
+			error = "No triangles";
+			return false;
+		}
+
+		//vertices can be used where they lie when every range is already interleaved and they follow one another
+		size_t vertexCount = ranges.back().base + ranges.back().position.count;
+		viewedVertices = true;
+		for (size_t i = 0; i < ranges.size(); i++)
+		{
+			viewedVertices &= Interleaved(ranges[i]) && ((i == 0) || (ranges[i].position.data == ranges[i - 1].position.data + ranges[i - 1].position.count * sizeof(Vertex)));
+		}
+
+		if (viewedVertices)
+		{
+			mesh.vertices = reinterpret_cast<const Vertex*>(ranges[0].position.data);
+		}
+		else
+		{
+			mesh.gatheredVertices.resize(vertexCount);
+			for (const VertexRange& range : ranges)
+			{
+				GatherVertices(range, mesh.gatheredVertices.data() + range.base);
+			}
+			mesh.vertices = mesh.gatheredVertices.data();
+		}
+		mesh.vertexCount = vertexCount;
+
+		bool missingNormals = false;
+		for (const VertexRange& range : ranges)
+		{
+			missingNormals |= !range.hasNormal;
+		}
+
+		//the same for indices, which also need no offset for that, so all of them index the one range.
+		//Normals computed from the triangles are added up over gathered indices
+		size_t indexSize = primitives[0].indexed ? ComponentSize(primitives[0].indices.componentType) : 0;
+		viewedIndices = (ranges.size() == 1) && !ranges[0].flipped && !missingNormals && ((indexSize == 2) || (indexSize == 4));
+		for (size_t i = 0; viewedIndices && (i < primitives.size()); i++)
+		{
+			const AccessorView& indices = primitives[i].indices;
+			viewedIndices = primitives[i].indexed && (ComponentSize(indices.componentType) == indexSize) && (indices.stride == indexSize) &&
+				(reinterpret_cast<uintptr_t>(indices.data) % indexSize == 0) &&
+				((i == 0) || (indices.data == primitives[i - 1].indices.data + primitives[i - 1].indices.count * indexSize));
+		}
+
+		size_t indexCount = 0;
+		for (const Primitive& primitive : primitives)
+		{
+			Submesh submesh;
+			submesh.Start = static_cast<int>(indexCount);
+			submesh.size = static_cast<int>(primitive.indexCount);
+			mesh.submeshes.push_back(submesh);
+			mesh.submeshMaterials.push_back(primitive.material);
+
+			indexCount += primitive.indexCount;
+		}
+		mesh.indexCount = indexCount;
+
+		if (viewedIndices)
+		{
+			//the indices are never copied, but a bad one must not reach the buffers
+			uint32_t largest = 0;
+			for (const Primitive& primitive : primitives)
+			{
+				for (size_t i = 0; i < primitive.indexCount; i++)
+				{
+					largest = std::max(largest, ReadIndex(primitive.indices.data + i * indexSize, primitive.indices.componentType));
+				}
+			}
+			if (largest >= vertexCount)
+			{
+				error = "Index past the vertices of its primitive";
+				return false;
+			}
+
+			mesh.indices = primitives[0].indices.data;
+			mesh.indexSize = indexSize;
+			return true;
+		}
+
+		mesh.gatheredIndices.resize(indexCount);
+		uint32_t* output = mesh.gatheredIndices.data();
+		for (const Primitive& primitive : primitives)
+		{
+			const VertexRange& range = ranges[primitive.range];
+			for (size_t i = 0; i < primitive.indexCount; i++)
+			{
+				uint32_t index = primitive.indexed ? ReadIndex(primitive.indices.data + i * primitive.indices.stride, primitive.indices.componentType) : static_cast<uint32_t>(i);
+				if (index >= range.position.count)
+				{
+					error = "Index past the vertices of its primitive";
+					return false;
+				}
+				output[i] = static_cast<uint32_t>(range.base + index);
+			}
+
+			//a mirroring transform turns the triangles around
+			if (range.flipped)
+			{
+				for (size_t i = 0; i < primitive.indexCount; i += 3)
+				{
+					std::swap(output[i + 1], output[i + 2]);
+				}
+			}
+			output += primitive.indexCount;
+		}
+		mesh.indices = mesh.gatheredIndices.data();
+		mesh.indexSize = sizeof(uint32_t);
+
+		if (missingNormals)
+		{
+			ComputeNormals(ranges, mesh.gatheredVertices.data(), mesh.gatheredIndices.data(), indexCount);
+		}
+
+		return true;
+	}
+
+	bool ParseFile(const std::string& GLBFilepath, Asset& file, Document& document)
+	{
+		if (!AssetPack::Open(GLBFilepath, file))
+		{
+			std::cerr << "Failed to open glb filepath: " << GLBFilepath << std::endl;
+			return false;
+		}
+
+		std::string error;
+		document.filepath = GLBFilepath;
+		if (!ParseContainer(file.Data(), file.Size(), document, error))
+		{
+			std::cerr << error << " in " << GLBFilepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+double GLBReader::ReadStats::MegabytesPerSecond() const
+{
+	if (seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / seconds;
+}
+
+bool GLBReader::IsGLB(const std::string& filepath)
+{
+	std::string extension = std::filesystem::path(filepath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char character) { return static_cast<char>(tolower(static_cast<unsigned char>(character))); });
+	return extension == ".glb";
+}
+
+bool GLBReader::Map(const std::string& GLBFilepath, MappedMesh& mesh, ReadStats* stats)
+{
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+	mesh = MappedMesh();
+
+	Document document;
+	if (!ParseFile(GLBFilepath, mesh.file, document))
+	{
+		return false;
+	}
+
+	bool viewedVertices = false;
+	bool viewedIndices = false;
+	std::string error;
+	if (!MapMesh(document, mesh, viewedVertices, viewedIndices, error))
+	{
+		std::cerr << error << " in " << GLBFilepath << std::endl;
+		return false;
+	}
+
+	mesh.bounds = MeshBounds::Compute(mesh.vertices, mesh.vertexCount);
+
+	if (stats != nullptr)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		stats->bytes = mesh.file.Size();
+		stats->seconds = elapsed.count();
+		stats->viewedVertices = viewedVertices;
+		stats->viewedIndices = viewedIndices;
+	}
+
+	return true;
+}
+
+bool GLBReader::Read(const std::string& GLBFilepath, MeshData& mesh, ReadStats* stats)
+{
+	MappedMesh mapped;
+	if (!Map(GLBFilepath, mapped, stats))
+	{
+		return false;
+	}
+
+	mesh.vertices.assign(mapped.vertices, mapped.vertices + mapped.vertexCount);
+
+	if (mapped.indexSize == sizeof(uint32_t))
+	{
+		const uint32_t* indices = static_cast<const uint32_t*>(mapped.indices);
+		mesh.indices.assign(indices, indices + mapped.indexCount);
+	}
+	else
+	{
+		mesh.indices.resize(mapped.indexCount);
+		const uint8_t* indices = static_cast<const uint8_t*>(mapped.indices);
+		for (size_t i = 0; i < mapped.indexCount; i++)
+		{
+			uint16_t index;
+			memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+			mesh.indices[i] = index;
+		}
+	}
+
+	mesh.submeshes = std::move(mapped.submeshes);
+	mesh.submeshMaterials = std::move(mapped.submeshMaterials);
+	mesh.materialLibraries = { GLBFilepath };
+	mesh.bounds = mapped.bounds;
+	return true;
+}
+
+bool GLBReader::ReadMaterials(const std::string& GLBFilepath, std::vector<Material>& materials)
+{
+	Asset file;
+	Document document;
+	if (!ParseFile(GLBFilepath, file, document))
+	{
+		return false;
+	}
+
+	::ReadMaterials(document, materials);
+	return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MeshData.h"
+#include "AssetPack.h"
+
+//Binary glTF 2.0 import straight out of the mapped file, or out of the mounted AssetPack. Only the JSON chunk is parsed, vertex and index
+//data is taken from the buffer views as they are.
+//Triangles of every mesh the default scene places are merged into one mesh, a primitive becomes a submesh. UVs are used as glTF stores them,
+//which samples the same as the flipped ones of an OBJ with the wrapping sampler
+namespace GLBReader
+{
+	//the MTL material a glTF one comes closest to, so it is drawn by the same materials as an OBJ.
+	//baseColor becomes the diffuse map, occlusion the ambient one and the specular map is the diffuse one tinted by metalness
+	struct Material
+	{
+		//"<file>:<material name>", glTF names are optional and only unique within their file
+		std::string name;
+
+		bool textured = false;
+		float Ns = 0.0f;
+		float Ka[3] = { 1.0f, 1.0f, 1.0f };
+		float Kd[3] = { 1.0f, 1.0f, 1.0f };
+		float Ks[3] = { 0.5f, 0.5f, 0.5f };
+
+		//relative to the working directory like every other texture path
+		std::string map_Ka;
+		std::string map_Kd;
+		std::string map_Ks;
+	};
+
+	struct ReadStats
+	{
+		size_t bytes = 0;
+		double seconds = 0.0;
+
+		//Map only: the arrays point into the file instead of into gathered copies
+		bool viewedVertices = false;
+		bool viewedIndices = false;
+
+		double MegabytesPerSecond() const;
+	};
+
+	//a mesh mapped from a .glb. vertices and indices point into the file where their buffer views are laid out as the GPU buffers want them,
+	//interleaved Vertex and unsigned short or int indices of one range, else into the gathered copies. Valid as long as this object lives
+	struct MappedMesh
+	{
+		Asset file;
+		std::vector<Vertex> gatheredVertices;
+		std::vector<uint32_t> gatheredIndices;
+
+		const Vertex* vertices = nullptr;
+		size_t vertexCount = 0;
+
+		//2 or 4 byte indices, gathered ones are always 4
+		const void* indices = nullptr;
+		size_t indexCount = 0;
+		size_t indexSize = sizeof(uint32_t);
+
+		std::vector<Submesh> submeshes;
+		std::vector<std::string> submeshMaterials;
+		std::vector<Material> materials;
+
+		Bounds bounds;
+	};
+
+	bool IsGLB(const std::string& filepath);
+
+	//fails on anything but triangles, sparse accessors and buffers outside the file, and on indices past the vertices
+	bool Map(const std::string& GLBFilepath, MappedMesh& mesh, ReadStats* stats = nullptr);
+
+	//copies the mesh into MeshData for the imports that build on it. The file stands in for the material library, it carries its own materials
+	bool Read(const std::string& GLBFilepath, MeshData& mesh, ReadStats* stats = nullptr);
+
+	//only parses the JSON chunk
+	bool ReadMaterials(const std::string& GLBFilepath, std::vector<Material>& materials);
+}
@@ -0,0 +1,199 @@
+#include "InstanceBatcher.h"
+#include <iostream>
+
+#include "Pipeline.h"
+#include "SharedResources.h"
+
+InstanceBatcher::InstanceBatcher() : transformBuffer(nullptr), transformSRV(nullptr), capacity(0)
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+	if (transformBuffer != nullptr)
+	{
+		transformBuffer->Release();
+		transformSRV->Release();
+	}
+}
+
+bool InstanceBatcher::Add(Object* object)
+{
+	MeshResource* mesh = nullptr;
+	const std::vector<Submesh>* submeshes = nullptr;
+	if (!object->InstanceBatch(mesh, submeshes))
+	{
+		return false;
+	}
+
+	groups.Add(mesh, submeshes, object);
+	return true;
+}
+
+void InstanceBatcher::Render()
+{
+	Draw(true);
+}
+
+void InstanceBatcher::DepthRender()
+{
+	Draw(false);
+}
+
+bool InstanceBatcher::Reserve(UINT instanceCount)
+{
+	if (instanceCount <= capacity)
+	{
+		return true;
+	}
+
+	UINT newCapacity = (capacity == 0) ? 64 : capacity;
+	while (newCapacity < instanceCount)
+	{
+		newCapacity *= 2;
+	}
+
+	if (transformBuffer != nullptr)
+	{
+		transformBuffer->Release();
+		transformSRV->Release();
+		transformBuffer = nullptr;
+		transformSRV = nullptr;
+	}
+	capacity = 0;
+
+	D3D11_BUFFER_DESC bufferDesc;
+
+	bufferDesc.ByteWidth = sizeof(DirectX::XMFLOAT4X4) * 2 * newCapacity;
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(DirectX::XMFLOAT4X4) * 2;
+
+	if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, nullptr, &transformBuffer)))
+	{
+		std::cerr << "Failed to set up instance transform buffer!" << std::endl;
+		transformBuffer = nullptr;
+		return false;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+
+	D3D11_BUFFER_SRV bufSRV = {};
+	bufSRV.NumElements = newCapacity;
+	srvDesc.Buffer = bufSRV;
+
+	if (FAILED(Pipeline::Device()->CreateShaderResourceView(transformBuffer, &srvDesc, &transformSRV)))
+	{
+		std::cerr << "Failed to set up instance transform buffer SRV" << std::endl;
+		transformBuffer->Release();
+		transformBuffer = nullptr;
+		transformSRV = nullptr;
+		return false;
+	}
+
+	capacity = newCapacity;
+	return true;
+}
+
+void InstanceBatcher::Draw(bool materials)
+{
+	for (size_t i = 0; i < groups.Size(); i++)
+	{
+		const Instancing::Groups<MeshResource, Object*>::Group& group = groups[i];
+		UINT instanceCount = static_cast<UINT>(group.items.size());
+
+		if ((instanceCount < Instancing::MinimumInstances) || !Reserve(instanceCount))
+		{
+			for (Object* object : group.items)
+			{
+				if (materials)
+				{
+					object->Render();
+				}
+				else
+				{
+					object->DepthRender();
+				}
+			}
+			continue;
+		}
+
+		//same layout as the ObjectTransform buffer of a single object, already transposed for the shader
+		transforms.clear();
+		for (Object* object : group.items)
+		{
+			transforms.push_back(object->TransformMatrix());
+			transforms.push_back(object->InverseTransformMatrix());
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
+
+		Pipeline::ResourceManipulation::MapBuffer(transformBuffer, &mappedResource);
+		memcpy(mappedResource.pData, transforms.data(), sizeof(DirectX::XMFLOAT4X4) * transforms.size());
+		Pipeline::ResourceManipulation::UnmapBuffer(transformBuffer);
+
+		const MeshResource* mesh = group.mesh;
+		UINT stride = materials ? mesh->vertexStride : sizeof(PositionVertex);
+		UINT offset = 0;
+
+		//depth passes only fetch positions
+		Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, materials ? mesh->vertexBuffer : mesh->positionBuffer);
+		Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(mesh->indexBuffer, mesh->indexFormat);
+		Pipeline::Deferred::GeometryPass::VertexShader::Bind::InstanceTransforms(transformSRV);
+
+		if (materials)
+		{
+			SharedResources::BindMeshVertexShader(*mesh, true);
+		}
+		else
+		{
+			SharedResources::BindVertexShader(SharedResources::vShader::VSDepthInstanced);
+		}
+		Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		//without materials the whole level is one draw
+		Submesh range;
+		if (!materials && Instancing::CoveringRange(*group.submeshes, range))
+		{
+			if (range.size > 0)
+			{
+				Pipeline::DrawIndexedInstanced(range.size, range.Start, instanceCount, mesh->positionBaseVertex);
+			}
+			continue;
+		}
+
+		int previousMaterial = -1;
+		for (Submesh submesh : *group.submeshes)
+		{
+			//coarse levels can lose every triangle of a submesh
+			if (submesh.size == 0)
+			{
+				continue;
+			}
+
+			if (materials)
+			{
+				if (submesh.material == -1)
+				{
+					//extra precaution, should not happen during correct execution.
+					submesh.material = 0;
+				}
+
+				if (submesh.material != previousMaterial)
+				{
+					previousMaterial = submesh.material;
+					SharedResources::BindMaterial(submesh.material);
+				}
+			}
+
+			Pipeline::DrawIndexedInstanced(submesh.size, submesh.Start, instanceCount, materials ? submesh.baseVertex : mesh->positionBaseVertex);
+		}
+	}
+
+	groups.Clear();
+}
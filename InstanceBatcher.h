@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <d3d11.h>
+#include <DirectXMath.h>
+
+#include "BaseObject.h"
+#include "MeshData.h"
+#include "Instancing.h"
+
+struct MeshResource;
+
+//one per renderer, objects are queued while the renderer walks its object lists and drawn once it is done with them
+class InstanceBatcher
+{
+public:
+	InstanceBatcher();
+	~InstanceBatcher();
+
+	InstanceBatcher(const InstanceBatcher&) = delete;
+	InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+	//queues object for the next Render or DepthRender, false when it can not be instanced and has to be drawn on its own
+	bool Add(Object* object);
+
+	//draws everything queued since the last call and empties the queue
+	void Render();
+	void DepthRender();
+
+private:
+	Instancing::Groups<MeshResource, Object*> groups;
+
+	//world and inverse world matrix of every instance of one group, rewritten before each group is drawn
+	ID3D11Buffer* transformBuffer;
+	ID3D11ShaderResourceView* transformSRV;
+	UINT capacity;
+
+	std::vector<DirectX::XMFLOAT4X4> transforms;
+
+	bool Reserve(UINT instanceCount);
+
+	void Draw(bool materials);
+};
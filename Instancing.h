@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <utility>
+#include <climits>
+
+#include "MeshData.h"
+
+//Grouping of visible objects that share a mesh and level of detail, so each group is drawn with one DrawIndexedInstanced per submesh
+//instead of one DrawIndexed per object and submesh, or one per level in passes that bind no material. InstanceBatcher does the drawing.
+namespace Instancing
+{
+	//a group of fewer objects is handed back to Render and DepthRender, so a lone object keeps its meshlet culling
+	const size_t MinimumInstances = 2;
+
+	//the single index range of all submeshes of a level, so passes that bind no material draw it at once.
+	//False when the submeshes are not laid out one after another, they have to be drawn one by one then
+	inline bool CoveringRange(const std::vector<Submesh>& submeshes, Submesh& range)
+	{
+		range = Submesh();
+		int end = INT_MIN;
+		for (const Submesh& submesh : submeshes)
+		{
+			//coarse levels can lose every triangle of a submesh
+			if (submesh.size == 0)
+			{
+				continue;
+			}
+
+			if (end == INT_MIN)
+			{
+				range.Start = submesh.Start;
+				range.baseVertex = submesh.baseVertex;
+			}
+			else if (submesh.Start != end)
+			{
+				return false;
+			}
+			end = submesh.Start + submesh.size;
+		}
+
+		range.size = (end == INT_MIN) ? 0 : end - range.Start;
+		return true;
+	}
+
+	//sorts items by mesh and submesh list, groups keep the order they were first seen in
+	template<typename Mesh, typename Item>
+	class Groups
+	{
+	public:
+		struct Group
+		{
+			const Mesh* mesh;
+			const std::vector<Submesh>* submeshes;
+			std::vector<Item> items;
+		};
+
+		void Add(const Mesh* mesh, const std::vector<Submesh>* submeshes, Item item)
+		{
+			auto found = lookup.try_emplace(std::make_pair(static_cast<const void*>(mesh), static_cast<const void*>(submeshes)), used);
+			if (found.second)
+			{
+				//the groups of earlier frames are reused, so their item vectors keep their memory
+				if (used == groups.size())
+				{
+					groups.emplace_back();
+				}
+				groups[used].mesh = mesh;
+				groups[used].submeshes = submeshes;
+				used++;
+			}
+			groups[found.first->second].items.push_back(item);
+		}
+
+		void Clear()
+		{
+			for (size_t i = 0; i < used; i++)
+			{
+				groups[i].items.clear();
+			}
+			used = 0;
+			lookup.clear();
+		}
+
+		size_t Size() const
+		{
+			return used;
+		}
+
+		const Group& operator[](size_t index) const
+		{
+			return groups[index];
+		}
+
+	private:
+		std::vector<Group> groups;
+		size_t used = 0;
+
+		std::map<std::pair<const void*, const void*>, size_t> lookup;
+	};
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include <cstdint>
+
+//Assignment of material textures to texture arrays: textures of the same format, size and mip count share an array and each gets one slice.
+//MaterialTable creates the arrays.
+namespace MaterialPacking
+{
+	//texture arrays the material table pixel shader has registers for
+	const int ArraySlots = 8;
+
+	//D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION, a full array starts another one of the same key
+	const int MaxSlices = 2048;
+
+	struct TextureKey
+	{
+		uint32_t format = 0;
+		int width = 0;
+		int height = 0;
+		int levels = 0;
+
+		bool operator<(const TextureKey& other) const
+		{
+			return std::tie(format, width, height, levels) < std::tie(other.format, other.width, other.height, other.levels);
+		}
+	};
+
+	struct Slot
+	{
+		//-1 when every array slot was taken before the texture was reached
+		int array = -1;
+		int slice = 0;
+	};
+
+	struct Layout
+	{
+		std::vector<TextureKey> arrays;
+		std::vector<int> arraySizes;
+
+		//one per packed texture, in the order they were given
+		std::vector<Slot> slots;
+	};
+
+	//one more texture after the ones already in layout, slots given earlier never move
+	inline Slot Append(Layout& layout, const TextureKey& texture)
+	{
+		Slot slot;
+
+		//the last array of a key is the one that can still have free slices
+		int found = -1;
+		for (int a = static_cast<int>(layout.arrays.size()) - 1; (a >= 0) && (found < 0); a--)
+		{
+			if (!(layout.arrays[a] < texture) && !(texture < layout.arrays[a]))
+			{
+				found = a;
+			}
+		}
+
+		if ((found < 0) || (layout.arraySizes[found] == MaxSlices))
+		{
+			if (static_cast<int>(layout.arrays.size()) < ArraySlots)
+			{
+				layout.arrays.push_back(texture);
+				layout.arraySizes.push_back(0);
+				found = static_cast<int>(layout.arrays.size()) - 1;
+			}
+			else
+			{
+				found = -1;
+			}
+		}
+
+		if (found >= 0)
+		{
+			slot.array = found;
+			slot.slice = layout.arraySizes[found]++;
+		}
+		layout.slots.push_back(slot);
+		return slot;
+	}
+
+	//arrays are opened in order of first use, so the textures of the first materials always get a slot
+	inline Layout Pack(const std::vector<TextureKey>& textures)
+	{
+		Layout layout;
+		for (const TextureKey& texture : textures)
+		{
+			Append(layout, texture);
+		}
+		return layout;
+	}
+
+	//slices an array is created with for slices textures, the spare ones take the textures of later materials without a new array
+	inline int Reserve(int slices)
+	{
+		int reserved = 4;
+		while ((reserved < slices) && (reserved < MaxSlices))
+		{
+			reserved *= 2;
+		}
+		return reserved;
+	}
+}
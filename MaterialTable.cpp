@@ -0,0 +1,348 @@
+#include "MaterialTable.h"
+#include <iostream>
+#include <map>
+#include <cstring>
+#include <algorithm>
+
+#include "Pipeline.h"
+#include "SharedResources.h"
+
+MaterialTable::MaterialTable() : dirty(false), updatedRows(0), tableBuffer(nullptr), tableSRV(nullptr), tableCapacity(0), arraySRVs(), indexBuffer(nullptr), bound(false), boundVersion(0)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+
+	bufferDesc.ByteWidth = sizeof(UINT) * 4;
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, nullptr, &indexBuffer)))
+	{
+		std::cerr << "Failed to set up material index buffer!" << std::endl;
+		indexBuffer = nullptr;
+	}
+}
+
+MaterialTable::~MaterialTable()
+{
+	Release();
+
+	if (indexBuffer != nullptr)
+	{
+		indexBuffer->Release();
+	}
+}
+
+void MaterialTable::Release()
+{
+	if (tableBuffer != nullptr)
+	{
+		tableBuffer->Release();
+		tableBuffer = nullptr;
+	}
+
+	if (tableSRV != nullptr)
+	{
+		tableSRV->Release();
+		tableSRV = nullptr;
+	}
+
+	ReleaseArrays();
+
+	tableCapacity = 0;
+	updatedRows = 0;
+	layout = MaterialPacking::Layout();
+	textureIDs.clear();
+	packed.clear();
+	contained.clear();
+	bound = false;
+}
+
+void MaterialTable::ReleaseArrays()
+{
+	for (ID3D11Texture2D* texture : arrays)
+	{
+		texture->Release();
+	}
+	arrays.clear();
+	arrayCapacities.clear();
+
+	for (ID3D11ShaderResourceView*& SRV : arraySRVs)
+	{
+		if (SRV != nullptr)
+		{
+			SRV->Release();
+			SRV = nullptr;
+		}
+	}
+}
+
+void MaterialTable::Add(const MaterialData& material, int ambientMap, int diffuseMap, int specularMap)
+{
+	Row row = {};
+	row.Ns = material.Ns;
+	row.textured = material.textured ? 1 : 0;
+	for (int i = 0; i < 3; i++)
+	{
+		row.Ka[i] = material.Ka[i];
+		row.Kd[i] = material.Kd[i];
+		row.Ks[i] = material.Ks[i];
+	}
+
+	rows.push_back(row);
+	maps.push_back(ambientMap);
+	maps.push_back(diffuseMap);
+	maps.push_back(specularMap);
+	dirty = true;
+}
+
+bool MaterialTable::Contains(int materialID, Textures& textures)
+{
+	if (dirty)
+	{
+		Update(textures);
+	}
+	return (materialID >= 0) && (static_cast<size_t>(materialID) < contained.size()) && contained[materialID];
+}
+
+void MaterialTable::Bind(int materialID, Textures& textures)
+{
+	if (dirty)
+	{
+		Update(textures);
+	}
+
+	//anything else that touched the pixel shader state since replaced part of the bind set
+	if (!bound || (boundVersion != Pipeline::Deferred::GeometryPass::PixelShader::StateVersion()))
+	{
+		SharedResources::BindPixelShader(SharedResources::pShader::PSMaterialTable);
+		Pipeline::Deferred::GeometryPass::PixelShader::Bind::MaterialTable(tableSRV, arraySRVs, MaterialPacking::ArraySlots);
+		Pipeline::Deferred::GeometryPass::PixelShader::Bind::MaterialParameters(indexBuffer);
+
+		bound = true;
+		boundVersion = Pipeline::Deferred::GeometryPass::PixelShader::StateVersion();
+		Pipeline::Statistics::CountMaterialBind();
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	Pipeline::ResourceManipulation::MapBuffer(indexBuffer, &mappedResource);
+	UINT index[4] = { static_cast<UINT>(materialID), 0, 0, 0 };
+	memcpy(mappedResource.pData, index, sizeof(index));
+	Pipeline::ResourceManipulation::UnmapBuffer(indexBuffer);
+}
+
+bool MaterialTable::Update(Textures& textures)
+{
+	if (!dirty)
+	{
+		return tableSRV != nullptr;
+	}
+	dirty = false;
+
+	if (indexBuffer == nullptr)
+	{
+		contained.assign(rows.size(), false);
+		return false;
+	}
+
+	//maps of the new rows that no earlier row used take the next slices, the slots of the rows before never move
+	size_t firstNew = textureIDs.size();
+	bool outgrown = false;
+	for (size_t row = updatedRows; row < rows.size(); row++)
+	{
+		for (int map = 0; (map < 3) && (rows[row].textured != 0); map++)
+		{
+			int textureID = maps[row * 3 + map];
+			if (!packed.try_emplace(textureID, textureIDs.size()).second)
+			{
+				continue;
+			}
+			textureIDs.push_back(textureID);
+
+			D3D11_TEXTURE2D_DESC textureDesc;
+			textures.GetTexture(textureID)->GetDesc(&textureDesc);
+			MaterialPacking::Slot slot = MaterialPacking::Append(layout, { static_cast<uint32_t>(textureDesc.Format), static_cast<int>(textureDesc.Width), static_cast<int>(textureDesc.Height), static_cast<int>(textureDesc.MipLevels) });
+
+			outgrown |= (slot.array >= 0) && ((slot.array >= static_cast<int>(arrays.size())) || (slot.slice >= arrayCapacities[slot.array]));
+		}
+	}
+
+	if (outgrown)
+	{
+		if (!CreateArrays(textures))
+		{
+			Release();
+			return false;
+		}
+	}
+	else
+	{
+		for (size_t i = firstNew; i < textureIDs.size(); i++)
+		{
+			CopyIntoArray(i, textures);
+		}
+	}
+
+	contained.resize(rows.size(), false);
+	for (size_t row = updatedRows; row < rows.size(); row++)
+	{
+		if (rows[row].textured == 0)
+		{
+			contained[row] = true;
+			continue;
+		}
+
+		UINT* rowMaps[3] = { rows[row].ambientMap, rows[row].diffuseMap, rows[row].specularMap };
+		bool fits = true;
+		for (int map = 0; map < 3; map++)
+		{
+			int textureID = maps[row * 3 + map];
+			const MaterialPacking::Slot& slot = layout.slots[packed[textureID]];
+
+			fits &= (slot.array >= 0);
+			rowMaps[map][0] = static_cast<UINT>(std::max(slot.array, 0));
+			rowMaps[map][1] = static_cast<UINT>(slot.slice);
+			rowMaps[map][2] = textures.SingleChannel(textureID) ? 1 : 0;
+			rowMaps[map][3] = 0;
+		}
+		contained[row] = fits;
+	}
+
+	if (rows.size() > tableCapacity)
+	{
+		if (!CreateTable())
+		{
+			Release();
+			return false;
+		}
+	}
+	else
+	{
+		Pipeline::ResourceManipulation::UpdateBuffer(tableBuffer, static_cast<UINT>(sizeof(Row) * updatedRows), rows.data() + updatedRows, static_cast<UINT>(sizeof(Row) * (rows.size() - updatedRows)));
+	}
+
+	updatedRows = rows.size();
+	return true;
+}
+
+bool MaterialTable::CreateArrays(Textures& textures)
+{
+	ReleaseArrays();
+	bound = false;
+
+	for (size_t a = 0; a < layout.arrays.size(); a++)
+	{
+		const MaterialPacking::TextureKey& key = layout.arrays[a];
+
+		D3D11_TEXTURE2D_DESC arrayDesc;
+		arrayDesc.Width = key.width;
+		arrayDesc.Height = key.height;
+		arrayDesc.MipLevels = key.levels;
+		arrayDesc.ArraySize = MaterialPacking::Reserve(layout.arraySizes[a]);
+		arrayDesc.Format = static_cast<DXGI_FORMAT>(key.format);
+		arrayDesc.SampleDesc.Count = 1;
+		arrayDesc.SampleDesc.Quality = 0;
+		arrayDesc.Usage = D3D11_USAGE_DEFAULT;
+		arrayDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		arrayDesc.CPUAccessFlags = 0;
+		arrayDesc.MiscFlags = 0;
+
+		ID3D11Texture2D* array;
+		if (FAILED(Pipeline::Device()->CreateTexture2D(&arrayDesc, nullptr, &array)))
+		{
+			std::cerr << "Failed to create material texture array" << std::endl;
+			return false;
+		}
+		arrays.push_back(array);
+		arrayCapacities.push_back(static_cast<int>(arrayDesc.ArraySize));
+
+		if (FAILED(Pipeline::Device()->CreateShaderResourceView(array, nullptr, &arraySRVs[a])))
+		{
+			std::cerr << "Failed to create material texture array SRV" << std::endl;
+			arraySRVs[a] = nullptr;
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < textureIDs.size(); i++)
+	{
+		CopyIntoArray(i, textures);
+	}
+	return true;
+}
+
+void MaterialTable::CopyIntoArray(size_t packedIndex, Textures& textures)
+{
+	const MaterialPacking::Slot& slot = layout.slots[packedIndex];
+	if (slot.array < 0)
+	{
+		return;
+	}
+
+	//copied on the GPU, the textures keep their own copy for materials that are bound on their own
+	UINT levels = static_cast<UINT>(layout.arrays[slot.array].levels);
+	for (UINT level = 0; level < levels; level++)
+	{
+		Pipeline::ResourceManipulation::CopySubresource(arrays[slot.array], D3D11CalcSubresource(level, slot.slice, levels), textures.GetTexture(textureIDs[packedIndex]), level);
+	}
+}
+
+bool MaterialTable::CreateTable()
+{
+	if (tableBuffer != nullptr)
+	{
+		tableBuffer->Release();
+		tableBuffer = nullptr;
+	}
+
+	if (tableSRV != nullptr)
+	{
+		tableSRV->Release();
+		tableSRV = nullptr;
+	}
+	bound = false;
+
+	//doubled, so materials that keep arriving over many frames recreate the buffer a few times only
+	UINT capacity = std::max(tableCapacity, 16u);
+	while (capacity < rows.size())
+	{
+		capacity *= 2;
+	}
+
+	D3D11_BUFFER_DESC bufferDesc;
+
+	bufferDesc.ByteWidth = static_cast<UINT>(sizeof(Row) * capacity);
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(Row);
+
+	if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, nullptr, &tableBuffer)))
+	{
+		std::cerr << "Failed to set up material table buffer!" << std::endl;
+		tableBuffer = nullptr;
+		return false;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+
+	D3D11_BUFFER_SRV bufSRV = {};
+	bufSRV.NumElements = capacity;
+	srvDesc.Buffer = bufSRV;
+
+	if (FAILED(Pipeline::Device()->CreateShaderResourceView(tableBuffer, &srvDesc, &tableSRV)))
+	{
+		std::cerr << "Failed to set up material table SRV" << std::endl;
+		tableSRV = nullptr;
+		return false;
+	}
+
+	tableCapacity = capacity;
+	Pipeline::ResourceManipulation::UpdateBuffer(tableBuffer, 0, rows.data(), static_cast<UINT>(sizeof(Row) * rows.size()));
+	return true;
+}
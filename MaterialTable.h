@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <d3d11.h>
+
+#include "MaterialPacking.h"
+
+struct MaterialData;
+class Textures;
+
+//Every material as one row of a structured buffer, with the maps of textured materials packed into texture arrays. Once the table
+//is bound, switching material only writes the row index, so a whole mesh or batch draws with one bind set.
+class MaterialTable
+{
+	public :
+		MaterialTable();
+		~MaterialTable();
+
+		MaterialTable(const MaterialTable&) = delete;
+		MaterialTable& operator=(const MaterialTable&) = delete;
+
+		//rows are added in material ID order, map IDs are ignored for untextured materials
+		void Add(const MaterialData& material, int ambientMap, int diffuseMap, int specularMap);
+
+		//false for textured materials whose maps did not get an array slot, those are bound on their own
+		bool Contains(int materialID, Textures& textures);
+
+		//binds the table again if another bind set replaced it, then selects the row of materialID
+		void Bind(int materialID, Textures& textures);
+
+		//uploads the materials added since the last update, once per frame before anything is drawn. Contains and Bind update
+		//the table themselves when a material was added in between
+		bool Update(Textures& textures);
+
+	private :
+		struct Row
+		{
+			float Ka[3];
+			float Ns;
+			float Kd[3];
+			UINT textured;
+			float Ks[3];
+			UINT padding;
+
+			//array, slice and single channel flag of each map
+			UINT ambientMap[4];
+			UINT diffuseMap[4];
+			UINT specularMap[4];
+		};
+
+		std::vector<Row> rows;
+		std::vector<int> maps;
+		std::vector<bool> contained;
+		bool dirty;
+
+		//rows before updatedRows are uploaded and their maps copied into the arrays
+		size_t updatedRows;
+		MaterialPacking::Layout layout;
+		std::vector<int> textureIDs;
+		std::map<int, size_t> packed;
+
+		ID3D11Buffer* tableBuffer;
+		ID3D11ShaderResourceView* tableSRV;
+		UINT tableCapacity;
+		std::vector<ID3D11Texture2D*> arrays;
+		std::vector<int> arrayCapacities;
+		ID3D11ShaderResourceView* arraySRVs[MaterialPacking::ArraySlots];
+
+		//row index, rewritten on every change of material
+		ID3D11Buffer* indexBuffer;
+
+		bool bound;
+		UINT64 boundVersion;
+
+		//also forgets what was uploaded, the next update then packs every row again
+		void Release();
+		void ReleaseArrays();
+
+		//creates the arrays with spare slices for the layout and copies every packed texture in, only when the layout outgrew them
+		bool CreateArrays(Textures& textures);
+
+		//the texture packed at packedIndex into its slice, with every mip level
+		void CopyIntoArray(size_t packedIndex, Textures& textures);
+
+		//creates the table buffer with spare rows and uploads every row, only when the rows outgrew it
+		bool CreateTable();
+};
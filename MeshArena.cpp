@@ -0,0 +1,189 @@
+#include "MeshArena.h"
+#include <algorithm>
+#include <iterator>
+
+double MeshArena::Report::Fragmentation() const
+{
+	size_t freeBytes = capacityBytes - usedBytes;
+	if (freeBytes == 0)
+	{
+		return 0.0;
+	}
+	return 1.0 - static_cast<double>(largestFreeBytes) / freeBytes;
+}
+
+MeshArena::Allocator::Allocator(size_t capacity) : capacity(capacity), used(0), peak(0)
+{
+	if (capacity > 0)
+	{
+		freeRanges[0] = capacity;
+	}
+}
+
+bool MeshArena::Allocator::Allocate(size_t count, size_t& offset)
+{
+	if (count == 0)
+	{
+		return false;
+	}
+
+	//the smallest range that fits leaves the large ones for large meshes
+	std::map<size_t, size_t>::iterator best = freeRanges.end();
+	for (std::map<size_t, size_t>::iterator range = freeRanges.begin(); range != freeRanges.end(); range++)
+	{
+		if ((range->second >= count) && ((best == freeRanges.end()) || (range->second < best->second)))
+		{
+			best = range;
+			if (range->second == count)
+			{
+				break;
+			}
+		}
+	}
+
+	if (best == freeRanges.end())
+	{
+		return false;
+	}
+
+	offset = best->first;
+	size_t remaining = best->second - count;
+	freeRanges.erase(best);
+	if (remaining > 0)
+	{
+		freeRanges[offset + count] = remaining;
+	}
+
+	allocations[offset] = count;
+	used += count;
+	peak = std::max(peak, used);
+	return true;
+}
+
+void MeshArena::Allocator::Free(size_t offset)
+{
+	std::map<size_t, size_t>::iterator allocation = allocations.find(offset);
+	if (allocation == allocations.end())
+	{
+		return;
+	}
+
+	size_t count = allocation->second;
+	allocations.erase(allocation);
+	used -= count;
+
+	std::map<size_t, size_t>::iterator next = freeRanges.lower_bound(offset);
+	if ((next != freeRanges.end()) && (offset + count == next->first))
+	{
+		count += next->second;
+		next = freeRanges.erase(next);
+	}
+
+	if (next != freeRanges.begin())
+	{
+		std::map<size_t, size_t>::iterator previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += count;
+			return;
+		}
+	}
+
+	freeRanges[offset] = count;
+}
+
+size_t MeshArena::Allocator::Capacity() const
+{
+	return capacity;
+}
+
+size_t MeshArena::Allocator::Used() const
+{
+	return used;
+}
+
+size_t MeshArena::Allocator::Peak() const
+{
+	return peak;
+}
+
+size_t MeshArena::Allocator::Allocations() const
+{
+	return allocations.size();
+}
+
+size_t MeshArena::Allocator::FreeRanges() const
+{
+	return freeRanges.size();
+}
+
+size_t MeshArena::Allocator::LargestFree() const
+{
+	size_t largest = 0;
+	for (const std::pair<const size_t, size_t>& range : freeRanges)
+	{
+		largest = std::max(largest, range.second);
+	}
+	return largest;
+}
+
+MeshArena::Stream::Stream(size_t blockElements) : blockElements(blockElements)
+{
+}
+
+bool MeshArena::Stream::Allocate(size_t count, Range& range)
+{
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].Allocate(count, range.offset))
+		{
+			range.block = i;
+			range.count = count;
+			return true;
+		}
+	}
+	return false;
+}
+
+void MeshArena::Stream::Free(const Range& range)
+{
+	if (range.block < blocks.size())
+	{
+		blocks[range.block].Free(range.offset);
+	}
+}
+
+size_t MeshArena::Stream::NextBlockCapacity(size_t count) const
+{
+	return std::max(blockElements, count);
+}
+
+size_t MeshArena::Stream::AddBlock(size_t capacity)
+{
+	blocks.emplace_back(capacity);
+	return blocks.size() - 1;
+}
+
+size_t MeshArena::Stream::Blocks() const
+{
+	return blocks.size();
+}
+
+size_t MeshArena::Stream::BlockCapacity(size_t block) const
+{
+	return blocks[block].Capacity();
+}
+
+void MeshArena::Stream::Describe(size_t elementSize, Report& report) const
+{
+	for (const Allocator& block : blocks)
+	{
+		report.buffers++;
+		report.allocations += block.Allocations();
+		report.capacityBytes += block.Capacity() * elementSize;
+		report.usedBytes += block.Used() * elementSize;
+		report.peakBytes += block.Peak() * elementSize;
+		report.freeRanges += block.FreeRanges();
+		report.largestFreeBytes = std::max(report.largestFreeBytes, block.LargestFree() * elementSize);
+	}
+}
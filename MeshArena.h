@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <cstddef>
+
+//size of each arena buffer, a mesh larger than this gets a buffer of its own size
+#define MESH_ARENA_BUFFER_BYTES (16 * 1024 * 1024)
+
+//Bookkeeping of the arena all static meshes are suballocated from, a few large buffers per vertex layout and index format instead of a
+//buffer pair per mesh. Counts elements, not bytes. MeshArenaBuffers owns the buffers
+namespace MeshArena
+{
+	//what the arena holds and how well the free space can still be used, summed over every buffer
+	struct Report
+	{
+		size_t buffers = 0;
+		size_t allocations = 0;
+
+		size_t capacityBytes = 0;
+		size_t usedBytes = 0;
+
+		//the most bytes each buffer held at once, summed. What the arena has to be sized for
+		size_t peakBytes = 0;
+
+		size_t freeRanges = 0;
+		size_t largestFreeBytes = 0;
+
+		//share of the free bytes outside the largest free range, 0 while all of them can still take one mesh
+		double Fragmentation() const;
+	};
+
+	//best fit ranges of one buffer, a free range is merged with its free neighbours when released
+	class Allocator
+	{
+	public:
+		Allocator(size_t capacity = 0);
+
+		//false when no free range is large enough, count has to be more than 0
+		bool Allocate(size_t count, size_t& offset);
+
+		//offset has to be one Allocate returned and not released yet
+		void Free(size_t offset);
+
+		size_t Capacity() const;
+		size_t Used() const;
+		size_t Peak() const;
+		size_t Allocations() const;
+		size_t FreeRanges() const;
+		size_t LargestFree() const;
+
+	private:
+		size_t capacity;
+		size_t used;
+		size_t peak;
+
+		//offset to count
+		std::map<size_t, size_t> freeRanges;
+		std::map<size_t, size_t> allocations;
+	};
+
+	struct Range
+	{
+		size_t block = 0;
+		size_t offset = 0;
+		size_t count = 0;
+	};
+
+	//the buffers of one element size, every one blockElements large unless a single allocation needs more
+	class Stream
+	{
+	public:
+		Stream(size_t blockElements = 0);
+
+		//only tries the existing blocks, lowest block first
+		bool Allocate(size_t count, Range& range);
+		void Free(const Range& range);
+
+		//how large the block has to be that takes count elements when Allocate fails
+		size_t NextBlockCapacity(size_t count) const;
+
+		//once the buffer of the block exists, returns its index
+		size_t AddBlock(size_t capacity);
+
+		size_t Blocks() const;
+		size_t BlockCapacity(size_t block) const;
+
+		void Describe(size_t elementSize, Report& report) const;
+
+	private:
+		size_t blockElements;
+		std::vector<Allocator> blocks;
+	};
+}
@@ -0,0 +1,157 @@
+#include "MeshBounds.h"
+#include <cmath>
+
+namespace
+{
+	float DistanceSquared(const float a[3], const float b[3])
+	{
+		float x = a[0] - b[0];
+		float y = a[1] - b[1];
+		float z = a[2] - b[2];
+		return x * x + y * y + z * z;
+	}
+
+	//moves the sphere just far enough to also hold point, keeping the far side where it was
+	void Grow(float center[3], float& radius, const float point[3])
+	{
+		float distance = sqrtf(DistanceSquared(point, center));
+		if (distance <= radius)
+		{
+			return;
+		}
+
+		float newRadius = 0.5f * (radius + distance);
+		float shift = (newRadius - radius) / distance;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] += (point[axis] - center[axis]) * shift;
+		}
+		radius = newRadius;
+	}
+}
+
+Bounds MeshBounds::Compute(const std::vector<Vertex>& vertices)
+{
+	return Compute(vertices.data(), vertices.size());
+}
+
+Bounds MeshBounds::Compute(const Vertex* vertices, size_t count)
+{
+	Bounds bounds;
+	if (count == 0)
+	{
+		return bounds;
+	}
+
+	//the vertices with the smallest and largest coordinate on every axis
+	size_t lowest[3] = { 0, 0, 0 };
+	size_t highest[3] = { 0, 0, 0 };
+	for (int axis = 0; axis < 3; axis++)
+	{
+		bounds.min[axis] = vertices[0].pos[axis];
+		bounds.max[axis] = vertices[0].pos[axis];
+	}
+
+	for (size_t i = 1; i < count; i++)
+	{
+		const float* pos = vertices[i].pos;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (pos[axis] < bounds.min[axis])
+			{
+				bounds.min[axis] = pos[axis];
+				lowest[axis] = i;
+			}
+			if (pos[axis] > bounds.max[axis])
+			{
+				bounds.max[axis] = pos[axis];
+				highest[axis] = i;
+			}
+		}
+	}
+
+	//start from the pair of extremes that lies furthest apart
+	int widest = 0;
+	float widestDistance = -1.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float distance = DistanceSquared(vertices[lowest[axis]].pos, vertices[highest[axis]].pos);
+		if (distance > widestDistance)
+		{
+			widestDistance = distance;
+			widest = axis;
+		}
+	}
+
+	float center[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		center[axis] = 0.5f * (vertices[lowest[widest]].pos[axis] + vertices[highest[widest]].pos[axis]);
+	}
+	float radius = 0.5f * sqrtf(widestDistance);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Grow(center, radius, vertices[i].pos);
+	}
+
+	//the box center wins for some shapes, a cube seen along its diagonal for instance
+	float boxCenter[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		boxCenter[axis] = 0.5f * (bounds.min[axis] + bounds.max[axis]);
+	}
+	float boxRadius = 0.0f;
+	for (size_t i = 0; i < count; i++)
+	{
+		boxRadius = fmaxf(boxRadius, DistanceSquared(vertices[i].pos, boxCenter));
+	}
+	boxRadius = sqrtf(boxRadius);
+
+	if (boxRadius < radius)
+	{
+		radius = boxRadius;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] = boxCenter[axis];
+		}
+	}
+
+	//float rounding in Grow can leave a vertex a hair outside
+	radius *= 1.0f + 1e-5f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		bounds.center[axis] = center[axis];
+	}
+	bounds.radius = radius;
+
+	return bounds;
+}
+
+void MeshBounds::Extend(Bounds& bounds, size_t previousCount, const Vertex* vertices, size_t count)
+{
+	if (previousCount == 0)
+	{
+		bounds = Compute(vertices, count);
+		return;
+	}
+
+	float radius = bounds.radius;
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* pos = vertices[i].pos;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bounds.min[axis] = fminf(bounds.min[axis], pos[axis]);
+			bounds.max[axis] = fmaxf(bounds.max[axis], pos[axis]);
+		}
+		Grow(bounds.center, bounds.radius, pos);
+	}
+
+	//same slack as Compute, only when the batch moved the sphere so it does not pile up over batches that fit
+	if (bounds.radius > radius)
+	{
+		bounds.radius *= 1.0f + 1e-5f;
+	}
+}
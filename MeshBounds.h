@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+#include "MeshData.h"
+
+//Import time bounding volumes of a mesh.
+namespace MeshBounds
+{
+	//axis aligned box and a close to minimal sphere around every vertex position. The sphere is Ritter's, grown
+	//from the farthest pair of axis extremes, or the sphere around the box when that one is smaller
+	Bounds Compute(const std::vector<Vertex>& vertices);
+	Bounds Compute(const Vertex* vertices, size_t count);
+
+	//adds count vertices to bounds that hold previousCount, for meshes that are never in memory at once. The first batch goes through
+	//Compute, later ones only grow the box and the sphere, so the sphere can end up looser than the one Compute finds for the whole mesh
+	void Extend(Bounds& bounds, size_t previousCount, const Vertex* vertices, size_t count);
+}
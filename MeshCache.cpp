@@ -0,0 +1,603 @@
+#include "MeshCache.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <thread>
+
+#include "MeshCodec.h"
+#include "AssetPack.h"
+
+namespace
+{
+	const char Magic[4] = { 'S', 'T', 'D', 'M' };
+
+	//bump whenever the layout of the file or of Vertex changes
+	const uint32_t Version = 6;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t vertexStride;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t submeshCount;
+		uint32_t materialLibraryCount;
+		uint32_t buildFlags;
+		uint32_t lodCount;
+		uint32_t meshletCount;
+		Bounds bounds;
+
+		//vertex and index data are MeshCodec streams of vertexBytes and indexBytes instead of the arrays themselves
+		uint32_t compressed;
+		uint32_t padding;
+		uint64_t vertexBytes;
+		uint64_t indexBytes;
+
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint64_t sourceHash;
+
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t submeshOffset;
+		uint64_t lodOffset;
+		uint64_t meshletOffset;
+		uint64_t stringOffset;
+		uint64_t stringBytes;
+	};
+
+	struct SubmeshRecord
+	{
+		int32_t start;
+		int32_t size;
+	};
+
+	//every level of detail is its error followed by one SubmeshRecord per submesh
+	uint64_t LODRecordSize(uint32_t submeshCount)
+	{
+		return sizeof(float) + sizeof(SubmeshRecord) * static_cast<uint64_t>(submeshCount);
+	}
+
+	//vertex and index data start on 16 byte boundaries so the mapped pointers are as aligned as a heap allocation
+	uint64_t Align(uint64_t offset)
+	{
+		return (offset + 15) & ~static_cast<uint64_t>(15);
+	}
+
+	void AppendString(std::vector<char>& strings, const std::string& text)
+	{
+		uint32_t length = static_cast<uint32_t>(text.size());
+		strings.insert(strings.end(), reinterpret_cast<const char*>(&length), reinterpret_cast<const char*>(&length) + sizeof(uint32_t));
+		strings.insert(strings.end(), text.begin(), text.end());
+	}
+
+	bool ReadString(const char*& cursor, const char* end, std::string& text)
+	{
+		uint32_t length;
+		if (static_cast<size_t>(end - cursor) < sizeof(uint32_t))
+		{
+			return false;
+		}
+		memcpy(&length, cursor, sizeof(uint32_t));
+		cursor += sizeof(uint32_t);
+
+		if (static_cast<size_t>(end - cursor) < length)
+		{
+			return false;
+		}
+		text.assign(cursor, length);
+		cursor += length;
+		return true;
+	}
+
+	//FNV-1a taken a word at a time, the byte wise version is the bottleneck of a cached load.
+	//Hashing a file in blocks gives the same result as hashing it at once as long as every block but the last is a multiple of 8 bytes
+	uint64_t ContinueHash(uint64_t hash, const char* data, size_t size)
+	{
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t word;
+			memcpy(&word, data + i, sizeof(uint64_t));
+			hash ^= word;
+			hash *= 1099511628211ull;
+		}
+		for (; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//copies between files go through blocks of this size
+	const size_t CopyBlockBytes = 1024 * 1024;
+
+	std::string TemporaryPath(const std::string& filepath, const char* extension)
+	{
+		return filepath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + extension;
+	}
+
+	//everything but the source fields, with the offsets of a file holding vertexCount vertices and indexCount indices in vertexBytes and indexBytes
+	void FillHeader(Header& header, const MeshData& mesh, uint64_t vertexCount, uint64_t indexCount, uint64_t vertexBytes, uint64_t indexBytes, bool compressed, uint32_t buildFlags, std::vector<char>& strings)
+	{
+		header = {};
+		memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.vertexStride = sizeof(Vertex);
+		header.vertexCount = static_cast<uint32_t>(vertexCount);
+		header.indexCount = static_cast<uint32_t>(indexCount);
+		header.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+		header.materialLibraryCount = static_cast<uint32_t>(mesh.materialLibraries.size());
+		header.bounds = mesh.bounds;
+		header.buildFlags = buildFlags;
+		header.lodCount = static_cast<uint32_t>(mesh.lods.size());
+		header.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+		header.compressed = compressed ? 1 : 0;
+		header.vertexBytes = vertexBytes;
+		header.indexBytes = indexBytes;
+
+		strings.clear();
+		for (const std::string& library : mesh.materialLibraries)
+		{
+			AppendString(strings, library);
+		}
+		for (const std::string& material : mesh.submeshMaterials)
+		{
+			AppendString(strings, material);
+		}
+
+		header.vertexOffset = Align(sizeof(Header));
+		header.indexOffset = Align(header.vertexOffset + vertexBytes);
+		header.submeshOffset = Align(header.indexOffset + indexBytes);
+		header.lodOffset = header.submeshOffset + sizeof(SubmeshRecord) * mesh.submeshes.size();
+		header.meshletOffset = Align(header.lodOffset + LODRecordSize(header.submeshCount) * header.lodCount);
+		header.stringOffset = header.meshletOffset + sizeof(Meshlet) * mesh.meshlets.size();
+		header.stringBytes = strings.size();
+	}
+
+	void Pad(std::ofstream& cache, uint64_t offset)
+	{
+		const char zeros[16] = {};
+		uint64_t position = static_cast<uint64_t>(cache.tellp());
+		cache.write(zeros, offset - position);
+	}
+
+	//submeshes, levels of detail, meshlets and strings, everything after the index data
+	void WriteTail(std::ofstream& cache, const Header& header, const MeshData& mesh, const std::vector<char>& strings)
+	{
+		Pad(cache, header.submeshOffset);
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			SubmeshRecord record = { submesh.Start, submesh.size };
+			cache.write(reinterpret_cast<const char*>(&record), sizeof(SubmeshRecord));
+		}
+
+		for (const MeshLOD& lod : mesh.lods)
+		{
+			cache.write(reinterpret_cast<const char*>(&lod.error), sizeof(float));
+			for (const Submesh& submesh : lod.submeshes)
+			{
+				SubmeshRecord record = { submesh.Start, submesh.size };
+				cache.write(reinterpret_cast<const char*>(&record), sizeof(SubmeshRecord));
+			}
+		}
+
+		Pad(cache, header.meshletOffset);
+		cache.write(reinterpret_cast<const char*>(mesh.meshlets.data()), sizeof(Meshlet) * mesh.meshlets.size());
+
+		cache.write(strings.data(), strings.size());
+	}
+
+	//written so that offsets and sizes read from a damaged header cannot wrap around the file size
+	bool InFile(uint64_t offset, uint64_t bytes, uint64_t fileSize)
+	{
+		return (offset <= fileSize) && (bytes <= fileSize - offset);
+	}
+
+	//a range of a cache that is read straight into draw calls and the arena has to stay inside its indices
+	bool InIndexRange(int64_t start, int64_t size, uint32_t indexCount)
+	{
+		return (start >= 0) && (size >= 0) && (start + size <= static_cast<int64_t>(indexCount));
+	}
+
+	bool MoveIntoPlace(const std::string& temporaryFilepath, const std::string& cacheFilepath)
+	{
+		std::error_code error;
+		std::filesystem::rename(temporaryFilepath, cacheFilepath, error);
+		if (error)
+		{
+			std::filesystem::remove(temporaryFilepath, error);
+			std::cerr << "Failed to write mesh cache: " << cacheFilepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+std::string MeshCache::CachePath(const std::string& sourceFilepath, uint32_t buildFlags)
+{
+	return sourceFilepath + "." + std::to_string(buildFlags) + ".stdmesh";
+}
+
+uint64_t MeshCache::HashFile(const char* data, size_t size)
+{
+	return ContinueHash(14695981039346656037ull, data, size);
+}
+
+bool MeshCache::Write(const std::string& cacheFilepath, const std::string& sourceFilepath, const MeshData& mesh, uint32_t buildFlags, bool compress)
+{
+	const char* vertexData = reinterpret_cast<const char*>(mesh.vertices.data());
+	const char* indexData = reinterpret_cast<const char*>(mesh.indices.data());
+	uint64_t vertexBytes = sizeof(Vertex) * mesh.vertices.size();
+	uint64_t indexBytes = sizeof(uint32_t) * mesh.indices.size();
+
+	std::vector<uint8_t> encodedVertices;
+	std::vector<uint8_t> encodedIndices;
+	if (compress)
+	{
+		MeshCodec::EncodeVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), encodedVertices);
+		MeshCodec::EncodeIndices(mesh.indices.data(), mesh.indices.size(), encodedIndices);
+
+		vertexData = reinterpret_cast<const char*>(encodedVertices.data());
+		indexData = reinterpret_cast<const char*>(encodedIndices.data());
+		vertexBytes = encodedVertices.size();
+		indexBytes = encodedIndices.size();
+	}
+
+	Header header;
+	std::vector<char> strings;
+	FillHeader(header, mesh, mesh.vertices.size(), mesh.indices.size(), vertexBytes, indexBytes, compress, buildFlags, strings);
+
+	if (!AssetPack::SourceInfo(sourceFilepath, header.sourceSize, header.sourceTime))
+	{
+		return false;
+	}
+
+	Asset source;
+	if (!AssetPack::Open(sourceFilepath, source))
+	{
+		return false;
+	}
+	header.sourceHash = HashFile(source.Data(), source.Size());
+	source.Close();
+
+	//written to a temporary first so a crash mid write never leaves a cache that looks valid.
+	//asynchronous loads of the same file can write at the same time, each thread gets its own temporary
+	std::string temporaryFilepath = TemporaryPath(cacheFilepath, ".tmp");
+	bool written = false;
+	{
+		std::ofstream cache(temporaryFilepath, std::ios::binary | std::ios::trunc);
+		if (!cache.is_open())
+		{
+			std::cerr << "Failed to create mesh cache: " << cacheFilepath << std::endl;
+			return false;
+		}
+
+		cache.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+		Pad(cache, header.vertexOffset);
+		cache.write(vertexData, vertexBytes);
+
+		Pad(cache, header.indexOffset);
+		cache.write(indexData, indexBytes);
+
+		WriteTail(cache, header, mesh, strings);
+		written = cache.good();
+	}
+
+	if (!written)
+	{
+		std::error_code error;
+		std::filesystem::remove(temporaryFilepath, error);
+		std::cerr << "Failed to write mesh cache: " << cacheFilepath << std::endl;
+		return false;
+	}
+
+	return MoveIntoPlace(temporaryFilepath, cacheFilepath);
+}
+
+MeshCache::StreamWriter::StreamWriter(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags) :
+	cacheFilepath(cacheFilepath), sourceFilepath(sourceFilepath), buildFlags(buildFlags), vertexCount(0), indexCount(0), failed(false)
+{
+	temporaryFilepath = TemporaryPath(cacheFilepath, ".tmp");
+	indexFilepath = TemporaryPath(cacheFilepath, ".indices.tmp");
+
+	cache.open(temporaryFilepath, std::ios::binary | std::ios::trunc);
+	indices.open(indexFilepath, std::ios::binary | std::ios::trunc);
+	if (!cache.is_open() || !indices.is_open())
+	{
+		std::cerr << "Failed to create mesh cache: " << cacheFilepath << std::endl;
+		failed = true;
+		return;
+	}
+
+	//the header is only known at the end, vertices start where FillHeader puts them for any mesh
+	Header header = {};
+	cache.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	Pad(cache, Align(sizeof(Header)));
+}
+
+MeshCache::StreamWriter::~StreamWriter()
+{
+	//only left behind when Finish was not reached or failed
+	cache.close();
+	indices.close();
+
+	std::error_code error;
+	std::filesystem::remove(temporaryFilepath, error);
+	std::filesystem::remove(indexFilepath, error);
+}
+
+bool MeshCache::StreamWriter::Vertices(const Vertex* vertices, size_t count)
+{
+	cache.write(reinterpret_cast<const char*>(vertices), sizeof(Vertex) * count);
+	vertexCount += count;
+	failed |= !cache.good();
+	return !failed;
+}
+
+bool MeshCache::StreamWriter::Indices(const uint32_t* indexData, size_t count)
+{
+	indices.write(reinterpret_cast<const char*>(indexData), sizeof(uint32_t) * count);
+	indexCount += count;
+	failed |= !indices.good();
+	return !failed;
+}
+
+bool MeshCache::StreamWriter::Finish(const MeshData& mesh)
+{
+	if (failed)
+	{
+		std::cerr << "Failed to write mesh cache: " << cacheFilepath << std::endl;
+		return false;
+	}
+
+	Header header;
+	std::vector<char> strings;
+	FillHeader(header, mesh, vertexCount, indexCount, sizeof(Vertex) * vertexCount, sizeof(uint32_t) * indexCount, false, buildFlags, strings);
+
+	if (!AssetPack::SourceInfo(sourceFilepath, header.sourceSize, header.sourceTime))
+	{
+		return false;
+	}
+
+	//read in blocks like the import itself, mapping a source this large would bring all of it into memory.
+	//A packed source is already mapped with the pack and hashed from there
+	std::vector<char> block(CopyBlockBytes);
+	if (AssetPack::Contains(sourceFilepath))
+	{
+		Asset source;
+		if (!AssetPack::Open(sourceFilepath, source))
+		{
+			return false;
+		}
+		header.sourceHash = HashFile(source.Data(), source.Size());
+	}
+	else
+	{
+		std::ifstream source(sourceFilepath, std::ios::binary);
+		uint64_t hash = 14695981039346656037ull;
+		while (source.good())
+		{
+			source.read(block.data(), block.size());
+			hash = ContinueHash(hash, block.data(), static_cast<size_t>(source.gcount()));
+		}
+		if (!source.eof())
+		{
+			return false;
+		}
+		header.sourceHash = hash;
+	}
+
+	indices.close();
+	{
+		std::ifstream spilled(indexFilepath, std::ios::binary);
+		Pad(cache, header.indexOffset);
+		while (spilled.good())
+		{
+			spilled.read(block.data(), block.size());
+			cache.write(block.data(), spilled.gcount());
+		}
+	}
+
+	WriteTail(cache, header, mesh, strings);
+
+	cache.seekp(0);
+	cache.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+	if (!cache.good())
+	{
+		std::cerr << "Failed to write mesh cache: " << cacheFilepath << std::endl;
+		return false;
+	}
+	cache.close();
+
+	return MoveIntoPlace(temporaryFilepath, cacheFilepath);
+}
+
+bool MeshCache::Read(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags, CachedMesh& mesh)
+{
+	if (!AssetPack::Open(cacheFilepath, mesh.file) || (mesh.file.Size() < sizeof(Header)))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, mesh.file.Data(), sizeof(Header));
+
+	if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || (header.vertexStride != sizeof(Vertex)) || (header.buildFlags != buildFlags))
+	{
+		return false;
+	}
+
+	//a source of the same size and timestamp is trusted without reading it, that read is what the cache is there to avoid.
+	//Only a source that was touched is hashed, until the cooker restamps the cache with the new timestamp
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!AssetPack::SourceInfo(sourceFilepath, sourceSize, sourceTime) || (sourceSize != header.sourceSize))
+	{
+		return false;
+	}
+
+	if (sourceTime != header.sourceTime)
+	{
+		Asset source;
+		if (!AssetPack::Open(sourceFilepath, source) || (HashFile(source.Data(), source.Size()) != header.sourceHash))
+		{
+			return false;
+		}
+	}
+
+	bool compressed = header.compressed != 0;
+	if (!compressed && ((header.vertexBytes != sizeof(Vertex) * static_cast<uint64_t>(header.vertexCount)) || (header.indexBytes != sizeof(uint32_t) * static_cast<uint64_t>(header.indexCount))))
+	{
+		return false;
+	}
+
+	uint64_t fileSize = mesh.file.Size();
+	//counts are 32 bit so the record sizes cannot overflow, except the LOD records which are two counts multiplied
+	if (!InFile(header.vertexOffset, header.vertexBytes, fileSize) ||
+		!InFile(header.indexOffset, header.indexBytes, fileSize) ||
+		!InFile(header.submeshOffset, sizeof(SubmeshRecord) * static_cast<uint64_t>(header.submeshCount), fileSize) ||
+		!InFile(header.lodOffset, 0, fileSize) || ((header.lodCount > 0) && (LODRecordSize(header.submeshCount) > (fileSize - header.lodOffset) / header.lodCount)) ||
+		!InFile(header.meshletOffset, sizeof(Meshlet) * static_cast<uint64_t>(header.meshletCount), fileSize) ||
+		!InFile(header.stringOffset, header.stringBytes, fileSize))
+	{
+		return false;
+	}
+
+	const char* data = mesh.file.Data();
+
+	if (compressed)
+	{
+		if ((header.vertexCount > MeshCodec::MaxVertexCount(header.vertexBytes, sizeof(Vertex))) || (header.indexCount > MeshCodec::MaxIndexCount(header.indexBytes)))
+		{
+			return false;
+		}
+
+		mesh.decodedVertices.resize(header.vertexCount);
+		mesh.decodedIndices.resize(header.indexCount);
+		if (!MeshCodec::DecodeVertices(mesh.decodedVertices.data(), header.vertexCount, sizeof(Vertex), reinterpret_cast<const uint8_t*>(data + header.vertexOffset), header.vertexBytes) ||
+			!MeshCodec::DecodeIndices(mesh.decodedIndices.data(), header.indexCount, reinterpret_cast<const uint8_t*>(data + header.indexOffset), header.indexBytes))
+		{
+			return false;
+		}
+
+		mesh.vertices = mesh.decodedVertices.data();
+		mesh.indices = mesh.decodedIndices.data();
+	}
+	else
+	{
+		mesh.vertices = reinterpret_cast<const Vertex*>(data + header.vertexOffset);
+		mesh.indices = reinterpret_cast<const uint32_t*>(data + header.indexOffset);
+	}
+	mesh.vertexCount = header.vertexCount;
+	mesh.indexCount = header.indexCount;
+	mesh.bounds = header.bounds;
+
+	mesh.submeshes.resize(header.submeshCount);
+	for (uint32_t i = 0; i < header.submeshCount; i++)
+	{
+		SubmeshRecord record;
+		memcpy(&record, data + header.submeshOffset + sizeof(SubmeshRecord) * i, sizeof(SubmeshRecord));
+		if (!InIndexRange(record.start, record.size, header.indexCount))
+		{
+			return false;
+		}
+		mesh.submeshes[i].Start = record.start;
+		mesh.submeshes[i].size = record.size;
+	}
+
+	mesh.lods.resize(header.lodCount);
+	for (uint32_t level = 0; level < header.lodCount; level++)
+	{
+		const char* record = data + header.lodOffset + LODRecordSize(header.submeshCount) * level;
+		MeshLOD& lod = mesh.lods[level];
+
+		memcpy(&lod.error, record, sizeof(float));
+		lod.submeshes.resize(header.submeshCount);
+		for (uint32_t i = 0; i < header.submeshCount; i++)
+		{
+			SubmeshRecord submesh;
+			memcpy(&submesh, record + sizeof(float) + sizeof(SubmeshRecord) * i, sizeof(SubmeshRecord));
+			if (!InIndexRange(submesh.start, submesh.size, header.indexCount))
+			{
+				return false;
+			}
+			lod.submeshes[i].Start = submesh.start;
+			lod.submeshes[i].size = submesh.size;
+		}
+	}
+
+	mesh.meshlets.resize(header.meshletCount);
+	if (header.meshletCount > 0)
+	{
+		memcpy(mesh.meshlets.data(), data + header.meshletOffset, sizeof(Meshlet) * header.meshletCount);
+	}
+	for (const Meshlet& meshlet : mesh.meshlets)
+	{
+		if (!InIndexRange(meshlet.indexStart, meshlet.indexCount, header.indexCount))
+		{
+			return false;
+		}
+	}
+
+	const char* cursor = data + header.stringOffset;
+	const char* end = cursor + header.stringBytes;
+
+	mesh.materialLibraries.resize(header.materialLibraryCount);
+	for (std::string& library : mesh.materialLibraries)
+	{
+		if (!ReadString(cursor, end, library))
+		{
+			return false;
+		}
+	}
+
+	mesh.submeshMaterials.resize(header.submeshCount);
+	for (std::string& material : mesh.submeshMaterials)
+	{
+		if (!ReadString(cursor, end, material))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MeshCache::Restamp(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags, uint64_t sourceHash)
+{
+	std::fstream cache(cacheFilepath, std::ios::binary | std::ios::in | std::ios::out);
+	Header header;
+	if (!cache.is_open() || !cache.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+	{
+		return false;
+	}
+
+	if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || (header.vertexStride != sizeof(Vertex)) ||
+		(header.buildFlags != buildFlags) || (header.sourceHash != sourceHash))
+	{
+		return false;
+	}
+
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!AssetPack::SourceInfo(sourceFilepath, sourceSize, sourceTime))
+	{
+		return false;
+	}
+	if ((sourceSize == header.sourceSize) && (sourceTime == header.sourceTime))
+	{
+		return true;
+	}
+
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	cache.seekp(0);
+	cache.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	return cache.good();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+
+#include "MeshData.h"
+#include "AssetPack.h"
+
+//Binary copy of an imported mesh, written next to the source as "<source>.<build flags>.stdmesh".
+//The vertex and index arrays are stored exactly as the GPU buffers expect them so a load is one mapping and no parsing,
+//or compressed through MeshCodec for a smaller file and a decode on load. Cache and source are read through AssetPack, so both can come from a mounted pack.
+namespace MeshCache
+{
+	//a mesh read from a cache file. vertices and indices point into the cache asset, or into the decoded copies of a compressed cache,
+	//and stay valid as long as this object lives.
+	struct CachedMesh
+	{
+		Asset file;
+		std::vector<Vertex> decodedVertices;
+		std::vector<uint32_t> decodedIndices;
+
+		const Vertex* vertices = nullptr;
+		size_t vertexCount = 0;
+		const uint32_t* indices = nullptr;
+		size_t indexCount = 0;
+
+		std::vector<Submesh> submeshes;
+		std::vector<std::string> submeshMaterials;
+		std::vector<std::string> materialLibraries;
+
+		std::vector<MeshLOD> lods;
+		std::vector<Meshlet> meshlets;
+
+		Bounds bounds;
+	};
+
+	//one file per set of build flags, so loads of the same source with other flags do not overwrite each other's cache
+	std::string CachePath(const std::string& sourceFilepath, uint32_t buildFlags);
+
+	//hash of the whole source file, stored in the cache to tell a touched source from an edited one of the same size
+	uint64_t HashFile(const char* data, size_t size);
+
+	//buildFlags are the import flags that change the mesh content, a cache is only reused for the same flags.
+	//compress stores the vertices and indices through MeshCodec, they are then decoded on every read instead of used from the mapping
+	bool Write(const std::string& cacheFilepath, const std::string& sourceFilepath, const MeshData& mesh, uint32_t buildFlags, bool compress = false);
+
+	//writes the cache of a mesh that is streamed in and never held in memory. Vertices go straight into the cache file and indices
+	//into a temporary next to it, Finish adds everything else once the import is done. Without Finish nothing is left behind
+	class StreamWriter : public MeshSink
+	{
+		public:
+			StreamWriter(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags);
+			~StreamWriter();
+
+			StreamWriter(const StreamWriter&) = delete;
+			StreamWriter& operator=(const StreamWriter&) = delete;
+
+			bool Vertices(const Vertex* vertices, size_t count) override;
+			bool Indices(const uint32_t* indices, size_t count) override;
+
+			//mesh holds the submeshes, materials and bounds, its vertices and indices are not used
+			bool Finish(const MeshData& mesh);
+
+		private:
+			std::string cacheFilepath;
+			std::string sourceFilepath;
+			std::string temporaryFilepath;
+			std::string indexFilepath;
+			uint32_t buildFlags;
+
+			std::ofstream cache;
+			std::ofstream indices;
+			uint64_t vertexCount;
+			uint64_t indexCount;
+			bool failed;
+	};
+
+	//fails quietly if the cache is missing, from another version or does not match the source file.
+	//A source of the size and timestamp the cache was written for is not read, one with another timestamp is hashed
+	bool Read(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags, CachedMesh& mesh);
+
+	//takes over the size and timestamp of a source that was touched without changing, so Read accepts the cache again without a rebuild.
+	//Only the header is read and written. Fails if the cache is from another version, for other flags or of a source with another hash
+	bool Restamp(const std::string& cacheFilepath, const std::string& sourceFilepath, uint32_t buildFlags, uint64_t sourceHash);
+}
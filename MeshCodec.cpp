@@ -0,0 +1,671 @@
+#include "MeshCodec.h"
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC lets every function use any instruction set, whether it runs is decided by SIMDAvailable
+#define SSSE3_TARGET
+#else
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+namespace
+{
+	//first byte of every stream, the low bits are the format version
+	const uint8_t VertexHeader = 0xA0;
+	const uint8_t IndexHeader = 0xB0;
+
+	//vertices in one block are delta coded one byte stream at a time, a block of every stream fits in the L1 cache
+	const size_t BlockBytes = 8192;
+	const size_t MaxBlockVertices = 256;
+	const size_t GroupSize = 16;
+
+	//the SIMD group decoder reads this far past the start of a group
+	const size_t GroupReadBytes = 24;
+
+	size_t BlockVertices(size_t vertexSize)
+	{
+		size_t count = (BlockBytes / vertexSize) & ~(GroupSize - 1);
+		return std::max(GroupSize, std::min(count, MaxBlockVertices));
+	}
+
+	inline uint8_t Zigzag8(uint8_t value)
+	{
+		return static_cast<uint8_t>((value << 1) ^ static_cast<uint8_t>(static_cast<int8_t>(value) >> 7));
+	}
+
+	inline uint8_t Unzigzag8(uint8_t value)
+	{
+		return static_cast<uint8_t>((value >> 1) ^ static_cast<uint8_t>(-(value & 1)));
+	}
+
+	inline uint32_t Zigzag32(uint32_t value)
+	{
+		return (value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(value) >> 31);
+	}
+
+	inline uint32_t Unzigzag32(uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	struct Tables
+	{
+		//positions of the bytes stored after a vertex group for every 8 bit mask of values that did not fit, 0x80 zeroes a lane
+		uint8_t groupShuffle[256][8];
+		uint8_t groupCount[256];
+
+		//stream vbyte: where the bytes of four indices go for every control byte, and how many bytes they take
+		uint8_t indexShuffle[256][16];
+		uint8_t indexLength[256];
+
+		bool SSSE3;
+
+		Tables()
+		{
+			for (int mask = 0; mask < 256; mask++)
+			{
+				uint8_t count = 0;
+				for (int i = 0; i < 8; i++)
+				{
+					groupShuffle[mask][i] = ((mask >> i) & 1) ? count++ : 0x80;
+				}
+				groupCount[mask] = count;
+
+				uint8_t offset = 0;
+				for (int j = 0; j < 4; j++)
+				{
+					int length = ((mask >> (2 * j)) & 3) + 1;
+					for (int b = 0; b < 4; b++)
+					{
+						indexShuffle[mask][4 * j + b] = (b < length) ? static_cast<uint8_t>(offset + b) : 0x80;
+					}
+					offset = static_cast<uint8_t>(offset + length);
+				}
+				indexLength[mask] = offset;
+			}
+
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			SSSE3 = (info[2] & (1 << 9)) != 0;
+#else
+			SSSE3 = __builtin_cpu_supports("ssse3");
+#endif
+		}
+	};
+
+	const Tables& GetTables()
+	{
+		static Tables tables;
+		return tables;
+	}
+
+	//16 zigzagged deltas as 0, 2, 4 or 8 bits each, values at the largest 2 or 4 bit value are stored whole after the packed ones
+	int EncodeGroup(const uint8_t* values, std::vector<uint8_t>& encoded)
+	{
+		size_t size2 = 4;
+		size_t size4 = 8;
+		bool zero = true;
+		for (size_t i = 0; i < GroupSize; i++)
+		{
+			zero &= (values[i] == 0);
+			size2 += (values[i] >= 3);
+			size4 += (values[i] >= 15);
+		}
+
+		if (zero)
+		{
+			return 0;
+		}
+
+		if ((size2 <= size4) && (size2 < GroupSize))
+		{
+			for (size_t b = 0; b < 4; b++)
+			{
+				uint8_t packed = 0;
+				for (size_t i = 0; i < 4; i++)
+				{
+					packed |= static_cast<uint8_t>(std::min<uint8_t>(values[b * 4 + i], 3) << (6 - 2 * i));
+				}
+				encoded.push_back(packed);
+			}
+			for (size_t i = 0; i < GroupSize; i++)
+			{
+				if (values[i] >= 3)
+				{
+					encoded.push_back(values[i]);
+				}
+			}
+			return 1;
+		}
+
+		if (size4 < GroupSize)
+		{
+			for (size_t b = 0; b < 8; b++)
+			{
+				encoded.push_back(static_cast<uint8_t>((std::min<uint8_t>(values[b * 2], 15) << 4) | std::min<uint8_t>(values[b * 2 + 1], 15)));
+			}
+			for (size_t i = 0; i < GroupSize; i++)
+			{
+				if (values[i] >= 15)
+				{
+					encoded.push_back(values[i]);
+				}
+			}
+			return 2;
+		}
+
+		encoded.insert(encoded.end(), values, values + GroupSize);
+		return 3;
+	}
+
+	const uint8_t* DecodeGroup(int code, const uint8_t* data, const uint8_t* end, uint8_t* values)
+	{
+		if (code == 0)
+		{
+			memset(values, 0, GroupSize);
+			return data;
+		}
+
+		if (code == 3)
+		{
+			if (static_cast<size_t>(end - data) < GroupSize)
+			{
+				return nullptr;
+			}
+			memcpy(values, data, GroupSize);
+			return data + GroupSize;
+		}
+
+		int bits = (code == 1) ? 2 : 4;
+		size_t packedBytes = GroupSize * bits / 8;
+		uint8_t full = static_cast<uint8_t>((1 << bits) - 1);
+		if (static_cast<size_t>(end - data) < packedBytes)
+		{
+			return nullptr;
+		}
+
+		const uint8_t* extra = data + packedBytes;
+		for (size_t i = 0; i < GroupSize; i++)
+		{
+			size_t bit = i * bits;
+			uint8_t value = (data[bit / 8] >> (8 - bits - bit % 8)) & full;
+			if (value == full)
+			{
+				if (extra >= end)
+				{
+					return nullptr;
+				}
+				value = *extra++;
+			}
+			values[i] = value;
+		}
+		return extra;
+	}
+
+	//zigzagged deltas of every byte of the block's vertices, one row of rowSize per byte of the vertex
+	const uint8_t* DecodeBlockScalar(const uint8_t* data, const uint8_t* end, uint8_t* deltas, size_t rowSize, size_t vertexSize)
+	{
+		size_t groupCount = rowSize / GroupSize;
+		size_t headerBytes = (groupCount + 3) / 4;
+
+		for (size_t k = 0; k < vertexSize; k++)
+		{
+			if (static_cast<size_t>(end - data) < headerBytes)
+			{
+				return nullptr;
+			}
+			const uint8_t* header = data;
+			data += headerBytes;
+
+			for (size_t group = 0; group < groupCount; group++)
+			{
+				int code = (header[group / 4] >> ((group % 4) * 2)) & 3;
+				data = DecodeGroup(code, data, end, deltas + k * rowSize + group * GroupSize);
+				if (data == nullptr)
+				{
+					return nullptr;
+				}
+			}
+		}
+		return data;
+	}
+
+	void ReconstructScalar(const uint8_t* deltas, size_t rowSize, size_t count, size_t vertexSize, uint8_t* last, uint8_t* vertices)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			for (size_t k = 0; k < vertexSize; k++)
+			{
+				last[k] = static_cast<uint8_t>(last[k] + Unzigzag8(deltas[k * rowSize + i]));
+				vertices[i * vertexSize + k] = last[k];
+			}
+		}
+	}
+
+	SSSE3_TARGET inline __m128i Unzigzag8(__m128i value)
+	{
+		__m128i shifted = _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7f));
+		__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+		return _mm_xor_si128(shifted, sign);
+	}
+
+	//same as DecodeGroup, but only called with GroupReadBytes left so the loads can run past the group
+	SSSE3_TARGET inline const uint8_t* DecodeGroupSIMD(int code, const uint8_t* data, const uint8_t* end, uint8_t* values, const Tables& tables)
+	{
+		if (code == 0)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_setzero_si128());
+			return data;
+		}
+
+		if (code == 3)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+			return data + GroupSize;
+		}
+
+		__m128i selected;
+		size_t packedBytes;
+		if (code == 1)
+		{
+			int packed;
+			memcpy(&packed, data, sizeof(int));
+			__m128i sel2 = _mm_cvtsi32_si128(packed);
+			__m128i sel22 = _mm_unpacklo_epi8(_mm_srli_epi16(sel2, 4), sel2);
+			__m128i sel2222 = _mm_unpacklo_epi8(_mm_srli_epi16(sel22, 2), sel22);
+			selected = _mm_and_si128(sel2222, _mm_set1_epi8(3));
+			packedBytes = 4;
+		}
+		else
+		{
+			__m128i sel4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+			__m128i sel44 = _mm_unpacklo_epi8(_mm_srli_epi16(sel4, 4), sel4);
+			selected = _mm_and_si128(sel44, _mm_set1_epi8(15));
+			packedBytes = 8;
+		}
+
+		__m128i full = _mm_cmpeq_epi8(selected, _mm_set1_epi8((code == 1) ? 3 : 15));
+		int mask = _mm_movemask_epi8(full);
+		int lowMask = mask & 0xff;
+		int highMask = mask >> 8;
+
+		//the stored bytes are moved into the lanes that were full, the high half continues after the ones of the low half
+		__m128i lowShuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tables.groupShuffle[lowMask]));
+		__m128i highShuffle = _mm_add_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(tables.groupShuffle[highMask])), _mm_set1_epi8(static_cast<char>(tables.groupCount[lowMask])));
+		__m128i shuffle = _mm_unpacklo_epi64(lowShuffle, highShuffle);
+
+		__m128i stored = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + packedBytes)), shuffle);
+		__m128i result = _mm_or_si128(stored, _mm_andnot_si128(full, selected));
+
+		const uint8_t* next = data + packedBytes + tables.groupCount[lowMask] + tables.groupCount[highMask];
+		if (next > end)
+		{
+			return nullptr;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(values), result);
+		return next;
+	}
+
+	SSSE3_TARGET const uint8_t* DecodeBlockSIMD(const uint8_t* data, const uint8_t* end, uint8_t* deltas, size_t rowSize, size_t vertexSize, const Tables& tables)
+	{
+		size_t groupCount = rowSize / GroupSize;
+		size_t headerBytes = (groupCount + 3) / 4;
+
+		for (size_t k = 0; k < vertexSize; k++)
+		{
+			if (static_cast<size_t>(end - data) < headerBytes)
+			{
+				return nullptr;
+			}
+			const uint8_t* header = data;
+			data += headerBytes;
+
+			for (size_t group = 0; group < groupCount; group++)
+			{
+				int code = (header[group / 4] >> ((group % 4) * 2)) & 3;
+				uint8_t* values = deltas + k * rowSize + group * GroupSize;
+
+				//the last groups of the stream go through the scalar decoder, which never reads past end
+				data = (static_cast<size_t>(end - data) >= GroupReadBytes) ? DecodeGroupSIMD(code, data, end, values, tables) : DecodeGroup(code, data, end, values);
+				if (data == nullptr)
+				{
+					return nullptr;
+				}
+			}
+		}
+		return data;
+	}
+
+	//adds the deltas of four vertices held as 4 byte words to the word of the vertex before, last holds that word in every lane
+	SSSE3_TARGET inline __m128i PrefixSum8(__m128i words, __m128i& last)
+	{
+		words = _mm_add_epi8(words, _mm_slli_si128(words, 4));
+		words = _mm_add_epi8(words, _mm_slli_si128(words, 8));
+		words = _mm_add_epi8(words, last);
+		last = _mm_shuffle_epi32(words, 0xFF);
+		return words;
+	}
+
+	SSSE3_TARGET inline void StoreWords(__m128i words, uint8_t* vertex, size_t vertexSize)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			int word = _mm_cvtsi128_si32(words);
+			memcpy(vertex + j * vertexSize, &word, sizeof(int));
+			words = _mm_srli_si128(words, 4);
+		}
+	}
+
+	//four byte rows of 16 vertices transposed into 4 byte words and added up, four words of four vertices each
+	SSSE3_TARGET inline void SumWords(const uint8_t* deltas, size_t rowSize, __m128i& lastWords, __m128i words[4])
+	{
+		__m128i row0 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas)));
+		__m128i row1 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + rowSize)));
+		__m128i row2 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + 2 * rowSize)));
+		__m128i row3 = Unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + 3 * rowSize)));
+
+		__m128i low01 = _mm_unpacklo_epi8(row0, row1);
+		__m128i high01 = _mm_unpackhi_epi8(row0, row1);
+		__m128i low23 = _mm_unpacklo_epi8(row2, row3);
+		__m128i high23 = _mm_unpackhi_epi8(row2, row3);
+
+		words[0] = PrefixSum8(_mm_unpacklo_epi16(low01, low23), lastWords);
+		words[1] = PrefixSum8(_mm_unpackhi_epi16(low01, low23), lastWords);
+		words[2] = PrefixSum8(_mm_unpacklo_epi16(high01, high23), lastWords);
+		words[3] = PrefixSum8(_mm_unpackhi_epi16(high01, high23), lastWords);
+	}
+
+	//16 bytes of every vertex at a time, so whole vertex rows can be stored instead of single words. Used for vertex sizes that are a multiple of 16
+	SSSE3_TARGET void ReconstructRowsSIMD(const uint8_t* deltas, size_t rowSize, size_t fullCount, size_t vertexSize, uint8_t* last, uint8_t* vertices)
+	{
+		for (size_t k = 0; k < vertexSize; k += 16)
+		{
+			__m128i lastWords[4];
+			for (int w = 0; w < 4; w++)
+			{
+				int lastWord;
+				memcpy(&lastWord, last + k + 4 * w, sizeof(int));
+				lastWords[w] = _mm_set1_epi32(lastWord);
+			}
+
+			for (size_t i = 0; i < fullCount; i += GroupSize)
+			{
+				//words[w][q] holds word w of vertices 4q to 4q + 3
+				__m128i words[4][4];
+				for (int w = 0; w < 4; w++)
+				{
+					SumWords(deltas + (k + 4 * w) * rowSize + i, rowSize, lastWords[w], words[w]);
+				}
+
+				for (int q = 0; q < 4; q++)
+				{
+					__m128i low01 = _mm_unpacklo_epi32(words[0][q], words[1][q]);
+					__m128i low23 = _mm_unpacklo_epi32(words[2][q], words[3][q]);
+					__m128i high01 = _mm_unpackhi_epi32(words[0][q], words[1][q]);
+					__m128i high23 = _mm_unpackhi_epi32(words[2][q], words[3][q]);
+
+					uint8_t* vertex = vertices + (i + 4 * q) * vertexSize + k;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(vertex), _mm_unpacklo_epi64(low01, low23));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(vertex + vertexSize), _mm_unpackhi_epi64(low01, low23));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(vertex + 2 * vertexSize), _mm_unpacklo_epi64(high01, high23));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(vertex + 3 * vertexSize), _mm_unpackhi_epi64(high01, high23));
+				}
+			}
+
+			for (int w = 0; w < 4; w++)
+			{
+				int lastWord = _mm_cvtsi128_si32(lastWords[w]);
+				memcpy(last + k + 4 * w, &lastWord, sizeof(int));
+			}
+		}
+	}
+
+	//the running sum of a vertex is one add on 4 byte words, any vertex size
+	SSSE3_TARGET void ReconstructSIMD(const uint8_t* deltas, size_t rowSize, size_t count, size_t vertexSize, uint8_t* last, uint8_t* vertices)
+	{
+		size_t fullCount = count & ~(GroupSize - 1);
+
+		for (size_t k = 0; (k < vertexSize) && (vertexSize % 16 != 0); k += 4)
+		{
+			int lastWord;
+			memcpy(&lastWord, last + k, sizeof(int));
+			__m128i lastWords = _mm_set1_epi32(lastWord);
+
+			for (size_t i = 0; i < fullCount; i += GroupSize)
+			{
+				__m128i words[4];
+				SumWords(deltas + k * rowSize + i, rowSize, lastWords, words);
+
+				uint8_t* vertex = vertices + i * vertexSize + k;
+				for (int q = 0; q < 4; q++)
+				{
+					StoreWords(words[q], vertex + 4 * q * vertexSize, vertexSize);
+				}
+			}
+
+			lastWord = _mm_cvtsi128_si32(lastWords);
+			memcpy(last + k, &lastWord, sizeof(int));
+		}
+
+		if (vertexSize % 16 == 0)
+		{
+			ReconstructRowsSIMD(deltas, rowSize, fullCount, vertexSize, last, vertices);
+		}
+
+		//the vertices after the last full group, usually only in the last block
+		ReconstructScalar(deltas + fullCount, rowSize, count - fullCount, vertexSize, last, vertices + fullCount * vertexSize);
+	}
+
+	//decodes groups of four while 16 bytes can be loaded, returns how many indices that was
+	SSSE3_TARGET size_t DecodeIndicesSIMD(uint32_t* indices, size_t groupCount, const uint8_t* controls, const uint8_t*& data, const uint8_t* end, uint32_t& previous, const Tables& tables)
+	{
+		__m128i last = _mm_set1_epi32(static_cast<int>(previous));
+		size_t group = 0;
+		for (; (group < groupCount) && (static_cast<size_t>(end - data) >= 16); group++)
+		{
+			uint8_t control = controls[group];
+			__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.indexShuffle[control]));
+			__m128i zigzagged = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), shuffle);
+			data += tables.indexLength[control];
+
+			__m128i deltas = _mm_xor_si128(_mm_srli_epi32(zigzagged, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(zigzagged, _mm_set1_epi32(1))));
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+			deltas = _mm_add_epi32(deltas, last);
+			last = _mm_shuffle_epi32(deltas, 0xFF);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + group * 4), deltas);
+		}
+
+		previous = static_cast<uint32_t>(_mm_cvtsi128_si32(last));
+		return group * 4;
+	}
+}
+
+void MeshCodec::EncodeVertices(const void* vertices, size_t vertexCount, size_t vertexSize, std::vector<uint8_t>& encoded)
+{
+	encoded.clear();
+	encoded.push_back(VertexHeader);
+
+	const uint8_t* source = static_cast<const uint8_t*>(vertices);
+	size_t blockVertices = BlockVertices(vertexSize);
+
+	uint8_t last[MaxVertexSize] = {};
+	uint8_t deltas[MaxBlockVertices];
+
+	for (size_t start = 0; start < vertexCount; start += blockVertices)
+	{
+		size_t count = std::min(blockVertices, vertexCount - start);
+		size_t groupCount = (count + GroupSize - 1) / GroupSize;
+
+		for (size_t k = 0; k < vertexSize; k++)
+		{
+			uint8_t previous = last[k];
+			for (size_t i = 0; i < count; i++)
+			{
+				uint8_t value = source[(start + i) * vertexSize + k];
+				deltas[i] = Zigzag8(static_cast<uint8_t>(value - previous));
+				previous = value;
+			}
+			memset(deltas + count, 0, groupCount * GroupSize - count);
+			last[k] = previous;
+
+			size_t header = encoded.size();
+			encoded.resize(encoded.size() + (groupCount + 3) / 4, 0);
+			for (size_t group = 0; group < groupCount; group++)
+			{
+				int code = EncodeGroup(deltas + group * GroupSize, encoded);
+				encoded[header + group / 4] |= static_cast<uint8_t>(code << ((group % 4) * 2));
+			}
+		}
+	}
+}
+
+bool MeshCodec::DecodeVertices(void* vertices, size_t vertexCount, size_t vertexSize, const uint8_t* encoded, size_t encodedSize, bool allowSIMD)
+{
+	if ((vertexSize == 0) || (vertexSize % 4 != 0) || (vertexSize > MaxVertexSize) || (encodedSize < 1) || (encoded[0] != VertexHeader))
+	{
+		return false;
+	}
+
+	const Tables& tables = GetTables();
+	bool SIMD = allowSIMD && tables.SSSE3;
+
+	const uint8_t* data = encoded + 1;
+	const uint8_t* end = encoded + encodedSize;
+	uint8_t* destination = static_cast<uint8_t*>(vertices);
+	size_t blockVertices = BlockVertices(vertexSize);
+
+	uint8_t last[MaxVertexSize] = {};
+	std::vector<uint8_t> deltas(blockVertices * vertexSize);
+
+	for (size_t start = 0; start < vertexCount; start += blockVertices)
+	{
+		size_t count = std::min(blockVertices, vertexCount - start);
+		size_t rowSize = (count + GroupSize - 1) / GroupSize * GroupSize;
+
+		if (SIMD)
+		{
+			data = DecodeBlockSIMD(data, end, deltas.data(), rowSize, vertexSize, tables);
+			if (data == nullptr)
+			{
+				return false;
+			}
+			ReconstructSIMD(deltas.data(), rowSize, count, vertexSize, last, destination + start * vertexSize);
+		}
+		else
+		{
+			data = DecodeBlockScalar(data, end, deltas.data(), rowSize, vertexSize);
+			if (data == nullptr)
+			{
+				return false;
+			}
+			ReconstructScalar(deltas.data(), rowSize, count, vertexSize, last, destination + start * vertexSize);
+		}
+	}
+
+	return data == end;
+}
+
+void MeshCodec::EncodeIndices(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>& encoded)
+{
+	size_t controlBytes = (indexCount + 3) / 4;
+	encoded.assign(1 + controlBytes, 0);
+	encoded[0] = IndexHeader;
+
+	uint32_t previous = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t value = Zigzag32(indices[i] - previous);
+		previous = indices[i];
+
+		int length = (value < (1u << 8)) ? 1 : (value < (1u << 16)) ? 2 : (value < (1u << 24)) ? 3 : 4;
+		encoded[1 + i / 4] |= static_cast<uint8_t>((length - 1) << ((i % 4) * 2));
+		for (int b = 0; b < length; b++)
+		{
+			encoded.push_back(static_cast<uint8_t>(value >> (8 * b)));
+		}
+	}
+}
+
+bool MeshCodec::DecodeIndices(uint32_t* indices, size_t indexCount, const uint8_t* encoded, size_t encodedSize, bool allowSIMD)
+{
+	size_t controlBytes = (indexCount + 3) / 4;
+	if ((encodedSize < 1 + controlBytes) || (encoded[0] != IndexHeader))
+	{
+		return false;
+	}
+
+	const Tables& tables = GetTables();
+	const uint8_t* controls = encoded + 1;
+	const uint8_t* data = controls + controlBytes;
+	const uint8_t* end = encoded + encodedSize;
+
+	//whole groups of four as far as 16 bytes can be loaded, the rest one index at a time
+	uint32_t previous = 0;
+	size_t i = 0;
+	if (allowSIMD && tables.SSSE3)
+	{
+		i = DecodeIndicesSIMD(indices, indexCount / 4, controls, data, end, previous, tables);
+	}
+
+	for (; i < indexCount; i++)
+	{
+		int length = ((controls[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+		if (end - data < length)
+		{
+			return false;
+		}
+
+		uint32_t value = 0;
+		for (int b = 0; b < length; b++)
+		{
+			value |= static_cast<uint32_t>(data[b]) << (8 * b);
+		}
+		data += length;
+
+		previous += Unzigzag32(value);
+		indices[i] = previous;
+	}
+
+	//unused control bits of the last group are zero, anything else is not an encoding of indexCount indices
+	if ((indexCount % 4 != 0) && ((controls[controlBytes - 1] >> ((indexCount % 4) * 2)) != 0))
+	{
+		return false;
+	}
+
+	return data == end;
+}
+
+size_t MeshCodec::MaxVertexCount(size_t encodedSize, size_t vertexSize)
+{
+	if ((encodedSize < 1) || (vertexSize == 0))
+	{
+		return 0;
+	}
+
+	//every block takes at least one header byte per byte of a vertex
+	return (encodedSize - 1) / vertexSize * BlockVertices(vertexSize);
+}
+
+size_t MeshCodec::MaxIndexCount(size_t encodedSize)
+{
+	if (encodedSize < 1)
+	{
+		return 0;
+	}
+
+	//every index takes at least one byte and a quarter of a control byte
+	return (encodedSize - 1) / 5 * 4 + ((encodedSize - 1) % 5 * 4) / 5;
+}
+
+bool MeshCodec::SIMDAvailable()
+{
+	return GetTables().SSSE3;
+}
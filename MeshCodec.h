@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Compression of vertex and index streams for storage on disk, decoded on load.
+//Vertices are delta coded byte by byte against the vertex before, zigzagged and packed in groups of 16 at 0, 2, 4 or 8 bits with the
+//values that do not fit stored whole after each group, the byte oriented scheme of meshoptimizer's vertex codec.
+//Indices are delta coded against the index before, zigzagged and stored in 1 to 4 bytes with a 2 bit length each (stream vbyte).
+//Both decoders have an SSSE3 path that is used when the CPU has it.
+namespace MeshCodec
+{
+	//vertexSize has to be a multiple of 4 and at most MaxVertexSize
+	const size_t MaxVertexSize = 256;
+
+	void EncodeVertices(const void* vertices, size_t vertexCount, size_t vertexSize, std::vector<uint8_t>& encoded);
+	void EncodeIndices(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>& encoded);
+
+	//fail on anything that is not exactly the encoding of vertexCount or indexCount elements, without reading past encodedSize.
+	//allowSIMD false forces the scalar decoder, both give the same result
+	bool DecodeVertices(void* vertices, size_t vertexCount, size_t vertexSize, const uint8_t* encoded, size_t encodedSize, bool allowSIMD = true);
+	bool DecodeIndices(uint32_t* indices, size_t indexCount, const uint8_t* encoded, size_t encodedSize, bool allowSIMD = true);
+
+	//the most elements an encoding of encodedSize bytes can hold, so a count read from a file is checked before anything is allocated for it
+	size_t MaxVertexCount(size_t encodedSize, size_t vertexSize);
+	size_t MaxIndexCount(size_t encodedSize);
+
+	//whether the decoders can take the SSSE3 path on this CPU
+	bool SIMDAvailable();
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "VertexFormat.h"
+
+//the format every import produces and every cache holds, narrower formats are converted from it when a mesh is uploaded
+using Vertex = VertexOf<VertexAttribute::Position, VertexAttribute::Normal, VertexAttribute::UV>;
+
+//for meshes none of whose materials sample a texture
+using UntexturedVertex = VertexOf<VertexAttribute::Position, VertexAttribute::Normal>;
+
+//the stream depth and shadow passes read, they need nothing but where the triangles are
+using PositionVertex = VertexOf<VertexAttribute::Position>;
+
+static_assert(sizeof(Vertex) == Vertex::Stride, "vertex attributes must not be padded");
+static_assert(sizeof(UntexturedVertex) == UntexturedVertex::Stride, "vertex attributes must not be padded");
+static_assert(sizeof(PositionVertex) == PositionVertex::Stride, "vertex attributes must not be padded");
+static_assert(std::is_trivially_copyable_v<Vertex>, "vertices are copied as bytes into caches and buffers");
+
+struct Submesh {
+	int Start = 0;
+	int size = 0;
+	int material = 0;
+
+	//where the vertices of the mesh start in the vertex buffer, 0 unless the mesh shares the buffer with others
+	int baseVertex = 0;
+};
+
+//a coarser version of the whole mesh. submeshes[i] covers the same part as MeshData::submeshes[i] and may have no triangles left
+struct MeshLOD
+{
+	//how far the surface may have moved from the full resolution mesh, relative to the bounding radius
+	float error = 0.0f;
+	std::vector<Submesh> submeshes;
+};
+
+//a short run of neighbouring triangles that is culled on its own, against the frustum and by the way it faces
+struct Meshlet
+{
+	uint32_t indexStart = 0;
+	uint32_t indexCount = 0;
+
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+
+	//every triangle normal lies within the cone around coneAxis, coneCutoff is the sine of its half angle. 1 when it cannot be culled by facing
+	float coneAxis[3] = { 0.0f, 0.0f, 0.0f };
+	float coneCutoff = 1.0f;
+};
+
+//mesh space bounding volumes of all vertex positions
+struct Bounds
+{
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+
+	float min[3] = { 0.0f, 0.0f, 0.0f };
+	float max[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+//CPU side result of a mesh import. Materials are kept by name until the owner resolves them through SharedResources.
+struct MeshData
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+
+	std::vector<Submesh> submeshes;
+	std::vector<std::string> submeshMaterials;
+
+	std::vector<std::string> materialLibraries;
+
+	//from fine to coarse, their index ranges follow the full resolution ones in indices
+	std::vector<MeshLOD> lods;
+
+	//ordered by indexStart, together they cover the submeshes of every level
+	std::vector<Meshlet> meshlets;
+
+	Bounds bounds;
+};
+
+//receives a mesh in batches, for imports that never hold all of it in memory. Indices only refer to vertices that were handed on before them
+class MeshSink
+{
+	public:
+		virtual ~MeshSink() = default;
+
+		virtual bool Vertices(const Vertex* vertices, size_t count) = 0;
+		virtual bool Indices(const uint32_t* indices, size_t count) = 0;
+};
@@ -0,0 +1,604 @@
+#include "MeshOptimizer.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "MeshBounds.h"
+
+namespace
+{
+	const uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	//cache size the Forsyth scoring assumes, larger than any real cache so it also works well for smaller ones
+	const int ForsythCacheSize = 32;
+
+	//cache size used to find cluster boundaries for the overdraw pass
+	const int ClusterCacheSize = 16;
+
+	//FIFO cache simulation using one timestamp per vertex, timestamps must be zeroed and as large as the vertex count
+	size_t CountCacheMisses(const uint32_t* indices, size_t indexCount, int cacheSize, std::vector<uint32_t>& timestamps)
+	{
+		uint32_t time = static_cast<uint32_t>(cacheSize) + 1;
+		size_t misses = 0;
+
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			uint32_t vertex = indices[i];
+			if (time - timestamps[vertex] > static_cast<uint32_t>(cacheSize))
+			{
+				timestamps[vertex] = time++;
+				misses++;
+			}
+		}
+
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			timestamps[indices[i]] = 0;
+		}
+
+		return misses;
+	}
+
+	uint64_t MixKey(uint64_t x, uint64_t y, uint64_t z)
+	{
+		uint64_t hash = x * 0x9E3779B97F4A7C15ull;
+		hash ^= y + 0x7F4A7C159E3779B9ull + (hash << 6) + (hash >> 2);
+		hash ^= z + 0x94D049BB133111EBull + (hash << 6) + (hash >> 2);
+
+		//splitmix64 finalizer
+		hash ^= hash >> 30;
+		hash *= 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 27;
+		hash *= 0x94D049BB133111EBull;
+		hash ^= hash >> 31;
+		return hash;
+	}
+
+	bool WithinEpsilon(const Vertex& a, const Vertex& b, float epsilon)
+	{
+		if (epsilon <= 0.0f)
+		{
+			return memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			if ((fabsf(a.pos[i] - b.pos[i]) > epsilon) || (fabsf(a.norm[i] - b.norm[i]) > epsilon))
+			{
+				return false;
+			}
+		}
+		for (int i = 0; i < 2; i++)
+		{
+			if (fabsf(a.uv[i] - b.uv[i]) > epsilon)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	float VertexScore(int cachePosition, uint32_t activeTriangles)
+	{
+		const float CacheDecayPower = 1.5f;
+		const float LastTriangleScore = 0.75f;
+		const float ValenceBoostScale = 2.0f;
+		const float ValenceBoostPower = 0.5f;
+
+		if (activeTriangles == 0)
+		{
+			//no triangles left to draw, the vertex is useless
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				//used by the triangle that was just drawn, scored low on purpose so strips are not favoured over fans
+				score = LastTriangleScore;
+			}
+			else
+			{
+				float scaler = 1.0f / (ForsythCacheSize - 3);
+				score = powf(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+			}
+		}
+
+		//vertices with few triangles left get a boost so they are finished off and leave the cache
+		score += ValenceBoostScale * powf(static_cast<float>(activeTriangles), -ValenceBoostPower);
+		return score;
+	}
+
+	void ForsythRange(uint32_t* indices, size_t indexCount, std::vector<uint32_t>& localOf)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		//compact vertex ids so the per vertex state is only as large as this submesh
+		std::vector<uint32_t> globalOf;
+		std::vector<uint32_t> local(indexCount);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			uint32_t& id = localOf[indices[i]];
+			if (id == InvalidIndex)
+			{
+				id = static_cast<uint32_t>(globalOf.size());
+				globalOf.push_back(indices[i]);
+			}
+			local[i] = id;
+		}
+		for (uint32_t vertex : globalOf)
+		{
+			localOf[vertex] = InvalidIndex;
+		}
+
+		size_t vertexCount = globalOf.size();
+
+		std::vector<uint32_t> activeCount(vertexCount, 0);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			activeCount[local[i]]++;
+		}
+
+		std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacencyOffset[v + 1] = adjacencyOffset[v] + activeCount[v];
+		}
+
+		std::vector<uint32_t> adjacency(indexCount);
+		std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacency[fill[local[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vertexScore[v] = VertexScore(-1, activeCount[v]);
+		}
+
+		std::vector<float> triangleScore(triangleCount);
+		std::vector<bool> triangleAdded(triangleCount, false);
+
+		int bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			triangleScore[t] = vertexScore[local[t * 3]] + vertexScore[local[t * 3 + 1]] + vertexScore[local[t * 3 + 2]];
+			if (triangleScore[t] > bestScore)
+			{
+				bestScore = triangleScore[t];
+				bestTriangle = static_cast<int>(t);
+			}
+		}
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> newCache;
+		cache.reserve(ForsythCacheSize + 3);
+		newCache.reserve(ForsythCacheSize + 3);
+
+		std::vector<uint32_t> output(indexCount);
+		size_t nextUnadded = 0;
+
+		for (size_t drawn = 0; drawn < triangleCount; drawn++)
+		{
+			if (bestTriangle < 0)
+			{
+				//nothing in the cache has triangles left, continue with the next triangle in the original order
+				while (triangleAdded[nextUnadded])
+				{
+					nextUnadded++;
+				}
+				bestTriangle = static_cast<int>(nextUnadded);
+			}
+
+			size_t triangle = static_cast<size_t>(bestTriangle);
+			triangleAdded[triangle] = true;
+
+			newCache.clear();
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t vertex = local[triangle * 3 + k];
+				output[drawn * 3 + k] = globalOf[vertex];
+
+				uint32_t* list = &adjacency[adjacencyOffset[vertex]];
+				for (uint32_t i = 0; i < activeCount[vertex]; i++)
+				{
+					if (list[i] == triangle)
+					{
+						std::swap(list[i], list[activeCount[vertex] - 1]);
+						activeCount[vertex]--;
+						break;
+					}
+				}
+
+				if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			size_t triangleVertices = newCache.size();
+			for (uint32_t vertex : cache)
+			{
+				if (std::find(newCache.begin(), newCache.begin() + triangleVertices, vertex) == newCache.begin() + triangleVertices)
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			for (size_t i = 0; i < newCache.size(); i++)
+			{
+				uint32_t vertex = newCache[i];
+				cachePosition[vertex] = (i < ForsythCacheSize) ? static_cast<int>(i) : -1;
+				vertexScore[vertex] = VertexScore(cachePosition[vertex], activeCount[vertex]);
+			}
+
+			bestTriangle = -1;
+			bestScore = -1.0f;
+			for (uint32_t vertex : newCache)
+			{
+				const uint32_t* list = &adjacency[adjacencyOffset[vertex]];
+				for (uint32_t i = 0; i < activeCount[vertex]; i++)
+				{
+					uint32_t t = list[i];
+					triangleScore[t] = vertexScore[local[t * 3]] + vertexScore[local[t * 3 + 1]] + vertexScore[local[t * 3 + 2]];
+					if (triangleScore[t] > bestScore)
+					{
+						bestScore = triangleScore[t];
+						bestTriangle = static_cast<int>(t);
+					}
+				}
+			}
+
+			if (newCache.size() > ForsythCacheSize)
+			{
+				newCache.resize(ForsythCacheSize);
+			}
+			cache.swap(newCache);
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void Subtract(const float a[3], const float b[3], float result[3])
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			result[i] = a[i] - b[i];
+		}
+	}
+
+	void OverdrawRange(const std::vector<Vertex>& vertices, uint32_t* indices, size_t indexCount, float threshold, std::vector<uint32_t>& timestamps)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		//a triangle that misses on all three vertices restarts the cache, so the order can change there for free
+		std::vector<size_t> clusters;
+		{
+			uint32_t time = ClusterCacheSize + 1;
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				int misses = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t vertex = indices[t * 3 + k];
+					if (time - timestamps[vertex] > ClusterCacheSize)
+					{
+						timestamps[vertex] = time++;
+						misses++;
+					}
+				}
+				if ((t == 0) || (misses == 3))
+				{
+					clusters.push_back(t);
+				}
+			}
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				timestamps[indices[i]] = 0;
+			}
+		}
+		if (clusters.size() < 2)
+		{
+			return;
+		}
+		clusters.push_back(triangleCount);
+
+		size_t clusterCount = clusters.size() - 1;
+		std::vector<float> clusterCentroid(clusterCount * 3, 0.0f);
+		std::vector<float> clusterNormal(clusterCount * 3, 0.0f);
+		std::vector<float> clusterArea(clusterCount, 0.0f);
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+			{
+				const float* p0 = vertices[indices[t * 3]].pos;
+				const float* p1 = vertices[indices[t * 3 + 1]].pos;
+				const float* p2 = vertices[indices[t * 3 + 2]].pos;
+
+				float e1[3];
+				float e2[3];
+				Subtract(p1, p0, e1);
+				Subtract(p2, p0, e2);
+
+				//the unnormalized cross product weighs every face normal by its area
+				float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+				for (int i = 0; i < 3; i++)
+				{
+					float centroid = (p0[i] + p1[i] + p2[i]) / 3.0f;
+					clusterCentroid[c * 3 + i] += centroid * area;
+					clusterNormal[c * 3 + i] += normal[i];
+					meshCentroid[i] += centroid * area;
+				}
+				clusterArea[c] += area;
+				meshArea += area;
+			}
+		}
+
+		if (meshArea > 0.0f)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				meshCentroid[i] /= meshArea;
+			}
+		}
+
+		//clusters far out along their own normal are likely to cover the rest, so they go first
+		std::vector<float> sortKey(clusterCount, 0.0f);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			if (clusterArea[c] <= 0.0f)
+			{
+				continue;
+			}
+
+			float* normal = &clusterNormal[c * 3];
+			float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+
+			for (int i = 0; i < 3; i++)
+			{
+				float centroid = clusterCentroid[c * 3 + i] / clusterArea[c];
+				sortKey[c] += (centroid - meshCentroid[i]) * (normal[i] / length);
+			}
+		}
+
+		std::vector<size_t> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&sortKey](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+		std::vector<uint32_t> sorted;
+		sorted.reserve(indexCount);
+		for (size_t c : order)
+		{
+			sorted.insert(sorted.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+		}
+
+		size_t missesBefore = CountCacheMisses(indices, indexCount, ClusterCacheSize, timestamps);
+		size_t missesAfter = CountCacheMisses(sorted.data(), indexCount, ClusterCacheSize, timestamps);
+		if (static_cast<float>(missesAfter) > static_cast<float>(missesBefore) * threshold)
+		{
+			return;
+		}
+
+		std::copy(sorted.begin(), sorted.end(), indices);
+	}
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const MeshData& mesh, int cacheSize)
+{
+	CacheStats stats;
+	if (mesh.indices.empty())
+	{
+		return stats;
+	}
+
+	std::vector<uint32_t> timestamps(mesh.vertices.size(), 0);
+	size_t misses = CountCacheMisses(mesh.indices.data(), mesh.indices.size(), cacheSize, timestamps);
+
+	std::vector<bool> referenced(mesh.vertices.size(), false);
+	size_t uniqueVertices = 0;
+	for (uint32_t index : mesh.indices)
+	{
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			uniqueVertices++;
+		}
+	}
+
+	stats.ACMR = static_cast<double>(misses) / static_cast<double>(mesh.indices.size() / 3);
+	stats.ATVR = static_cast<double>(misses) / static_cast<double>(uniqueVertices);
+	return stats;
+}
+
+void MeshOptimizer::WeldVertices(MeshData& mesh, float epsilon)
+{
+	std::vector<uint32_t> remap(mesh.vertices.size());
+	std::vector<Vertex> welded;
+	welded.reserve(mesh.vertices.size());
+
+	//vertices are bucketed by position, with an epsilon the buckets are epsilon wide and the neighbouring ones are searched too
+	std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+	cells.reserve(mesh.vertices.size());
+
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		const Vertex& vertex = mesh.vertices[i];
+
+		int64_t cell[3];
+		for (int k = 0; k < 3; k++)
+		{
+			if (epsilon > 0.0f)
+			{
+				cell[k] = static_cast<int64_t>(floor(static_cast<double>(vertex.pos[k]) / epsilon));
+			}
+			else
+			{
+				uint32_t bits;
+				memcpy(&bits, &vertex.pos[k], sizeof(uint32_t));
+				cell[k] = bits;
+			}
+		}
+
+		uint32_t found = InvalidIndex;
+		int range = (epsilon > 0.0f) ? 1 : 0;
+		for (int x = -range; (x <= range) && (found == InvalidIndex); x++)
+		{
+			for (int y = -range; (y <= range) && (found == InvalidIndex); y++)
+			{
+				for (int z = -range; (z <= range) && (found == InvalidIndex); z++)
+				{
+					std::unordered_map<uint64_t, std::vector<uint32_t>>::iterator bucket = cells.find(MixKey(cell[0] + x, cell[1] + y, cell[2] + z));
+					if (bucket == cells.end())
+					{
+						continue;
+					}
+
+					for (uint32_t candidate : bucket->second)
+					{
+						if (WithinEpsilon(welded[candidate], vertex, epsilon))
+						{
+							found = candidate;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		if (found == InvalidIndex)
+		{
+			found = static_cast<uint32_t>(welded.size());
+			welded.push_back(vertex);
+			cells[MixKey(cell[0], cell[1], cell[2])].push_back(found);
+		}
+		remap[i] = found;
+	}
+
+	for (uint32_t& index : mesh.indices)
+	{
+		index = remap[index];
+	}
+	mesh.vertices.swap(welded);
+}
+
+void MeshOptimizer::MergeSubmeshes(MeshData& mesh)
+{
+	std::vector<Submesh> merged;
+	std::vector<std::string> mergedMaterials;
+
+	for (size_t i = 0; i < mesh.submeshes.size(); i++)
+	{
+		const Submesh& submesh = mesh.submeshes[i];
+		if (!merged.empty() && (mergedMaterials.back() == mesh.submeshMaterials[i]) && (merged.back().Start + merged.back().size == submesh.Start))
+		{
+			merged.back().size += submesh.size;
+			continue;
+		}
+
+		merged.push_back(submesh);
+		mergedMaterials.push_back(mesh.submeshMaterials[i]);
+	}
+
+	mesh.submeshes.swap(merged);
+	mesh.submeshMaterials.swap(mergedMaterials);
+}
+
+void MeshOptimizer::OptimizeVertexCache(MeshData& mesh)
+{
+	std::vector<uint32_t> localOf(mesh.vertices.size(), InvalidIndex);
+	for (const Submesh& submesh : mesh.submeshes)
+	{
+		ForsythRange(mesh.indices.data() + submesh.Start, submesh.size, localOf);
+	}
+}
+
+void MeshOptimizer::OptimizeOverdraw(MeshData& mesh, float threshold)
+{
+	std::vector<uint32_t> timestamps(mesh.vertices.size(), 0);
+	for (const Submesh& submesh : mesh.submeshes)
+	{
+		OverdrawRange(mesh.vertices, mesh.indices.data() + submesh.Start, submesh.size, threshold, timestamps);
+	}
+}
+
+void MeshOptimizer::OptimizeVertexFetch(MeshData& mesh)
+{
+	std::vector<uint32_t> remap(mesh.vertices.size(), InvalidIndex);
+	std::vector<Vertex> reordered;
+	reordered.reserve(mesh.vertices.size());
+
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == InvalidIndex)
+		{
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	//unreferenced vertices are gone, they no longer count towards the bounds
+	mesh.vertices.swap(reordered);
+	mesh.bounds = MeshBounds::Compute(mesh.vertices);
+}
+
+MeshOptimizer::OptimizeStats MeshOptimizer::Optimize(MeshData& mesh, float weldEpsilon)
+{
+	OptimizeStats stats;
+	stats.before = AnalyzeVertexCache(mesh);
+	stats.verticesBefore = mesh.vertices.size();
+	stats.submeshesBefore = mesh.submeshes.size();
+
+	WeldVertices(mesh, weldEpsilon);
+	MergeSubmeshes(mesh);
+	OptimizeVertexCache(mesh);
+	OptimizeOverdraw(mesh);
+	OptimizeVertexFetch(mesh);
+
+	stats.after = AnalyzeVertexCache(mesh);
+	stats.verticesAfter = mesh.vertices.size();
+	stats.submeshesAfter = mesh.submeshes.size();
+	return stats;
+}
+
+void MeshOptimizer::OptimizeLODs(MeshData& mesh)
+{
+	std::vector<uint32_t> localOf(mesh.vertices.size(), InvalidIndex);
+	for (const MeshLOD& lod : mesh.lods)
+	{
+		for (const Submesh& submesh : lod.submeshes)
+		{
+			ForsythRange(mesh.indices.data() + submesh.Start, submesh.size, localOf);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+
+#include "MeshData.h"
+
+//Import time reordering of a MeshData for the GPU. Every step keeps the rendered result the same, only order and sharing change.
+namespace MeshOptimizer
+{
+	//post transform cache statistics, simulated with a FIFO cache of the given size
+	struct CacheStats
+	{
+		double ACMR = 0.0; //cache misses per triangle, 0.5 is the best case for a regular grid
+		double ATVR = 0.0; //cache misses per referenced vertex, 1.0 is optimal
+	};
+
+	struct OptimizeStats
+	{
+		CacheStats before;
+		CacheStats after;
+
+		size_t verticesBefore = 0;
+		size_t verticesAfter = 0;
+		size_t submeshesBefore = 0;
+		size_t submeshesAfter = 0;
+	};
+
+	CacheStats AnalyzeVertexCache(const MeshData& mesh, int cacheSize = 16);
+
+	//merges vertices whose position, normal and uv all lie within epsilon of each other. 0 only merges bit identical vertices
+	void WeldVertices(MeshData& mesh, float epsilon);
+
+	//joins neighbouring submeshes that use the same material so they become one draw call
+	void MergeSubmeshes(MeshData& mesh);
+
+	//reorders the triangles of every submesh for the post transform vertex cache (Forsyth)
+	void OptimizeVertexCache(MeshData& mesh);
+
+	//sorts cache friendly triangle clusters of every submesh so outward facing ones are drawn first.
+	//gives up on a submesh if it would cost more than threshold times its ACMR
+	void OptimizeOverdraw(MeshData& mesh, float threshold = 1.05f);
+
+	//renumbers vertices in the order they are first used and drops unused ones
+	void OptimizeVertexFetch(MeshData& mesh);
+
+	//all of the above in the order they depend on each other
+	OptimizeStats Optimize(MeshData& mesh, float weldEpsilon = 1e-6f);
+
+	//vertex cache order for the level of detail ranges, which Optimize does not touch
+	void OptimizeLODs(MeshData& mesh);
+}
@@ -0,0 +1,672 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	//every level aims for this share of the triangles of the level before it
+	const float LODReduction = 0.5f;
+
+	//a level that keeps more than this share of the triangles of the level before it is not worth switching to
+	const float LODMinimumGain = 0.9f;
+
+	//error limit of the first level relative to the bounding radius, doubled for every level after it
+	const float LODBaseError = 0.01f;
+
+	//border planes weigh much more than surface planes so outlines and submesh seams barely move
+	const double BorderWeight = 10.0;
+
+	//a collapse is rejected if it turns any remaining triangle by more than about 85 degrees
+	const double FlipThreshold = 0.1;
+
+	//symmetric 4x4 matrix of summed plane outer products, weight is the summed triangle area used to turn the sum into a mean
+	struct Quadric
+	{
+		double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+		double ab = 0.0, ac = 0.0, ad = 0.0;
+		double bc = 0.0, bd = 0.0, cd = 0.0;
+		double weight = 0.0;
+	};
+
+	void AddPlane(Quadric& quadric, double a, double b, double c, double d, double weight)
+	{
+		quadric.a2 += a * a * weight;
+		quadric.b2 += b * b * weight;
+		quadric.c2 += c * c * weight;
+		quadric.d2 += d * d * weight;
+		quadric.ab += a * b * weight;
+		quadric.ac += a * c * weight;
+		quadric.ad += a * d * weight;
+		quadric.bc += b * c * weight;
+		quadric.bd += b * d * weight;
+		quadric.cd += c * d * weight;
+	}
+
+	void AddQuadric(Quadric& quadric, const Quadric& other)
+	{
+		quadric.a2 += other.a2;
+		quadric.b2 += other.b2;
+		quadric.c2 += other.c2;
+		quadric.d2 += other.d2;
+		quadric.ab += other.ab;
+		quadric.ac += other.ac;
+		quadric.ad += other.ad;
+		quadric.bc += other.bc;
+		quadric.bd += other.bd;
+		quadric.cd += other.cd;
+		quadric.weight += other.weight;
+	}
+
+	//summed squared plane distance of a point
+	double Evaluate(const Quadric& quadric, const float* pos)
+	{
+		double x = pos[0];
+		double y = pos[1];
+		double z = pos[2];
+
+		double error = quadric.a2 * x * x + quadric.b2 * y * y + quadric.c2 * z * z + quadric.d2
+			+ 2.0 * (quadric.ab * x * y + quadric.ac * x * z + quadric.bc * y * z)
+			+ 2.0 * (quadric.ad * x + quadric.bd * y + quadric.cd * z);
+
+		return (error > 0.0) ? error : 0.0;
+	}
+
+	void Cross(const double a[3], const double b[3], double result[3])
+	{
+		result[0] = a[1] * b[2] - a[2] * b[1];
+		result[1] = a[2] * b[0] - a[0] * b[2];
+		result[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	double Dot(const double a[3], const double b[3])
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	//unnormalized normal, its length is twice the triangle area
+	void TriangleNormal(const float* p0, const float* p1, const float* p2, double normal[3])
+	{
+		double edge0[3] = { static_cast<double>(p1[0]) - p0[0], static_cast<double>(p1[1]) - p0[1], static_cast<double>(p1[2]) - p0[2] };
+		double edge1[3] = { static_cast<double>(p2[0]) - p0[0], static_cast<double>(p2[1]) - p0[1], static_cast<double>(p2[2]) - p0[2] };
+		Cross(edge0, edge1, normal);
+	}
+
+	struct Edge
+	{
+		uint32_t low;
+		uint32_t high;
+		uint32_t triangle;
+		bool operator<(const Edge& other) const
+		{
+			return (low != other.low) ? (low < other.low) : (high != other.high) ? (high < other.high) : (triangle < other.triangle);
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		uint32_t from;
+		uint32_t to;
+	};
+
+	//the state of one Simplify call. Vertices sharing a position form a group, collapses move a whole group onto a neighbouring one
+	//so uv and normal seams stay closed. Positions never change, a collapsed group just points at the group it was snapped to.
+	class Simplification
+	{
+		public :
+			Simplification(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleRegions) :
+				vertices(vertices), indices(indices), triangleRegions(triangleRegions)
+			{
+				liveTriangles.resize(indices.size() / 3);
+				for (size_t i = 0; i < liveTriangles.size(); i++)
+				{
+					liveTriangles[i] = static_cast<uint32_t>(i);
+				}
+
+				BuildGroups();
+				BuildQuadrics();
+			}
+
+			float Run(size_t targetIndexCount, float targetError)
+			{
+				double maxCost = static_cast<double>(targetError) * static_cast<double>(targetError);
+				double largestCost = 0.0;
+
+				while (true)
+				{
+					CollectTriangles();
+					if (liveTriangles.size() * 3 <= targetIndexCount)
+					{
+						break;
+					}
+
+					CollectEdges();
+					if (collapses.empty())
+					{
+						break;
+					}
+
+					std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+					//at most one collapse per group and pass, everything else is re-evaluated against the new surface in the next pass
+					std::vector<bool> locked(groupCount, false);
+					size_t remainingTriangles = liveTriangles.size();
+					bool collapsed = false;
+
+					for (const Collapse& collapse : collapses)
+					{
+						if (collapse.cost > maxCost)
+						{
+							break;
+						}
+						if (locked[collapse.from] || locked[collapse.to] || Flips(collapse.from, collapse.to))
+						{
+							continue;
+						}
+
+						remainingTriangles -= SharedTriangles(collapse.from, collapse.to);
+						groupRemap[collapse.from] = collapse.to;
+						AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+						locked[collapse.from] = true;
+						locked[collapse.to] = true;
+
+						largestCost = std::max(largestCost, collapse.cost);
+						collapsed = true;
+
+						if (remainingTriangles * 3 <= targetIndexCount)
+						{
+							break;
+						}
+					}
+
+					if (!collapsed)
+					{
+						break;
+					}
+				}
+
+				CollectTriangles();
+				return static_cast<float>(sqrt(largestCost));
+			}
+
+			void Output(std::vector<uint32_t>& result, std::vector<uint32_t>& resultRegions)
+			{
+				result.clear();
+				resultRegions.clear();
+				result.reserve(liveTriangles.size() * 3);
+				resultRegions.reserve(liveTriangles.size());
+
+				std::vector<uint32_t> snapped(vertices.size(), InvalidIndex);
+				for (uint32_t triangle : liveTriangles)
+				{
+					for (int k = 0; k < 3; k++)
+					{
+						result.push_back(Snap(indices[triangle * 3 + k], snapped));
+					}
+					resultRegions.push_back(triangleRegions.empty() ? 0 : triangleRegions[triangle]);
+				}
+			}
+
+		private :
+			void BuildGroups()
+			{
+				std::vector<uint32_t> used;
+				used.reserve(indices.size());
+				std::vector<bool> seen(vertices.size(), false);
+				for (uint32_t index : indices)
+				{
+					if (!seen[index])
+					{
+						seen[index] = true;
+						used.push_back(index);
+					}
+				}
+
+				const std::vector<Vertex>& vertexArray = vertices;
+				std::sort(used.begin(), used.end(), [&vertexArray](uint32_t a, uint32_t b)
+				{
+					const float* pa = vertexArray[a].pos;
+					const float* pb = vertexArray[b].pos;
+					return (pa[0] != pb[0]) ? (pa[0] < pb[0]) : (pa[1] != pb[1]) ? (pa[1] < pb[1]) : (pa[2] < pb[2]);
+				});
+
+				groupOf.assign(vertices.size(), InvalidIndex);
+				groupStart.clear();
+				groupMembers = used;
+				groupCount = 0;
+
+				for (size_t i = 0; i < used.size(); i++)
+				{
+					const float* pos = vertices[used[i]].pos;
+					if ((i == 0) || (pos[0] != groupPosition.back()[0]) || (pos[1] != groupPosition.back()[1]) || (pos[2] != groupPosition.back()[2]))
+					{
+						groupStart.push_back(static_cast<uint32_t>(i));
+						groupPosition.push_back(pos);
+						groupCount++;
+					}
+					groupOf[used[i]] = groupCount - 1;
+				}
+				groupStart.push_back(static_cast<uint32_t>(used.size()));
+
+				groupRemap.resize(groupCount);
+				for (uint32_t i = 0; i < groupCount; i++)
+				{
+					groupRemap[i] = i;
+				}
+			}
+
+			void BuildQuadrics()
+			{
+				quadrics.assign(groupCount, Quadric());
+
+				for (uint32_t triangle : liveTriangles)
+				{
+					uint32_t groups[3];
+					if (!TriangleGroups(triangle, groups))
+					{
+						continue;
+					}
+
+					double normal[3];
+					TriangleNormal(groupPosition[groups[0]], groupPosition[groups[1]], groupPosition[groups[2]], normal);
+					double length = sqrt(Dot(normal, normal));
+					if (length <= 0.0)
+					{
+						continue;
+					}
+
+					double area = length * 0.5;
+					double unit[3] = { normal[0] / length, normal[1] / length, normal[2] / length };
+					const float* p0 = groupPosition[groups[0]];
+					double d = -(unit[0] * p0[0] + unit[1] * p0[1] + unit[2] * p0[2]);
+
+					for (int k = 0; k < 3; k++)
+					{
+						AddPlane(quadrics[groups[k]], unit[0], unit[1], unit[2], d, area);
+						quadrics[groups[k]].weight += area;
+					}
+				}
+
+				//a plane through every border edge, perpendicular to its triangle, keeps the outline where it is.
+				//its weight does not count towards the mean so moving a border costs about BorderWeight times the squared distance
+				CollectTriangles();
+				CollectEdges();
+				for (size_t i = 0; i < edges.size(); )
+				{
+					size_t run = EdgeRun(i);
+					if (IsBorderRun(i, run))
+					{
+						for (size_t j = i; j < i + run; j++)
+						{
+							AddBorderPlane(edges[j]);
+						}
+					}
+					i += run;
+				}
+			}
+
+			void AddBorderPlane(const Edge& edge)
+			{
+				uint32_t groups[3];
+				TriangleGroups(edge.triangle, groups);
+
+				double normal[3];
+				TriangleNormal(groupPosition[groups[0]], groupPosition[groups[1]], groupPosition[groups[2]], normal);
+
+				const float* p0 = groupPosition[edge.low];
+				const float* p1 = groupPosition[edge.high];
+				double direction[3] = { static_cast<double>(p1[0]) - p0[0], static_cast<double>(p1[1]) - p0[1], static_cast<double>(p1[2]) - p0[2] };
+
+				double plane[3];
+				Cross(direction, normal, plane);
+				double length = sqrt(Dot(plane, plane));
+				if (length <= 0.0)
+				{
+					return;
+				}
+
+				for (int k = 0; k < 3; k++)
+				{
+					plane[k] /= length;
+				}
+				double d = -(plane[0] * p0[0] + plane[1] * p0[1] + plane[2] * p0[2]);
+				double weight = Dot(direction, direction) * BorderWeight;
+
+				AddPlane(quadrics[edge.low], plane[0], plane[1], plane[2], d, weight);
+				AddPlane(quadrics[edge.high], plane[0], plane[1], plane[2], d, weight);
+			}
+
+			uint32_t Find(uint32_t group)
+			{
+				while (groupRemap[group] != group)
+				{
+					groupRemap[group] = groupRemap[groupRemap[group]];
+					group = groupRemap[group];
+				}
+				return group;
+			}
+
+			//false if two corners ended up in the same group
+			bool TriangleGroups(uint32_t triangle, uint32_t groups[3])
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					groups[k] = Find(groupOf[indices[triangle * 3 + k]]);
+				}
+				return (groups[0] != groups[1]) && (groups[1] != groups[2]) && (groups[0] != groups[2]);
+			}
+
+			//drops degenerate triangles and rebuilds the group to triangle adjacency
+			void CollectTriangles()
+			{
+				std::vector<uint32_t> kept;
+				kept.reserve(liveTriangles.size());
+				for (uint32_t triangle : liveTriangles)
+				{
+					uint32_t groups[3];
+					if (TriangleGroups(triangle, groups))
+					{
+						kept.push_back(triangle);
+					}
+				}
+				liveTriangles.swap(kept);
+
+				adjacencyStart.assign(groupCount + 1, 0);
+				for (uint32_t triangle : liveTriangles)
+				{
+					uint32_t groups[3];
+					TriangleGroups(triangle, groups);
+					for (int k = 0; k < 3; k++)
+					{
+						adjacencyStart[groups[k] + 1]++;
+					}
+				}
+				for (uint32_t i = 0; i < groupCount; i++)
+				{
+					adjacencyStart[i + 1] += adjacencyStart[i];
+				}
+
+				adjacency.resize(adjacencyStart[groupCount]);
+				std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+				for (uint32_t triangle : liveTriangles)
+				{
+					uint32_t groups[3];
+					TriangleGroups(triangle, groups);
+					for (int k = 0; k < 3; k++)
+					{
+						adjacency[cursor[groups[k]]++] = triangle;
+					}
+				}
+			}
+
+			size_t EdgeRun(size_t first)
+			{
+				size_t last = first + 1;
+				while ((last < edges.size()) && (edges[last].low == edges[first].low) && (edges[last].high == edges[first].high))
+				{
+					last++;
+				}
+				return last - first;
+			}
+
+			//open edges, edges shared by more than two triangles and edges between regions
+			bool IsBorderRun(size_t first, size_t run)
+			{
+				if (run != 2)
+				{
+					return true;
+				}
+				return !triangleRegions.empty() && (triangleRegions[edges[first].triangle] != triangleRegions[edges[first + 1].triangle]);
+			}
+
+			//lists every edge once per triangle, marks border groups and prices every allowed collapse
+			void CollectEdges()
+			{
+				edges.clear();
+				edges.reserve(liveTriangles.size() * 3);
+				for (uint32_t triangle : liveTriangles)
+				{
+					uint32_t groups[3];
+					TriangleGroups(triangle, groups);
+					for (int k = 0; k < 3; k++)
+					{
+						uint32_t a = groups[k];
+						uint32_t b = groups[(k + 1) % 3];
+						edges.push_back({ std::min(a, b), std::max(a, b), triangle });
+					}
+				}
+				std::sort(edges.begin(), edges.end());
+
+				border.assign(groupCount, false);
+				for (size_t i = 0; i < edges.size(); )
+				{
+					size_t run = EdgeRun(i);
+					if (IsBorderRun(i, run))
+					{
+						border[edges[i].low] = true;
+						border[edges[i].high] = true;
+					}
+					i += run;
+				}
+
+				//a border group may only slide along a border edge, otherwise the outline would cave in
+				collapses.clear();
+				for (size_t i = 0; i < edges.size(); )
+				{
+					size_t run = EdgeRun(i);
+					bool borderEdge = IsBorderRun(i, run);
+					uint32_t low = edges[i].low;
+					uint32_t high = edges[i].high;
+					i += run;
+
+					Quadric combined = quadrics[low];
+					AddQuadric(combined, quadrics[high]);
+					double weight = (combined.weight > 0.0) ? combined.weight : 1.0;
+
+					bool lowMovable = !border[low] || (borderEdge && border[high]);
+					bool highMovable = !border[high] || (borderEdge && border[low]);
+
+					Collapse best = { 0.0, InvalidIndex, InvalidIndex };
+					if (lowMovable)
+					{
+						best = { Evaluate(combined, groupPosition[high]) / weight, low, high };
+					}
+					if (highMovable)
+					{
+						double cost = Evaluate(combined, groupPosition[low]) / weight;
+						if ((best.from == InvalidIndex) || (cost < best.cost))
+						{
+							best = { cost, high, low };
+						}
+					}
+
+					if (best.from != InvalidIndex)
+					{
+						collapses.push_back(best);
+					}
+				}
+			}
+
+			//true if moving from onto to would turn a triangle around or squash it flat
+			bool Flips(uint32_t from, uint32_t to)
+			{
+				for (uint32_t i = adjacencyStart[from]; i < adjacencyStart[from + 1]; i++)
+				{
+					uint32_t groups[3];
+					if (!TriangleGroups(adjacency[i], groups) || (groups[0] == to) || (groups[1] == to) || (groups[2] == to))
+					{
+						continue;
+					}
+
+					const float* before[3];
+					const float* after[3];
+					for (int k = 0; k < 3; k++)
+					{
+						before[k] = groupPosition[groups[k]];
+						after[k] = (groups[k] == from) ? groupPosition[to] : before[k];
+					}
+
+					double normalBefore[3];
+					double normalAfter[3];
+					TriangleNormal(before[0], before[1], before[2], normalBefore);
+					TriangleNormal(after[0], after[1], after[2], normalAfter);
+
+					if (Dot(normalBefore, normalAfter) <= FlipThreshold * sqrt(Dot(normalBefore, normalBefore) * Dot(normalAfter, normalAfter)))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+
+			//triangles that disappear when from is moved onto to
+			size_t SharedTriangles(uint32_t from, uint32_t to)
+			{
+				size_t shared = 0;
+				for (uint32_t i = adjacencyStart[from]; i < adjacencyStart[from + 1]; i++)
+				{
+					uint32_t groups[3];
+					if (TriangleGroups(adjacency[i], groups) && ((groups[0] == to) || (groups[1] == to) || (groups[2] == to)))
+					{
+						shared++;
+					}
+				}
+				return shared;
+			}
+
+			//a corner whose group was collapsed takes the vertex of the new group with the closest normal and uv
+			uint32_t Snap(uint32_t vertex, std::vector<uint32_t>& snapped)
+			{
+				uint32_t group = Find(groupOf[vertex]);
+				if (group == groupOf[vertex])
+				{
+					return vertex;
+				}
+				if (snapped[vertex] != InvalidIndex)
+				{
+					return snapped[vertex];
+				}
+
+				const Vertex& original = vertices[vertex];
+				uint32_t best = groupMembers[groupStart[group]];
+				float bestDistance = -1.0f;
+				for (uint32_t i = groupStart[group]; i < groupStart[group + 1]; i++)
+				{
+					const Vertex& candidate = vertices[groupMembers[i]];
+					float distance = 0.0f;
+					for (int k = 0; k < 3; k++)
+					{
+						distance += (candidate.norm[k] - original.norm[k]) * (candidate.norm[k] - original.norm[k]);
+					}
+					for (int k = 0; k < 2; k++)
+					{
+						distance += (candidate.uv[k] - original.uv[k]) * (candidate.uv[k] - original.uv[k]);
+					}
+
+					if ((bestDistance < 0.0f) || (distance < bestDistance))
+					{
+						bestDistance = distance;
+						best = groupMembers[i];
+					}
+				}
+
+				snapped[vertex] = best;
+				return best;
+			}
+
+			const std::vector<Vertex>& vertices;
+			const std::vector<uint32_t>& indices;
+			const std::vector<uint32_t>& triangleRegions;
+
+			uint32_t groupCount;
+			std::vector<uint32_t> groupOf;
+			std::vector<uint32_t> groupStart;
+			std::vector<uint32_t> groupMembers;
+			std::vector<const float*> groupPosition;
+			std::vector<uint32_t> groupRemap;
+			std::vector<Quadric> quadrics;
+			std::vector<bool> border;
+
+			std::vector<uint32_t> liveTriangles;
+			std::vector<uint32_t> adjacencyStart;
+			std::vector<uint32_t> adjacency;
+
+			std::vector<Edge> edges;
+			std::vector<Collapse> collapses;
+	};
+}
+
+float MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleRegions, size_t targetIndexCount, float targetError,
+	std::vector<uint32_t>& result, std::vector<uint32_t>& resultRegions)
+{
+	Simplification simplification(vertices, indices, triangleRegions);
+	float error = simplification.Run(targetIndexCount, targetError);
+	simplification.Output(result, resultRegions);
+	return error;
+}
+
+void MeshSimplifier::BuildLODs(MeshData& mesh, int levelCount)
+{
+	mesh.lods.clear();
+
+	std::vector<Submesh> previous = mesh.submeshes;
+	float previousError = 0.0f;
+
+	std::vector<uint32_t> source;
+	std::vector<uint32_t> sourceRegions;
+	std::vector<uint32_t> result;
+	std::vector<uint32_t> resultRegions;
+
+	for (int level = 0; level < levelCount; level++)
+	{
+		source.clear();
+		sourceRegions.clear();
+		for (size_t i = 0; i < previous.size(); i++)
+		{
+			source.insert(source.end(), mesh.indices.begin() + previous[i].Start, mesh.indices.begin() + previous[i].Start + previous[i].size);
+			sourceRegions.insert(sourceRegions.end(), previous[i].size / 3, static_cast<uint32_t>(i));
+		}
+		if (source.empty())
+		{
+			break;
+		}
+
+		size_t targetIndexCount = static_cast<size_t>(static_cast<float>(source.size() / 3) * LODReduction) * 3;
+		float targetError = LODBaseError * static_cast<float>(1 << level) * mesh.bounds.radius;
+
+		float error = Simplify(mesh.vertices, source, sourceRegions, targetIndexCount, targetError, result, resultRegions);
+		if (static_cast<float>(result.size()) > static_cast<float>(source.size()) * LODMinimumGain)
+		{
+			break;
+		}
+
+		//kept triangles stay in region order, so every submesh is one contiguous range again
+		MeshLOD lod;
+		lod.submeshes.resize(mesh.submeshes.size());
+		for (size_t i = 0; i < mesh.submeshes.size(); i++)
+		{
+			lod.submeshes[i].Start = static_cast<int>(mesh.indices.size());
+			lod.submeshes[i].size = 0;
+			lod.submeshes[i].material = mesh.submeshes[i].material;
+		}
+		for (size_t triangle = 0; triangle < resultRegions.size(); triangle++)
+		{
+			Submesh& submesh = lod.submeshes[resultRegions[triangle]];
+			if (submesh.size == 0)
+			{
+				submesh.Start = static_cast<int>(mesh.indices.size() + triangle * 3);
+			}
+			submesh.size += 3;
+		}
+		mesh.indices.insert(mesh.indices.end(), result.begin(), result.end());
+
+		//every level is built from the one before, so their errors add up
+		previousError += (mesh.bounds.radius > 0.0f) ? error / mesh.bounds.radius : 0.0f;
+		lod.error = previousError;
+
+		mesh.lods.push_back(lod);
+		previous = mesh.lods.back().submeshes;
+	}
+}
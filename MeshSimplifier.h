@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "MeshData.h"
+
+//Import time level of detail generation through quadric error edge collapses.
+namespace MeshSimplifier
+{
+	//collapses edges until at most targetIndexCount indices are left or the next collapse would move the surface further than targetError.
+	//vertices are only ever snapped onto other vertices of the input, so the result indexes the same vertex array.
+	//triangleRegions is empty or holds one id per triangle, edges between regions are kept like borders so neighbouring submeshes stay watertight.
+	//kept triangles stay in input order, resultRegions gets their region. Returns the largest error of a collapse that was made, in mesh units.
+	float Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleRegions, size_t targetIndexCount, float targetError,
+		std::vector<uint32_t>& result, std::vector<uint32_t>& resultRegions);
+
+	//appends up to levelCount coarser versions of every submesh to mesh.indices and lists them in mesh.lods, each with about half the triangles of the one before.
+	//stops early once a level would not get meaningfully smaller within its error limit.
+	//runs after MeshOptimizer::Optimize, which only knows about the full resolution submeshes
+	void BuildLODs(MeshData& mesh, int levelCount);
+}
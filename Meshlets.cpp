@@ -0,0 +1,439 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	//sphere around the box of the used vertices, at most about 15% larger than the smallest sphere
+	void BoundingSphere(const MeshData& mesh, const uint32_t* indices, size_t indexCount, Meshlet& meshlet)
+	{
+		float minimum[3] = { INFINITY, INFINITY, INFINITY };
+		float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			const float* pos = mesh.vertices[indices[i]].pos;
+			for (int k = 0; k < 3; k++)
+			{
+				minimum[k] = std::min(minimum[k], pos[k]);
+				maximum[k] = std::max(maximum[k], pos[k]);
+			}
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			meshlet.center[k] = (minimum[k] + maximum[k]) * 0.5f;
+		}
+
+		float radius = 0.0f;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			const float* pos = mesh.vertices[indices[i]].pos;
+			float distance = sqrtf(powf(pos[0] - meshlet.center[0], 2.0f) + powf(pos[1] - meshlet.center[1], 2.0f) + powf(pos[2] - meshlet.center[2], 2.0f));
+			radius = std::max(radius, distance);
+		}
+		meshlet.radius = radius;
+	}
+
+	//averaged face normal and the widest angle any face normal makes with it.
+	//the face normal is the one the rasterizer culls by, (p1 - p0) x (p2 - p0) points to the side that is drawn
+	void NormalCone(const MeshData& mesh, const uint32_t* indices, size_t indexCount, Meshlet& meshlet)
+	{
+		std::vector<float> normals;
+		normals.reserve(indexCount);
+
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const float* p0 = mesh.vertices[indices[i]].pos;
+			const float* p1 = mesh.vertices[indices[i + 1]].pos;
+			const float* p2 = mesh.vertices[indices[i + 2]].pos;
+
+			float edge0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float edge1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float normal[3] = { edge0[1] * edge1[2] - edge0[2] * edge1[1], edge0[2] * edge1[0] - edge0[0] * edge1[2], edge0[0] * edge1[1] - edge0[1] * edge1[0] };
+
+			float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0f)
+			{
+				//degenerate triangles are never rasterized, they do not limit the cone
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				normal[k] /= length;
+				axis[k] += normal[k];
+				normals.push_back(normal[k]);
+			}
+		}
+
+		meshlet.coneCutoff = 1.0f;
+		float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (normals.empty() || (axisLength <= 0.0f))
+		{
+			return;
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			meshlet.coneAxis[k] = axis[k] / axisLength;
+		}
+
+		float minimumDot = 1.0f;
+		for (size_t i = 0; i < normals.size(); i += 3)
+		{
+			float dot = normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] + normals[i + 2] * meshlet.coneAxis[2];
+			minimumDot = std::min(minimumDot, dot);
+		}
+
+		//a cone of 90 degrees or more always has a triangle facing the camera
+		if (minimumDot > 0.0f)
+		{
+			meshlet.coneCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+		}
+	}
+
+	//how much a triangle facing away from the meshlet cone costs compared to one new vertex
+	const float ConeWeight = 8.0f;
+
+	//triangles turned further than this from the meshlet normal start a new meshlet instead, keeps the cones narrow enough to cull
+	const float MinimumFacing = 0.5f;
+
+	void FaceNormal(const MeshData& mesh, const uint32_t* triangle, float normal[3])
+	{
+		const float* p0 = mesh.vertices[triangle[0]].pos;
+		const float* p1 = mesh.vertices[triangle[1]].pos;
+		const float* p2 = mesh.vertices[triangle[2]].pos;
+
+		float edge0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float edge1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		normal[0] = edge0[1] * edge1[2] - edge0[2] * edge1[1];
+		normal[1] = edge0[2] * edge1[0] - edge0[0] * edge1[2];
+		normal[2] = edge0[0] * edge1[1] - edge0[1] * edge1[0];
+
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		for (int k = 0; k < 3; k++)
+		{
+			normal[k] = (length > 0.0f) ? normal[k] / length : 0.0f;
+		}
+	}
+
+	//position along a curve over the octahedral map of a direction, close directions get close keys
+	uint32_t DirectionKey(const float direction[3])
+	{
+		float length = fabsf(direction[0]) + fabsf(direction[1]) + fabsf(direction[2]);
+		if (length <= 0.0f)
+		{
+			return 0;
+		}
+
+		float x = direction[0] / length;
+		float y = direction[1] / length;
+		if (direction[2] < 0.0f)
+		{
+			float foldedX = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+			float foldedY = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		uint32_t u = static_cast<uint32_t>((x * 0.5f + 0.5f) * 65535.0f);
+		uint32_t v = static_cast<uint32_t>((y * 0.5f + 0.5f) * 65535.0f);
+
+		//interleaved bits, a Morton curve
+		uint32_t key = 0;
+		for (int bit = 0; bit < 16; bit++)
+		{
+			key |= ((u >> bit) & 1) << (bit * 2);
+			key |= ((v >> bit) & 1) << (bit * 2 + 1);
+		}
+		return key;
+	}
+
+	//grows meshlets over neighbouring triangles, preferring the ones that add few vertices and face the same way as the meshlet so far,
+	//then rewrites the range in meshlet order. Triangles are neighbours when they share a position, uv and normal seams do not split meshlets
+	void BuildRange(MeshData& mesh, int start, int size, std::vector<uint32_t>& usedBy, std::vector<Meshlet>& meshlets)
+	{
+		size_t triangleCount = static_cast<size_t>(size) / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+		const uint32_t* indices = mesh.indices.data() + start;
+
+		//vertices sharing a position get one id
+		std::vector<uint32_t> corners(indices, indices + triangleCount * 3);
+		std::sort(corners.begin(), corners.end());
+		corners.erase(std::unique(corners.begin(), corners.end()), corners.end());
+
+		const std::vector<Vertex>& vertices = mesh.vertices;
+		std::vector<uint32_t> byPosition = corners;
+		std::sort(byPosition.begin(), byPosition.end(), [&vertices](uint32_t a, uint32_t b)
+		{
+			const float* pa = vertices[a].pos;
+			const float* pb = vertices[b].pos;
+			return (pa[0] != pb[0]) ? (pa[0] < pb[0]) : (pa[1] != pb[1]) ? (pa[1] < pb[1]) : (pa[2] < pb[2]);
+		});
+
+		std::vector<uint32_t> positionOf(corners.size());
+		auto local = [&corners](uint32_t vertex) { return static_cast<uint32_t>(std::lower_bound(corners.begin(), corners.end(), vertex) - corners.begin()); };
+		uint32_t positionCount = 0;
+		for (size_t i = 0; i < byPosition.size(); i++)
+		{
+			if ((i > 0) && (memcmp(vertices[byPosition[i]].pos, vertices[byPosition[i - 1]].pos, sizeof(float) * 3) != 0))
+			{
+				positionCount++;
+			}
+			positionOf[local(byPosition[i])] = positionCount;
+		}
+		positionCount++;
+
+		std::vector<uint32_t> trianglePositions(triangleCount * 3);
+		std::vector<uint32_t> adjacencyStart(positionCount + 1, 0);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			trianglePositions[i] = positionOf[local(indices[i])];
+			adjacencyStart[trianglePositions[i] + 1]++;
+		}
+		for (uint32_t i = 0; i < positionCount; i++)
+		{
+			adjacencyStart[i + 1] += adjacencyStart[i];
+		}
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency[cursor[trianglePositions[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<float> normals(triangleCount * 3);
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			FaceNormal(mesh, indices + i * 3, &normals[i * 3]);
+		}
+
+		std::vector<bool> assigned(triangleCount, false);
+		std::vector<uint32_t> order;
+		order.reserve(triangleCount);
+		std::vector<uint32_t> candidates;
+		size_t nextSeed = 0;
+
+		std::vector<Meshlet> built;
+		std::vector<uint32_t> directionKeys;
+
+		while (order.size() < triangleCount)
+		{
+			uint32_t meshletId = static_cast<uint32_t>(meshlets.size() + built.size());
+			Meshlet meshlet;
+			meshlet.indexStart = static_cast<uint32_t>(start + order.size() * 3);
+
+			size_t vertexCount = 0;
+			float axis[3] = { 0.0f, 0.0f, 0.0f };
+			candidates.clear();
+
+			while (meshlet.indexCount / 3 < Meshlets::MaxTriangles)
+			{
+				//the best neighbour, or the next triangle in the original order once the meshlet has none left
+				uint32_t best = 0xFFFFFFFF;
+				float bestScore = 0.0f;
+				for (size_t c = 0; c < candidates.size(); )
+				{
+					uint32_t triangle = candidates[c];
+					if (assigned[triangle])
+					{
+						candidates[c] = candidates.back();
+						candidates.pop_back();
+						continue;
+					}
+
+					int newVertices = 0;
+					for (int k = 0; k < 3; k++)
+					{
+						newVertices += (usedBy[indices[triangle * 3 + k]] != meshletId) ? 1 : 0;
+					}
+
+					const float* normal = &normals[triangle * 3];
+					float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+					float facing = (axisLength > 0.0f) ? (normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2]) / axisLength : 1.0f;
+					float score = static_cast<float>(newVertices) + (1.0f - facing) * ConeWeight;
+
+					if ((vertexCount + newVertices <= Meshlets::MaxVertices) && (facing >= MinimumFacing) && ((best == 0xFFFFFFFF) || (score < bestScore)))
+					{
+						best = triangle;
+						bestScore = score;
+					}
+					c++;
+				}
+
+				if ((best == 0xFFFFFFFF) && candidates.empty() && (meshlet.indexCount == 0))
+				{
+					while ((nextSeed < triangleCount) && assigned[nextSeed])
+					{
+						nextSeed++;
+					}
+					if (nextSeed < triangleCount)
+					{
+						int newVertices = 0;
+						for (int k = 0; k < 3; k++)
+						{
+							newVertices += (usedBy[indices[nextSeed * 3 + k]] != meshletId) ? 1 : 0;
+						}
+						if (vertexCount + newVertices <= Meshlets::MaxVertices)
+						{
+							best = static_cast<uint32_t>(nextSeed);
+						}
+					}
+				}
+
+				if (best == 0xFFFFFFFF)
+				{
+					break;
+				}
+
+				assigned[best] = true;
+				order.push_back(best);
+				meshlet.indexCount += 3;
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t vertex = indices[best * 3 + k];
+					if (usedBy[vertex] != meshletId)
+					{
+						usedBy[vertex] = meshletId;
+						vertexCount++;
+					}
+					axis[k] += normals[best * 3 + k];
+
+					uint32_t position = trianglePositions[best * 3 + k];
+					for (uint32_t a = adjacencyStart[position]; a < adjacencyStart[position + 1]; a++)
+					{
+						if (!assigned[adjacency[a]])
+						{
+							candidates.push_back(adjacency[a]);
+						}
+					}
+				}
+			}
+
+			built.push_back(meshlet);
+			directionKeys.push_back(DirectionKey(axis));
+		}
+
+		//meshlets facing the same way are stored next to each other so the visible ones of a view merge into few draws
+		std::vector<uint32_t> sorted(built.size());
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			sorted[i] = static_cast<uint32_t>(i);
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [&directionKeys](uint32_t a, uint32_t b) { return directionKeys[a] < directionKeys[b]; });
+
+		std::vector<uint32_t> reordered;
+		reordered.reserve(triangleCount * 3);
+		for (uint32_t i : sorted)
+		{
+			Meshlet meshlet = built[i];
+			uint32_t firstTriangle = (meshlet.indexStart - static_cast<uint32_t>(start)) / 3;
+			meshlet.indexStart = static_cast<uint32_t>(start + reordered.size());
+
+			for (uint32_t t = firstTriangle; t < firstTriangle + meshlet.indexCount / 3; t++)
+			{
+				reordered.insert(reordered.end(), indices + order[t] * 3, indices + order[t] * 3 + 3);
+			}
+			meshlets.push_back(meshlet);
+		}
+		std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + start);
+	}
+
+	bool Visible(const Meshlet& meshlet, const Meshlets::CullView& view)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const float* plane = view.planes[i];
+			float distance = plane[0] * meshlet.center[0] + plane[1] * meshlet.center[1] + plane[2] * meshlet.center[2] + plane[3];
+			float scale = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			if (distance < -meshlet.radius * scale)
+			{
+				return false;
+			}
+		}
+
+		if (!view.backfaceCulling || (meshlet.coneCutoff >= 1.0f))
+		{
+			return true;
+		}
+
+		//every triangle faces away if the direction to the camera is far enough from the cone, checked for the whole bounding sphere
+		if (view.perspective)
+		{
+			float offset[3] = { meshlet.center[0] - view.position[0], meshlet.center[1] - view.position[1], meshlet.center[2] - view.position[2] };
+			float distance = sqrtf(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+			float dot = offset[0] * meshlet.coneAxis[0] + offset[1] * meshlet.coneAxis[1] + offset[2] * meshlet.coneAxis[2];
+			return dot < meshlet.coneCutoff * distance + meshlet.radius;
+		}
+
+		float dot = view.direction[0] * meshlet.coneAxis[0] + view.direction[1] * meshlet.coneAxis[1] + view.direction[2] * meshlet.coneAxis[2];
+		float length = sqrtf(view.direction[0] * view.direction[0] + view.direction[1] * view.direction[1] + view.direction[2] * view.direction[2]);
+		return dot < meshlet.coneCutoff * length;
+	}
+}
+
+void Meshlets::Build(MeshData& mesh)
+{
+	mesh.meshlets.clear();
+
+	std::vector<const Submesh*> ranges;
+	for (const Submesh& submesh : mesh.submeshes)
+	{
+		ranges.push_back(&submesh);
+	}
+	for (const MeshLOD& lod : mesh.lods)
+	{
+		for (const Submesh& submesh : lod.submeshes)
+		{
+			ranges.push_back(&submesh);
+		}
+	}
+	std::sort(ranges.begin(), ranges.end(), [](const Submesh* a, const Submesh* b) { return a->Start < b->Start; });
+
+	std::vector<uint32_t> usedBy(mesh.vertices.size(), InvalidIndex);
+	for (const Submesh* submesh : ranges)
+	{
+		BuildRange(mesh, submesh->Start, submesh->size, usedBy, mesh.meshlets);
+	}
+
+	for (Meshlet& meshlet : mesh.meshlets)
+	{
+		const uint32_t* indices = mesh.indices.data() + meshlet.indexStart;
+		BoundingSphere(mesh, indices, meshlet.indexCount, meshlet);
+		NormalCone(mesh, indices, meshlet.indexCount, meshlet);
+	}
+}
+
+void Meshlets::Cull(const Meshlet* meshlets, size_t meshletCount, const CullView& view, std::vector<DrawRange>& ranges)
+{
+	for (size_t i = 0; i < meshletCount; i++)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		if (!Visible(meshlet, view))
+		{
+			continue;
+		}
+
+		if (!ranges.empty() && (ranges.back().start + ranges.back().count == meshlet.indexStart))
+		{
+			ranges.back().count += meshlet.indexCount;
+		}
+		else
+		{
+			ranges.push_back({ meshlet.indexStart, meshlet.indexCount });
+		}
+	}
+}
+
+size_t Meshlets::FindFirst(const std::vector<Meshlet>& meshlets, uint32_t indexStart)
+{
+	std::vector<Meshlet>::const_iterator first = std::lower_bound(meshlets.begin(), meshlets.end(), indexStart, [](const Meshlet& meshlet, uint32_t start) { return meshlet.indexStart < start; });
+	return static_cast<size_t>(first - meshlets.begin());
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MeshData.h"
+
+//Import time split of a mesh into meshlets and the per camera test that decides which of them are drawn.
+namespace Meshlets
+{
+	const size_t MaxVertices = 64;
+	const size_t MaxTriangles = 124;
+
+	//what a meshlet is tested against, in the same space as the meshlets
+	struct CullView
+	{
+		//inside is a * x + b * y + c * z + d >= 0, the planes do not have to be normalized
+		float planes[6][4];
+
+		//camera position for perspective views, view direction for orthographic ones
+		float position[3];
+		float direction[3];
+		bool perspective = true;
+
+		//off when the object is mirrored, which turns the facing around
+		bool backfaceCulling = true;
+	};
+
+	struct DrawRange
+	{
+		uint32_t start;
+		uint32_t count;
+	};
+
+	//splits every submesh of every level into connected groups of at most MaxVertices vertices and MaxTriangles triangles that face about the same way.
+	//triangles are rewritten in meshlet order, which replaces the overdraw order of MeshOptimizer. Runs after MeshOptimizer and MeshSimplifier
+	void Build(MeshData& mesh);
+
+	//appends the index ranges of the visible meshlets to ranges, neighbouring visible meshlets are merged into one range
+	void Cull(const Meshlet* meshlets, size_t meshletCount, const CullView& view, std::vector<DrawRange>& ranges);
+
+	//first meshlet of a submesh that starts at indexStart, meshlets are ordered by indexStart
+	size_t FindFirst(const std::vector<Meshlet>& meshlets, uint32_t indexStart);
+}
@@ -0,0 +1,227 @@
+#include "MipChain.h"
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+
+#include "ThreadPool.h"
+
+namespace
+{
+	//linear values are looked up at this resolution, fine enough for the steep start of the sRGB curve
+	const int LinearSteps = 16384;
+
+	//rows of one level handed to a worker at a time
+	const int RowsPerTask = 16;
+
+	struct Tables
+	{
+		float sRGBToLinear[256];
+		float unormToFloat[256];
+		uint8_t linearToSRGB[LinearSteps + 1];
+
+		Tables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				double value = i / 255.0;
+				sRGBToLinear[i] = static_cast<float>((value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4));
+				unormToFloat[i] = static_cast<float>(value);
+			}
+
+			for (int i = 0; i <= LinearSteps; i++)
+			{
+				double value = static_cast<double>(i) / LinearSteps;
+				double encoded = (value <= 0.0031308) ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+				linearToSRGB[i] = static_cast<uint8_t>(std::min(255.0, floor(encoded * 255.0 + 0.5)));
+			}
+		}
+	};
+
+	const Tables& GetTables()
+	{
+		static const Tables tables;
+		return tables;
+	}
+
+	//source texels that make up one destination texel along one axis
+	struct Taps
+	{
+		int index[3];
+		float weight[3];
+		int count;
+	};
+
+	Taps GetTaps(int destination, int sourceSize)
+	{
+		Taps taps;
+		if (sourceSize == 1)
+		{
+			taps.index[0] = 0;
+			taps.weight[0] = 1.0f;
+			taps.count = 1;
+		}
+		else if ((sourceSize & 1) == 0)
+		{
+			taps.index[0] = destination * 2;
+			taps.index[1] = destination * 2 + 1;
+			taps.weight[0] = 0.5f;
+			taps.weight[1] = 0.5f;
+			taps.count = 2;
+		}
+		else
+		{
+			taps.index[0] = destination * 2;
+			taps.index[1] = destination * 2 + 1;
+			taps.index[2] = destination * 2 + 2;
+			taps.weight[0] = 0.25f;
+			taps.weight[1] = 0.5f;
+			taps.weight[2] = 0.25f;
+			taps.count = 3;
+		}
+		return taps;
+	}
+
+	//per channel decode table and encode scale, unused channels decode to 0 and are never written
+	struct Format
+	{
+		int channels;
+		const float* decode[4];
+		bool sRGB[4];
+		__m128 encodeScale;
+	};
+
+	Format GetFormat(int channels)
+	{
+		const Tables& tables = GetTables();
+
+		Format format;
+		format.channels = channels;
+		float scale[4];
+		for (int channel = 0; channel < 4; channel++)
+		{
+			format.sRGB[channel] = (channels >= 3) && (channel < 3);
+			format.decode[channel] = format.sRGB[channel] ? tables.sRGBToLinear : tables.unormToFloat;
+			scale[channel] = format.sRGB[channel] ? static_cast<float>(LinearSteps) : 255.0f;
+		}
+		format.encodeScale = _mm_loadu_ps(scale);
+		return format;
+	}
+
+	__m128 LoadTexel(const uint8_t* texel, const Format& format)
+	{
+		if (format.channels == 4)
+		{
+			return _mm_set_ps(format.decode[3][texel[3]], format.decode[2][texel[2]], format.decode[1][texel[1]], format.decode[0][texel[0]]);
+		}
+
+		float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int channel = 0; channel < format.channels; channel++)
+		{
+			values[channel] = format.decode[channel][texel[channel]];
+		}
+		return _mm_loadu_ps(values);
+	}
+
+	void StoreTexel(__m128 value, uint8_t* texel, const Format& format)
+	{
+		//clamp, scale to table index or unorm and round to nearest for all four channels at once
+		value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		__m128i rounded = _mm_cvtps_epi32(_mm_mul_ps(value, format.encodeScale));
+
+		int32_t indices[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(indices), rounded);
+
+		const uint8_t* toSRGB = GetTables().linearToSRGB;
+		for (int channel = 0; channel < format.channels; channel++)
+		{
+			texel[channel] = format.sRGB[channel] ? toSRGB[indices[channel]] : static_cast<uint8_t>(indices[channel]);
+		}
+	}
+
+	void DownsampleRows(const uint8_t* source, int sourceWidth, int sourceHeight, MipChain::Level& destination, int firstRow, int lastRow, const Format& format)
+	{
+		size_t sourcePitch = static_cast<size_t>(sourceWidth) * format.channels;
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			Taps rows = GetTaps(y, sourceHeight);
+			for (int x = 0; x < destination.width; x++)
+			{
+				Taps columns = GetTaps(x, sourceWidth);
+
+				__m128 sum = _mm_setzero_ps();
+				for (int row = 0; row < rows.count; row++)
+				{
+					const uint8_t* sourceRow = source + rows.index[row] * sourcePitch;
+
+					__m128 rowSum = _mm_setzero_ps();
+					for (int column = 0; column < columns.count; column++)
+					{
+						__m128 texel = LoadTexel(sourceRow + static_cast<size_t>(columns.index[column]) * format.channels, format);
+						rowSum = _mm_add_ps(rowSum, _mm_mul_ps(texel, _mm_set1_ps(columns.weight[column])));
+					}
+					sum = _mm_add_ps(sum, _mm_mul_ps(rowSum, _mm_set1_ps(rows.weight[row])));
+				}
+
+				StoreTexel(sum, destination.pixels.data() + (static_cast<size_t>(y) * destination.width + x) * format.channels, format);
+			}
+		}
+	}
+}
+
+int MipChain::LevelCount(int width, int height)
+{
+	int count = 1;
+	while ((width > 1) || (height > 1))
+	{
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		count++;
+	}
+	return count;
+}
+
+void MipChain::Build(const uint8_t* pixels, int width, int height, int channels, std::vector<Level>& levels)
+{
+	if ((pixels == nullptr) || (width <= 0) || (height <= 0) || (channels < 1) || (channels > 4))
+	{
+		return;
+	}
+
+	Format format = GetFormat(channels);
+
+	const uint8_t* source = pixels;
+	int sourceWidth = width;
+	int sourceHeight = height;
+
+	size_t first = levels.size();
+	levels.resize(first + LevelCount(width, height) - 1);
+	for (size_t i = first; i < levels.size(); i++)
+	{
+		Level& level = levels[i];
+		level.width = std::max(1, sourceWidth / 2);
+		level.height = std::max(1, sourceHeight / 2);
+		level.pixels.resize(static_cast<size_t>(level.width) * level.height * channels);
+
+		size_t tasks = (level.height + RowsPerTask - 1) / RowsPerTask;
+		ThreadPool::Shared().ParallelFor(tasks, [&](size_t task)
+		{
+			int firstRow = static_cast<int>(task) * RowsPerTask;
+			DownsampleRows(source, sourceWidth, sourceHeight, level, firstRow, std::min(level.height, firstRow + RowsPerTask), format);
+		});
+
+		source = level.pixels.data();
+		sourceWidth = level.width;
+		sourceHeight = level.height;
+	}
+}
+
+float MipChain::SRGBToLinear(uint8_t value)
+{
+	return GetTables().sRGBToLinear[value];
+}
+
+uint8_t MipChain::LinearToSRGB(float value)
+{
+	value = std::min(std::max(value, 0.0f), 1.0f);
+	return GetTables().linearToSRGB[static_cast<int>(value * LinearSteps + 0.5f)];
+}
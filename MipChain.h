@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+//Load time mip chain generation for 8 bit textures.
+namespace MipChain
+{
+	struct Level
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	//levels down to 1x1, the full resolution one included
+	int LevelCount(int width, int height);
+
+	//appends every level below the full resolution one to levels, each half the size of the one above and built from it.
+	//box filter, with a 1 2 1 tent along odd sides so no texel is dropped. Filtering happens in linear light, the colour channels
+	//of 3 and 4 channel images are sRGB and alpha as well as 1 and 2 channel images are linear. Rows are spread over the shared thread pool
+	void Build(const uint8_t* pixels, int width, int height, int channels, std::vector<Level>& levels);
+
+	//through tables, LinearToSRGB is within one step of the exact curve
+	float SRGBToLinear(uint8_t value);
+	uint8_t LinearToSRGB(float value);
+}
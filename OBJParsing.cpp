@@ -1,21 +1,47 @@
 #include "OBJParsing.h"
 #include <fstream>
+#include <sstream>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 #include <DirectXCollision.h>
 
 #include "SharedResources.h"
+#include "MeshCache.h"
+#include "AssetPack.h"
+#include "AssetCooker.h"
+#include "VertexQuantization.h"
+#include "Instancing.h"
 #include "Pipeline.h"
 #include "Renderer.h"
+#include "Camera.h"
 
-STDOBJ::STDOBJ(const std::string OBJFilepath)
+STDOBJ::STDOBJ(const std::string OBJFilepath, UINT importFlags) : worldBoundsReady(false)
 {
-	boundingVolume = DirectX::BoundingSphere();
 	if (!CreateTransformBuffer())
 	{
 		std::cerr << "Failed to create transform buffer!" << std::endl;
 	}
 
-	if (!LoadOBJ(OBJFilepath))
+	//only flags that change the buffers tell meshes of the same file apart
+	UINT buildFlags = importFlags & (OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_COMPACT | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS | OBJ_IMPORT_TRIM_VERTICES);
+
+	bool created = false;
+	meshResource = SharedResources::GetMesh(OBJFilepath, buildFlags, created);
+	if (!created)
+	{
+		return;
+	}
+
+	if ((importFlags & OBJ_IMPORT_ASYNC) != 0)
+	{
+		std::unique_ptr<PreparedOBJ> prepared = std::make_unique<PreparedOBJ>();
+		prepared->OBJFilepath = OBJFilepath;
+		prepared->importFlags = importFlags;
+
+		AsyncLoading::Start(LoadOBJAsync(meshResource, std::move(prepared)));
+	}
+	else if (!LoadOBJ(OBJFilepath, importFlags, *meshResource))
 	{
 		std::cerr << "failed to load OBJ" << std::endl;
 	}
@@ -26,27 +52,33 @@ STDOBJ::STDOBJ(const std::string OBJFilepath)
 STDOBJ::~STDOBJ()
 {
 	worldTransformBuffer->Release();
-	vertexBuffer->Release();
-	indexBuffer->Release();
 }
 
 void STDOBJ::Render()
 {
-	UINT stride = sizeof(Vertex);
+	if (!Ready())
+	{
+		return;
+	}
+
+	UINT stride = meshResource->vertexStride;
 	UINT offset = 0;
 	
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, vertexBuffer);
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(indexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, meshResource->vertexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(meshResource->indexBuffer, meshResource->indexFormat);
 
 	UpdateTransformBuffer();
 
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::ObjectTransform(worldTransformBuffer);
 	
-	SharedResources::BindVertexShader(SharedResources::vShader::VSStandard);
+	SharedResources::BindMeshVertexShader(*meshResource);
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+	Meshlets::CullView cullView;
+	bool culling = ActiveCullView(cullView);
+
 	int previousMaterial = -1;
-	for (Submesh submesh : submeshes)
+	for (Submesh submesh : SelectLOD())
 	{
 		if (submesh.material == -1)
 		{
@@ -60,39 +92,130 @@ void STDOBJ::Render()
 			SharedResources::BindMaterial(submesh.material);
 		}
 
-		Pipeline::DrawIndexed(submesh.size, submesh.Start);
+		DrawSubmesh(submesh, culling ? &cullView : nullptr);
 	}
 }
 
 void STDOBJ::DepthRender()
 {
-	UINT stride = sizeof(Vertex);
+	if (!Ready())
+	{
+		return;
+	}
+
+	//positions only, no material is bound so every submesh of the level is drawn at once
+	UINT stride = sizeof(PositionVertex);
 	UINT offset = 0;
 
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, vertexBuffer);
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(indexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, meshResource->positionBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(meshResource->indexBuffer, meshResource->indexFormat);
 
 	UpdateTransformBuffer();
 
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::ObjectTransform(worldTransformBuffer);
 
-	SharedResources::BindVertexShader(SharedResources::vShader::VSStandard);
+	SharedResources::BindVertexShader(SharedResources::vShader::VSDepth);
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-	for (Submesh submesh : submeshes)
+	Meshlets::CullView cullView;
+	bool culling = ActiveCullView(cullView);
+
+	const std::vector<Submesh>& level = SelectLOD();
+
+	//with meshlets the visible ones of the whole level are merged into as few ranges as they allow
+	Submesh range;
+	if (Instancing::CoveringRange(level, range))
 	{
-		Pipeline::DrawIndexed(submesh.size, submesh.Start);
+		range.baseVertex = meshResource->positionBaseVertex;
+		DrawSubmesh(range, culling ? &cullView : nullptr);
+		return;
+	}
+
+	for (Submesh submesh : level)
+	{
+		submesh.baseVertex = meshResource->positionBaseVertex;
+		DrawSubmesh(submesh, culling ? &cullView : nullptr);
 	}
 }
 
-bool STDOBJ::Contained(DirectX::BoundingFrustum& viewFrustum)
+const std::vector<Submesh>& STDOBJ::SelectLOD()
 {
-	float biggestScale = 0.0f;
-	if (scale.x > biggestScale) biggestScale = scale.x;
-	if (scale.y > biggestScale) biggestScale = scale.y;
-	if (scale.z > biggestScale) biggestScale = scale.z;
+	const std::vector<MeshLOD>& lods = meshResource->lods;
+	if (lods.empty())
+	{
+		return meshResource->submeshes;
+	}
+
+	const ActiveViewState& view = Camera::ActiveView();
+
+	//the view moves to the front, a view not seen before takes the place of the one drawn from longest ago
+	size_t slot = 0;
+	while ((slot + 1 < viewLODs.size()) && (viewLODs[slot].viewID != view.viewID))
+	{
+		slot++;
+	}
+	if (viewLODs[slot].viewID != view.viewID)
+	{
+		viewLODs[slot] = ViewLOD();
+		viewLODs[slot].viewID = view.viewID;
+	}
+	std::rotate(viewLODs.begin(), viewLODs.begin() + slot, viewLODs.begin() + slot + 1);
+	int& currentLOD = viewLODs.front().level;
+	float radius = worldVolume.Radius;
+
+	//radius of the bounding sphere on screen in pixels, LOD errors are relative to it
+	float projectedRadius = radius * view.pixelsPerUnit;
+	if (view.perspective)
+	{
+		DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&worldVolume.Center), DirectX::XMLoadFloat3(&view.position));
+		float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(offset));
 
-	DirectX::XMMATRIX scaling = DirectX::XMMatrixScaling(biggestScale, biggestScale, biggestScale);
+		if (distance <= radius)
+		{
+			currentLOD = 0;
+			return meshResource->submeshes;
+		}
+		projectedRadius /= distance;
+	}
+
+	auto pixelError = [&lods, projectedRadius](int level)
+	{
+		return (level == 0) ? 0.0f : lods[level - 1].error * projectedRadius;
+	};
+
+	//only coarsen once a level is clearly below the limit and only refine once the current one is clearly above it.
+	//each view keeps its own level, a shadow map pass in between does not reset what the main camera drew last frame
+	int coarsest = 0;
+	while ((coarsest < static_cast<int>(lods.size())) && (pixelError(coarsest + 1) <= STDOBJ_LOD_PIXEL_ERROR * (1.0f - STDOBJ_LOD_HYSTERESIS)))
+	{
+		coarsest++;
+	}
+
+	if (coarsest > currentLOD)
+	{
+		currentLOD = coarsest;
+	}
+	else if (pixelError(currentLOD) > STDOBJ_LOD_PIXEL_ERROR * (1.0f + STDOBJ_LOD_HYSTERESIS))
+	{
+		while ((currentLOD > 0) && (pixelError(currentLOD) > STDOBJ_LOD_PIXEL_ERROR))
+		{
+			currentLOD--;
+		}
+	}
+
+	return (currentLOD == 0) ? meshResource->submeshes : lods[currentLOD - 1].submeshes;
+}
+
+bool STDOBJ::ActiveCullView(Meshlets::CullView& view)
+{
+	if (meshResource->meshlets.empty())
+	{
+		return false;
+	}
+
+	const ActiveViewState& active = Camera::ActiveView();
+
+	DirectX::XMMATRIX scaling = DirectX::XMMatrixScaling(scale.x, scale.y, scale.z);
 
 	DirectX::XMMATRIX rotation = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&rotationQuaternion));
 
@@ -100,33 +223,146 @@ bool STDOBJ::Contained(DirectX::BoundingFrustum& viewFrustum)
 
 	DirectX::XMMATRIX transform = scaling * rotation * translation;
 
-	DirectX::BoundingSphere transformedVolume;
+	DirectX::XMVECTOR determinant;
+	DirectX::XMMATRIX inverseTransform = DirectX::XMMatrixInverse(&determinant, transform);
+	if (DirectX::XMVectorGetX(determinant) == 0.0f)
+	{
+		return false;
+	}
+
+	//the frustum planes face outwards, the meshlet test wants them facing in. Planes go to object space through the transposed transform
+	DirectX::XMVECTOR planes[6];
+	active.frustum.GetPlanes(&planes[0], &planes[1], &planes[2], &planes[3], &planes[4], &planes[5]);
 
-	boundingVolume.Transform(transformedVolume, transform);
-	
-	return transformedVolume.Intersects(viewFrustum);
+	DirectX::XMMATRIX planeTransform = DirectX::XMMatrixTranspose(transform);
+	for (int i = 0; i < 6; i++)
+	{
+		DirectX::XMFLOAT4 plane;
+		DirectX::XMStoreFloat4(&plane, DirectX::XMVectorNegate(DirectX::XMPlaneTransform(planes[i], planeTransform)));
+		view.planes[i][0] = plane.x;
+		view.planes[i][1] = plane.y;
+		view.planes[i][2] = plane.z;
+		view.planes[i][3] = plane.w;
+	}
+
+	DirectX::XMFLOAT3 localPosition;
+	DirectX::XMFLOAT3 localDirection;
+	DirectX::XMStoreFloat3(&localPosition, DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&active.position), inverseTransform));
+	DirectX::XMStoreFloat3(&localDirection, DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&active.forward), inverseTransform));
+
+	view.position[0] = localPosition.x;
+	view.position[1] = localPosition.y;
+	view.position[2] = localPosition.z;
+	view.direction[0] = localDirection.x;
+	view.direction[1] = localDirection.y;
+	view.direction[2] = localDirection.z;
+	view.perspective = active.perspective;
+	view.backfaceCulling = DirectX::XMVectorGetX(determinant) > 0.0f;
+
+	return true;
+}
+
+void STDOBJ::DrawSubmesh(const Submesh& submesh, const Meshlets::CullView* view)
+{
+	if (view == nullptr)
+	{
+		Pipeline::DrawIndexed(submesh.size, submesh.Start, submesh.baseVertex);
+		return;
+	}
+
+	const std::vector<Meshlet>& meshlets = meshResource->meshlets;
+	size_t first = Meshlets::FindFirst(meshlets, static_cast<uint32_t>(submesh.Start));
+	size_t last = Meshlets::FindFirst(meshlets, static_cast<uint32_t>(submesh.Start + submesh.size));
+
+	drawRanges.clear();
+	Meshlets::Cull(meshlets.data() + first, last - first, *view, drawRanges);
+
+	for (const Meshlets::DrawRange& range : drawRanges)
+	{
+		Pipeline::DrawIndexed(range.count, range.start, submesh.baseVertex);
+	}
+}
+
+bool STDOBJ::IsLoaded() const
+{
+	return meshResource->loaded;
+}
+
+bool STDOBJ::Ready()
+{
+	if (!worldBoundsReady)
+	{
+		if (!meshResource->loaded)
+		{
+			return false;
+		}
+
+		worldBoundsReady = true;
+		OnModyfied();
+	}
+	return true;
+}
+
+bool STDOBJ::Contained(DirectX::BoundingFrustum& viewFrustum)
+{
+	if (!Ready())
+	{
+		return false;
+	}
+
+	//the sphere rejects most objects, the box only runs for the ones the sphere could not
+	return worldVolume.Intersects(viewFrustum) && worldBox.Intersects(viewFrustum);
 }
 
 void STDOBJ::AddToQuadTree(QuadTree* tree)
 {
-	float biggestScale = 0.0f;
-	if (scale.x > biggestScale) biggestScale = scale.x;
-	if (scale.y > biggestScale) biggestScale = scale.y;
-	if (scale.z > biggestScale) biggestScale = scale.z;
+	Ready();
+	tree->InsertObject(this, &worldVolume);
+}
 
-	DirectX::XMMATRIX scaling = DirectX::XMMatrixScaling(biggestScale, biggestScale, biggestScale);
+bool STDOBJ::InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes)
+{
+	if (!Ready() || !meshResource->meshlets.empty())
+	{
+		return false;
+	}
 
-	DirectX::XMMATRIX rotation = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&rotationQuaternion));
+	mesh = meshResource.get();
+	submeshes = &SelectLOD();
+	return true;
+}
 
-	DirectX::XMMATRIX translation = DirectX::XMMatrixTranslation(position.x, position.y, position.z);
+void STDOBJ::OnModyfied()
+{
+	if (!worldBoundsReady)
+	{
+		return;
+	}
 
-	DirectX::XMMATRIX transform = scaling * rotation * translation;
+	const Bounds& bounds = meshResource->bounds;
 
-	DirectX::BoundingSphere transformedVolume;
+	DirectX::XMVECTOR rotation = DirectX::XMLoadFloat4(&rotationQuaternion);
+	DirectX::XMVECTOR translation = DirectX::XMLoadFloat3(&position);
+	DirectX::XMVECTOR scaling = DirectX::XMLoadFloat3(&scale);
 
-	boundingVolume.Transform(transformedVolume, transform);
-	
-	tree->InsertObject(this, &transformedVolume);
+	float biggestScale = fmaxf(fabsf(scale.x), fmaxf(fabsf(scale.y), fabsf(scale.z)));
+
+	//scaling, then rotation, then translation, the same order as TransformMatrix
+	DirectX::XMVECTOR sphereCenter = DirectX::XMVectorMultiply(DirectX::XMVectorSet(bounds.center[0], bounds.center[1], bounds.center[2], 0.0f), scaling);
+	sphereCenter = DirectX::XMVectorAdd(DirectX::XMVector3Rotate(sphereCenter, rotation), translation);
+	DirectX::XMStoreFloat3(&worldVolume.Center, sphereCenter);
+	worldVolume.Radius = bounds.radius * biggestScale;
+
+	DirectX::XMVECTOR boxMin = DirectX::XMVectorSet(bounds.min[0], bounds.min[1], bounds.min[2], 0.0f);
+	DirectX::XMVECTOR boxMax = DirectX::XMVectorSet(bounds.max[0], bounds.max[1], bounds.max[2], 0.0f);
+	DirectX::XMVECTOR boxCenter = DirectX::XMVectorScale(DirectX::XMVectorAdd(boxMin, boxMax), 0.5f);
+	DirectX::XMVECTOR boxExtents = DirectX::XMVectorScale(DirectX::XMVectorSubtract(boxMax, boxMin), 0.5f);
+
+	//a mirrored axis turns the box around its own center, which does not change it
+	boxCenter = DirectX::XMVectorAdd(DirectX::XMVector3Rotate(DirectX::XMVectorMultiply(boxCenter, scaling), rotation), translation);
+	DirectX::XMStoreFloat3(&worldBox.Center, boxCenter);
+	DirectX::XMStoreFloat3(&worldBox.Extents, DirectX::XMVectorMultiply(boxExtents, DirectX::XMVectorAbs(scaling)));
+	worldBox.Orientation = rotationQuaternion;
 }
 
 bool GetWord(std::string& word, std::string& line, char splitChar)
@@ -152,201 +388,325 @@ bool GetWord(std::string& word, std::string& line, char splitChar)
 	return true;
 }
 
-bool STDOBJ::LoadOBJ(std::string OBJFilepath)
+bool STDOBJ::LoadOBJ(std::string OBJFilepath, UINT importFlags, MeshResource& resource)
 {
-	
-	std::ifstream OBJ;
-	OBJ.open(OBJFilepath);
+	std::unique_ptr<PreparedOBJ> prepared = std::make_unique<PreparedOBJ>();
+	prepared->OBJFilepath = OBJFilepath;
+	prepared->importFlags = importFlags;
 
-	if (!OBJ.is_open())
-	{
-		std::cerr << "Failed to open obj filepath: " << OBJFilepath << std::endl;
-		return false;
-	}
+	return PrepareOBJ(*prepared) && CreateResources(*prepared, resource);
+}
 
-	std::vector<std::array<float, 3>> pos;
-	std::vector<std::array<float, 2>> uv;
-	std::vector<std::array<float, 3>> norm;
+bool STDOBJ::PrepareOBJ(PreparedOBJ& prepared)
+{
+	const std::string& OBJFilepath = prepared.OBJFilepath;
+	UINT importFlags = prepared.importFlags;
+	MeshCache::CachedMesh& cached = prepared.cached;
+	MeshData& mesh = prepared.mesh;
 
-	std::map<std::string, int> vertMap;
-	std::vector<Vertex> vertecies;
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
 
-	std::vector<UINT> indecies;
+	bool useCache = (importFlags & OBJ_IMPORT_NO_CACHE) == 0;
+	UINT buildFlags = importFlags & (OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS | OBJ_IMPORT_COMPRESSED);
+	std::string cacheFilepath = MeshCache::CachePath(OBJFilepath, buildFlags);
 
-	Submesh currentSubmesh;
-	bool newSubmesh = false;
+	bool glb = GLBReader::IsGLB(OBJFilepath);
 
-	std::string line = "";
+	if (glb && ((importFlags & (OBJ_IMPORT_OPTIMIZE | OBJ_IMPORT_LOD | OBJ_IMPORT_MESHLETS)) == 0))
+	{
+		//nothing to build, the buffer views already are what a cache would hold
+		GLBReader::MappedMesh& mapped = prepared.glb;
+		GLBReader::ReadStats stats;
+		if (!GLBReader::Map(OBJFilepath, mapped, &stats))
+		{
+			return false;
+		}
+
+		cached.vertices = mapped.vertices;
+		cached.vertexCount = mapped.vertexCount;
+		cached.indexCount = mapped.indexCount;
+		if (mapped.indexSize == sizeof(uint16_t))
+		{
+			prepared.shortIndexData = static_cast<const uint16_t*>(mapped.indices);
+		}
+		else
+		{
+			cached.indices = static_cast<const uint32_t*>(mapped.indices);
+		}
+		cached.submeshes = std::move(mapped.submeshes);
+		cached.submeshMaterials = std::move(mapped.submeshMaterials);
+		cached.bounds = mapped.bounds;
 
-	float boundingRadius = 0.0f;
+		AddGLBMaterials(mapped.materials, prepared.materials);
 
-	while (std::getline(OBJ, line))
+		std::cout << OBJFilepath << ": mapped " << stats.bytes / 1024 << " KB in " << stats.seconds * 1000.0 << " ms, " << (stats.viewedVertices ? "viewed" : "gathered") << " vertices and "
+			<< (stats.viewedIndices ? "viewed" : "gathered") << " indices" << std::endl;
+	}
+	else if (useCache && MeshCache::Read(cacheFilepath, OBJFilepath, buildFlags, cached))
 	{
-		std::string word = "";
-		
-		GetWord(word, line, ' ');
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << OBJFilepath << ": loaded cache in " << elapsed.count() * 1000.0 << " ms" << std::endl;
+	}
+	else if (useCache && !glb && ((importFlags & OBJ_IMPORT_STREAMING) != 0) && (buildFlags == 0))
+	{
+		//nothing to build on the whole mesh, so it never has to be in memory: stream it into the cache and map that
+		OBJReader::ReadStats stats;
+		MeshCache::StreamWriter writer(cacheFilepath, OBJFilepath, buildFlags);
 
-		if (word == "mtllib")
+		if (!OBJReader::Stream(OBJFilepath, writer, mesh, importFlags, OBJReader::StreamOptions(), &stats) || !writer.Finish(mesh) ||
+			!MeshCache::Read(cacheFilepath, OBJFilepath, buildFlags, cached))
 		{
-			if (!LoadMTL(line))
-			{
-				std::cerr << "Failed to load: " << line << std::endl;
-			}
+			std::cerr << "Failed to stream: " << OBJFilepath << std::endl;
+			return false;
 		}
-		else if (word == "v")
+
+		std::cout << OBJFilepath << ": streamed " << stats.bytes / 1024 << " KB in " << stats.seconds * 1000.0 << " ms (" << stats.MegabytesPerSecond() << " MB/s, " << stats.windows << " windows, "
+			<< stats.peakWorkingBytes / 1024 << " KB working memory)" << std::endl;
+	}
+	else
+	{
+		if (!AssetCooker::BuildMesh(OBJFilepath, importFlags, mesh))
 		{
-			std::array<float, 3> temp;
-			
-			GetWord(word, line, ' ');
-			temp[0] = std::stof(word);
-			GetWord(word, line, ' ');
-			temp[1] = std::stof(word);
-			temp[2] = std::stof(line);
-
-			pos.push_back(temp);
+			return false;
 		}
-		else if (word == "vt")
+
+		if (useCache && !MeshCache::Write(cacheFilepath, OBJFilepath, mesh, buildFlags, (importFlags & OBJ_IMPORT_COMPRESSED) != 0))
 		{
-			std::array<float, 2> temp;
+			std::cerr << "Failed to write mesh cache for: " << OBJFilepath << std::endl;
+		}
 
-			GetWord(word, line, ' ');
-			temp[0] = std::stof(word);
-			temp[1] = std::stof(line);
+		cached.vertices = mesh.vertices.data();
+		cached.vertexCount = mesh.vertices.size();
+		cached.indices = mesh.indices.data();
+		cached.indexCount = mesh.indices.size();
+		cached.submeshes = std::move(mesh.submeshes);
+		cached.submeshMaterials = std::move(mesh.submeshMaterials);
+		cached.materialLibraries = std::move(mesh.materialLibraries);
+		cached.lods = std::move(mesh.lods);
+		cached.meshlets = std::move(mesh.meshlets);
+		cached.bounds = mesh.bounds;
+	}
 
-			uv.push_back(temp);
-		}
-		else if (word == "vn")
+	for (const std::string& MTLFilepath : cached.materialLibraries)
+	{
+		//a mesh built from a .glb names the file itself, it carries its own materials
+		std::vector<GLBReader::Material> GLBMaterials;
+		if (GLBReader::IsGLB(MTLFilepath) ? !GLBReader::ReadMaterials(MTLFilepath, GLBMaterials) : !ParseMTL(MTLFilepath, prepared.materials))
 		{
-			std::array<float, 3> temp;
+			std::cerr << "Failed to load: " << MTLFilepath << std::endl;
+		}
+		AddGLBMaterials(GLBMaterials, prepared.materials);
+	}
 
-			GetWord(word, line, ' ');
-			temp[0] = std::stof(word);
-			GetWord(word, line, ' ');
-			temp[1] = std::stof(word);
-			temp[2] = std::stof(line);
+	if ((importFlags & OBJ_IMPORT_COMPACT) != 0)
+	{
+		VertexQuantization::Quantize(cached.vertices, cached.vertexCount, prepared.compactVertices, prepared.decode);
 
-			norm.push_back(temp);
-		}
-		else if (word == "s")
+		if ((prepared.shortIndexData == nullptr) && VertexQuantization::FitsShortIndices(cached.vertexCount))
 		{
-			if (newSubmesh)
-			{
-				submeshes.push_back(currentSubmesh);
-			}
-			else
-			{
-				newSubmesh = true;
-			}
-			currentSubmesh.Start = indecies.size();
-			currentSubmesh.size = 0;
+			VertexQuantization::ShortenIndices(cached.indices, cached.indexCount, prepared.shortIndices);
+			prepared.shortIndexData = prepared.shortIndices.data();
 		}
-		else if (word == "usemtl")
-		{
-			if (!newSubmesh)
-			{
-				std::cerr << ".obj must use submeshes partitioned by s!" << std::endl;
-				return false;
-			}
+	}
+	else if (((importFlags & OBJ_IMPORT_TRIM_VERTICES) != 0) && !SamplesTextures(prepared.materials, cached.submeshMaterials))
+	{
+		UntexturedVertex::Convert(cached.vertices, cached.vertexCount, prepared.untexturedVertices);
+	}
+
+	PositionVertex::Convert(cached.vertices, cached.vertexCount, prepared.positions);
+
+	return true;
+}
 
-			currentSubmesh.material = SharedResources::GetMaterialID(line);
+bool STDOBJ::SamplesTextures(const std::vector<MaterialData>& materials, const std::vector<std::string>& submeshMaterials)
+{
+	for (const std::string& name : submeshMaterials)
+	{
+		std::vector<MaterialData>::const_iterator material = std::find_if(materials.begin(), materials.end(), [&name](const MaterialData& candidate) { return candidate.name == name; });
+		if ((material == materials.end()) || material->textured)
+		{
+			return true;
 		}
-		else if (word == "f")
+	}
+	return false;
+}
+
+std::vector<std::string> STDOBJ::MaterialTextures(const std::vector<MaterialData>& materials)
+{
+	std::vector<std::string> texturePaths;
+	for (const MaterialData& material : materials)
+	{
+		if (material.textured && !SharedResources::MaterialExists(material.name))
 		{
-			if (!newSubmesh)
-			{
-				std::cerr << ".obj must use submeshes partitioned by s!" << std::endl;
-				return false;
-			}
-			while (GetWord(word, line, ' '))
-			{
-				std::string key = word;
-				if (!(vertMap.count(key) > 0))
-				{
-					vertMap[key] = vertecies.size();
+			texturePaths.push_back(material.map_Ka);
+			texturePaths.push_back(material.map_Kd);
+			texturePaths.push_back(material.map_Ks);
+		}
+	}
+	return texturePaths;
+}
 
-					std::string letter;
-					int index[3];
+bool STDOBJ::CreateResources(PreparedOBJ& prepared, MeshResource& resource)
+{
+	MeshCache::CachedMesh& cached = prepared.cached;
 
-					GetWord(letter, word, '/');
-					index[0] = std::stoi(letter) - 1;
-					GetWord(letter, word, '/');
-					index[1] = std::stoi(letter) - 1;
-					index[2] = std::stoi(word) - 1;
+	//all textures of the file decode at once, TexturedMaterial then finds them already added
+	SharedResources::LoadTextures(MaterialTextures(prepared.materials));
 
-					Vertex temp = { {pos[index[0]][0], pos[index[0]][1], pos[index[0]][2]}, {norm[index[2]][0], norm[index[2]][1], norm[index[2]][2]}, {uv[index[1]][0], -uv[index[1]][1]} };
+	for (MaterialData& material : prepared.materials)
+	{
+		SharedResources::AddMaterial(material);
+	}
 
-					vertecies.push_back(temp);
+	for (size_t i = 0; i < cached.submeshes.size(); i++)
+	{
+		cached.submeshes[i].material = SharedResources::GetMaterialID(cached.submeshMaterials[i]);
+	}
+	resource.submeshes = cached.submeshes;
 
-					float distance = sqrtf(powf(temp.pos[0], 2.0f) + powf(temp.pos[1], 2.0f) + powf(temp.pos[2], 2.0f));
-					if (distance > boundingRadius)
-					{
-						boundingRadius = distance;
-					}
-				}
+	resource.meshlets = cached.meshlets;
 
-				indecies.push_back(vertMap[key]);
-				currentSubmesh.size++;
-			}
+	//a level draws the same materials as the full resolution submesh it was simplified from
+	resource.lods = cached.lods;
+	for (MeshLOD& lod : resource.lods)
+	{
+		for (size_t i = 0; i < lod.submeshes.size(); i++)
+		{
+			lod.submeshes[i].material = resource.submeshes[i].material;
 		}
 	}
-	if (newSubmesh)
+
+	bool compact = (prepared.importFlags & OBJ_IMPORT_COMPACT) != 0;
+
+	const void* vertexData = cached.vertices;
+	const void* indexData = cached.indices;
+	UINT indexStride = sizeof(UINT);
+
+	//another file may have registered a textured material under the same name first
+	bool untextured = !prepared.untexturedVertices.empty() &&
+		std::none_of(resource.submeshes.begin(), resource.submeshes.end(), [](const Submesh& submesh) { return SharedResources::MaterialTextured(submesh.material); });
+
+	if (compact)
+	{
+		vertexData = prepared.compactVertices.data();
+		resource.vertexStride = sizeof(CompactVertex);
+		resource.vertexLayout = VertexLayout::Compact;
+	}
+	else if (untextured)
 	{
-		submeshes.push_back(currentSubmesh);
+		vertexData = prepared.untexturedVertices.data();
+		resource.vertexStride = sizeof(UntexturedVertex);
+		resource.vertexLayout = VertexLayout::Untextured;
 	}
-	
-	D3D11_BUFFER_DESC bufferDesc;
 
-	bufferDesc.ByteWidth = sizeof(Vertex) * vertecies.size();
-	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bufferDesc.CPUAccessFlags = 0;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
+	if (prepared.shortIndexData != nullptr)
+	{
+		indexData = prepared.shortIndexData;
+		indexStride = sizeof(uint16_t);
+		resource.indexFormat = DXGI_FORMAT_R16_UINT;
+	}
 
+	D3D11_BUFFER_DESC bufferDesc;
 	D3D11_SUBRESOURCE_DATA data;
-	data.pSysMem = &vertecies[0];
-	data.SysMemPitch = 0;
-	data.SysMemSlicePitch = 0;
 
-	if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &vertexBuffer)))
+	if (MESH_ARENA)
 	{
-		std::cerr << "Failed to create VertexBuffer!" << std::endl;
-		return false;
+		if (!SharedResources::PlaceInArena(resource, vertexData, prepared.positions.data(), cached.vertexCount, indexData, indexStride, cached.indexCount))
+		{
+			std::cerr << "Failed to place mesh in the arena!" << std::endl;
+			return false;
+		}
 	}
+	else
+	{
+		bufferDesc.ByteWidth = resource.vertexStride * cached.vertexCount;
+		bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bufferDesc.CPUAccessFlags = 0;
+		bufferDesc.MiscFlags = 0;
+		bufferDesc.StructureByteStride = 0;
+
+		data.pSysMem = vertexData;
+		data.SysMemPitch = 0;
+		data.SysMemSlicePitch = 0;
+
+		if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &resource.vertexBuffer)))
+		{
+			std::cerr << "Failed to create VertexBuffer!" << std::endl;
+			return false;
+		}
 
-	bufferDesc.ByteWidth = sizeof(UINT) * indecies.size();
-	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	bufferDesc.CPUAccessFlags = 0;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
+		bufferDesc.ByteWidth = sizeof(PositionVertex) * cached.vertexCount;
+		data.pSysMem = prepared.positions.data();
 
-	data.pSysMem = indecies.data();
-	data.SysMemPitch = 0;
-	data.SysMemSlicePitch = 0;
+		if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &resource.positionBuffer)))
+		{
+			std::cerr << "Failed to create position buffer!" << std::endl;
+			return false;
+		}
+
+		bufferDesc.ByteWidth = indexStride * cached.indexCount;
+		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		bufferDesc.CPUAccessFlags = 0;
+		bufferDesc.MiscFlags = 0;
+		bufferDesc.StructureByteStride = 0;
+
+		data.pSysMem = indexData;
+		data.SysMemPitch = 0;
+		data.SysMemSlicePitch = 0;
+
+		if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &resource.indexBuffer)))
+		{
+			std::cerr << "Failed to create indexbuffer!" << std::endl;
+			return false;
+		}
+	}
 
-	if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &indexBuffer)))
+	if (compact)
 	{
-		std::cerr << "Failed to create indexbuffer!" << std::endl;
-		return false;
+		bufferDesc.ByteWidth = sizeof(MeshDecodeBufferStruct);
+		bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bufferDesc.CPUAccessFlags = 0;
+		bufferDesc.MiscFlags = 0;
+		bufferDesc.StructureByteStride = 0;
+
+		data.pSysMem = &prepared.decode;
+		data.SysMemPitch = 0;
+		data.SysMemSlicePitch = 0;
+
+		if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, &data, &resource.meshDecodeBuffer)))
+		{
+			std::cerr << "Failed to create mesh decode buffer!" << std::endl;
+			return false;
+		}
+
+		std::cout << prepared.OBJFilepath << ": compact vertices, " << (resource.vertexStride * cached.vertexCount + indexStride * cached.indexCount) / 1024 << " KB instead of " << (sizeof(Vertex) * cached.vertexCount + sizeof(UINT) * cached.indexCount) / 1024 << " KB" << std::endl;
 	}
 
-	boundingVolume = DirectX::BoundingSphere({ 0.0f, 0.0f, 0.0f }, boundingRadius);
+	if (untextured)
+	{
+		std::cout << prepared.OBJFilepath << ": untextured vertices, " << (resource.vertexStride * cached.vertexCount) / 1024 << " KB instead of " << (sizeof(Vertex) * cached.vertexCount) / 1024 << " KB" << std::endl;
+	}
 
+	resource.bounds = cached.bounds;
+	resource.loaded = true;
 	return true;
 }
 
-bool STDOBJ::LoadMTL(std::string MTLFilepath)
+bool STDOBJ::ParseMTL(std::string MTLFilepath, std::vector<MaterialData>& materials)
 {
-	std::ifstream MTL;
-	MTL.open("OBJ/" + MTLFilepath);
-
-	if (!MTL.is_open())
+	Asset MTLFile;
+	if (!AssetPack::Open("OBJ/" + MTLFilepath, MTLFile))
 	{
 		std::cerr << "Failed to open mtl filepath: " << MTLFilepath << std::endl;
 		return false;
 	}
 
+	std::istringstream MTL(std::string(MTLFile.Data(), MTLFile.Size()));
+	MTLFile.Close();
+
 	std::string line = "";
 	MaterialData currentMatData = MaterialData();
 	bool newMaterial = false;
@@ -361,20 +721,14 @@ bool STDOBJ::LoadMTL(std::string MTLFilepath)
 		{
 			if (newMaterial)
 			{
-				SharedResources::AddMaterial(currentMatData);
+				materials.push_back(currentMatData);
 
 				currentMatData = MaterialData();
 			}
 
-			if (!SharedResources::MaterialExists(line))
-			{
-				currentMatData.name = line;
-				newMaterial = true;
-			}
-			else
-			{
-				newMaterial = false;
-			}
+			//materials that already exist are skipped when they are registered, which is on the main thread
+			currentMatData.name = line;
+			newMaterial = true;
 		}
 		else if (newMaterial)
 		{
@@ -426,12 +780,55 @@ bool STDOBJ::LoadMTL(std::string MTLFilepath)
 
 	if (newMaterial)
 	{
-		SharedResources::AddMaterial(currentMatData);
+		materials.push_back(currentMatData);
 	}
 
 	return true;
 }
 
+void STDOBJ::AddGLBMaterials(const std::vector<GLBReader::Material>& GLBMaterials, std::vector<MaterialData>& materials)
+{
+	for (const GLBReader::Material& material : GLBMaterials)
+	{
+		MaterialData converted;
+		converted.textured = material.textured;
+		converted.name = material.name;
+		converted.Ns = material.Ns;
+		for (int i = 0; i < 3; i++)
+		{
+			converted.Ka[i] = material.Ka[i];
+			converted.Kd[i] = material.Kd[i];
+			converted.Ks[i] = material.Ks[i];
+		}
+		converted.map_Ka = material.map_Ka;
+		converted.map_Kd = material.map_Kd;
+		converted.map_Ks = material.map_Ks;
+
+		materials.push_back(converted);
+	}
+}
+
+AsyncLoading::Task<void> STDOBJ::LoadOBJAsync(std::shared_ptr<MeshResource> resource, std::unique_ptr<PreparedOBJ> prepared)
+{
+	co_await AsyncLoading::ToWorker();
+
+	if (!PrepareOBJ(*prepared))
+	{
+		std::cerr << "failed to load OBJ" << std::endl;
+		co_return;
+	}
+
+	co_await AsyncLoading::ToMainThread();
+
+	//textures are created before the materials that use them, so those do not decode them again
+	co_await SharedResources::LoadTexturesAsync(MaterialTextures(prepared->materials));
+
+	if (!CreateResources(*prepared, *resource))
+	{
+		std::cerr << "failed to load OBJ" << std::endl;
+	}
+}
+
 STDOBJTesselated::STDOBJTesselated(const std::string OBJFilepath, float maxTesselation, float maxDistance, float minDistance, float interpolationFactor) : STDOBJ(OBJFilepath)
 {
 	D3D11_BUFFER_DESC bufferDesc;
@@ -463,11 +860,11 @@ STDOBJTesselated::~STDOBJTesselated()
 
 void STDOBJTesselated::Render()
 {
-	UINT stride = sizeof(Vertex);
+	UINT stride = meshResource->vertexStride;
 	UINT offset = 0;
 
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, vertexBuffer);
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(indexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, meshResource->vertexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(meshResource->indexBuffer, meshResource->indexFormat);
 
 	UpdateTransformBuffer();
 
@@ -486,7 +883,7 @@ void STDOBJTesselated::Render()
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
 
 	int previousMaterial = -1;
-	for (Submesh submesh : submeshes)
+	for (Submesh submesh : meshResource->submeshes)
 	{
 		if (submesh.material == -1)
 		{
@@ -500,7 +897,7 @@ void STDOBJTesselated::Render()
 			SharedResources::BindMaterial(submesh.material);
 		}
 
-		Pipeline::DrawIndexed(submesh.size, submesh.Start);
+		Pipeline::DrawIndexed(submesh.size, submesh.Start, submesh.baseVertex);
 	}
 
 	Pipeline::Deferred::GeometryPass::HullShader::UnBind::HullShader();
@@ -509,11 +906,11 @@ void STDOBJTesselated::Render()
 
 void STDOBJTesselated::DepthRender()
 {
-	UINT stride = sizeof(Vertex);
+	UINT stride = meshResource->vertexStride;
 	UINT offset = 0;
 
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, vertexBuffer);
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(indexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, meshResource->vertexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(meshResource->indexBuffer, meshResource->indexFormat);
 
 	UpdateTransformBuffer();
 
@@ -531,17 +928,24 @@ void STDOBJTesselated::DepthRender()
 
 	Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
 
-	for (Submesh submesh : submeshes)
+	for (Submesh submesh : meshResource->submeshes)
 	{
-		Pipeline::DrawIndexed(submesh.size, submesh.Start);
+		Pipeline::DrawIndexed(submesh.size, submesh.Start, submesh.baseVertex);
 	}
 
 	Pipeline::Deferred::GeometryPass::HullShader::UnBind::HullShader();
 	Pipeline::Deferred::GeometryPass::DomainShader::UnBind::DomainShader();
 }
 
+bool STDOBJTesselated::InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes)
+{
+	return false;
+}
+
 STDOBJMirror::STDOBJMirror(const std::string OBJFilepath, UINT resolution, DeferredRenderer* renderer, float nearPlane, float farPlane) : STDOBJ(OBJFilepath), renderer(renderer), resolution(resolution), nearPlane(nearPlane), farPlane(farPlane), blockRender(false)
 {
+	reflectionView = new CameraPerspective(resolution, resolution, 0, 0, 90.0f, nearPlane, farPlane);
+
 	D3D11_TEXTURE2D_DESC textureDesc;
 	textureDesc.MipLevels = 1;
 	textureDesc.ArraySize = 6;
@@ -599,17 +1003,18 @@ STDOBJMirror::~STDOBJMirror()
 	}
 	textureCube->Release();
 	SRV->Release();
+	delete reflectionView;
 }
 
 void STDOBJMirror::Render()
 {
 	if (blockRender) return;
 
-	UINT stride = sizeof(Vertex);
+	UINT stride = meshResource->vertexStride;
 	UINT offset = 0;
 
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, vertexBuffer);
-	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(indexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(stride, offset, meshResource->vertexBuffer);
+	Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(meshResource->indexBuffer, meshResource->indexFormat);
 
 	UpdateTransformBuffer();
 
@@ -622,12 +1027,17 @@ void STDOBJMirror::Render()
 
 	Pipeline::Deferred::GeometryPass::PixelShader::Bind::Reflectionmap(SRV);
 
-	for (Submesh submesh : submeshes)
+	for (Submesh submesh : meshResource->submeshes)
 	{
-		Pipeline::DrawIndexed(submesh.size, submesh.Start);
+		Pipeline::DrawIndexed(submesh.size, submesh.Start, submesh.baseVertex);
 	}
 }
 
+bool STDOBJMirror::InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes)
+{
+	return false;
+}
+
 void STDOBJMirror::ReflectionRender()
 {
 	for (int i = 0; i < 6; i++)
@@ -635,10 +1045,9 @@ void STDOBJMirror::ReflectionRender()
 		Pipeline::Clean::UnorderedAccessView(UAVs[i]);
 	}
 
-	CameraPerspective view = CameraPerspective(resolution, resolution, 0.0f, 0.0f, 90.0f, nearPlane, farPlane);
-	view.Translate({ position.x, position.y, position.z }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
+	reflectionView->Translate({ position.x, position.y, position.z }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
 
 	blockRender = true;
-	renderer->OmniCameraDeferredRender(&view, UAVs);
+	renderer->OmniCameraDeferredRender(reflectionView, UAVs);
 	blockRender = false;
 }
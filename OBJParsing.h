@@ -2,43 +2,35 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <memory>
 #include <d3d11.h>
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
 
 #include "BaseObject.h"
+#include "MeshData.h"
+#include "OBJReader.h"
+#include "GLBReader.h"
+#include "Meshlets.h"
+#include "MeshCache.h"
+#include "VertexQuantization.h"
+#include "AsyncLoading.h"
 #include "SharedResources.h"
 #include "QuadTree.h"
 
-struct Vertex {
-	float pos[3];
-	float norm[3];
-	float uv[2];
+class CameraPerspective;
 
-	Vertex(const std::array<float, 3>& position, const std::array<float, 3>& normal, const std::array<float, 2>& uvCoords)
-	{
-		for (int i = 0; i < 3; i++)
-		{
-			pos[i] = position[i];
-			norm[i] = normal[i];
-		}
-		for (int i = 0; i < 2; i++)
-		{
-			uv[i] = uvCoords[i];
-		}
-	}
-};
-
-struct Submesh {
-	int Start = 0;
-	int size = 0;
-	int material = 0;
-};
+//a level is drawn while its error covers less than this many pixels on screen
+#define STDOBJ_LOD_PIXEL_ERROR 1.0f
+//margin around STDOBJ_LOD_PIXEL_ERROR, so an object close to a switching distance does not flicker between two levels
+#define STDOBJ_LOD_HYSTERESIS 0.25f
+//views an object keeps its level for, the view drawn from longest ago gives way to a new one
+#define STDOBJ_LOD_VIEWS 8
 
 class STDOBJ : public Object
 {
 	public:
-		STDOBJ(const std::string OBJFilepath);
+		STDOBJ(const std::string OBJFilepath, UINT importFlags = OBJ_IMPORT_PARALLEL);
 
 		~STDOBJ();
 
@@ -46,19 +38,101 @@ class STDOBJ : public Object
 		virtual void DepthRender() override;
 
 		virtual bool Contained(DirectX::BoundingFrustum& viewFrustum) override;
+
+		//the bounds are only known once the object is loaded, add OBJ_IMPORT_ASYNC objects after IsLoaded()
 		virtual void AddToQuadTree(QuadTree* tree) override;
 
+		//only without meshlets, the meshlets of an object are culled against its own transform
+		virtual bool InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes) override;
+
+		//an object made from a file that is already loading is not loaded before the first one is done
+		bool IsLoaded() const;
+
 	protected:
-		std::vector<Submesh> submeshes;
-		ID3D11Buffer* vertexBuffer;
-		ID3D11Buffer* indexBuffer;
+		//shared with every other STDOBJ loaded from the same file and flags
+		std::shared_ptr<MeshResource> meshResource;
+
+		//the level last drawn from each view, most recent first. The main camera and every shadow map camera move on their own
+		struct ViewLOD
+		{
+			UINT viewID = 0;
+			int level = 0;
+		};
+		std::array<ViewLOD, STDOBJ_LOD_VIEWS> viewLODs;
+
+		//picks the level for the camera made active last, 0 is submeshes and n is lods[n - 1]
+		const std::vector<Submesh>& SelectLOD();
+
+		std::vector<Meshlets::DrawRange> drawRanges;
+
+		//the camera made active last in object space, false when there is nothing to cull with
+		bool ActiveCullView(Meshlets::CullView& view);
+
+		//draws the visible meshlets of a submesh, or all of it without a view
+		void DrawSubmesh(const Submesh& submesh, const Meshlets::CullView* view);
+
+		//moves the world space bounds along with the object
+		virtual void OnModyfied() override;
+
+		//false until the shared mesh is loaded, the first call after that computes the world space bounds
+		bool Ready();
 
 	private:
-		DirectX::BoundingSphere boundingVolume;
+		//world space, only recomputed when the object is moved, rotated or scaled
+		DirectX::BoundingSphere worldVolume;
+		DirectX::BoundingOrientedBox worldBox;
+		bool worldBoundsReady;
 
-		bool LoadOBJ(std::string OBJFilepath);
+		//everything a load produces before it touches the device
+		struct PreparedOBJ
+		{
+			std::string OBJFilepath;
+			UINT importFlags = 0;
+
+			//the cache is mapped and its arrays handed straight to CreateBuffer, mesh is only used when there is no valid cache
+			MeshCache::CachedMesh cached;
+			MeshData mesh;
+
+			//a .glb that needs nothing built is mapped instead of cached, cached then points into it
+			GLBReader::MappedMesh glb;
+
+			std::vector<MaterialData> materials;
+
+			//the compact layout is encoded here, caches always hold full precision vertices
+			std::vector<CompactVertex> compactVertices;
+			MeshDecodeBufferStruct decode;
+			std::vector<uint16_t> shortIndices;
+
+			//OBJ_IMPORT_TRIM_VERTICES of a mesh whose materials are all parameter materials, empty otherwise
+			std::vector<UntexturedVertex> untexturedVertices;
+
+			//the position stream of the depth passes
+			std::vector<PositionVertex> positions;
+
+			//16 bit indices for the index buffer, into shortIndices or straight into the .glb. cached.indices is not used then
+			const uint16_t* shortIndexData = nullptr;
+		};
+
+		static bool LoadOBJ(std::string OBJFilepath, UINT importFlags, MeshResource& resource);
 
-		bool LoadMTL(std::string MTLFilepath);
+		//file access, parsing and encoding only, safe on any thread
+		static bool PrepareOBJ(PreparedOBJ& prepared);
+		static bool ParseMTL(std::string MTLFilepath, std::vector<MaterialData>& materials);
+
+		//the MTL materials the ones of a .glb come closest to
+		static void AddGLBMaterials(const std::vector<GLBReader::Material>& GLBMaterials, std::vector<MaterialData>& materials);
+
+		//map_Ka, map_Kd and map_Ks of every textured material that is not registered yet
+		static std::vector<std::string> MaterialTextures(const std::vector<MaterialData>& materials);
+
+		//true when a submesh material is textured or not among materials, so it might be
+		static bool SamplesTextures(const std::vector<MaterialData>& materials, const std::vector<std::string>& submeshMaterials);
+
+		//registers the materials and creates the buffers, main thread only
+		static bool CreateResources(PreparedOBJ& prepared, MeshResource& resource);
+
+		//holds on to the resource, so the load finishes even when every object using it is gone
+		static AsyncLoading::Task<void> LoadOBJAsync(std::shared_ptr<MeshResource> resource, std::unique_ptr<PreparedOBJ> prepared);
 };
 
 struct TesselationConfigBufferStruct
@@ -86,6 +160,9 @@ public:
 	virtual void Render() override;
 	virtual void DepthRender() override;
 
+	//drawn through the tesselation stages, which the instanced shaders do not feed
+	virtual bool InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes) override;
+
 private:
 	ID3D11Buffer* tesselationConfigBuffer;
 };
@@ -100,6 +177,9 @@ public:
 
 	virtual void Render() override;
 
+	//every mirror samples its own reflection
+	virtual bool InstanceBatch(MeshResource*& mesh, const std::vector<Submesh>*& submeshes) override;
+
 	void ReflectionRender();
 
 private:
@@ -110,6 +190,9 @@ private:
 
 	DeferredRenderer* renderer;
 
+	//kept from frame to frame so the objects in the reflection keep their level of detail for it
+	CameraPerspective* reflectionView;
+
 	ID3D11UnorderedAccessView* UAVs[6];
 	ID3D11Texture2D* textureCube;
 	ID3D11ShaderResourceView* SRV;
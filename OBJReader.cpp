@@ -0,0 +1,964 @@
+#include "OBJReader.h"
+#include <iostream>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include "CornerHashTable.h"
+#include "MeshBounds.h"
+
+namespace
+{
+	inline bool IsBlank(char c)
+	{
+		return (c == ' ') || (c == '\t') || (c == '\r');
+	}
+
+	const char* SkipBlanks(const char* cursor, const char* end)
+	{
+		while ((cursor < end) && IsBlank(*cursor))
+		{
+			cursor++;
+		}
+		return cursor;
+	}
+
+	const char* LineEnd(const char* cursor, const char* end)
+	{
+		const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+		return (newline != nullptr) ? newline : end;
+	}
+
+	//returns a view into the mapped file, no copy is made
+	std::string_view NextToken(const char*& cursor, const char* end)
+	{
+		cursor = SkipBlanks(cursor, end);
+
+		const char* start = cursor;
+		while ((cursor < end) && !IsBlank(*cursor))
+		{
+			cursor++;
+		}
+		return std::string_view(start, cursor - start);
+	}
+
+	//everything after the keyword and its separator, same as what the old line based parser handed on
+	std::string_view RestOfLineView(const char* cursor, const char* end)
+	{
+		if ((cursor < end) && (*cursor == ' '))
+		{
+			cursor++;
+		}
+		return std::string_view(cursor, end - cursor);
+	}
+
+	bool ParseFloat(const char*& cursor, const char* end, float& value)
+	{
+		cursor = SkipBlanks(cursor, end);
+		if ((cursor < end) && (*cursor == '+'))
+		{
+			cursor++;
+		}
+
+		std::from_chars_result result = std::from_chars(cursor, end, value);
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+
+		cursor = result.ptr;
+		return true;
+	}
+
+	bool ParseIndex(const char*& cursor, const char* end, int& value)
+	{
+		if ((cursor < end) && (*cursor == '+'))
+		{
+			cursor++;
+		}
+
+		std::from_chars_result result = std::from_chars(cursor, end, value);
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+
+		cursor = result.ptr;
+		return true;
+	}
+
+	//"pos/uv/norm" with 1 based indices, converted to 0 based
+	bool ParseCorner(std::string_view corner, int index[3])
+	{
+		const char* cursor = corner.data();
+		const char* end = corner.data() + corner.size();
+
+		for (int i = 0; i < 3; i++)
+		{
+			if (i > 0)
+			{
+				if ((cursor >= end) || (*cursor != '/'))
+				{
+					return false;
+				}
+				cursor++;
+			}
+
+			if (!ParseIndex(cursor, end, index[i]))
+			{
+				return false;
+			}
+			index[i]--;
+		}
+
+		return cursor == end;
+	}
+
+	struct Corner
+	{
+		int index[3];
+	};
+
+	enum class RecordType { Library, Smoothing, Material, Face };
+
+	//the lines that depend on file order, kept so they can be replayed after all chunks are parsed
+	struct Record
+	{
+		RecordType type;
+		std::string_view text;
+		uint32_t firstCorner;
+		uint32_t cornerCount;
+	};
+
+	//one line aligned slice of the file. v/vt/vn only depend on their own line so every chunk is parsed on its own
+	struct Chunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		std::vector<std::array<float, 3>> pos;
+		std::vector<std::array<float, 2>> uv;
+		std::vector<std::array<float, 3>> norm;
+
+		std::vector<Record> records;
+		std::vector<Corner> corners;
+
+		std::string error;
+	};
+
+	//chunks smaller than this are not worth handing to another thread
+	const size_t MinimumChunkBytes = 256 * 1024;
+
+	void SplitIntoChunks(const char* data, size_t size, size_t chunkCount, std::vector<Chunk>& chunks)
+	{
+		chunks.resize(chunkCount);
+
+		const char* fileEnd = data + size;
+		const char* begin = data;
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			const char* end = (i + 1 == chunkCount) ? fileEnd : data + (size * (i + 1)) / chunkCount;
+			if (end < begin)
+			{
+				end = begin;
+			}
+			if (end < fileEnd)
+			{
+				end = LineEnd(end, fileEnd);
+				end = (end < fileEnd) ? end + 1 : fileEnd;
+			}
+
+			chunks[i].begin = begin;
+			chunks[i].end = end;
+			begin = end;
+		}
+	}
+
+	void ParseChunk(Chunk& chunk, const std::string& OBJFilepath)
+	{
+		const char* cursor = chunk.begin;
+		const char* chunkEnd = chunk.end;
+
+		while (cursor < chunkEnd)
+		{
+			const char* lineEnd = LineEnd(cursor, chunkEnd);
+
+			std::string_view word = NextToken(cursor, lineEnd);
+
+			if (word == "v")
+			{
+				std::array<float, 3> temp;
+
+				if (!ParseFloat(cursor, lineEnd, temp[0]) || !ParseFloat(cursor, lineEnd, temp[1]) || !ParseFloat(cursor, lineEnd, temp[2]))
+				{
+					chunk.error = "Malformed vertex position in " + OBJFilepath;
+					return;
+				}
+
+				chunk.pos.push_back(temp);
+			}
+			else if (word == "vt")
+			{
+				std::array<float, 2> temp;
+
+				if (!ParseFloat(cursor, lineEnd, temp[0]) || !ParseFloat(cursor, lineEnd, temp[1]))
+				{
+					chunk.error = "Malformed texture coordinate in " + OBJFilepath;
+					return;
+				}
+
+				chunk.uv.push_back(temp);
+			}
+			else if (word == "vn")
+			{
+				std::array<float, 3> temp;
+
+				if (!ParseFloat(cursor, lineEnd, temp[0]) || !ParseFloat(cursor, lineEnd, temp[1]) || !ParseFloat(cursor, lineEnd, temp[2]))
+				{
+					chunk.error = "Malformed vertex normal in " + OBJFilepath;
+					return;
+				}
+
+				chunk.norm.push_back(temp);
+			}
+			else if (word == "f")
+			{
+				Record record = { RecordType::Face, std::string_view(), static_cast<uint32_t>(chunk.corners.size()), 0 };
+
+				std::string_view text = NextToken(cursor, lineEnd);
+				while (!text.empty())
+				{
+					Corner corner;
+					if (!ParseCorner(text, corner.index))
+					{
+						chunk.error = "Malformed face in " + OBJFilepath + ", expected v/vt/vn";
+						return;
+					}
+
+					chunk.corners.push_back(corner);
+					record.cornerCount++;
+
+					text = NextToken(cursor, lineEnd);
+				}
+
+				chunk.records.push_back(record);
+			}
+			else if (word == "s")
+			{
+				chunk.records.push_back({ RecordType::Smoothing, std::string_view(), 0, 0 });
+			}
+			else if (word == "usemtl" || word == "mtllib")
+			{
+				std::string_view rest = RestOfLineView(cursor, lineEnd);
+				chunk.records.push_back({ (word == "usemtl") ? RecordType::Material : RecordType::Library, rest, 0, 0 });
+			}
+
+			cursor = (lineEnd < chunkEnd) ? lineEnd + 1 : chunkEnd;
+		}
+	}
+
+	//the order dependent s/usemtl/mtllib lines of the replay, faces only check that a submesh was started
+	struct SubmeshState
+	{
+		Submesh current;
+		std::string material = "";
+		bool started = false;
+
+		bool Replay(const Record& record, MeshData& mesh, size_t indexCount)
+		{
+			if (record.type == RecordType::Library)
+			{
+				mesh.materialLibraries.push_back(std::string(record.text));
+			}
+			else if (record.type == RecordType::Smoothing)
+			{
+				if (started)
+				{
+					mesh.submeshes.push_back(current);
+					mesh.submeshMaterials.push_back(material);
+				}
+				else
+				{
+					started = true;
+				}
+				current.Start = static_cast<int>(indexCount);
+				current.size = 0;
+			}
+			else if (!started)
+			{
+				std::cerr << ".obj must use submeshes partitioned by s!" << std::endl;
+				return false;
+			}
+			else if (record.type == RecordType::Material)
+			{
+				material = std::string(record.text);
+			}
+			return true;
+		}
+
+		void Close(MeshData& mesh)
+		{
+			if (started)
+			{
+				mesh.submeshes.push_back(current);
+				mesh.submeshMaterials.push_back(material);
+			}
+		}
+	};
+
+	//positions, uvs or normals of a streaming import. Kept in pages of which only the ones used last stay in memory,
+	//the others are written to a temporary file and read back when a face refers to them again
+	template<typename T>
+	class AttributeStore
+	{
+		public:
+			static const size_t PageElements = 4096;
+
+			AttributeStore(size_t budgetBytes, const std::string& name) : spillFilepath(SpillPath(name)), size(0), clock(0)
+			{
+				maxFrames = std::max<size_t>(4, budgetBytes / (PageElements * sizeof(T)));
+			}
+
+			~AttributeStore()
+			{
+				if (spill.is_open())
+				{
+					spill.close();
+					std::error_code error;
+					std::filesystem::remove(spillFilepath, error);
+				}
+			}
+
+			AttributeStore(const AttributeStore&) = delete;
+			AttributeStore& operator=(const AttributeStore&) = delete;
+
+			bool Append(const std::vector<T>& values)
+			{
+				for (const T& value : values)
+				{
+					Frame* frame = Load(size / PageElements);
+					if (frame == nullptr)
+					{
+						return false;
+					}
+					frame->data[size % PageElements] = value;
+					frame->dirty = true;
+					size++;
+				}
+				return true;
+			}
+
+			//nullptr if the spill file failed, index has to be below Size()
+			const T* Get(size_t index)
+			{
+				Frame* frame = Load(index / PageElements);
+				return (frame != nullptr) ? &frame->data[index % PageElements] : nullptr;
+			}
+
+			size_t Size() const
+			{
+				return size;
+			}
+
+			size_t Bytes() const
+			{
+				return frames.size() * PageElements * sizeof(T) + pageFrames.capacity() * sizeof(int) + onDisk.capacity() / 8;
+			}
+
+		private:
+			struct Frame
+			{
+				size_t page = 0;
+				uint64_t used = 0;
+				bool dirty = false;
+				std::vector<T> data;
+			};
+
+			std::string spillFilepath;
+			std::fstream spill;
+
+			std::vector<Frame> frames;
+			size_t maxFrames;
+
+			//frame holding each page, -1 when it is not in memory
+			std::vector<int> pageFrames;
+			std::vector<bool> onDisk;
+
+			size_t size;
+			uint64_t clock;
+
+			static std::string SpillPath(const std::string& name)
+			{
+				std::error_code error;
+				std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+				return (directory / (name + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".spill")).string();
+			}
+
+			Frame* Load(size_t page)
+			{
+				if (page >= pageFrames.size())
+				{
+					pageFrames.resize(page + 1, -1);
+					onDisk.resize(page + 1, false);
+				}
+
+				if (pageFrames[page] >= 0)
+				{
+					Frame& frame = frames[pageFrames[page]];
+					frame.used = ++clock;
+					return &frame;
+				}
+
+				size_t slot = frames.size();
+				if (frames.size() < maxFrames)
+				{
+					frames.emplace_back();
+					frames.back().data.resize(PageElements);
+				}
+				else
+				{
+					slot = 0;
+					for (size_t i = 1; i < frames.size(); i++)
+					{
+						if (frames[i].used < frames[slot].used)
+						{
+							slot = i;
+						}
+					}
+					if (!Evict(frames[slot]))
+					{
+						return nullptr;
+					}
+				}
+
+				Frame& frame = frames[slot];
+				frame.page = page;
+				frame.used = ++clock;
+				frame.dirty = false;
+				pageFrames[page] = static_cast<int>(slot);
+
+				if (onDisk[page])
+				{
+					spill.seekg(static_cast<std::streamoff>(page * PageElements * sizeof(T)));
+					spill.read(reinterpret_cast<char*>(frame.data.data()), PageElements * sizeof(T));
+					if (!spill.good())
+					{
+						std::cerr << "Failed to read back: " << spillFilepath << std::endl;
+						return nullptr;
+					}
+				}
+				return &frame;
+			}
+
+			bool Evict(Frame& frame)
+			{
+				pageFrames[frame.page] = -1;
+				if (!frame.dirty)
+				{
+					return true;
+				}
+
+				if (!spill.is_open())
+				{
+					spill.open(spillFilepath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+				}
+
+				spill.seekp(static_cast<std::streamoff>(frame.page * PageElements * sizeof(T)));
+				spill.write(reinterpret_cast<const char*>(frame.data.data()), PageElements * sizeof(T));
+				if (!spill.good())
+				{
+					std::cerr << "Failed to page out to: " << spillFilepath << std::endl;
+					return false;
+				}
+
+				onDisk[frame.page] = true;
+				return true;
+			}
+	};
+
+	//collects a streamed mesh in MeshData, for OBJReader::Read with OBJ_IMPORT_STREAMING
+	class MeshDataSink : public MeshSink
+	{
+		public:
+			MeshDataSink(MeshData& mesh) : mesh(mesh)
+			{
+			}
+
+			bool Vertices(const Vertex* vertices, size_t count) override
+			{
+				mesh.vertices.insert(mesh.vertices.end(), vertices, vertices + count);
+				return true;
+			}
+
+			bool Indices(const uint32_t* indices, size_t count) override
+			{
+				mesh.indices.insert(mesh.indices.end(), indices, indices + count);
+				return true;
+			}
+
+		private:
+			MeshData& mesh;
+	};
+
+	template<typename T>
+	size_t VectorBytes(const std::vector<T>& values)
+	{
+		return values.capacity() * sizeof(T);
+	}
+
+	template<typename T>
+	void Concatenate(ThreadPool* pool, std::vector<Chunk>& chunks, std::vector<T> Chunk::* stream, std::vector<T>& result)
+	{
+		std::vector<size_t> offsets(chunks.size() + 1, 0);
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			offsets[i + 1] = offsets[i] + (chunks[i].*stream).size();
+		}
+
+		result.resize(offsets.back());
+
+		auto copyChunk = [&](size_t i)
+		{
+			const std::vector<T>& source = chunks[i].*stream;
+			std::copy(source.begin(), source.end(), result.begin() + offsets[i]);
+		};
+
+		if (pool != nullptr)
+		{
+			pool->ParallelFor(chunks.size(), copyChunk);
+		}
+		else
+		{
+			for (size_t i = 0; i < chunks.size(); i++)
+			{
+				copyChunk(i);
+			}
+		}
+	}
+}
+
+double OBJReader::ReadStats::MegabytesPerSecond() const
+{
+	if (seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / seconds;
+}
+
+bool OBJReader::Read(const std::string& OBJFilepath, MeshData& mesh, unsigned int importFlags, ReadStats* stats)
+{
+	if ((importFlags & OBJ_IMPORT_STREAMING) != 0)
+	{
+		MeshDataSink sink(mesh);
+		return Stream(OBJFilepath, sink, mesh, importFlags, StreamOptions(), stats);
+	}
+
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+	Asset file;
+	if (!AssetPack::Open(OBJFilepath, file))
+	{
+		std::cerr << "Failed to open obj filepath: " << OBJFilepath << std::endl;
+		return false;
+	}
+
+	ThreadPool* pool = nullptr;
+	size_t chunkCount = 1;
+	if ((importFlags & OBJ_IMPORT_PARALLEL) != 0)
+	{
+		pool = &ThreadPool::Shared();
+		size_t maxChunks = static_cast<size_t>(pool->ThreadCount() + 1) * 4;
+		chunkCount = std::max<size_t>(1, std::min(file.Size() / MinimumChunkBytes, maxChunks));
+		if (chunkCount == 1)
+		{
+			pool = nullptr;
+		}
+	}
+
+	//first pass: attribute streams and face corners, independently per chunk
+	std::vector<Chunk> chunks;
+	SplitIntoChunks(file.Data(), file.Size(), chunkCount, chunks);
+
+	if (pool != nullptr)
+	{
+		pool->ParallelFor(chunks.size(), [&](size_t i) { ParseChunk(chunks[i], OBJFilepath); });
+	}
+	else
+	{
+		ParseChunk(chunks[0], OBJFilepath);
+	}
+
+	for (const Chunk& chunk : chunks)
+	{
+		if (!chunk.error.empty())
+		{
+			std::cerr << chunk.error << std::endl;
+			return false;
+		}
+	}
+
+	std::vector<std::array<float, 3>> pos;
+	std::vector<std::array<float, 2>> uv;
+	std::vector<std::array<float, 3>> norm;
+
+	Concatenate(pool, chunks, &Chunk::pos, pos);
+	Concatenate(pool, chunks, &Chunk::uv, uv);
+	Concatenate(pool, chunks, &Chunk::norm, norm);
+
+	std::chrono::time_point<std::chrono::steady_clock> dedupStart = std::chrono::steady_clock::now();
+
+	//second pass: replay the ordered records in file order so submeshes and vertex order match a serial read
+	size_t cornerCount = 0;
+	for (const Chunk& chunk : chunks)
+	{
+		cornerCount += chunk.corners.size();
+	}
+
+	//closed meshes share most corners, a table sized for half of them rarely has to grow
+	CornerHashTable vertMap(cornerCount / 2);
+	mesh.indices.reserve(cornerCount);
+
+	SubmeshState submeshes;
+
+	for (const Chunk& chunk : chunks)
+	{
+		for (const Record& record : chunk.records)
+		{
+			if (!submeshes.Replay(record, mesh, mesh.indices.size()))
+			{
+				return false;
+			}
+
+			if (record.type == RecordType::Face)
+			{
+				for (uint32_t i = record.firstCorner; i < record.firstCorner + record.cornerCount; i++)
+				{
+					const Corner& corner = chunk.corners[i];
+
+					bool inserted = false;
+					uint32_t vertex = vertMap.FindOrInsert(corner.index, static_cast<uint32_t>(mesh.vertices.size()), inserted);
+					if (inserted)
+					{
+						const int* index = corner.index;
+						if ((index[0] < 0) || (index[0] >= static_cast<int>(pos.size())) ||
+							(index[1] < 0) || (index[1] >= static_cast<int>(uv.size())) ||
+							(index[2] < 0) || (index[2] >= static_cast<int>(norm.size())))
+						{
+							std::cerr << "Face index out of range in " << OBJFilepath << std::endl;
+							return false;
+						}
+
+						Vertex temp = { {pos[index[0]][0], pos[index[0]][1], pos[index[0]][2]}, {norm[index[2]][0], norm[index[2]][1], norm[index[2]][2]}, {uv[index[1]][0], -uv[index[1]][1]} };
+
+						mesh.vertices.push_back(temp);
+					}
+
+					mesh.indices.push_back(vertex);
+					submeshes.current.size++;
+				}
+			}
+		}
+	}
+	submeshes.Close(mesh);
+
+	mesh.bounds = MeshBounds::Compute(mesh.vertices);
+
+	std::chrono::duration<double> dedupTime = std::chrono::steady_clock::now() - dedupStart;
+
+	if (stats != nullptr)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		stats->bytes = file.Size();
+		stats->seconds = elapsed.count();
+		stats->chunks = chunks.size();
+		stats->dedupSeconds = dedupTime.count();
+	}
+
+	return true;
+}
+
+bool OBJReader::Stream(const std::string& OBJFilepath, MeshSink& sink, MeshData& mesh, unsigned int importFlags, const StreamOptions& options, ReadStats* stats)
+{
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+	//a packed file is already mapped with the pack, its windows are copied out of the mapping instead of read
+	Asset packed;
+	std::ifstream file;
+	if (AssetPack::Contains(OBJFilepath))
+	{
+		AssetPack::Open(OBJFilepath, packed);
+	}
+	else
+	{
+		file.open(OBJFilepath, std::ios::binary);
+	}
+
+	if (!packed.IsOpen() && !file.is_open())
+	{
+		std::cerr << "Failed to open obj filepath: " << OBJFilepath << std::endl;
+		return false;
+	}
+
+	//shares of the budget. Parsed chunks take up to about three times the text of their window and their vectors can
+	//be twice the size they need, which leaves a third of the budget as headroom for files denser than usual
+	size_t budget = std::max(options.memoryBudget, MinimumStreamingBudget);
+	size_t windowBytes = budget / 32;
+	size_t attributeBytes = budget / 18;
+	size_t cornerTableBytes = budget / 6;
+	size_t vertexBatchCount = budget / 32 / sizeof(Vertex);
+	size_t indexBatchCount = budget / 64 / sizeof(uint32_t);
+
+	ThreadPool* pool = nullptr;
+	size_t chunkCount = 1;
+	if ((importFlags & OBJ_IMPORT_PARALLEL) != 0)
+	{
+		pool = &ThreadPool::Shared();
+		size_t maxChunks = static_cast<size_t>(pool->ThreadCount() + 1) * 4;
+		chunkCount = std::max<size_t>(1, std::min(windowBytes / MinimumChunkBytes, maxChunks));
+		if (chunkCount == 1)
+		{
+			pool = nullptr;
+		}
+	}
+
+	std::string spillName = std::filesystem::path(OBJFilepath).filename().string();
+	AttributeStore<std::array<float, 3>> pos(attributeBytes, spillName + ".pos");
+	AttributeStore<std::array<float, 2>> uv(attributeBytes, spillName + ".uv");
+	AttributeStore<std::array<float, 3>> norm(attributeBytes, spillName + ".norm");
+
+	//started over instead of growing past its share, corners seen before that are welded into new vertices
+	const size_t cornerTableEntries = cornerTableBytes / 256;
+	CornerHashTable vertMap(cornerTableEntries);
+
+	std::vector<Vertex> vertexBatch;
+	std::vector<uint32_t> indexBatch;
+	vertexBatch.reserve(vertexBatchCount);
+	indexBatch.reserve(indexBatchCount);
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+
+	std::vector<char> window(windowBytes);
+	std::vector<Chunk> chunks;
+	SubmeshState submeshes;
+
+	size_t fileBytes = 0;
+	size_t windowCount = 0;
+	size_t chunksParsed = 0;
+	size_t peakBytes = 0;
+	std::chrono::duration<double> dedupTime(0.0);
+
+	auto measure = [&]()
+	{
+		size_t bytes = VectorBytes(window) + VectorBytes(chunks) + pos.Bytes() + uv.Bytes() + norm.Bytes() + vertMap.Bytes() + VectorBytes(vertexBatch) + VectorBytes(indexBatch);
+		for (const Chunk& chunk : chunks)
+		{
+			bytes += VectorBytes(chunk.pos) + VectorBytes(chunk.uv) + VectorBytes(chunk.norm) + VectorBytes(chunk.records) + VectorBytes(chunk.corners);
+		}
+		peakBytes = std::max(peakBytes, bytes);
+	};
+
+	auto flushVertices = [&]()
+	{
+		if (vertexBatch.empty())
+		{
+			return true;
+		}
+
+		MeshBounds::Extend(mesh.bounds, vertexCount - vertexBatch.size(), vertexBatch.data(), vertexBatch.size());
+		bool written = sink.Vertices(vertexBatch.data(), vertexBatch.size());
+		vertexBatch.clear();
+		return written;
+	};
+
+	//indices only go out after the vertices they refer to
+	auto flushIndices = [&]()
+	{
+		if (!flushVertices())
+		{
+			return false;
+		}
+
+		bool written = indexBatch.empty() || sink.Indices(indexBatch.data(), indexBatch.size());
+		indexBatch.clear();
+		return written;
+	};
+
+	size_t carried = 0;
+	bool lastWindow = false;
+	while (!lastWindow)
+	{
+		size_t read;
+		if (packed.IsOpen())
+		{
+			read = std::min(window.size() - carried, packed.Size() - fileBytes);
+			memcpy(window.data() + carried, packed.Data() + fileBytes, read);
+		}
+		else
+		{
+			file.read(window.data() + carried, window.size() - carried);
+			read = static_cast<size_t>(file.gcount());
+		}
+		size_t filled = carried + read;
+		fileBytes += read;
+		lastWindow = filled < window.size();
+
+		//the partial line at the end of a window is carried over to the next one
+		const char* begin = window.data();
+		const char* end = begin + filled;
+		if (!lastWindow)
+		{
+			const char* lastNewline = begin + filled;
+			while ((lastNewline > begin) && (lastNewline[-1] != '\n'))
+			{
+				lastNewline--;
+			}
+			if (lastNewline == begin)
+			{
+				std::cerr << "Line longer than the streaming window in " << OBJFilepath << std::endl;
+				return false;
+			}
+			end = lastNewline;
+		}
+
+		if (end > begin)
+		{
+			size_t windowChunks = std::max<size_t>(1, std::min(static_cast<size_t>(end - begin) / MinimumChunkBytes, chunkCount));
+			SplitIntoChunks(begin, end - begin, windowChunks, chunks);
+			for (Chunk& chunk : chunks)
+			{
+				chunk.pos.clear();
+				chunk.uv.clear();
+				chunk.norm.clear();
+				chunk.records.clear();
+				chunk.corners.clear();
+				chunk.error.clear();
+			}
+
+			if ((pool != nullptr) && (chunks.size() > 1))
+			{
+				pool->ParallelFor(chunks.size(), [&](size_t i) { ParseChunk(chunks[i], OBJFilepath); });
+			}
+			else
+			{
+				ParseChunk(chunks[0], OBJFilepath);
+			}
+
+			for (const Chunk& chunk : chunks)
+			{
+				if (!chunk.error.empty())
+				{
+					std::cerr << chunk.error << std::endl;
+					return false;
+				}
+				if (!pos.Append(chunk.pos) || !uv.Append(chunk.uv) || !norm.Append(chunk.norm))
+				{
+					return false;
+				}
+			}
+
+			std::chrono::time_point<std::chrono::steady_clock> dedupStart = std::chrono::steady_clock::now();
+
+			for (const Chunk& chunk : chunks)
+			{
+				for (const Record& record : chunk.records)
+				{
+					if (!submeshes.Replay(record, mesh, indexCount))
+					{
+						return false;
+					}
+
+					if (record.type != RecordType::Face)
+					{
+						continue;
+					}
+
+					for (uint32_t i = record.firstCorner; i < record.firstCorner + record.cornerCount; i++)
+					{
+						const Corner& corner = chunk.corners[i];
+
+						if (vertMap.GrowsOnInsert() && (vertMap.Bytes() * 2 > cornerTableBytes))
+						{
+							measure();
+							vertMap = CornerHashTable(cornerTableEntries);
+						}
+
+						bool inserted = false;
+						uint32_t vertex = vertMap.FindOrInsert(corner.index, static_cast<uint32_t>(vertexCount), inserted);
+						if (inserted)
+						{
+							const int* index = corner.index;
+							if ((index[0] < 0) || (static_cast<size_t>(index[0]) >= pos.Size()) ||
+								(index[1] < 0) || (static_cast<size_t>(index[1]) >= uv.Size()) ||
+								(index[2] < 0) || (static_cast<size_t>(index[2]) >= norm.Size()))
+							{
+								std::cerr << "Face index out of range in " << OBJFilepath << std::endl;
+								return false;
+							}
+
+							const std::array<float, 3>* position = pos.Get(index[0]);
+							const std::array<float, 2>* coordinate = uv.Get(index[1]);
+							const std::array<float, 3>* normal = norm.Get(index[2]);
+							if ((position == nullptr) || (coordinate == nullptr) || (normal == nullptr))
+							{
+								return false;
+							}
+							Vertex temp = { {(*position)[0], (*position)[1], (*position)[2]}, {(*normal)[0], (*normal)[1], (*normal)[2]}, {(*coordinate)[0], -(*coordinate)[1]} };
+
+							vertexBatch.push_back(temp);
+							vertexCount++;
+							if ((vertexBatch.size() == vertexBatchCount) && !flushVertices())
+							{
+								return false;
+							}
+						}
+
+						indexBatch.push_back(vertex);
+						indexCount++;
+						submeshes.current.size++;
+						if ((indexBatch.size() == indexBatchCount) && !flushIndices())
+						{
+							return false;
+						}
+					}
+				}
+			}
+
+			dedupTime += std::chrono::steady_clock::now() - dedupStart;
+			chunksParsed += chunks.size();
+		}
+
+		windowCount++;
+		measure();
+
+		carried = filled - (end - begin);
+		memmove(window.data(), end, carried);
+	}
+
+	if (!flushIndices())
+	{
+		return false;
+	}
+	submeshes.Close(mesh);
+
+	if (stats != nullptr)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		stats->bytes = fileBytes;
+		stats->seconds = elapsed.count();
+		stats->chunks = chunksParsed;
+		stats->dedupSeconds = dedupTime.count();
+		stats->windows = windowCount;
+		stats->peakWorkingBytes = peakBytes;
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+#include "MeshData.h"
+
+//parse the file on the calling thread only
+#define OBJ_IMPORT_SERIAL 0x00
+//split the file into line aligned chunks and parse them on the shared thread pool. Produces the same mesh as a serial read.
+#define OBJ_IMPORT_PARALLEL 0x01
+//STDOBJ only: always parse the text and do not read or write the binary mesh cache
+#define OBJ_IMPORT_NO_CACHE 0x02
+//STDOBJ only: run MeshOptimizer over the parsed mesh (welding, submesh merging, vertex cache, overdraw and fetch order)
+#define OBJ_IMPORT_OPTIMIZE 0x04
+//STDOBJ only: upload CompactVertex (16 bytes) instead of Vertex and 16 bit indices when they fit. Only used by STDOBJ itself, not its subclasses.
+#define OBJ_IMPORT_COMPACT 0x08
+//STDOBJ only: build coarser levels of detail with MeshSimplifier and draw the one that fits the size on screen
+#define OBJ_IMPORT_LOD 0x10
+//levels of detail built for OBJ_IMPORT_LOD
+#define STDOBJ_LOD_LEVELS 4
+//STDOBJ only: split the mesh into meshlets and only draw the ones that can be seen by the active camera
+#define OBJ_IMPORT_MESHLETS 0x20
+//STDOBJ only: return from the constructor right away and load on the shared thread pool, the object draws nothing until IsLoaded()
+#define OBJ_IMPORT_ASYNC 0x40
+//read the file in fixed size windows and keep the working memory of the import within OBJ_STREAMING_BUDGET, for meshes too large to parse
+//in one piece. With the cache in use and no other build flag STDOBJ streams straight into the cache file. Faces may only use v/vt/vn lines
+//above them, and vertices can be welded a little less than by a normal read
+#define OBJ_IMPORT_STREAMING 0x80
+//STDOBJ only: compress the vertices and indices of the binary mesh cache with MeshCodec, a fraction of the size on disk for a decode on load
+#define OBJ_IMPORT_COMPRESSED 0x100
+//STDOBJ only: upload only the vertex attributes the materials read, UntexturedVertex (24 bytes) when none of them samples a texture.
+//Only used by STDOBJ itself, not its subclasses. OBJ_IMPORT_COMPACT takes precedence
+#define OBJ_IMPORT_TRIM_VERTICES 0x200
+
+//working memory a streaming import may use when no other budget is given
+#define OBJ_STREAMING_BUDGET (64ull * 1024 * 1024)
+
+//Text OBJ parsing straight out of a memory mapped file, or out of the mounted AssetPack.
+namespace OBJReader
+{
+	struct ReadStats
+	{
+		size_t bytes = 0;
+		double seconds = 0.0;
+		size_t chunks = 0;
+
+		//time spent welding face corners into vertices, part of seconds
+		double dedupSeconds = 0.0;
+
+		//streaming only: windows the file was read in and the most memory the import held at once, not counting what the sink keeps
+		size_t windows = 0;
+		size_t peakWorkingBytes = 0;
+
+		double MegabytesPerSecond() const;
+	};
+
+	struct StreamOptions
+	{
+		//raised to MinimumStreamingBudget when smaller
+		size_t memoryBudget = OBJ_STREAMING_BUDGET;
+	};
+
+	const size_t MinimumStreamingBudget = 4 * 1024 * 1024;
+
+	//with OBJ_IMPORT_STREAMING the mesh is streamed into mesh.vertices and mesh.indices with the default budget
+	bool Read(const std::string& OBJFilepath, MeshData& mesh, unsigned int importFlags = OBJ_IMPORT_PARALLEL, ReadStats* stats = nullptr);
+
+	//hands the vertices and indices to sink in batches as the file is read and fills in everything else of mesh, its vertices and indices are not touched.
+	//Raw positions, uvs and normals beyond the budget are paged out to a temporary file, the corner table is started over when it would outgrow its share.
+	//A file that is compressed in the pack is decompressed whole before streaming, pack the sources that need streaming uncompressed
+	bool Stream(const std::string& OBJFilepath, MeshSink& sink, MeshData& mesh, unsigned int importFlags = OBJ_IMPORT_PARALLEL, const StreamOptions& options = StreamOptions(), ReadStats* stats = nullptr);
+}
@@ -0,0 +1,99 @@
+struct PixelShaderInput
+{
+    float4 position : SV_POSITION;
+    float3 normal : normal;
+    float2 uv : uv;
+    float distance : dist;
+};
+
+struct PixelShaderOutput
+{
+	float4 normal3_shinyness1 : SV_Target0;
+	float4 ambient3_color1 : SV_Target1;
+	float4 diffuse3_color1 : SV_Target2;
+	float4 specular3_color1 : SV_Target3;
+};
+
+struct Material
+{
+	float3 ambientKoeff;
+	float shininessConstant;
+	float3 diffuseKoeff;
+	uint textured;
+	float3 specularKoeff;
+	uint padding;
+
+	//array, slice, single channel
+	uint4 ambientMap;
+	uint4 diffuseMap;
+	uint4 specularMap;
+};
+
+cbuffer MaterialIndex : register(b0)
+{
+	uint materialIndex;
+	uint3 indexPadding;
+};
+
+StructuredBuffer<Material> materials : register(t0);
+
+Texture2DArray maps[8] : register(t1);
+
+SamplerState basicSampler : register(s0);
+
+float4 SampleMap(uint4 map, float2 uv)
+{
+	float3 coordinates = float3(uv, map.y);
+	float4 value = float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	//the same for every pixel of a draw, resource arrays can only be indexed by constants
+	[forcecase]
+	switch (map.x)
+	{
+		case 0: value = maps[0].Sample(basicSampler, coordinates); break;
+		case 1: value = maps[1].Sample(basicSampler, coordinates); break;
+		case 2: value = maps[2].Sample(basicSampler, coordinates); break;
+		case 3: value = maps[3].Sample(basicSampler, coordinates); break;
+		case 4: value = maps[4].Sample(basicSampler, coordinates); break;
+		case 5: value = maps[5].Sample(basicSampler, coordinates); break;
+		case 6: value = maps[6].Sample(basicSampler, coordinates); break;
+		default: value = maps[7].Sample(basicSampler, coordinates); break;
+	}
+
+	//grey maps are stored as BC4 which only samples into red
+	if (map.z != 0)
+	{
+		value.rgb = value.rrr;
+	}
+	return value;
+}
+
+PixelShaderOutput main(PixelShaderInput input)
+{
+	PixelShaderOutput output;
+
+	Material material = materials[materialIndex];
+
+	output.normal3_shinyness1 = float4(input.normal, material.shininessConstant);
+
+	if (material.textured != 0)
+	{
+		output.ambient3_color1 = SampleMap(material.ambientMap, input.uv);
+		output.diffuse3_color1 = SampleMap(material.diffuseMap, input.uv);
+		output.specular3_color1 = SampleMap(material.specularMap, input.uv);
+	}
+	else
+	{
+		output.ambient3_color1 = float4(material.ambientKoeff, 0.0f);
+		output.diffuse3_color1 = float4(material.diffuseKoeff, 0.0f);
+		output.specular3_color1 = float4(material.specularKoeff, 0.0f);
+	}
+
+	float3 color = float3(0.0f, 0.0f, 0.0f);
+
+	output.ambient3_color1.w = color.r;
+	output.diffuse3_color1.w = color.g;
+	output.specular3_color1.w = color.b;
+
+	return output;
+}
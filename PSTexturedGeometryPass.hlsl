@@ -17,7 +17,9 @@ struct PixelShaderOutput
 cbuffer MaterialParameters : register(b0)
 {
 	float shininessConstant;
-	float3 padding;
+	float ambientSingleChannel;
+	float diffuseSingleChannel;
+	float specularSingleChannel;
 };
 
 Texture2D ambientKoeff : register(t0);
@@ -40,6 +42,22 @@ PixelShaderOutput main(PixelShaderInput input)
 	
 	output.specular3_color1 = specularKoeff.Sample(basicSampler, input.uv);
 	
+	//grey maps are stored as BC4 which only samples into red
+	if (ambientSingleChannel > 0.0f)
+	{
+		output.ambient3_color1.rgb = output.ambient3_color1.rrr;
+	}
+	
+	if (diffuseSingleChannel > 0.0f)
+	{
+		output.diffuse3_color1.rgb = output.diffuse3_color1.rrr;
+	}
+	
+	if (specularSingleChannel > 0.0f)
+	{
+		output.specular3_color1.rgb = output.specular3_color1.rrr;
+	}
+	
 	float3 color = float3(0.0f, 0.0f, 0.0f);
 	
 	output.ambient3_color1.w = color.r;
@@ -16,6 +16,32 @@ namespace Base
 	static UINT frameCount;
 }
 
+namespace Counters
+{
+	static UINT drawCalls;
+	static UINT64 triangles;
+	static UINT materialBinds;
+	static UINT materialChanges;
+	static UINT bufferBinds;
+}
+
+//the buffers the input assembler was given last, so objects that share the buffers of the mesh arena do not bind them again
+namespace InputAssemblerState
+{
+	static ID3D11Buffer* vertexBuffer;
+	static UINT stride;
+	static UINT offset;
+
+	static ID3D11Buffer* indexBuffer;
+	static DXGI_FORMAT indexFormat;
+}
+
+//counts every change to the pixel shader, its constant buffers and its resources, so a bind set can tell whether it is still in place
+namespace PixelState
+{
+	static UINT64 version;
+}
+
 namespace Samplers
 {
 	static ID3D11SamplerState* samplerwrap;
@@ -97,7 +123,7 @@ bool Pipeline::SetupRender(UINT width, UINT height, HWND window)
 	samplerDesc.MaxAnisotropy = 1;
 	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
 	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = 0;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 
 	if (FAILED(Base::device->CreateSamplerState(&samplerDesc, &Samplers::samplerwrap)))
 	{
@@ -223,9 +249,20 @@ UINT Pipeline::BackBufferHeight()
 	return Base::backBufferHeight;
 }
 
-void Pipeline::DrawIndexed(UINT size, UINT start)
+void Pipeline::DrawIndexed(UINT size, UINT start, INT baseVertex)
+{
+	Counters::drawCalls++;
+	Counters::triangles += size / 3;
+
+	Base::immediateContext->DrawIndexed(size, start, baseVertex);
+}
+
+void Pipeline::DrawIndexedInstanced(UINT size, UINT start, UINT instanceCount, INT baseVertex)
 {
-	Base::immediateContext->DrawIndexed(size, start, 0);
+	Counters::drawCalls++;
+	Counters::triangles += static_cast<UINT64>(size / 3) * instanceCount;
+
+	Base::immediateContext->DrawIndexedInstanced(size, instanceCount, start, baseVertex, 0);
 }
 
 void Pipeline::Switch()
@@ -243,6 +280,50 @@ UINT Pipeline::FrameCounter()
 	return Base::frameCount;
 }
 
+void Pipeline::Statistics::Reset()
+{
+	Counters::drawCalls = 0;
+	Counters::triangles = 0;
+	Counters::materialBinds = 0;
+	Counters::materialChanges = 0;
+	Counters::bufferBinds = 0;
+}
+
+void Pipeline::Statistics::CountMaterialBind()
+{
+	Counters::materialBinds++;
+}
+
+void Pipeline::Statistics::CountMaterialChange()
+{
+	Counters::materialChanges++;
+}
+
+UINT Pipeline::Statistics::DrawCalls()
+{
+	return Counters::drawCalls;
+}
+
+UINT64 Pipeline::Statistics::Triangles()
+{
+	return Counters::triangles;
+}
+
+UINT Pipeline::Statistics::MaterialBinds()
+{
+	return Counters::materialBinds;
+}
+
+UINT Pipeline::Statistics::MaterialChanges()
+{
+	return Counters::materialChanges;
+}
+
+UINT Pipeline::Statistics::BufferBinds()
+{
+	return Counters::bufferBinds;
+}
+
 void Pipeline::Deferred::GeometryPass::Set::Viewport(D3D11_VIEWPORT& viewport)
 {
 	Base::immediateContext->RSSetViewports(1, &viewport);
@@ -265,12 +346,29 @@ void Pipeline::Deferred::GeometryPass::VertexShader::Bind::PrimitiveTopology(D3D
 
 void Pipeline::Deferred::GeometryPass::VertexShader::Bind::VertexBuffer(UINT stride, UINT offset, ID3D11Buffer* vBuffer)
 {
+	if ((vBuffer == InputAssemblerState::vertexBuffer) && (stride == InputAssemblerState::stride) && (offset == InputAssemblerState::offset))
+	{
+		return;
+	}
+	InputAssemblerState::vertexBuffer = vBuffer;
+	InputAssemblerState::stride = stride;
+	InputAssemblerState::offset = offset;
+
+	Counters::bufferBinds++;
 	Base::immediateContext->IASetVertexBuffers(0, 1, &vBuffer, &stride, &offset);
 }
 
-void Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(ID3D11Buffer* iBuffer)
+void Pipeline::Deferred::GeometryPass::VertexShader::Bind::IndexBuffer(ID3D11Buffer* iBuffer, DXGI_FORMAT format)
 {
-	Base::immediateContext->IASetIndexBuffer(iBuffer, DXGI_FORMAT_R32_UINT, 0);
+	if ((iBuffer == InputAssemblerState::indexBuffer) && (format == InputAssemblerState::indexFormat))
+	{
+		return;
+	}
+	InputAssemblerState::indexBuffer = iBuffer;
+	InputAssemblerState::indexFormat = format;
+
+	Counters::bufferBinds++;
+	Base::immediateContext->IASetIndexBuffer(iBuffer, format, 0);
 }
 
 void Pipeline::Deferred::GeometryPass::VertexShader::Bind::cameraViewBuffer(ID3D11Buffer* cameraViewBuffer)
@@ -288,36 +386,59 @@ void Pipeline::Deferred::GeometryPass::VertexShader::Bind::ObjectTransform(ID3D1
 	Base::immediateContext->VSSetConstantBuffers(2, 1, &transformBuffer);
 }
 
+void Pipeline::Deferred::GeometryPass::VertexShader::Bind::MeshDecode(ID3D11Buffer* decodeBuffer)
+{
+	Base::immediateContext->VSSetConstantBuffers(3, 1, &decodeBuffer);
+}
+
+void Pipeline::Deferred::GeometryPass::VertexShader::Bind::InstanceTransforms(ID3D11ShaderResourceView* transformSRV)
+{
+	Base::immediateContext->VSSetShaderResources(0, 1, &transformSRV);
+}
+
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::PixelShader(ID3D11PixelShader* pShader)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShader(pShader, nullptr, 0);
 }
 
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::MaterialParameters(ID3D11Buffer* paramBuffer)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetConstantBuffers(0, 1, &paramBuffer);
 }
 
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::AmbientMap(ID3D11ShaderResourceView* SRV)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(0, 1, &SRV);
 }
 
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::DiffuseMap(ID3D11ShaderResourceView* SRV)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(1, 1, &SRV);
 }
 
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::SpecularMap(ID3D11ShaderResourceView* SRV)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(2, 1, &SRV);
 }
 
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::Reflectionmap(ID3D11ShaderResourceView* SRV)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(0, 1, &SRV);
 }
 
+void Pipeline::Deferred::GeometryPass::PixelShader::Bind::MaterialTable(ID3D11ShaderResourceView* tableSRV, ID3D11ShaderResourceView* const* arraySRVs, UINT arrayCount)
+{
+	PixelState::version++;
+	Base::immediateContext->PSSetShaderResources(0, 1, &tableSRV);
+	Base::immediateContext->PSSetShaderResources(1, arrayCount, arraySRVs);
+}
+
 void Pipeline::Deferred::GeometryPass::PixelShader::Bind::GBuffers(ID3D11RenderTargetView* normal, ID3D11RenderTargetView* ambient, ID3D11RenderTargetView* diffuse, ID3D11RenderTargetView* specular, ID3D11DepthStencilView* dsView)
 {
 	ID3D11RenderTargetView* RTVs[4] = { normal, ambient, diffuse, specular };
@@ -328,9 +449,15 @@ void Pipeline::Deferred::GeometryPass::PixelShader::Bind::GBuffers(ID3D11RenderT
 void Pipeline::Deferred::GeometryPass::PixelShader::Clear::SRVs()
 {
 	ID3D11ShaderResourceView* clear[3] = {nullptr, nullptr, nullptr};
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(0, 3, clear);
 }
 
+UINT64 Pipeline::Deferred::GeometryPass::PixelShader::StateVersion()
+{
+	return PixelState::version;
+}
+
 void Pipeline::Deferred::GeometryPass::PixelShader::Clear::GBuffers()
 {
 	ID3D11RenderTargetView* clear[4] = { nullptr, nullptr, nullptr, nullptr };
@@ -511,13 +638,25 @@ void Pipeline::ResourceManipulation::StageResource(ID3D11Buffer* dstResource, UI
 	Base::immediateContext->CopySubresourceRegion(dstResource, 0, elementSize * dstIndex, 0, 0, stagingResource, 0, nullptr);
 }
 
+void Pipeline::ResourceManipulation::CopySubresource(ID3D11Resource* dstResource, UINT dstSubresource, ID3D11Resource* srcResource, UINT srcSubresource)
+{
+	Base::immediateContext->CopySubresourceRegion(dstResource, dstSubresource, 0, 0, 0, srcResource, srcSubresource, nullptr);
+}
+
 void Pipeline::ResourceManipulation::StageResource(ID3D11Texture2D* dstResource, UINT dstIndex, ID3D11Texture2D* stagingResource)
 {
 	Base::immediateContext->CopySubresourceRegion(dstResource, dstIndex, 0, 0, 0, stagingResource, 0, nullptr);
 }
 
+void Pipeline::ResourceManipulation::UpdateBuffer(ID3D11Buffer* buffer, UINT byteOffset, const void* data, UINT byteCount)
+{
+	D3D11_BOX box = { byteOffset, 0, 0, byteOffset + byteCount, 1, 1 };
+	Base::immediateContext->UpdateSubresource(buffer, 0, &box, data, 0, 0);
+}
+
 void Pipeline::ShadowMapping::ClearPixelShader()
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShader(nullptr, nullptr, 0);
 }
 
@@ -689,6 +828,12 @@ void Pipeline::Particles::Render::Clear::InputAssembler()
 	Base::immediateContext->IASetVertexBuffers(0, 1, clear, &uint, &uint);
 	Base::immediateContext->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
 	Base::immediateContext->IASetInputLayout(nullptr);
+
+	InputAssemblerState::vertexBuffer = nullptr;
+	InputAssemblerState::stride = 0;
+	InputAssemblerState::offset = 0;
+	InputAssemblerState::indexBuffer = nullptr;
+	InputAssemblerState::indexFormat = DXGI_FORMAT_UNKNOWN;
 }
 
 void Pipeline::Particles::Render::Clear::ParticleBuffer()
@@ -734,6 +879,7 @@ void Pipeline::Particles::Render::Bind::GSTransformBuffer(ID3D11Buffer* transfor
 
 void Pipeline::Particles::Render::Bind::PSParticleTexture(ID3D11ShaderResourceView* srv)
 {
+	PixelState::version++;
 	Base::immediateContext->PSSetShaderResources(0, 1, &srv);
 }
 
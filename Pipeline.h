@@ -13,12 +13,32 @@ namespace Pipeline
 	bool GetBackbufferUAV(ID3D11UnorderedAccessView*& backBufferUAV);
 	UINT BackBufferWidth();
 	UINT BackBufferHeight();
-	void DrawIndexed(UINT size, UINT start);
+	//baseVertex is where the vertices of the mesh start in a buffer shared with others
+	void DrawIndexed(UINT size, UINT start, INT baseVertex = 0);
+	//counts as one draw call and instanceCount times the triangles
+	void DrawIndexedInstanced(UINT size, UINT start, UINT instanceCount, INT baseVertex = 0);
 	void Switch();
 
 	void IncrementCounter();
 	UINT FrameCounter();
 
+	//what went through DrawIndexed and DrawIndexedInstanced since the last Reset
+	namespace Statistics
+	{
+		void Reset();
+		UINT DrawCalls();
+		UINT64 Triangles();
+
+		//a bind sets the pixel shader, maps and parameters of a material, a change selects another material. Without the material table both are the same
+		void CountMaterialBind();
+		void CountMaterialChange();
+		UINT MaterialBinds();
+		UINT MaterialChanges();
+
+		//vertex and index buffer binds that reached the input assembler, binding the buffers that are already bound is skipped
+		UINT BufferBinds();
+	}
+
 	namespace Deferred
 	{
 		namespace GeometryPass
@@ -37,11 +57,13 @@ namespace Pipeline
 					void PrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology);
 
 					void VertexBuffer(UINT stride, UINT offset, ID3D11Buffer* vBuffer);
-					void IndexBuffer(ID3D11Buffer* iBuffer);
+					void IndexBuffer(ID3D11Buffer* iBuffer, DXGI_FORMAT format = DXGI_FORMAT_R32_UINT);
 
 					void cameraViewBuffer(ID3D11Buffer* cameraViewBuffer);
 					void cameraProjectionBuffer(ID3D11Buffer* cameraProjectionBuffer);
 					void ObjectTransform(ID3D11Buffer* transformBuffer);
+					void MeshDecode(ID3D11Buffer* decodeBuffer);
+					void InstanceTransforms(ID3D11ShaderResourceView* transformSRV);
 				}
 			}
 
@@ -58,6 +80,9 @@ namespace Pipeline
 					void SpecularMap(ID3D11ShaderResourceView* SRV);
 					void Reflectionmap(ID3D11ShaderResourceView* SRV);
 
+					//table at t0, the texture arrays from t1 on
+					void MaterialTable(ID3D11ShaderResourceView* tableSRV, ID3D11ShaderResourceView* const* arraySRVs, UINT arrayCount);
+
 					void GBuffers(ID3D11RenderTargetView* normal, ID3D11RenderTargetView* ambient, ID3D11RenderTargetView* diffuse, ID3D11RenderTargetView* specular, ID3D11DepthStencilView* dsView);
 				}
 
@@ -66,6 +91,9 @@ namespace Pipeline
 					void SRVs();
 					void GBuffers();
 				}
+
+				//changes whenever the pixel shader, its constant buffers or its resources are set
+				UINT64 StateVersion();
 			}
 
 			namespace HullShader
@@ -180,6 +208,10 @@ namespace Pipeline
 		void MapStagingBuffer(ID3D11Buffer* buffer, D3D11_MAPPED_SUBRESOURCE* mappedResource);
 		void StageResource(ID3D11Buffer* dstResource, UINT dstIndex, UINT elementSize, ID3D11Buffer* stagingResource);
 		void StageResource(ID3D11Texture2D* dstResource, UINT dstIndex, ID3D11Texture2D* stagingResource);
+		void CopySubresource(ID3D11Resource* dstResource, UINT dstSubresource, ID3D11Resource* srcResource, UINT srcSubresource);
+
+		//byteCount bytes from data into a default usage buffer, starting at byteOffset
+		void UpdateBuffer(ID3D11Buffer* buffer, UINT byteOffset, const void* data, UINT byteCount);
 	}
 
 	namespace Particles
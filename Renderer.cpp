@@ -25,7 +25,10 @@ void DepthRenderer::CameraDepthRender(ID3D11DepthStencilView* dsv, Camera* view)
 
 	for (Object* object : *dynamicObjects)
 	{
-		object->DepthRender();
+		if (!batcher.Add(object))
+		{
+			object->DepthRender();
+		}
 	}
 
 	DirectX::BoundingFrustum viewFrustum;
@@ -34,8 +37,12 @@ void DepthRenderer::CameraDepthRender(ID3D11DepthStencilView* dsv, Camera* view)
 	(*staticObjects)->GetContainedInFrustum(&viewFrustum, containedStaticObjects);
 	for (Object* object : containedStaticObjects)
 	{
-		object->DepthRender();
+		if (!batcher.Add(object))
+		{
+			object->DepthRender();
+		}
 	}
+	batcher.DepthRender();
 
 	Pipeline::ShadowMapping::UnbindDepthStencil();
 }
@@ -127,7 +134,10 @@ void OmniDistanceRenderer::CameraDistanceRender(ID3D11RenderTargetView* rtv, Cam
 
 	for (Object* object : *dynamicObjects)
 	{
-		object->DepthRender();
+		if (!batcher.Add(object))
+		{
+			object->DepthRender();
+		}
 	}
 
 	DirectX::BoundingFrustum viewFrustum;
@@ -136,8 +146,12 @@ void OmniDistanceRenderer::CameraDistanceRender(ID3D11RenderTargetView* rtv, Cam
 	(*staticObjects)->GetContainedInFrustum(&viewFrustum, containedStaticObjects);
 	for (Object* object : containedStaticObjects)
 	{
-		object->DepthRender();
+		if (!batcher.Add(object))
+		{
+			object->DepthRender();
+		}
 	}
+	batcher.DepthRender();
 
 	Pipeline::ShadowMapping::UnbindDistanceBuffer();
 }
@@ -190,7 +204,10 @@ void DeferredRenderer::CameraDeferredRender(Camera* renderView, ID3D11UnorderedA
 
 	for (Object* object : *dynamicObjects)
 	{
-		object->Render();
+		if (!batcher.Add(object))
+		{
+			object->Render();
+		}
 	}
 
 	DirectX::BoundingFrustum viewFrustum;
@@ -199,8 +216,12 @@ void DeferredRenderer::CameraDeferredRender(Camera* renderView, ID3D11UnorderedA
 	(*staticObjects)->GetContainedInFrustum(&viewFrustum, containedStaticObjects);
 	for (Object* object : containedStaticObjects)
 	{
-		object->Render();
+		if (!batcher.Add(object))
+		{
+			object->Render();
+		}
 	}
+	batcher.Render();
 
 	for (ParticleSystem* partSys : *particles)
 	{
@@ -12,6 +12,7 @@
 #include "Lights.h"
 #include "QuadTree.h"
 #include "ParticleSystems.h"
+#include "InstanceBatcher.h"
 
 class DepthRenderer
 {
@@ -23,6 +24,8 @@ public:
 private:
 	std::vector<Object*>* dynamicObjects;
 	QuadTree** staticObjects;
+
+	InstanceBatcher batcher;
 };
 
 class OmniDistanceRenderer
@@ -44,6 +47,8 @@ private:
 	std::vector<Object*>* dynamicObjects;
 	QuadTree** staticObjects;
 
+	InstanceBatcher batcher;
+
 	void CameraDistanceRender(ID3D11RenderTargetView* rtv, Camera* view);
 };
 
@@ -72,6 +77,8 @@ class DeferredRenderer
 
 		QuadTree** staticObjects;
 
+		InstanceBatcher batcher;
+
 		ID3D11Texture2D* dsTexture;
 		ID3D11DepthStencilView* dsView;
 		ID3D11ShaderResourceView* depthSRV;
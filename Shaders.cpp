@@ -1,43 +1,69 @@
 #include "Shaders.h"
-#include <fstream>
 #include <iostream>
 
 #include "Pipeline.h"
+#include "AssetPack.h"
+#include "MeshData.h"
 
-VShader::VShader(const std::string shaderPath) : inputLayout(nullptr), vShader(nullptr)
+namespace
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	std::vector<D3D11_INPUT_ELEMENT_DESC> LayoutElements(VertexLayout layout)
 	{
-		std::cerr << "Could not open vertex shader file!" << std::endl;
-		return;
+		switch (layout)
+		{
+		case VertexLayout::Compact:
+			//unorm positions, octahedral normals and half float uvs, see CompactVertex
+			return
+			{
+				{"POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+				{"NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0},
+				{"UV", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0}
+			};
+		case VertexLayout::Untextured:
+			return InputElements<UntexturedVertex>();
+		case VertexLayout::Position:
+			return InputElements<PositionVertex>();
+		default:
+			return InputElements<Vertex>();
+		}
 	}
+}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
+DXGI_FORMAT FloatFormat(unsigned int components)
+{
+	switch (components)
+	{
+	case 1:
+		return DXGI_FORMAT_R32_FLOAT;
+	case 2:
+		return DXGI_FORMAT_R32G32_FLOAT;
+	case 3:
+		return DXGI_FORMAT_R32G32B32_FLOAT;
+	default:
+		return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	}
+}
 
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
+VShader::VShader(const std::string shaderPath, VertexLayout layout) : VShader(shaderPath, LayoutElements(layout))
+{
+}
 
-	if (FAILED(Pipeline::Device()->CreateVertexShader(shaderData.c_str(), shaderData.length(), nullptr, &vShader)))
+VShader::VShader(const std::string shaderPath, const std::vector<D3D11_INPUT_ELEMENT_DESC>& inputElements) : inputLayout(nullptr), vShader(nullptr)
+{
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
-		std::cerr << "Failed to create vertex shader!" << std::endl;
+		std::cerr << "Could not open vertex shader file!" << std::endl;
 		return;
 	}
 
-
-
-	D3D11_INPUT_ELEMENT_DESC inputDesc[3] =
+	if (FAILED(Pipeline::Device()->CreateVertexShader(shaderData.Data(), shaderData.Size(), nullptr, &vShader)))
 	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"UV", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0}
-	};
+		std::cerr << "Failed to create vertex shader!" << std::endl;
+		return;
+	}
 
-	if (FAILED(Pipeline::Device()->CreateInputLayout(inputDesc, 3, shaderData.c_str(), shaderData.length(), &inputLayout)))
+	if (FAILED(Pipeline::Device()->CreateInputLayout(inputElements.data(), static_cast<UINT>(inputElements.size()), shaderData.Data(), shaderData.Size(), &inputLayout)))
 	{
 		std::cerr << "failed to set up input layout!" << std::endl;
 	}
@@ -45,8 +71,15 @@ VShader::VShader(const std::string shaderPath) : inputLayout(nullptr), vShader(n
 
 VShader::~VShader()
 {
-	inputLayout->Release();
-	vShader->Release();
+	//both stay null when the shader file could not be loaded
+	if (inputLayout != nullptr)
+	{
+		inputLayout->Release();
+	}
+	if (vShader != nullptr)
+	{
+		vShader->Release();
+	}
 }
 
 void VShader::Bind()
@@ -57,25 +90,14 @@ void VShader::Bind()
 
 PShader::PShader(const std::string shaderPath) : pShader(nullptr)
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	shaderData.clear();
-	reader.close();
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
 		std::cerr << "Could not open pixel shader file!" << std::endl;
 		return;
 	}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
-
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
-
-	if (FAILED(Pipeline::Device()->CreatePixelShader(shaderData.c_str(), shaderData.length(), nullptr, &pShader)))
+	if (FAILED(Pipeline::Device()->CreatePixelShader(shaderData.Data(), shaderData.Size(), nullptr, &pShader)))
 	{
 		std::cerr << "Failed to create pixel shader!" << std::endl;
 	}
@@ -83,7 +105,10 @@ PShader::PShader(const std::string shaderPath) : pShader(nullptr)
 
 PShader::~PShader()
 {
-	pShader->Release();
+	if (pShader != nullptr)
+	{
+		pShader->Release();
+	}
 }
 
 void PShader::Bind()
@@ -93,25 +118,14 @@ void PShader::Bind()
 
 CShader::CShader(const std::string shaderPath) : cShader(nullptr)
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	shaderData.clear();
-	reader.close();
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
 		std::cerr << "Could not open compute shader file!" << std::endl;
 		return;
 	}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
-
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
-
-	if (FAILED(Pipeline::Device()->CreateComputeShader(shaderData.c_str(), shaderData.length(), nullptr, &cShader)))
+	if (FAILED(Pipeline::Device()->CreateComputeShader(shaderData.Data(), shaderData.Size(), nullptr, &cShader)))
 	{
 		std::cerr << "Failed to create compute shader!" << std::endl;
 	}
@@ -129,25 +143,14 @@ void CShader::Bind()
 
 HShader::HShader(const std::string shaderPath)
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	shaderData.clear();
-	reader.close();
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
 		std::cerr << "Could not open hull shader file!" << std::endl;
 		return;
 	}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
-
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
-
-	if (FAILED(Pipeline::Device()->CreateHullShader(shaderData.c_str(), shaderData.length(), nullptr, &hShader)))
+	if (FAILED(Pipeline::Device()->CreateHullShader(shaderData.Data(), shaderData.Size(), nullptr, &hShader)))
 	{
 		std::cerr << "Failed to create hull shader!" << std::endl;
 	}
@@ -165,25 +168,14 @@ void HShader::Bind()
 
 DShader::DShader(const std::string shaderPath)
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	shaderData.clear();
-	reader.close();
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
 		std::cerr << "Could not open domain shader file!" << std::endl;
 		return;
 	}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
-
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
-
-	if (FAILED(Pipeline::Device()->CreateDomainShader(shaderData.c_str(), shaderData.length(), nullptr, &dShader)))
+	if (FAILED(Pipeline::Device()->CreateDomainShader(shaderData.Data(), shaderData.Size(), nullptr, &dShader)))
 	{
 		std::cerr << "Failed to create domain shader!" << std::endl;
 	}
@@ -211,25 +203,14 @@ void IndirectVShader::Bind()
 
 GShader::GShader(const std::string shaderPath)
 {
-	std::string shaderData;
-	std::ifstream reader;
-
-	shaderData.clear();
-	reader.close();
-	reader.open(shaderPath, std::ios::binary | std::ios::ate);
-	if (!reader.is_open())
+	Asset shaderData;
+	if (!AssetPack::Open(shaderPath, shaderData))
 	{
 		std::cerr << "Could not open geometry shader file!" << std::endl;
 		return;
 	}
 
-	reader.seekg(0, std::ios::end);
-	shaderData.reserve(static_cast<unsigned int>(reader.tellg()));
-	reader.seekg(0, std::ios::beg);
-
-	shaderData.assign(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
-
-	if (FAILED(Pipeline::Device()->CreateGeometryShader(shaderData.c_str(), shaderData.length(), nullptr, &gShader)))
+	if (FAILED(Pipeline::Device()->CreateGeometryShader(shaderData.Data(), shaderData.Size(), nullptr, &gShader)))
 	{
 		std::cerr << "Failed to create geometry shader!" << std::endl;
 	}
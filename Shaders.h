@@ -1,11 +1,38 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <d3d11.h>
 
+#include "VertexFormat.h"
+
+//which vertex struct the input layout describes
+enum class VertexLayout
+{
+	Standard,	//Vertex
+	Compact,	//CompactVertex
+	Untextured,	//UntexturedVertex
+	Position	//PositionVertex
+};
+
+DXGI_FORMAT FloatFormat(unsigned int components);
+
+//the input layout of a VertexOf format, generated from its attribute list
+template<typename Format>
+std::vector<D3D11_INPUT_ELEMENT_DESC> InputElements()
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> elements;
+	for (const VertexAttributeInfo& attribute : Format::Layout)
+	{
+		elements.push_back({ attribute.semantic, 0, FloatFormat(attribute.components), 0, attribute.offset, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+	}
+	return elements;
+}
+
 class VShader
 {
 	public :
-		VShader(const std::string shaderPath);
+		VShader(const std::string shaderPath, VertexLayout layout = VertexLayout::Standard);
+		VShader(const std::string shaderPath, const std::vector<D3D11_INPUT_ELEMENT_DESC>& inputElements);
 		~VShader();
 
 		virtual void Bind();
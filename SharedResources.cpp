@@ -2,9 +2,10 @@
 
 #include <d3d11.h>
 #include <iostream>
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include <filesystem>
+#include <algorithm>
 #include "Pipeline.h"
+#include "ThreadPool.h"
 
 namespace Static
 {
@@ -20,6 +21,10 @@ namespace Static
 
 	static Materials* materials = nullptr;
 	static Textures* textures = nullptr;
+	static Meshes* meshes = nullptr;
+
+	//nullptr once released, meshes of objects that outlive SharedResources then have nothing left to return their ranges to
+	static MeshArenaBuffers* meshArena = nullptr;
 }
 
 Materials::Materials()
@@ -50,11 +55,13 @@ int Materials::AddMaterial(MaterialData& material)
 	{
 		TexturedMaterial* texMat = new TexturedMaterial(material);
 		container.push_back(texMat);
+		table.Add(material, texMat->AmbientMap(), texMat->DiffuseMap(), texMat->SpecularMap());
 	}
 	else
 	{
 		ParameterMaterial* paramMat = new ParameterMaterial(material);
 		container.push_back(paramMat);
+		table.Add(material, 0, 0, 0);
 	}
 
 	materialMap[material.name] = container.size() - 1;
@@ -66,6 +73,15 @@ bool Materials::Contains(const std::string materialName)
 	return materialMap.count(materialName) > 0;
 }
 
+bool Materials::Textured(int materialID)
+{
+	if ((materialID < 0) || (materialID >= static_cast<int>(container.size())))
+	{
+		return false;
+	}
+	return dynamic_cast<TexturedMaterial*>(container[materialID]) != nullptr;
+}
+
 int Materials::GetID(const std::string materialName)
 {
 	if (!Contains(materialName))
@@ -77,9 +93,26 @@ int Materials::GetID(const std::string materialName)
 
 void Materials::Bind(int materialID)
 {
+	Pipeline::Statistics::CountMaterialChange();
+
+	if (MATERIAL_TABLE && table.Contains(materialID, *Static::textures))
+	{
+		table.Bind(materialID, *Static::textures);
+		return;
+	}
+
+	Pipeline::Statistics::CountMaterialBind();
 	container[materialID]->Bind();
 }
 
+void Materials::Update()
+{
+	if (MATERIAL_TABLE)
+	{
+		table.Update(*Static::textures);
+	}
+}
+
 Textures::Textures()
 {
 	if (AddTexture("") != 0)
@@ -101,37 +134,39 @@ Textures::~Textures()
 	}
 }
 
-int Textures::AddTexture(const std::string& texturePath)
+int Textures::AddTexture(const std::string& texturePath, bool compress)
 {
 	if (textureMap.count(texturePath) > 0)
 	{
 		return textureMap[texturePath];
 	}
 
-	int x, y, n;
-	unsigned char* image;
-
-	if (texturePath == "")
+	TextureImage image;
+	if (!Decode(texturePath, image, compress))
 	{
-		image = stbi_load("textures/missingTexture.png", &x, &y, &n, 0);
-	}
-	else
-	{
-		image = stbi_load(texturePath.c_str(), &x, &y, &n, 0);
+		return 0;
 	}
 
-	if (image == NULL)
+	return AddTexture(texturePath, image);
+}
+
+int Textures::AddTexture(const std::string& texturePath, TextureImage& image)
+{
+	if (textureMap.count(texturePath) > 0)
 	{
-		return 0;
+		image.texture = TextureCache::CookedTexture();
+		return textureMap[texturePath];
 	}
 
+	const TextureCache::CookedTexture& cooked = image.texture;
+
 	ID3D11Texture2D* texture;
 
 	D3D11_TEXTURE2D_DESC textureDesc;
 
-	textureDesc.Width = x;
-	textureDesc.Height = y;
-	textureDesc.MipLevels = 1;
+	textureDesc.Width = cooked.levels[0].width;
+	textureDesc.Height = cooked.levels[0].height;
+	textureDesc.MipLevels = static_cast<UINT>(cooked.levels.size());
 	textureDesc.ArraySize = 1;
 	textureDesc.SampleDesc.Count = 1;
 	textureDesc.SampleDesc.Quality = 0;
@@ -139,44 +174,116 @@ int Textures::AddTexture(const std::string& texturePath)
 	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 	textureDesc.CPUAccessFlags = 0;
 	textureDesc.MiscFlags = 0;
-	switch (n)
+	switch (cooked.format)
 	{
-	case 1:
+	case TextureCache::Format::A8:
 		textureDesc.Format = DXGI_FORMAT_A8_UNORM;
 		break;
 
-	case 2:
+	case TextureCache::Format::R8G8:
 		textureDesc.Format = DXGI_FORMAT_R8G8_UNORM;
 		break;
 
-	case 4:
+	case TextureCache::Format::R8G8B8A8:
 		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 		break;
 
+	case TextureCache::Format::BC1:
+		textureDesc.Format = DXGI_FORMAT_BC1_UNORM;
+		break;
+
+	case TextureCache::Format::BC4:
+		textureDesc.Format = DXGI_FORMAT_BC4_UNORM;
+		break;
+
+	case TextureCache::Format::BC5:
+		textureDesc.Format = DXGI_FORMAT_BC5_UNORM;
+		break;
+
+	case TextureCache::Format::BC7:
+		textureDesc.Format = DXGI_FORMAT_BC7_UNORM;
+		break;
+
 	default:
 		std::cerr << "unsupported texture format" << std::endl;
-		stbi_image_free(image);
+		image.texture = TextureCache::CookedTexture();
 		return 0;
 	}
 
-	D3D11_SUBRESOURCE_DATA data;
-
-	data.pSysMem = image;
-	data.SysMemPitch = n * x;
-	data.SysMemSlicePitch = 0;
+	//the levels are already laid out as the device wants them, straight from the mapped file when the texture was cooked before
+	std::vector<D3D11_SUBRESOURCE_DATA> data(textureDesc.MipLevels);
+	for (size_t i = 0; i < cooked.levels.size(); i++)
+	{
+		data[i].pSysMem = cooked.LevelData(i);
+		data[i].SysMemPitch = cooked.levels[i].rowPitch;
+		data[i].SysMemSlicePitch = 0;
+	}
 
-	HRESULT hr = Pipeline::Device()->CreateTexture2D(&textureDesc, &data, &texture);
-	stbi_image_free(image);
+	HRESULT hr = Pipeline::Device()->CreateTexture2D(&textureDesc, data.data(), &texture);
+	image.texture = TextureCache::CookedTexture();
 
 	if (!FAILED(hr))
 	{
 		textures.push_back(texture);
+		singleChannel.push_back(textureDesc.Format == DXGI_FORMAT_BC4_UNORM);
 		textureMap[texturePath] = textures.size() - 1;
 		return textures.size() - 1;
 	}
 	return 0;
 }
 
+bool Textures::Decode(const std::string& texturePath, TextureImage& image, bool compress)
+{
+	if (texturePath == "")
+	{
+		return TextureCache::Load("textures/missingTexture.png", compress, image.texture);
+	}
+	return TextureCache::Load(texturePath, compress, image.texture);
+}
+
+std::vector<std::string> Textures::Missing(const std::vector<std::string>& texturePaths)
+{
+	std::vector<std::string> missing;
+	for (const std::string& texturePath : texturePaths)
+	{
+		if ((textureMap.count(texturePath) == 0) && (std::find(missing.begin(), missing.end(), texturePath) == missing.end()))
+		{
+			missing.push_back(texturePath);
+		}
+	}
+	return missing;
+}
+
+void Textures::AddTextures(const std::vector<std::string>& texturePaths, bool compress)
+{
+	std::vector<std::string> missing = Missing(texturePaths);
+
+	std::vector<TextureImage> images;
+	DecodeAll(missing, images, compress);
+	AddTextures(missing, images);
+}
+
+void Textures::AddTextures(const std::vector<std::string>& texturePaths, std::vector<TextureImage>& images)
+{
+	for (size_t i = 0; i < texturePaths.size(); i++)
+	{
+		if (images[i].Decoded())
+		{
+			AddTexture(texturePaths[i], images[i]);
+		}
+	}
+}
+
+void Textures::DecodeAll(const std::vector<std::string>& texturePaths, std::vector<TextureImage>& images, bool compress)
+{
+	images.assign(texturePaths.size(), TextureImage());
+
+	ThreadPool::Shared().ParallelFor(texturePaths.size(), [&texturePaths, &images, compress](size_t i)
+	{
+		Decode(texturePaths[i], images[i], compress);
+	});
+}
+
 ID3D11ShaderResourceView* Textures::GetSRV(int textureID)
 {
 	if (SRVs.count(textureID) <= 0)
@@ -193,6 +300,135 @@ ID3D11ShaderResourceView* Textures::GetSRV(int textureID)
 	return SRVs[textureID];
 }
 
+ID3D11Texture2D* Textures::GetTexture(int textureID)
+{
+	return textures[textureID];
+}
+
+bool Textures::SingleChannel(int textureID)
+{
+	return singleChannel[textureID];
+}
+
+MeshResource::~MeshResource()
+{
+	if (inArena)
+	{
+		SharedResources::ReleaseFromArena(*this);
+	}
+	else
+	{
+		if (vertexBuffer != nullptr)
+		{
+			vertexBuffer->Release();
+		}
+
+		if (indexBuffer != nullptr)
+		{
+			indexBuffer->Release();
+		}
+
+		if (positionBuffer != nullptr)
+		{
+			positionBuffer->Release();
+		}
+	}
+
+	if (meshDecodeBuffer != nullptr)
+	{
+		meshDecodeBuffer->Release();
+	}
+}
+
+MeshArenaBuffers::~MeshArenaBuffers()
+{
+	for (std::pair<const std::pair<UINT, UINT>, Pool>& pool : pools)
+	{
+		for (ID3D11Buffer* buffer : pool.second.buffers)
+		{
+			buffer->Release();
+		}
+	}
+}
+
+bool MeshArenaBuffers::Add(UINT bindFlags, UINT elementSize, const void* data, size_t count, MeshArenaRange& range, ID3D11Buffer*& buffer)
+{
+	std::pair<UINT, UINT> key(bindFlags, elementSize);
+	std::map<std::pair<UINT, UINT>, Pool>::iterator found = pools.find(key);
+	if (found == pools.end())
+	{
+		found = pools.emplace(key, Pool{ MeshArena::Stream(MESH_ARENA_BUFFER_BYTES / elementSize), {} }).first;
+	}
+	Pool& pool = found->second;
+
+	range.bindFlags = bindFlags;
+	range.elementSize = elementSize;
+
+	if (!pool.stream.Allocate(count, range.range))
+	{
+		size_t capacity = pool.stream.NextBlockCapacity(count);
+
+		D3D11_BUFFER_DESC bufferDesc;
+		bufferDesc.ByteWidth = static_cast<UINT>(capacity * elementSize);
+		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags = bindFlags;
+		bufferDesc.CPUAccessFlags = 0;
+		bufferDesc.MiscFlags = 0;
+		bufferDesc.StructureByteStride = 0;
+
+		ID3D11Buffer* newBuffer = nullptr;
+		if (FAILED(Pipeline::Device()->CreateBuffer(&bufferDesc, nullptr, &newBuffer)))
+		{
+			std::cerr << "Failed to create mesh arena buffer!" << std::endl;
+			return false;
+		}
+
+		pool.buffers.push_back(newBuffer);
+		pool.stream.AddBlock(capacity);
+
+		if (!pool.stream.Allocate(count, range.range))
+		{
+			return false;
+		}
+	}
+
+	buffer = pool.buffers[range.range.block];
+	Pipeline::ResourceManipulation::UpdateBuffer(buffer, static_cast<UINT>(range.range.offset * elementSize), data, static_cast<UINT>(count * elementSize));
+	return true;
+}
+
+void MeshArenaBuffers::Free(const MeshArenaRange& range)
+{
+	std::map<std::pair<UINT, UINT>, Pool>::iterator found = pools.find(std::make_pair(range.bindFlags, range.elementSize));
+	if (found != pools.end())
+	{
+		found->second.stream.Free(range.range);
+	}
+}
+
+MeshArena::Report MeshArenaBuffers::Report() const
+{
+	MeshArena::Report report;
+	for (const std::pair<const std::pair<UINT, UINT>, Pool>& pool : pools)
+	{
+		pool.second.stream.Describe(pool.first.second, report);
+	}
+	return report;
+}
+
+std::shared_ptr<MeshResource> Meshes::GetMesh(const std::string& key, bool& created)
+{
+	std::shared_ptr<MeshResource> mesh = meshMap[key].lock();
+	created = (mesh == nullptr);
+
+	if (created)
+	{
+		mesh = std::make_shared<MeshResource>();
+		meshMap[key] = mesh;
+	}
+	return mesh;
+}
+
 BaseMaterial::~BaseMaterial()
 {
 	materialBuffer->Release();
@@ -200,11 +436,14 @@ BaseMaterial::~BaseMaterial()
 
 TexturedMaterial::TexturedMaterial(MaterialData& matData)
 {
-	map_Ka = Static::textures->AddTexture(matData.map_Ka);
-	map_Ks = Static::textures->AddTexture(matData.map_Ks);
-	map_Kd = Static::textures->AddTexture(matData.map_Kd);
+	map_Ka = Static::textures->AddTexture(matData.map_Ka, MATERIAL_TEXTURE_COMPRESSION);
+	map_Ks = Static::textures->AddTexture(matData.map_Ks, MATERIAL_TEXTURE_COMPRESSION);
+	map_Kd = Static::textures->AddTexture(matData.map_Kd, MATERIAL_TEXTURE_COMPRESSION);
 
 	MatBufTex parameters = MatBufTex(matData.Ns);
+	parameters.ambientSingleChannel = Static::textures->SingleChannel(map_Ka) ? 1.0f : 0.0f;
+	parameters.diffuseSingleChannel = Static::textures->SingleChannel(map_Kd) ? 1.0f : 0.0f;
+	parameters.specularSingleChannel = Static::textures->SingleChannel(map_Ks) ? 1.0f : 0.0f;
 
 	D3D11_BUFFER_DESC bufferDesc;
 
@@ -237,6 +476,21 @@ void TexturedMaterial::Bind()
 	Pipeline::Deferred::GeometryPass::PixelShader::Bind::MaterialParameters(materialBuffer);
 }
 
+int TexturedMaterial::AmbientMap() const
+{
+	return map_Ka;
+}
+
+int TexturedMaterial::DiffuseMap() const
+{
+	return map_Kd;
+}
+
+int TexturedMaterial::SpecularMap() const
+{
+	return map_Ks;
+}
+
 ParameterMaterial::ParameterMaterial(MaterialData& matData)
 {
 	MatBufParam parameters = MatBufParam(matData.Ns, { matData.Ka[0], matData.Ka[1], matData.Ka[2] }, { matData.Kd[0], matData.Kd[1], matData.Kd[2] }, { matData.Ks[0], matData.Ks[1], matData.Ks[2] });
@@ -280,6 +534,20 @@ void SharedResources::Setup()
 
 	Static::Shaders::Vertex.push_back(new IndirectVShader("VSParticlePoints.cso"));
 
+	Static::Shaders::Vertex.push_back(new VShader("VSMeshGeometryPassCompact.cso", VertexLayout::Compact));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSMeshGeometryPassInstanced.cso"));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSMeshGeometryPassCompactInstanced.cso", VertexLayout::Compact));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSMeshGeometryPassUntextured.cso", VertexLayout::Untextured));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSMeshGeometryPassUntexturedInstanced.cso", VertexLayout::Untextured));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSDepthPass.cso", VertexLayout::Position));
+
+	Static::Shaders::Vertex.push_back(new VShader("VSDepthPassInstanced.cso", VertexLayout::Position));
+
 	Static::Shaders::Hull.push_back(new HShader("HSMeshGeometryPass.cso"));
 
 	Static::Shaders::Domain.push_back(new DShader("DSMeshGeometryPass.cso"));
@@ -294,6 +562,8 @@ void SharedResources::Setup()
 
 	Static::Shaders::Pixel.push_back(new PShader("PSGalaxyParticles.cso"));
 
+	Static::Shaders::Pixel.push_back(new PShader("PSMaterialTableGeometryPass.cso"));
+
 	Static::Shaders::Compute.push_back(new CShader("CSLightPass32x32.cso"));
 
 	Static::Shaders::Compute.push_back(new CShader("CSColorPass32x32.cso"));
@@ -308,6 +578,8 @@ void SharedResources::Setup()
 
 	Static::materials = new Materials();
 	Static::textures = new Textures();
+	Static::meshes = new Meshes();
+	Static::meshArena = new MeshArenaBuffers();
 }
 
 void SharedResources::Release()
@@ -339,6 +611,10 @@ void SharedResources::Release()
 
 	delete Static::materials;
 	delete Static::textures;
+	delete Static::meshes;
+
+	delete Static::meshArena;
+	Static::meshArena = nullptr;
 }
 
 bool SharedResources::MaterialExists(const std::string materialName)
@@ -361,11 +637,139 @@ void SharedResources::BindMaterial(int materialID)
 	Static::materials->Bind(materialID);
 }
 
+bool SharedResources::MaterialTextured(int materialID)
+{
+	return Static::materials->Textured(materialID);
+}
+
+void SharedResources::UpdateMaterials()
+{
+	Static::materials->Update();
+}
+
 int SharedResources::GetTexture(const std::string texturePath)
 {
 	return Static::textures->AddTexture(texturePath);
 }
 
+void SharedResources::LoadTextures(const std::vector<std::string>& texturePaths)
+{
+	Static::textures->AddTextures(texturePaths, MATERIAL_TEXTURE_COMPRESSION);
+}
+
+AsyncLoading::Task<void> SharedResources::LoadTexturesAsync(const std::vector<std::string> texturePaths)
+{
+	std::vector<std::string> missing = Static::textures->Missing(texturePaths);
+	if (missing.empty())
+	{
+		co_return;
+	}
+
+	co_await AsyncLoading::ToWorker();
+
+	std::vector<TextureImage> images;
+	Textures::DecodeAll(missing, images, MATERIAL_TEXTURE_COMPRESSION);
+
+	co_await AsyncLoading::ToMainThread();
+
+	//another load may have added some of them in the meantime, AddTexture drops those copies
+	Static::textures->AddTextures(missing, images);
+}
+
+std::shared_ptr<MeshResource> SharedResources::GetMesh(const std::string OBJFilepath, UINT buildFlags, bool& created)
+{
+	std::error_code error;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(OBJFilepath, error);
+
+	std::string key = (error ? OBJFilepath : canonicalPath.string()) + "|" + std::to_string(buildFlags);
+	return Static::meshes->GetMesh(key, created);
+}
+
+bool SharedResources::PlaceInArena(MeshResource& resource, const void* vertices, const PositionVertex* positions, size_t vertexCount, const void* indices, UINT indexSize, size_t indexCount)
+{
+	MeshArenaBuffers& arena = *Static::meshArena;
+
+	MeshArenaRange vertexRange;
+	MeshArenaRange positionRange;
+	MeshArenaRange indexRange;
+	ID3D11Buffer* vertexBuffer = nullptr;
+	ID3D11Buffer* positionBuffer = nullptr;
+	ID3D11Buffer* indexBuffer = nullptr;
+
+	if (!arena.Add(D3D11_BIND_VERTEX_BUFFER, resource.vertexStride, vertices, vertexCount, vertexRange, vertexBuffer))
+	{
+		return false;
+	}
+
+	if (!arena.Add(D3D11_BIND_VERTEX_BUFFER, sizeof(PositionVertex), positions, vertexCount, positionRange, positionBuffer))
+	{
+		arena.Free(vertexRange);
+		return false;
+	}
+
+	if (!arena.Add(D3D11_BIND_INDEX_BUFFER, indexSize, indices, indexCount, indexRange, indexBuffer))
+	{
+		arena.Free(vertexRange);
+		arena.Free(positionRange);
+		return false;
+	}
+
+	resource.vertexBuffer = vertexBuffer;
+	resource.positionBuffer = positionBuffer;
+	resource.indexBuffer = indexBuffer;
+	resource.vertexRange = vertexRange;
+	resource.positionRange = positionRange;
+	resource.indexRange = indexRange;
+	resource.inArena = true;
+
+	int baseVertex = static_cast<int>(vertexRange.range.offset);
+	int startIndex = static_cast<int>(indexRange.range.offset);
+	resource.positionBaseVertex = static_cast<int>(positionRange.range.offset);
+
+	for (Submesh& submesh : resource.submeshes)
+	{
+		submesh.Start += startIndex;
+		submesh.baseVertex = baseVertex;
+	}
+
+	for (MeshLOD& lod : resource.lods)
+	{
+		for (Submesh& submesh : lod.submeshes)
+		{
+			submesh.Start += startIndex;
+			submesh.baseVertex = baseVertex;
+		}
+	}
+
+	for (Meshlet& meshlet : resource.meshlets)
+	{
+		meshlet.indexStart += startIndex;
+	}
+
+	return true;
+}
+
+void SharedResources::ReleaseFromArena(MeshResource& resource)
+{
+	if (Static::meshArena == nullptr)
+	{
+		return;
+	}
+
+	Static::meshArena->Free(resource.vertexRange);
+	Static::meshArena->Free(resource.positionRange);
+	Static::meshArena->Free(resource.indexRange);
+}
+
+MeshArena::Report SharedResources::MeshArenaReport()
+{
+	if (Static::meshArena == nullptr)
+	{
+		return MeshArena::Report();
+	}
+	return Static::meshArena->Report();
+}
+
 ID3D11ShaderResourceView* SharedResources::GetTextureSRV(int textureID)
 {
 	return Static::textures->GetSRV(textureID);
@@ -376,6 +780,23 @@ void SharedResources::BindVertexShader(vShader ID)
 	Static::Shaders::Vertex[ID]->Bind();
 }
 
+void SharedResources::BindMeshVertexShader(const MeshResource& mesh, bool instanced)
+{
+	switch (mesh.vertexLayout)
+	{
+	case VertexLayout::Compact:
+		Pipeline::Deferred::GeometryPass::VertexShader::Bind::MeshDecode(mesh.meshDecodeBuffer);
+		BindVertexShader(instanced ? VSCompactInstanced : VSCompact);
+		break;
+	case VertexLayout::Untextured:
+		BindVertexShader(instanced ? VSUntexturedInstanced : VSUntextured);
+		break;
+	default:
+		BindVertexShader(instanced ? VSInstanced : VSStandard);
+		break;
+	}
+}
+
 void SharedResources::BindPixelShader(pShader ID)
 {
 	Static::Shaders::Pixel[ID]->Bind();
@@ -3,10 +3,22 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <memory>
 #include <d3d11.h>
 #include <array>
 
 #include "Shaders.h"
+#include "MeshData.h"
+#include "TextureCache.h"
+#include "MaterialTable.h"
+#include "AsyncLoading.h"
+#include "MeshArena.h"
+
+//materials are drawn through MaterialTable, false binds the shader, maps and parameters of every material on their own
+#define MATERIAL_TABLE true
+
+//static meshes are suballocated from the shared buffers of MeshArenaBuffers, false gives every mesh a buffer of its own
+#define MESH_ARENA true
 
 struct MaterialData {
 	bool textured = false;
@@ -23,7 +35,11 @@ struct MaterialData {
 struct MatBufTex
 {
 	float Ns = 0;
-	float padding[3] = { 0, 0, 0 };
+
+	//1 when the map is stored as BC4, the shader then spreads its red channel over rgb
+	float ambientSingleChannel = 0;
+	float diffuseSingleChannel = 0;
+	float specularSingleChannel = 0;
 
 	MatBufTex(const float specularExponent)
 	{
@@ -69,6 +85,10 @@ class TexturedMaterial : public BaseMaterial
 
 		virtual void Bind() override;
 
+		int AmbientMap() const;
+		int DiffuseMap() const;
+		int SpecularMap() const;
+
 	private :
 		int map_Ka = 0;
 		int map_Kd = 0;
@@ -94,9 +114,27 @@ class Materials
 		int GetID(const std::string materialName);
 		void Bind(int materialID);
 
+		//uploads the materials added since the last frame to the material table
+		void Update();
+
+		//false for parameter materials, they do not sample the uvs
+		bool Textured(int materialID);
+
 	private :
 		std::map<std::string, int> materialMap;
 		std::vector<BaseMaterial*> container;
+		MaterialTable table;
+};
+
+//a texture in its final format, owned until it is handed to Textures::AddTexture. See TextureCache
+struct TextureImage
+{
+	TextureCache::CookedTexture texture;
+
+	bool Decoded() const
+	{
+		return !texture.levels.empty();
+	}
 };
 
 class Textures
@@ -105,16 +143,132 @@ class Textures
 		Textures();
 		~Textures();
 
-		int AddTexture(const std::string& texturePath);
+		//compress only applies when the texture is not added yet
+		int AddTexture(const std::string& texturePath, bool compress = false);
+
+		//creates the texture from a cooked texture loaded earlier and releases it, also when texturePath was already added
+		int AddTexture(const std::string& texturePath, TextureImage& image);
+
+		//the paths that are not added yet, each once
+		std::vector<std::string> Missing(const std::vector<std::string>& texturePaths);
+
+		//decodes every path that is not added yet on the shared thread pool, then creates all of them
+		void AddTextures(const std::vector<std::string>& texturePaths, bool compress = false);
+
+		//creates the textures decoded by DecodeAll in one go, images that failed to decode are skipped
+		void AddTextures(const std::vector<std::string>& texturePaths, std::vector<TextureImage>& images);
+
+		//maps the cooked file when it is current, otherwise decodes and cooks the image and writes the cooked file. Can run on any thread.
+		//"" decodes the missing texture. With compress the levels are block compressed when the image allows it
+		static bool Decode(const std::string& texturePath, TextureImage& image, bool compress = false);
+
+		//images[i] is texturePaths[i], decoded in parallel on the shared thread pool. Can run on any thread, also on a worker of the pool
+		static void DecodeAll(const std::vector<std::string>& texturePaths, std::vector<TextureImage>& images, bool compress = false);
 
 		ID3D11ShaderResourceView* GetSRV(int textureID);
 
+		ID3D11Texture2D* GetTexture(int textureID);
+
+		//true for BC4 textures, they only sample into red
+		bool SingleChannel(int textureID);
+
 	private :
 		std::map<std::string, int> textureMap;
 		std::vector<ID3D11Texture2D*> textures;
+		std::vector<bool> singleChannel;
 		std::map<int, ID3D11ShaderResourceView*> SRVs;
 };
 
+//where one buffer of a mesh lives in the arena
+struct MeshArenaRange
+{
+	UINT bindFlags = 0;
+	UINT elementSize = 0;
+	MeshArena::Range range;
+};
+
+//GPU side of an imported mesh, immutable once loaded and shared by every STDOBJ made from the same file with the same build flags
+struct MeshResource
+{
+	//owned by the mesh, or by MeshArenaBuffers when inArena
+	ID3D11Buffer* vertexBuffer = nullptr;
+	ID3D11Buffer* indexBuffer = nullptr;
+
+	UINT vertexStride = sizeof(Vertex);
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+
+	//what the vertex buffer holds, picks the vertex shaders it is drawn with
+	VertexLayout vertexLayout = VertexLayout::Standard;
+
+	//PositionVertex of every vertex, separate from vertexBuffer so depth passes fetch 12 bytes a vertex whatever the layout
+	ID3D11Buffer* positionBuffer = nullptr;
+
+	//the base vertex of draws from positionBuffer, the submeshes carry the one of vertexBuffer
+	int positionBaseVertex = 0;
+
+	//the index ranges of submeshes, lods and meshlets then already include where the indices start in the arena buffer
+	bool inArena = false;
+	MeshArenaRange vertexRange;
+	MeshArenaRange positionRange;
+	MeshArenaRange indexRange;
+
+	//only set for the compact vertex layout, holds the bounds the positions are quantized against
+	ID3D11Buffer* meshDecodeBuffer = nullptr;
+
+	std::vector<Submesh> submeshes;
+
+	//coarser versions of submeshes in the same buffers, empty without OBJ_IMPORT_LOD
+	std::vector<MeshLOD> lods;
+
+	//empty without OBJ_IMPORT_MESHLETS
+	std::vector<Meshlet> meshlets;
+
+	Bounds bounds;
+
+	//set on the main thread once the buffers exist
+	bool loaded = false;
+
+	~MeshResource();
+};
+
+//the few large buffers the arena hands out, one set per vertex stride and index size so every mesh of a layout can share them
+class MeshArenaBuffers
+{
+	public:
+		MeshArenaBuffers() = default;
+		~MeshArenaBuffers();
+
+		MeshArenaBuffers(const MeshArenaBuffers&) = delete;
+		MeshArenaBuffers& operator=(const MeshArenaBuffers&) = delete;
+
+		//copies count elements into a free range of a buffer with bindFlags, creating another buffer when none has room
+		bool Add(UINT bindFlags, UINT elementSize, const void* data, size_t count, MeshArenaRange& range, ID3D11Buffer*& buffer);
+		void Free(const MeshArenaRange& range);
+
+		MeshArena::Report Report() const;
+
+	private:
+		struct Pool
+		{
+			MeshArena::Stream stream;
+			std::vector<ID3D11Buffer*> buffers;
+		};
+
+		//by bind flags and element size
+		std::map<std::pair<UINT, UINT>, Pool> pools;
+};
+
+class Meshes
+{
+	public:
+		//the mesh registered under key or a new empty one the caller has to load, created tells which.
+		//only weak references are kept, a mesh is released together with the last object using it
+		std::shared_ptr<MeshResource> GetMesh(const std::string& key, bool& created);
+
+	private:
+		std::map<std::string, std::weak_ptr<MeshResource>> meshMap;
+};
+
 namespace SharedResources
 {
 	void Setup();
@@ -124,8 +278,27 @@ namespace SharedResources
 	int AddMaterial(MaterialData& material);
 	int GetMaterialID(const std::string materialName);
 	void BindMaterial(int materialID);
+	bool MaterialTextured(int materialID);
+
+	//once per frame before rendering, so materials that arrive during a frame do not reach the material table in the middle of it
+	void UpdateMaterials();
 
 	int GetTexture(const std::string texturePath);
+
+	//decodes all textures at once on the thread pool and creates them afterwards, later GetTexture calls for them only look them up.
+	//used before materials are added, so the textures of a whole MTL file or scene do not decode one after another
+	void LoadTextures(const std::vector<std::string>& texturePaths);
+
+	//the same with the decoding on workers and the creation on the main thread, has to be started on the main thread. See AsyncLoading
+	AsyncLoading::Task<void> LoadTexturesAsync(const std::vector<std::string> texturePaths);
+
+	//keyed by the canonical path and the import flags that change what is loaded, so different spellings of one file share it
+	std::shared_ptr<MeshResource> GetMesh(const std::string OBJFilepath, UINT buildFlags, bool& created);
+
+	//uploads the buffers of resource into the arena and moves its submeshes, levels and meshlets to where they were put
+	bool PlaceInArena(MeshResource& resource, const void* vertices, const PositionVertex* positions, size_t vertexCount, const void* indices, UINT indexSize, size_t indexCount);
+	void ReleaseFromArena(MeshResource& resource);
+	MeshArena::Report MeshArenaReport();
 	ID3D11ShaderResourceView* GetTextureSRV(int textureID);
 
 
@@ -134,17 +307,28 @@ namespace SharedResources
 		VSStandard = 0,
 		Tesselation = 1,
 		VSCubemap = 2,
-		VSParticlePoints = 3
+		VSParticlePoints = 3,
+		VSCompact = 4,
+		VSInstanced = 5,
+		VSCompactInstanced = 6,
+		VSUntextured = 7,
+		VSUntexturedInstanced = 8,
+		VSDepth = 9,
+		VSDepthInstanced = 10
 	};
 	void BindVertexShader(vShader ID);
 
+	//the geometry pass vertex shader that reads the layout of mesh, with the decode buffer of a compact one
+	void BindMeshVertexShader(const MeshResource& mesh, bool instanced = false);
+
 	enum pShader
 	{
 		TextureMaterial = 0,
 		ParameterMaterial = 1,
 		DistanceWrite = 2,
 		PSCubemap = 3,
-		PSGalaxyParticles = 4
+		PSGalaxyParticles = 4,
+		PSMaterialTable = 5
 	};
 	void BindPixelShader(pShader ID);
 
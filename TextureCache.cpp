@@ -0,0 +1,359 @@
+#include "TextureCache.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <thread>
+#include <climits>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "MipChain.h"
+#include "AssetPack.h"
+
+namespace
+{
+	const char Magic[4] = { 'S', 'T', 'T', 'X' };
+
+	//bump whenever the layout of the file or the output of MipChain or BlockCompression changes
+	const uint32_t Version = 2;
+
+	//level data starts on this boundary in the file and in storage, so a mapped level can be read with aligned loads
+	const size_t DataAlignment = 16;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t format;
+		uint32_t levelCount;
+
+		uint32_t compress;
+		uint32_t padding;
+		uint64_t sourceSize;
+		int64_t sourceTime;
+	};
+
+	struct LevelRecord
+	{
+		int32_t width;
+		int32_t height;
+		uint32_t rowPitch;
+		uint32_t padding;
+		uint64_t offset;
+		uint64_t bytes;
+	};
+
+	size_t Align(size_t value)
+	{
+		return (value + DataAlignment - 1) / DataAlignment * DataAlignment;
+	}
+
+	size_t DataStart(size_t levelCount)
+	{
+		return Align(sizeof(Header) + levelCount * sizeof(LevelRecord));
+	}
+
+	bool ValidFormat(uint32_t format)
+	{
+		switch (static_cast<TextureCache::Format>(format))
+		{
+		case TextureCache::Format::A8:
+		case TextureCache::Format::R8G8:
+		case TextureCache::Format::R8G8B8A8:
+		case TextureCache::Format::BC1:
+		case TextureCache::Format::BC4:
+		case TextureCache::Format::BC5:
+		case TextureCache::Format::BC7:
+			return true;
+		}
+		return false;
+	}
+
+	//appends a level to storage and returns where its data goes
+	uint8_t* AddLevel(TextureCache::CookedTexture& texture, int width, int height)
+	{
+		TextureCache::Level level;
+		level.width = width;
+		level.height = height;
+		level.rowPitch = static_cast<uint32_t>(TextureCache::RowPitch(texture.format, width));
+		level.offset = Align(texture.storage.size());
+		level.bytes = TextureCache::LevelSize(texture.format, width, height);
+
+		texture.storage.resize(level.offset + level.bytes);
+		texture.levels.push_back(level);
+		return texture.storage.data() + level.offset;
+	}
+}
+
+TextureCache::Format TextureCache::FromBlockCompression(BlockCompression::Format format)
+{
+	return static_cast<Format>(0x100 | static_cast<uint32_t>(format));
+}
+
+size_t TextureCache::RowPitch(Format format, int width)
+{
+	switch (format)
+	{
+	case Format::A8:
+	case Format::R8G8:
+	case Format::R8G8B8A8:
+		return static_cast<size_t>(width) * static_cast<uint32_t>(format);
+
+	default:
+		return static_cast<size_t>((width + 3) / 4) * BlockCompression::BlockBytes(static_cast<BlockCompression::Format>(static_cast<uint32_t>(format) & 0xff));
+	}
+}
+
+size_t TextureCache::LevelSize(Format format, int width, int height)
+{
+	bool blocks = (static_cast<uint32_t>(format) & 0x100) != 0;
+	return RowPitch(format, width) * (blocks ? (height + 3) / 4 : height);
+}
+
+const uint8_t* TextureCache::CookedTexture::LevelData(size_t level) const
+{
+	const uint8_t* base = file.IsOpen() ? reinterpret_cast<const uint8_t*>(file.Data()) + fileDataStart : storage.data();
+	return base + levels[level].offset;
+}
+
+std::string TextureCache::CookedPath(const std::string& sourceFilepath)
+{
+	return sourceFilepath + ".stdtex";
+}
+
+bool TextureCache::Cook(const std::string& sourceFilepath, bool compress, CookedTexture& texture)
+{
+	int width;
+	int height;
+	int channels;
+	Asset source;
+	if (!AssetPack::Open(sourceFilepath, source) || (source.Size() > static_cast<size_t>(INT_MAX)))
+	{
+		return false;
+	}
+
+	unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.Data()), static_cast<int>(source.Size()), &width, &height, &channels, 0);
+	source.Close();
+	if (pixels == NULL)
+	{
+		return false;
+	}
+
+	if (channels == 3)
+	{
+		std::cerr << "unsupported texture format: " << sourceFilepath << std::endl;
+		stbi_image_free(pixels);
+		return false;
+	}
+
+	std::vector<MipChain::Level> mips;
+	MipChain::Build(pixels, width, height, channels, mips);
+
+	texture = CookedTexture();
+
+	BlockCompression::Format blockFormat;
+	if (compress && BlockCompression::Choose(pixels, width, height, channels, blockFormat))
+	{
+		texture.format = FromBlockCompression(blockFormat);
+
+		std::vector<uint8_t> blocks;
+		BlockCompression::Encode(pixels, width, height, channels, blockFormat, blocks);
+		uint8_t* destination = AddLevel(texture, width, height);
+		memcpy(destination, blocks.data(), blocks.size());
+
+		for (const MipChain::Level& mip : mips)
+		{
+			BlockCompression::Encode(mip.pixels.data(), mip.width, mip.height, channels, blockFormat, blocks);
+			destination = AddLevel(texture, mip.width, mip.height);
+			memcpy(destination, blocks.data(), blocks.size());
+		}
+	}
+	else
+	{
+		texture.format = static_cast<Format>(channels);
+
+		uint8_t* destination = AddLevel(texture, width, height);
+		memcpy(destination, pixels, LevelSize(texture.format, width, height));
+		for (const MipChain::Level& mip : mips)
+		{
+			destination = AddLevel(texture, mip.width, mip.height);
+			memcpy(destination, mip.pixels.data(), mip.pixels.size());
+		}
+	}
+
+	stbi_image_free(pixels);
+	return true;
+}
+
+bool TextureCache::Write(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress, const CookedTexture& texture)
+{
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.format = static_cast<uint32_t>(texture.format);
+	header.levelCount = static_cast<uint32_t>(texture.levels.size());
+	header.compress = compress ? 1 : 0;
+
+	if (!AssetPack::SourceInfo(sourceFilepath, header.sourceSize, header.sourceTime))
+	{
+		return false;
+	}
+
+	//same temporary and rename as MeshCache, two loads of one texture can write at the same time
+	std::string temporaryFilepath = cookedFilepath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream cooked(temporaryFilepath, std::ios::binary | std::ios::trunc);
+		if (!cooked.is_open())
+		{
+			std::cerr << "Failed to create cooked texture: " << cookedFilepath << std::endl;
+			return false;
+		}
+
+		cooked.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+		//levels are packed again in case texture was read from a file, the offsets then start at the first level
+		std::vector<LevelRecord> records(texture.levels.size());
+		uint64_t offset = 0;
+		for (size_t i = 0; i < texture.levels.size(); i++)
+		{
+			const Level& level = texture.levels[i];
+			records[i] = { level.width, level.height, level.rowPitch, 0, offset, level.bytes };
+			offset = Align(offset + level.bytes);
+		}
+		cooked.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(LevelRecord));
+
+		const char zeros[DataAlignment] = {};
+		size_t written = sizeof(Header) + records.size() * sizeof(LevelRecord);
+		cooked.write(zeros, DataStart(records.size()) - written);
+
+		for (size_t i = 0; i < texture.levels.size(); i++)
+		{
+			cooked.write(reinterpret_cast<const char*>(texture.LevelData(i)), texture.levels[i].bytes);
+			cooked.write(zeros, Align(texture.levels[i].bytes) - texture.levels[i].bytes);
+		}
+
+		if (!cooked.good())
+		{
+			std::cerr << "Failed to write cooked texture: " << cookedFilepath << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilepath, cookedFilepath, error);
+	if (error)
+	{
+		std::filesystem::remove(temporaryFilepath, error);
+		std::cerr << "Failed to write cooked texture: " << cookedFilepath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool TextureCache::Read(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress, CookedTexture& texture)
+{
+	Asset file;
+	if (!AssetPack::Open(cookedFilepath, file) || (file.Size() < sizeof(Header)))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, file.Data(), sizeof(Header));
+
+	if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || !ValidFormat(header.format) ||
+		(header.compress != (compress ? 1u : 0u)) || (header.levelCount == 0) || (file.Size() < DataStart(header.levelCount)))
+	{
+		return false;
+	}
+
+	//size and timestamp only, hashing would read the whole source and undo most of what cooking saves
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!AssetPack::SourceInfo(sourceFilepath, sourceSize, sourceTime) || (sourceSize != header.sourceSize) || (sourceTime != header.sourceTime))
+	{
+		return false;
+	}
+
+	CookedTexture cooked;
+	cooked.format = static_cast<Format>(header.format);
+	cooked.fileDataStart = DataStart(header.levelCount);
+	cooked.levels.resize(header.levelCount);
+
+	uint64_t dataSize = file.Size() - cooked.fileDataStart;
+	const char* records = file.Data() + sizeof(Header);
+	for (size_t i = 0; i < cooked.levels.size(); i++)
+	{
+		LevelRecord record;
+		memcpy(&record, records + i * sizeof(LevelRecord), sizeof(LevelRecord));
+
+		if ((record.width <= 0) || (record.height <= 0) || (record.rowPitch != RowPitch(cooked.format, record.width)) ||
+			(record.bytes != LevelSize(cooked.format, record.width, record.height)) || (record.offset > dataSize) || (dataSize - record.offset < record.bytes))
+		{
+			return false;
+		}
+
+		Level& level = cooked.levels[i];
+		level.width = record.width;
+		level.height = record.height;
+		level.rowPitch = record.rowPitch;
+		level.offset = record.offset;
+		level.bytes = record.bytes;
+	}
+
+	cooked.file = file;
+	texture = std::move(cooked);
+	return true;
+}
+
+bool TextureCache::Restamp(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress)
+{
+	std::fstream cooked(cookedFilepath, std::ios::binary | std::ios::in | std::ios::out);
+	Header header;
+	if (!cooked.is_open() || !cooked.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+	{
+		return false;
+	}
+
+	if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || (header.compress != (compress ? 1u : 0u)))
+	{
+		return false;
+	}
+
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!AssetPack::SourceInfo(sourceFilepath, sourceSize, sourceTime))
+	{
+		return false;
+	}
+	if ((sourceSize == header.sourceSize) && (sourceTime == header.sourceTime))
+	{
+		return true;
+	}
+
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	cooked.seekp(0);
+	cooked.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	return cooked.good();
+}
+
+bool TextureCache::Load(const std::string& sourceFilepath, bool compress, CookedTexture& texture)
+{
+	std::string cookedFilepath = CookedPath(sourceFilepath);
+	if (Read(cookedFilepath, sourceFilepath, compress, texture))
+	{
+		return true;
+	}
+
+	if (!Cook(sourceFilepath, compress, texture))
+	{
+		return false;
+	}
+
+	//a failed write only costs cooking again next time
+	Write(cookedFilepath, sourceFilepath, compress, texture);
+	return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "BlockCompression.h"
+#include "AssetPack.h"
+
+//material maps are block compressed when their format allows it, see BlockCompression. Particle and other textures stay uncompressed
+#define MATERIAL_TEXTURE_COMPRESSION true
+
+//Cooked textures: the final GPU format with the complete mip chain, written next to the source as "<source>.stdtex".
+//Source and cooked file are read through AssetPack. A current cooked file is mapped and handed to the device as it is, the source image is not decoded at all
+namespace TextureCache
+{
+	enum class Format : uint32_t
+	{
+		A8 = 1,
+		R8G8 = 2,
+		R8G8B8A8 = 4,
+		BC1 = 0x101,
+		BC4 = 0x104,
+		BC5 = 0x105,
+		BC7 = 0x107
+	};
+
+	Format FromBlockCompression(BlockCompression::Format format);
+
+	//bytes of one row of texels, or of one row of 4x4 blocks for the block compressed formats
+	size_t RowPitch(Format format, int width);
+	size_t LevelSize(Format format, int width, int height);
+
+	struct Level
+	{
+		int width = 0;
+		int height = 0;
+		uint32_t rowPitch = 0;
+
+		//from the start of the level data
+		uint64_t offset = 0;
+		uint64_t bytes = 0;
+	};
+
+	struct CookedTexture
+	{
+		Format format = Format::R8G8B8A8;
+
+		//the full resolution level first
+		std::vector<Level> levels;
+
+		//the levels are either in the cooked file asset or in storage, rows at rowPitch exactly like CreateTexture2D takes them
+		const uint8_t* LevelData(size_t level) const;
+
+		Asset file;
+		size_t fileDataStart = 0;
+		std::vector<uint8_t> storage;
+	};
+
+	std::string CookedPath(const std::string& sourceFilepath);
+
+	//decodes the source with stb_image and builds the mip chain, with compress the levels are block compressed when BlockCompression::Choose allows it.
+	//3 channel images are not supported
+	bool Cook(const std::string& sourceFilepath, bool compress, CookedTexture& texture);
+
+	bool Write(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress, const CookedTexture& texture);
+
+	//maps the cooked file without copying the levels. Fails quietly if it is missing, from another version, cooked with the other compress
+	//setting or the source changed size or timestamp since. The source is never opened
+	bool Read(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress, CookedTexture& texture);
+
+	//takes over the size and timestamp of a source that was touched without changing, only the header is read and written.
+	//The caller has to know the content is the same, fails if the cooked file is from another version or compress setting
+	bool Restamp(const std::string& cookedFilepath, const std::string& sourceFilepath, bool compress);
+
+	//Read, or Cook and Write when the cooked file is not current. Can run on any thread
+	bool Load(const std::string& sourceFilepath, bool compress, CookedTexture& texture);
+}
@@ -0,0 +1,130 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threadCount) : stopping(false)
+{
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueCondition.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		tasks.push_back(std::move(task));
+	}
+	queueCondition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::atomic<size_t> nextIndex(0);
+	std::atomic<size_t> finishedHelpers(0);
+
+	auto drain = [&]()
+	{
+		for (size_t i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1))
+		{
+			body(i);
+		}
+	};
+
+	size_t helpers = std::min(static_cast<size_t>(workers.size()), count - 1);
+	for (size_t i = 0; i < helpers; i++)
+	{
+		Submit([&]()
+		{
+			drain();
+			finishedHelpers.fetch_add(1);
+		});
+	}
+
+	drain();
+
+	//helpers may still be queued behind other work, help out instead of blocking so nested calls cannot deadlock
+	while (finishedHelpers.load() < helpers)
+	{
+		if (!RunPendingTask())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+unsigned int ThreadPool::ThreadCount() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			if (tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+bool ThreadPool::RunPendingTask()
+{
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (tasks.empty())
+		{
+			return false;
+		}
+
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	task();
+	return true;
+}
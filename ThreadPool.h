@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+//Small fixed size worker pool for CPU side loading work.
+class ThreadPool
+{
+	public:
+		//0 threads means one worker per hardware thread, minus the calling thread
+		ThreadPool(unsigned int threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void Submit(std::function<void()> task);
+
+		//runs body(0) .. body(count - 1) spread over the workers and the calling thread, returns once all are done
+		void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+		unsigned int ThreadCount() const;
+
+		//pool shared by the loaders so they do not spin up their own threads
+		static ThreadPool& Shared();
+
+	private:
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> tasks;
+
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+		bool stopping;
+
+		void WorkerLoop();
+
+		//runs one queued task on the calling thread, returns false if the queue was empty
+		bool RunPendingTask();
+};
@@ -0,0 +1,50 @@
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+};
+
+struct VertexShaderOutput
+{
+	float4 position : SV_POSITION;
+	float3 normal : normal;
+	float2 uv : uv;
+    float distance : dist;
+};
+
+cbuffer CameraTransform : register(b0)
+{
+	float4x4 cameraTransform;
+	float4x4 inverseCameraTransform;
+};
+
+cbuffer CameraProjection : register(b1)
+{
+	float4x4 projectionMatrix;
+	
+    float widthScalar;
+    float heightScalar;
+
+    float projectionConstantA;
+    float projectionVonstantB;
+};
+
+cbuffer ObjectTransform : register(b2)
+{
+	float4x4 objectWorldTransform;
+	float4x4 inverseObjectWorldTransform;
+};
+
+VertexShaderOutput main(VertexShaderInput input)
+{
+	VertexShaderOutput output;
+	output.position = mul(float4(input.position, 1.0f), objectWorldTransform);
+
+	output.position = mul(output.position, inverseCameraTransform);
+    output.distance = length(output.position);
+	output.position = mul(output.position, projectionMatrix);
+	//only written so the output matches the one PSDistanceWrite was compiled against
+	output.normal = float3(0.0f, 0.0f, 0.0f);
+	output.uv = float2(0.0f, 0.0f);
+
+	return output;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+struct VertexShaderInput
+{
+	float4 position : POSITION;
+	float2 normal : NORMAL;
+	float2 uv : UV;
+};
+
+struct VertexShaderOutput
+{
+	float4 position : SV_POSITION;
+	float3 normal : normal;
+	float2 uv : uv;
+    float distance : dist;
+};
+
+cbuffer CameraTransform : register(b0)
+{
+	float4x4 cameraTransform;
+	float4x4 inverseCameraTransform;
+};
+
+cbuffer CameraProjection : register(b1)
+{
+	float4x4 projectionMatrix;
+	
+    float widthScalar;
+    float heightScalar;
+
+    float projectionConstantA;
+    float projectionVonstantB;
+};
+
+cbuffer ObjectTransform : register(b2)
+{
+	float4x4 objectWorldTransform;
+	float4x4 inverseObjectWorldTransform;
+};
+
+cbuffer MeshDecode : register(b3)
+{
+    float3 boundsMin;
+    float padding1;
+    float3 boundsExtent;
+    float padding2;
+};
+
+//inverse of the octahedral mapping done in VertexQuantization
+float3 OctahedralDecode(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    normal.xy += (normal.xy >= 0.0f) ? -t : t;
+    return normalize(normal);
+}
+
+VertexShaderOutput main(VertexShaderInput input)
+{
+	VertexShaderOutput output;
+    
+    //positions arrive as unorm relative to the mesh bounds
+    float3 position = boundsMin + input.position.xyz * boundsExtent;
+    
+	output.position = mul(float4(position, 1.0f), objectWorldTransform);
+
+	output.position = mul(output.position, inverseCameraTransform);
+    output.distance = length(output.position);
+	output.position = mul(output.position, projectionMatrix);
+	output.normal = mul(float4(OctahedralDecode(input.normal), 0.0f), transpose(inverseObjectWorldTransform));
+    output.normal = normalize(output.normal);
+	output.uv = input.uv;
+
+	return output;
+}
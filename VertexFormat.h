@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+//Vertex formats put together from a list of attributes at compile time. A format derives from its attributes in the order they are listed,
+//so the members keep their names (pos, norm, uv) and the attributes follow each other without padding. Strides, offsets, input layouts
+//and the conversion from a wider format are generated from the list. InputElements in Shaders.h describes a format to the device
+namespace VertexAttribute
+{
+	struct Position
+	{
+		static constexpr const char* Semantic = "POSITION";
+		static constexpr unsigned int Components = 3;
+		using Array = std::array<float, Components>;
+
+		float pos[Components];
+
+		Position() = default;
+		Position(const Array& value)
+		{
+			for (unsigned int i = 0; i < Components; i++)
+			{
+				pos[i] = value[i];
+			}
+		}
+	};
+
+	struct Normal
+	{
+		static constexpr const char* Semantic = "NORMAL";
+		static constexpr unsigned int Components = 3;
+		using Array = std::array<float, Components>;
+
+		float norm[Components];
+
+		Normal() = default;
+		Normal(const Array& value)
+		{
+			for (unsigned int i = 0; i < Components; i++)
+			{
+				norm[i] = value[i];
+			}
+		}
+	};
+
+	struct UV
+	{
+		static constexpr const char* Semantic = "UV";
+		static constexpr unsigned int Components = 2;
+		using Array = std::array<float, Components>;
+
+		float uv[Components];
+
+		UV() = default;
+		UV(const Array& value)
+		{
+			for (unsigned int i = 0; i < Components; i++)
+			{
+				uv[i] = value[i];
+			}
+		}
+	};
+}
+
+//one element of the input layout, all attributes are 32 bit floats in the first vertex buffer slot
+struct VertexAttributeInfo
+{
+	const char* semantic;
+	unsigned int components;
+	unsigned int offset;
+};
+
+//bytes in front of Attribute in a format made from Attributes
+template<typename Attribute, typename... Attributes>
+constexpr unsigned int VertexAttributeOffset()
+{
+	unsigned int offset = 0;
+	bool found = false;
+	((found = found || std::is_same_v<Attribute, Attributes>, offset += found ? 0 : static_cast<unsigned int>(sizeof(Attributes))), ...);
+	return offset;
+}
+
+template<typename... Attributes>
+struct VertexOf : Attributes...
+{
+	static constexpr size_t AttributeCount = sizeof...(Attributes);
+	static constexpr unsigned int Stride = static_cast<unsigned int>((sizeof(Attributes) + ...));
+
+	template<typename Attribute>
+	static constexpr bool Has = (std::is_same_v<Attribute, Attributes> || ...);
+
+	template<typename Attribute>
+	static constexpr unsigned int Offset()
+	{
+		static_assert(Has<Attribute>, "the format does not have this attribute");
+		return VertexAttributeOffset<Attribute, Attributes...>();
+	}
+
+	//in the order of the attribute list
+	static constexpr std::array<VertexAttributeInfo, sizeof...(Attributes)> Layout = { VertexAttributeInfo{ Attributes::Semantic, Attributes::Components, VertexAttributeOffset<Attributes, Attributes...>() }... };
+
+	VertexOf() = default;
+
+	VertexOf(const typename Attributes::Array&... values) : Attributes(values)...
+	{
+	}
+
+	//keeps the attributes of this format, source has to have all of them
+	template<typename Source>
+	static VertexOf From(const Source& source)
+	{
+		VertexOf vertex;
+		((static_cast<Attributes&>(vertex) = static_cast<const Attributes&>(source)), ...);
+		return vertex;
+	}
+
+	template<typename Source>
+	static void Convert(const Source* vertices, size_t vertexCount, std::vector<VertexOf>& converted)
+	{
+		converted.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			converted[i] = From(vertices[i]);
+		}
+	}
+};
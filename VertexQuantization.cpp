@@ -0,0 +1,236 @@
+#include "VertexQuantization.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	uint16_t QuantizeUnorm16(float value)
+	{
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return static_cast<uint16_t>(value * 65535.0f + 0.5f);
+	}
+
+	int16_t QuantizeSnorm16(float value)
+	{
+		value = std::min(std::max(value, -1.0f), 1.0f);
+		return static_cast<int16_t>(roundf(value * 32767.0f));
+	}
+
+	float SignNotZero(float value)
+	{
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+}
+
+uint16_t VertexQuantization::FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(uint32_t));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	//NaN stays NaN, infinity stays infinity
+	if (exponent == 0xFF)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0));
+	}
+
+	int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+	//too large, rounds to infinity
+	if (halfExponent >= 31)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+
+	//denormal or zero in half precision
+	if (halfExponent <= 0)
+	{
+		if (halfExponent < -10)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+
+		mantissa |= 0x800000;
+		uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		uint32_t halfMantissa = mantissa >> shift;
+
+		//round to nearest even
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if ((remainder > halfway) || ((remainder == halfway) && ((halfMantissa & 1) != 0)))
+		{
+			halfMantissa++;
+		}
+		return static_cast<uint16_t>(sign | halfMantissa);
+	}
+
+	uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+
+	//round to nearest even, a carry into the exponent is the correct result
+	uint32_t remainder = mantissa & 0x1FFF;
+	if ((remainder > 0x1000) || ((remainder == 0x1000) && ((half & 1) != 0)))
+	{
+		half++;
+	}
+	return static_cast<uint16_t>(half);
+}
+
+float VertexQuantization::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+
+	uint32_t bits;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0)
+	{
+		//normalize the denormal
+		int32_t shift = 0;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			shift++;
+		}
+		mantissa &= 0x3FF;
+		bits = sign | (static_cast<uint32_t>(127 - 15 + 1 - shift) << 23) | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign;
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(float));
+	return result;
+}
+
+void VertexQuantization::OctahedralEncode(const float normal[3], int16_t encoded[2])
+{
+	float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+	if (length <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+	if (normal[2] < 0.0f)
+	{
+		//fold the lower hemisphere over the diagonals
+		float foldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+		float foldedY = (1.0f - fabsf(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = QuantizeSnorm16(x);
+	encoded[1] = QuantizeSnorm16(y);
+}
+
+void VertexQuantization::OctahedralDecode(const int16_t encoded[2], float normal[3])
+{
+	//same as the shader, SNORM maps -32768 to -1 as well
+	float x = std::max(encoded[0] / 32767.0f, -1.0f);
+	float y = std::max(encoded[1] / 32767.0f, -1.0f);
+	float z = 1.0f - fabsf(x) - fabsf(y);
+
+	float t = std::max(-z, 0.0f);
+	x += (x >= 0.0f) ? -t : t;
+	y += (y >= 0.0f) ? -t : t;
+
+	float length = sqrtf(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+void VertexQuantization::Quantize(const Vertex* vertices, size_t vertexCount, std::vector<CompactVertex>& compact, MeshDecodeBufferStruct& decode)
+{
+	float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+	float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			if ((i == 0) || (vertices[i].pos[k] < boundsMin[k]))
+			{
+				boundsMin[k] = vertices[i].pos[k];
+			}
+			if ((i == 0) || (vertices[i].pos[k] > boundsMax[k]))
+			{
+				boundsMax[k] = vertices[i].pos[k];
+			}
+		}
+	}
+
+	for (int k = 0; k < 3; k++)
+	{
+		decode.boundsMin[k] = boundsMin[k];
+		decode.boundsExtent[k] = boundsMax[k] - boundsMin[k];
+	}
+	decode.padding1 = 0.0f;
+	decode.padding2 = 0.0f;
+
+	compact.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const Vertex& vertex = vertices[i];
+		CompactVertex& result = compact[i];
+
+		for (int k = 0; k < 3; k++)
+		{
+			//a flat axis has no extent, every vertex sits on the minimum
+			float relative = (decode.boundsExtent[k] > 0.0f) ? (vertex.pos[k] - boundsMin[k]) / decode.boundsExtent[k] : 0.0f;
+			result.pos[k] = QuantizeUnorm16(relative);
+		}
+		result.pos[3] = 0;
+
+		OctahedralEncode(vertex.norm, result.norm);
+
+		result.uv[0] = FloatToHalf(vertex.uv[0]);
+		result.uv[1] = FloatToHalf(vertex.uv[1]);
+	}
+}
+
+Vertex VertexQuantization::Dequantize(const CompactVertex& vertex, const MeshDecodeBufferStruct& decode)
+{
+	Vertex result;
+	for (int k = 0; k < 3; k++)
+	{
+		result.pos[k] = decode.boundsMin[k] + (vertex.pos[k] / 65535.0f) * decode.boundsExtent[k];
+	}
+
+	OctahedralDecode(vertex.norm, result.norm);
+
+	result.uv[0] = HalfToFloat(vertex.uv[0]);
+	result.uv[1] = HalfToFloat(vertex.uv[1]);
+	return result;
+}
+
+bool VertexQuantization::FitsShortIndices(size_t vertexCount)
+{
+	return vertexCount < 65536;
+}
+
+void VertexQuantization::ShortenIndices(const uint32_t* indices, size_t indexCount, std::vector<uint16_t>& shortIndices)
+{
+	shortIndices.resize(indexCount);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		shortIndices[i] = static_cast<uint16_t>(indices[i]);
+	}
+}
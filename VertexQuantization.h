@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "MeshData.h"
+
+//16 byte vertex, half the size of Vertex. Decoded in VSMeshGeometryPassCompact.
+struct CompactVertex {
+	uint16_t pos[4];	//unorm16 relative to the mesh bounds, w unused
+	int16_t norm[2];	//octahedral snorm16
+	uint16_t uv[2];		//half floats
+};
+
+//what the vertex shader needs to turn the unorm positions back into object space, padded for a constant buffer
+struct MeshDecodeBufferStruct
+{
+	float boundsMin[3];
+	float padding1;
+	float boundsExtent[3];
+	float padding2;
+};
+
+//Encoding and decoding of CompactVertex.
+namespace VertexQuantization
+{
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	void OctahedralEncode(const float normal[3], int16_t encoded[2]);
+	void OctahedralDecode(const int16_t encoded[2], float normal[3]);
+
+	void Quantize(const Vertex* vertices, size_t vertexCount, std::vector<CompactVertex>& compact, MeshDecodeBufferStruct& decode);
+	Vertex Dequantize(const CompactVertex& vertex, const MeshDecodeBufferStruct& decode);
+
+	//16 bit index buffers can address this many vertices
+	bool FitsShortIndices(size_t vertexCount);
+	void ShortenIndices(const uint32_t* indices, size_t indexCount, std::vector<uint16_t>& shortIndices);
+}
@@ -4,6 +4,7 @@
 #include <DirectXMath.h>
 #include <chrono>
 #include <vector>
+#include <filesystem>
 
 #include "WindowHelper.h"
 #include "BaseObject.h"
@@ -15,6 +16,10 @@
 #include "Lights.h"
 #include "QuadTree.h"
 #include "ParticleSystems.h"
+#include "Diagnostics.h"
+#include "AsyncLoading.h"
+#include "AssetPack.h"
+#include "AssetCooker.h"
 
 #define SceneStepRate 60
 #define CameraPositionStepSize 0.05f
@@ -26,6 +31,22 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 {
 	//--------------------------------Setup--------------------------------//
 	
+	//"-benchmark" runs the headless loading benchmarks instead of the scene
+	if (wcsstr(lpCmdLine, L"-benchmark") != nullptr)
+	{
+		return Diagnostics::Run();
+	}
+
+	//"-cook" brings every mesh cache and cooked texture up to date, with "-pack" also the asset pack the scene mounts
+	if (wcsstr(lpCmdLine, L"-cook") != nullptr)
+	{
+		AssetCooker::Options options;
+		options.packFilepath = (wcsstr(lpCmdLine, L"-pack") != nullptr) ? AssetPack::DefaultPath : "";
+
+		AssetCooker::Report report;
+		return AssetCooker::Run(options, report) ? 0 : -1;
+	}
+
 	//Make sure width and height are multiples of 32 for compute shader to work properly
 	const UINT WIDTH = 1024;
 	const UINT HEIGHT = 576;
@@ -37,6 +58,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 		return -1;
 	}
 
+	//shaders, meshes and textures are read from the pack when there is one, the loose files are only used for what it does not have
+	if (std::filesystem::exists(AssetPack::DefaultPath))
+	{
+		AssetPack::Mount(AssetPack::DefaultPath);
+	}
+
 	Pipeline::SetupRender(WIDTH, HEIGHT, window);
 	SharedResources::Setup();
 
@@ -159,7 +186,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 		for (int j = 0; j < 9; j++)
 		{
 			int index = j + i * 9;
-			cornerCubes[index] = new STDOBJ("OBJ/simpleCube.obj");
+			cornerCubes[index] = new STDOBJ("OBJ/simpleCube.obj", SCENE_CORNER_CUBE_FLAGS | OBJ_IMPORT_ASYNC);
 
 			cornerCubes[index]->Translate({-50.0f + i * 12.5f, 0.0f, -50.0f + j * 12.5f }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
 
@@ -178,7 +205,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 	//-----------------------------Miscelanious----------------------------//
 
 	//the robot with original flat shading. made to rotate later in the render loop
-	STDOBJ hugin = STDOBJ("OBJ/Hugin.obj");
+	STDOBJ hugin = STDOBJ("OBJ/Hugin.obj", SCENE_HUGIN_FLAGS | OBJ_IMPORT_ASYNC);
 
 	hugin.Scale({ 0.05f, 0.05f, 0.05f }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
 	hugin.Rotate({ 0.0f, 180.0f, 0.0f }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE, OBJECT_ROTATION_UNIT_DEGREES);
@@ -196,7 +223,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 	huginSmooth.AddToQuadTree(&staticObjects);
 
 	//cube transformed into a floor plane to showcase transformations and casted shadows
-	STDOBJ cube = STDOBJ("OBJ/simpleCube.obj");
+	STDOBJ cube = STDOBJ("OBJ/simpleCube.obj", SCENE_FLOOR_CUBE_FLAGS);
 
 	cube.Translate({ 0.0f, -1.0f, 0.0f }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
 	cube.Scale({ 10.0f, 0.05f, 10.0f }, OBJECT_TRANSFORM_SPACE_GLOBAL, OBJECT_TRANSFORM_REPLACE);
@@ -289,6 +316,10 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 
 	std::chrono::steady_clock timer;
 	std::chrono::time_point<std::chrono::steady_clock> previous = timer.now();
+	std::chrono::time_point<std::chrono::steady_clock> previousReport = previous;
+
+	//"-stats" prints the draw and mesh arena statistics once a second
+	const bool printStatistics = wcsstr(lpCmdLine, L"-stats") != nullptr;
 
 	bool key3Hold = false;
 	bool secondaryCamera = false;
@@ -303,6 +334,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 			DispatchMessage(&msg);
 		}
 
+		//finishes asynchronous loads that are waiting to create their device resources
+		AsyncLoading::Pump();
+		SharedResources::UpdateMaterials();
+
+		Pipeline::Statistics::Reset();
+
 		Pipeline::Clean::UnorderedAccessView(backbufferUAV);
 		mainRenderer.CameraDeferredRender(&mainCamera, backbufferUAV);
 		
@@ -318,6 +355,19 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 
 		std::chrono::time_point<std::chrono::steady_clock> now = timer.now();
 
+		//submitted work of the last frame, shadow map passes included
+		if (printStatistics && (std::chrono::duration<double>(now - previousReport).count() >= 1.0))
+		{
+			previousReport = now;
+			std::cout << Pipeline::Statistics::DrawCalls() << " draw calls, " << Pipeline::Statistics::Triangles() << " triangles, "
+				<< Pipeline::Statistics::MaterialChanges() << " material changes, " << Pipeline::Statistics::MaterialBinds() << " material binds, "
+				<< Pipeline::Statistics::BufferBinds() << " buffer binds" << std::endl;
+
+			MeshArena::Report arena = SharedResources::MeshArenaReport();
+			std::cout << "mesh arena: " << arena.usedBytes / 1024 << " of " << arena.capacityBytes / 1024 << " KB in " << arena.buffers << " buffers, peak " << arena.peakBytes / 1024 << " KB, "
+				<< arena.allocations << " ranges, " << arena.freeRanges << " free ranges, " << arena.Fragmentation() * 100.0 << "% fragmented" << std::endl;
+		}
+
 		std::chrono::duration<double> deltaTime = now - previous;
 
 		//fixed time delta update